@@ -0,0 +1,680 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Crossfades the two inputs of an audio transition.
+ *
+ * The gains are computed for every sample from its stream time, which goes
+ * from 0 to the duration of the transition, so the fade does not depend on
+ * the size of the buffers. They are first written to two arrays, one value
+ * per sample, and then applied in a single branch-free loop that the
+ * compiler can vectorize.
+ *
+ * As for gesvideoblend, both inputs have to match the caps the first input
+ * negotiated, which the caps query of the sink pads answers with. */
+
+#include <math.h>
+#include <string.h>
+
+#include <gst/audio/audio.h>
+#include <gst/base/gstcollectpads.h>
+
+#include "ges-internal.h"
+
+#define GES_AUDIO_CROSSFADE(obj) ((GESAudioCrossfade *) (obj))
+
+typedef struct _GESAudioCrossfade GESAudioCrossfade;
+typedef struct _GESAudioCrossfadeClass GESAudioCrossfadeClass;
+
+typedef struct
+{
+  GstCollectData data;
+
+  /* The caps of this input are not the output ones yet */
+  gboolean mismatch;
+} GESAudioCrossfadeData;
+
+struct _GESAudioCrossfade
+{
+  GstElement parent;
+
+  GstPad *srcpad;
+  GstPad *sinka;
+  GstPad *sinkb;
+
+  GstCollectPads *collect;
+  GESAudioCrossfadeData *dataa;
+  GESAudioCrossfadeData *datab;
+
+  /* Protected by the object lock */
+  GstCaps *caps;
+  GstAudioInfo info;
+  gboolean send_caps;
+  GstClockTime duration;
+  GESAudioTransitionCurve curve;
+
+  /* Only accessed from the streaming thread */
+  gboolean send_segment;
+  GstSegment segment;
+  guint64 offset;               /* In frames since the start of the segment */
+
+  gfloat *gaina;
+  gfloat *gainb;
+  gint32 *igaina;
+  gint32 *igainb;
+  guint n_gains;
+};
+
+struct _GESAudioCrossfadeClass
+{
+  GstElementClass parent_class;
+};
+
+G_DEFINE_TYPE (GESAudioCrossfade, ges_audio_crossfade, GST_TYPE_ELEMENT);
+
+enum
+{
+  PROP_0,
+  PROP_DURATION,
+  PROP_CURVE
+};
+
+#define CROSSFADE_CAPS GST_AUDIO_CAPS_MAKE ("{ " GST_AUDIO_NE (F32) ", " \
+    GST_AUDIO_NE (S16) " }") ", layout = (string) interleaved"
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CROSSFADE_CAPS));
+
+static GstStaticPadTemplate sink_a_template =
+GST_STATIC_PAD_TEMPLATE ("sink_a",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CROSSFADE_CAPS));
+
+static GstStaticPadTemplate sink_b_template =
+GST_STATIC_PAD_TEMPLATE ("sink_b",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CROSSFADE_CAPS));
+
+static void
+free_gains (GESAudioCrossfade * fade)
+{
+  g_free (fade->gaina);
+  g_free (fade->gainb);
+  g_free (fade->igaina);
+  g_free (fade->igainb);
+  fade->gaina = fade->gainb = NULL;
+  fade->igaina = fade->igainb = NULL;
+  fade->n_gains = 0;
+}
+
+static void
+reset (GESAudioCrossfade * fade)
+{
+  GST_OBJECT_LOCK (fade);
+  gst_caps_replace (&fade->caps, NULL);
+  gst_audio_info_init (&fade->info);
+  fade->send_caps = FALSE;
+  GST_OBJECT_UNLOCK (fade);
+
+  fade->send_segment = TRUE;
+  fade->offset = 0;
+  fade->dataa->mismatch = FALSE;
+  fade->datab->mismatch = FALSE;
+  free_gains (fade);
+}
+
+static GstCaps *
+get_input_caps (GESAudioCrossfade * fade, GstPad * pad, GstCaps * filter)
+{
+  GstCaps *caps, *template, *tmp;
+
+  template = gst_pad_get_pad_template_caps (pad);
+
+  GST_OBJECT_LOCK (fade);
+  if (fade->caps) {
+    caps = gst_caps_ref (fade->caps);
+    GST_OBJECT_UNLOCK (fade);
+  } else {
+    GST_OBJECT_UNLOCK (fade);
+
+    caps = gst_pad_peer_query_caps (fade->srcpad, template);
+  }
+
+  tmp = gst_caps_intersect (caps, template);
+  gst_caps_unref (caps);
+  gst_caps_unref (template);
+  caps = tmp;
+
+  if (filter) {
+    tmp = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+    caps = tmp;
+  }
+
+  return caps;
+}
+
+static gboolean
+set_input_caps (GESAudioCrossfade * fade, GESAudioCrossfadeData * data,
+    GstCaps * caps)
+{
+  GstAudioInfo info;
+
+  if (!gst_audio_info_from_caps (&info, caps)) {
+    GST_WARNING_OBJECT (data->data.pad, "Invalid caps %" GST_PTR_FORMAT, caps);
+    return FALSE;
+  }
+
+  GST_OBJECT_LOCK (fade);
+  if (fade->caps == NULL) {
+    GST_DEBUG_OBJECT (data->data.pad, "Output caps %" GST_PTR_FORMAT, caps);
+
+    fade->caps = gst_caps_ref (caps);
+    fade->info = info;
+    fade->send_caps = TRUE;
+    data->mismatch = FALSE;
+  } else if (gst_caps_is_equal (caps, fade->caps)) {
+    data->mismatch = FALSE;
+  } else {
+    GST_DEBUG_OBJECT (data->data.pad, "%" GST_PTR_FORMAT " does not match "
+        "the output caps, renegotiating", caps);
+    data->mismatch = TRUE;
+  }
+  GST_OBJECT_UNLOCK (fade);
+
+  if (data->mismatch)
+    gst_pad_push_event (data->data.pad, gst_event_new_reconfigure ());
+
+  return TRUE;
+}
+
+static gboolean
+ges_audio_crossfade_sink_event (GstCollectPads * pads, GstCollectData * data,
+    GstEvent * event, GESAudioCrossfade * fade)
+{
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      gboolean ret;
+
+      gst_event_parse_caps (event, &caps);
+      ret = set_input_caps (fade, (GESAudioCrossfadeData *) data, caps);
+      gst_event_unref (event);
+
+      return ret;
+    }
+    case GST_EVENT_SEGMENT:
+    case GST_EVENT_FLUSH_STOP:
+      fade->send_segment = TRUE;
+      break;
+    default:
+      break;
+  }
+
+  return gst_collect_pads_event_default (pads, data, event, FALSE);
+}
+
+static gboolean
+ges_audio_crossfade_sink_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GESAudioCrossfade *fade = GES_AUDIO_CROSSFADE (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps;
+
+      gst_query_parse_caps (query, &filter);
+      caps = get_input_caps (fade, pad, filter);
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+
+      return TRUE;
+    }
+    case GST_QUERY_ACCEPT_CAPS:
+    {
+      GstCaps *caps, *allowed;
+
+      gst_query_parse_accept_caps (query, &caps);
+      allowed = get_input_caps (fade, pad, NULL);
+      gst_query_set_accept_caps_result (query,
+          gst_caps_can_intersect (caps, allowed));
+      gst_caps_unref (allowed);
+
+      return TRUE;
+    }
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static gboolean
+ges_audio_crossfade_src_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GESAudioCrossfade *fade = GES_AUDIO_CROSSFADE (parent);
+  gboolean ret;
+
+  /* Both inputs are driven by the same composition */
+  gst_event_ref (event);
+  ret = gst_pad_push_event (fade->sinka, event);
+  ret &= gst_pad_push_event (fade->sinkb, event);
+
+  return ret;
+}
+
+static gboolean
+ges_audio_crossfade_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GESAudioCrossfade *fade = GES_AUDIO_CROSSFADE (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps;
+
+      gst_query_parse_caps (query, &filter);
+
+      GST_OBJECT_LOCK (fade);
+      if (fade->caps)
+        caps = gst_caps_ref (fade->caps);
+      else
+        caps = gst_pad_get_pad_template_caps (pad);
+      GST_OBJECT_UNLOCK (fade);
+
+      if (filter) {
+        GstCaps *tmp =
+            gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+
+        gst_caps_unref (caps);
+        caps = tmp;
+      }
+
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+
+      return TRUE;
+    }
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+/* Fills the gains of the @n_samples samples starting at @stream_time */
+static void
+compute_gains (GESAudioCrossfade * fade, GstAudioInfo * info,
+    GstClockTime stream_time, guint n_samples)
+{
+  GESAudioTransitionCurve curve;
+  GstClockTime duration;
+  gint channels = GST_AUDIO_INFO_CHANNELS (info);
+  gdouble position, step;
+  guint i, c;
+
+  GST_OBJECT_LOCK (fade);
+  duration = fade->duration;
+  curve = fade->curve;
+  GST_OBJECT_UNLOCK (fade);
+
+  if (n_samples > fade->n_gains) {
+    free_gains (fade);
+    fade->gaina = g_new (gfloat, n_samples);
+    fade->gainb = g_new (gfloat, n_samples);
+    fade->igaina = g_new (gint32, n_samples);
+    fade->igainb = g_new (gint32, n_samples);
+    fade->n_gains = n_samples;
+  }
+
+  if (duration == 0 || !GST_CLOCK_TIME_IS_VALID (duration) ||
+      !GST_CLOCK_TIME_IS_VALID (stream_time)) {
+    position = 1.0;
+    step = 0.0;
+  } else {
+    position = (gdouble) stream_time / duration;
+    step = (gdouble) GST_SECOND / duration / GST_AUDIO_INFO_RATE (info);
+  }
+
+  for (i = 0; i < n_samples; i += channels) {
+    gdouble p = CLAMP (position, 0.0, 1.0);
+    gfloat a, b;
+
+    if (curve == GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER) {
+      a = cos (p * G_PI_2);
+      b = sin (p * G_PI_2);
+    } else {
+      a = 1.0 - p;
+      b = p;
+    }
+
+    for (c = 0; c < channels; c++) {
+      fade->gaina[i + c] = a;
+      fade->gainb[i + c] = b;
+    }
+
+    position += step;
+  }
+
+  if (GST_AUDIO_INFO_FORMAT (info) == GST_AUDIO_FORMAT_S16) {
+    for (i = 0; i < n_samples; i++) {
+      fade->igaina[i] = (gint32) (fade->gaina[i] * 32768 + 0.5);
+      fade->igainb[i] = (gint32) (fade->gainb[i] * 32768 + 0.5);
+    }
+  }
+}
+
+static void
+mix_f32 (gfloat * out, const gfloat * a, const gfloat * b, const gfloat * ga,
+    const gfloat * gb, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++)
+    out[i] = a[i] * ga[i] + b[i] * gb[i];
+}
+
+static void
+mix_s16 (gint16 * out, const gint16 * a, const gint16 * b, const gint32 * ga,
+    const gint32 * gb, guint n)
+{
+  guint i;
+
+  /* Equal power gains add up to more than 1 in the middle, clip */
+  for (i = 0; i < n; i++) {
+    gint32 v = (a[i] * ga[i] + b[i] * gb[i] + 16384) >> 15;
+
+    out[i] = CLAMP (v, G_MININT16, G_MAXINT16);
+  }
+}
+
+static GstBuffer *
+silence (gsize size)
+{
+  GstBuffer *buffer = gst_buffer_new_allocate (NULL, size, NULL);
+
+  gst_buffer_memset (buffer, 0, 0, size);
+
+  return buffer;
+}
+
+static GstFlowReturn
+ges_audio_crossfade_collected (GstCollectPads * pads, GESAudioCrossfade * fade)
+{
+  GstBuffer *bufa, *bufb;
+  GstMapInfo mapa, mapb;
+  GstAudioInfo info;
+  GstCaps *caps = NULL;
+  GstClockTime timestamp, stream_time;
+  guint avail, n_frames, n_samples;
+
+  GST_OBJECT_LOCK (fade);
+  info = fade->info;
+  if (fade->send_caps) {
+    caps = gst_caps_ref (fade->caps);
+    fade->send_caps = FALSE;
+  }
+  GST_OBJECT_UNLOCK (fade);
+
+  if (caps) {
+    gst_pad_push_event (fade->srcpad, gst_event_new_caps (caps));
+    gst_caps_unref (caps);
+  }
+
+  avail = gst_collect_pads_available (pads);
+  if (avail == 0) {
+    GST_DEBUG_OBJECT (fade, "All inputs are EOS");
+    gst_pad_push_event (fade->srcpad, gst_event_new_eos ());
+
+    return GST_FLOW_EOS;
+  }
+
+  if (GST_AUDIO_INFO_BPF (&info) == 0) {
+    GST_ELEMENT_ERROR (fade, CORE, NEGOTIATION, (NULL),
+        ("Received data before caps"));
+
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  n_frames = avail / GST_AUDIO_INFO_BPF (&info);
+  avail = n_frames * GST_AUDIO_INFO_BPF (&info);
+  n_samples = n_frames * GST_AUDIO_INFO_CHANNELS (&info);
+
+  bufa = gst_collect_pads_take_buffer (pads, (GstCollectData *) fade->dataa,
+      avail);
+  bufb = gst_collect_pads_take_buffer (pads, (GstCollectData *) fade->datab,
+      avail);
+
+  /* Missing inputs and inputs that are still renegotiating are silent */
+  if (bufa && fade->dataa->mismatch) {
+    gst_buffer_unref (bufa);
+    bufa = NULL;
+  }
+  if (bufb && fade->datab->mismatch) {
+    gst_buffer_unref (bufb);
+    bufb = NULL;
+  }
+  if (bufa == NULL && bufb == NULL)
+    return GST_FLOW_OK;
+  if (bufa == NULL)
+    bufa = silence (avail);
+  if (bufb == NULL)
+    bufb = silence (avail);
+
+  if (fade->send_segment) {
+    GstCollectData *data = (GstCollectData *) fade->dataa;
+
+    if (data->state & GST_COLLECT_PADS_STATE_EOS)
+      data = (GstCollectData *) fade->datab;
+
+    fade->segment = data->segment;
+    fade->offset = 0;
+    gst_pad_push_event (fade->srcpad, gst_event_new_segment (&fade->segment));
+    fade->send_segment = FALSE;
+  }
+
+  timestamp = fade->segment.start + gst_util_uint64_scale_int (fade->offset,
+      GST_SECOND, GST_AUDIO_INFO_RATE (&info));
+  stream_time = gst_segment_to_stream_time (&fade->segment, GST_FORMAT_TIME,
+      timestamp);
+
+  compute_gains (fade, &info, stream_time, n_samples);
+
+  /* Mix in place in the first input */
+  bufa = gst_buffer_make_writable (bufa);
+  gst_buffer_map (bufa, &mapa, GST_MAP_READWRITE);
+  gst_buffer_map (bufb, &mapb, GST_MAP_READ);
+
+  if (GST_AUDIO_INFO_FORMAT (&info) == GST_AUDIO_FORMAT_S16)
+    mix_s16 ((gint16 *) mapa.data, (gint16 *) mapa.data,
+        (gint16 *) mapb.data, fade->igaina, fade->igainb, n_samples);
+  else
+    mix_f32 ((gfloat *) mapa.data, (gfloat *) mapa.data,
+        (gfloat *) mapb.data, fade->gaina, fade->gainb, n_samples);
+
+  gst_buffer_unmap (bufb, &mapb);
+  gst_buffer_unmap (bufa, &mapa);
+  gst_buffer_unref (bufb);
+
+  GST_BUFFER_TIMESTAMP (bufa) = timestamp;
+  GST_BUFFER_OFFSET (bufa) = fade->offset;
+  fade->offset += n_frames;
+  GST_BUFFER_OFFSET_END (bufa) = fade->offset;
+  GST_BUFFER_DURATION (bufa) = fade->segment.start +
+      gst_util_uint64_scale_int (fade->offset, GST_SECOND,
+      GST_AUDIO_INFO_RATE (&info)) - timestamp;
+
+  return gst_pad_push (fade->srcpad, bufa);
+}
+
+static GstStateChangeReturn
+ges_audio_crossfade_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GESAudioCrossfade *fade = GES_AUDIO_CROSSFADE (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      reset (fade);
+      gst_collect_pads_start (fade->collect);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* Unblock the streaming threads before chaining up */
+      gst_collect_pads_stop (fade->collect);
+      break;
+    default:
+      break;
+  }
+
+  ret =
+      GST_ELEMENT_CLASS (ges_audio_crossfade_parent_class)->change_state
+      (element, transition);
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+    reset (fade);
+
+  return ret;
+}
+
+static void
+ges_audio_crossfade_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GESAudioCrossfade *fade = GES_AUDIO_CROSSFADE (object);
+
+  GST_OBJECT_LOCK (fade);
+  switch (property_id) {
+    case PROP_DURATION:
+      g_value_set_uint64 (value, fade->duration);
+      break;
+    case PROP_CURVE:
+      g_value_set_enum (value, fade->curve);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+  GST_OBJECT_UNLOCK (fade);
+}
+
+static void
+ges_audio_crossfade_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GESAudioCrossfade *fade = GES_AUDIO_CROSSFADE (object);
+
+  GST_OBJECT_LOCK (fade);
+  switch (property_id) {
+    case PROP_DURATION:
+      fade->duration = g_value_get_uint64 (value);
+      break;
+    case PROP_CURVE:
+      fade->curve = g_value_get_enum (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+  GST_OBJECT_UNLOCK (fade);
+}
+
+static void
+ges_audio_crossfade_finalize (GObject * object)
+{
+  GESAudioCrossfade *fade = GES_AUDIO_CROSSFADE (object);
+
+  gst_caps_replace (&fade->caps, NULL);
+  free_gains (fade);
+  gst_object_unref (fade->collect);
+
+  G_OBJECT_CLASS (ges_audio_crossfade_parent_class)->finalize (object);
+}
+
+static void
+ges_audio_crossfade_class_init (GESAudioCrossfadeClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  object_class->get_property = ges_audio_crossfade_get_property;
+  object_class->set_property = ges_audio_crossfade_set_property;
+  object_class->finalize = ges_audio_crossfade_finalize;
+
+  g_object_class_install_property (object_class, PROP_DURATION,
+      g_param_spec_uint64 ("duration", "Duration",
+          "Duration of the crossfade, in stream time", 0, G_MAXUINT64,
+          GST_CLOCK_TIME_NONE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (object_class, PROP_CURVE,
+      g_param_spec_enum ("curve", "Curve", "The shape of the gains",
+          GES_TYPE_AUDIO_TRANSITION_CURVE, GES_AUDIO_TRANSITION_CURVE_LINEAR,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  element_class->change_state = ges_audio_crossfade_change_state;
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&src_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_a_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_b_template));
+
+  gst_element_class_set_metadata (element_class,
+      "GES audio crossfade", "Filter/Editor/Audio",
+      "Crossfades two audio streams with per-sample gains",
+      "GStreamer Editing Services");
+}
+
+static void
+ges_audio_crossfade_init (GESAudioCrossfade * fade)
+{
+  fade->duration = GST_CLOCK_TIME_NONE;
+  fade->curve = GES_AUDIO_TRANSITION_CURVE_LINEAR;
+  gst_audio_info_init (&fade->info);
+  gst_segment_init (&fade->segment, GST_FORMAT_TIME);
+
+  fade->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_set_event_function (fade->srcpad, ges_audio_crossfade_src_event);
+  gst_pad_set_query_function (fade->srcpad, ges_audio_crossfade_src_query);
+  gst_element_add_pad (GST_ELEMENT (fade), fade->srcpad);
+
+  fade->sinka = gst_pad_new_from_static_template (&sink_a_template, "sink_a");
+  fade->sinkb = gst_pad_new_from_static_template (&sink_b_template, "sink_b");
+
+  fade->collect = gst_collect_pads_new ();
+  gst_collect_pads_set_function (fade->collect,
+      (GstCollectPadsFunction) ges_audio_crossfade_collected, fade);
+  gst_collect_pads_set_event_function (fade->collect,
+      (GstCollectPadsEventFunction) ges_audio_crossfade_sink_event, fade);
+
+  fade->dataa = (GESAudioCrossfadeData *)
+      gst_collect_pads_add_pad (fade->collect, fade->sinka,
+      sizeof (GESAudioCrossfadeData), NULL, TRUE);
+  fade->datab = (GESAudioCrossfadeData *)
+      gst_collect_pads_add_pad (fade->collect, fade->sinkb,
+      sizeof (GESAudioCrossfadeData), NULL, TRUE);
+
+  gst_pad_set_query_function (fade->sinka, ges_audio_crossfade_sink_query);
+  gst_pad_set_query_function (fade->sinkb, ges_audio_crossfade_sink_query);
+
+  gst_element_add_pad (GST_ELEMENT (fade), fade->sinka);
+  gst_element_add_pad (GST_ELEMENT (fade), fade->sinkb);
+}
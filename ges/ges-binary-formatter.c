@@ -0,0 +1,881 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:ges-binary-formatter
+ * @short_description: Compact binary formatter
+ *
+ * Saves the same information as #GESKeyfileFormatter in a compact binary
+ * file that is written in a single pass over the timeline and that is
+ * loaded directly from a memory mapping of the file.
+ *
+ * The file starts with a header and an index of its sections, each of them
+ * being an array of fixed size little endian records:
+ * <itemizedlist>
+ * <listitem><para>the string table, all the strings of the project
+ * (type and property names, caps, uris...) stored once and referenced by
+ * their offset in the table,</para></listitem>
+ * <listitem><para>the tracks,</para></listitem>
+ * <listitem><para>the layers, each referencing a range of
+ * objects,</para></listitem>
+ * <listitem><para>the sources, that is the uris of the
+ * #GESTimelineFileSource-s,</para></listitem>
+ * <listitem><para>the objects, with their timing stored as is and
+ * referencing a range of properties,</para></listitem>
+ * <listitem><para>the properties, whose values are stored in binary form
+ * when possible and serialized otherwise.</para></listitem>
+ * </itemizedlist>
+ *
+ * Unknown sections are ignored so that new ones can be added without
+ * breaking older readers, changes to the existing records bump the
+ * version.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "ges.h"
+#include "ges-internal.h"
+
+G_DEFINE_TYPE (GESBinaryFormatter, ges_binary_formatter, GES_TYPE_FORMATTER);
+
+#define BINARY_MAGIC "GESB"
+#define BINARY_VERSION 1
+
+/* Reference to nothing in a string or source table */
+#define NO_REF G_MAXUINT32
+
+typedef enum
+{
+  SECTION_STRINGS = 1,
+  SECTION_TRACKS,
+  SECTION_LAYERS,
+  SECTION_SOURCES,
+  SECTION_OBJECTS,
+  SECTION_PROPERTIES,
+  SECTION_LAST
+} SectionId;
+
+#define N_SECTIONS (SECTION_LAST - 1)
+
+typedef struct
+{
+  gchar magic[4];
+  guint32 version;
+  guint32 n_sections;
+  guint32 reserved;
+} FileHeader;
+
+typedef struct
+{
+  guint32 id;
+  guint32 reserved;
+  guint64 offset;               /* From the start of the file, 8 bytes aligned */
+  guint64 size;
+} SectionEntry;
+
+typedef struct
+{
+  guint32 type;                 /* GESTrackType */
+  guint32 caps;                 /* string */
+} TrackRecord;
+
+#define LAYER_FLAG_SIMPLE (1 << 0)
+
+typedef struct
+{
+  guint32 priority;
+  guint32 flags;
+  guint32 first_object;
+  guint32 n_objects;
+} LayerRecord;
+
+typedef struct
+{
+  guint32 uri;                  /* string */
+} SourceRecord;
+
+typedef struct
+{
+  guint64 start;
+  guint64 inpoint;
+  guint64 duration;
+  guint32 priority;
+  guint32 type;                 /* string, the GType name */
+  guint32 source;               /* index in the sources or NO_REF */
+  guint32 first_property;
+  guint32 n_properties;
+  guint32 reserved;
+} ObjectRecord;
+
+typedef enum
+{
+  VALUE_BOOLEAN = 1,
+  VALUE_INT,
+  VALUE_UINT,
+  VALUE_INT64,
+  VALUE_UINT64,
+  VALUE_DOUBLE,
+  VALUE_STRING,                 /* string or NO_REF */
+  VALUE_SERIALIZED              /* string, from gst_value_serialize() */
+} ValueKind;
+
+typedef struct
+{
+  guint32 name;                 /* string */
+  guint32 kind;                 /* ValueKind */
+  guint64 value;
+} PropertyRecord;
+
+/* Properties stored in the ObjectRecord-s */
+static const gchar *const record_properties[] =
+    { "start", "in-point", "duration", "priority", NULL };
+
+static gboolean save_binary (GESFormatter * formatter, GESTimeline * timeline);
+static gboolean load_binary (GESFormatter * formatter, GESTimeline * timeline);
+static gboolean load_binary_from_uri (GESFormatter * formatter,
+    GESTimeline * timeline, const gchar * uri);
+
+static void
+ges_binary_formatter_class_init (GESBinaryFormatterClass * klass)
+{
+  GESFormatterClass *formatter_klass;
+
+  formatter_klass = GES_FORMATTER_CLASS (klass);
+
+  formatter_klass->save = save_binary;
+  formatter_klass->load = load_binary;
+  formatter_klass->load_from_uri = load_binary_from_uri;
+}
+
+static void
+ges_binary_formatter_init (GESBinaryFormatter * object)
+{
+}
+
+/**
+ * ges_binary_formatter_new:
+ *
+ * Creates a new #GESBinaryFormatter.
+ *
+ * Returns: The newly created #GESBinaryFormatter.
+ */
+GESBinaryFormatter *
+ges_binary_formatter_new (void)
+{
+  return g_object_new (GES_TYPE_BINARY_FORMATTER, NULL);
+}
+
+/* Saving */
+
+typedef struct
+{
+  GByteArray *sections[SECTION_LAST];
+
+  /* {string: offset + 1} */
+  GHashTable *strings;
+  /* {uri: index + 1} */
+  GHashTable *sources;
+} SaveContext;
+
+static guint32
+add_string (SaveContext * ctx, const gchar * string)
+{
+  gpointer offset;
+  GByteArray *table = ctx->sections[SECTION_STRINGS];
+
+  if (string == NULL)
+    return NO_REF;
+
+  offset = g_hash_table_lookup (ctx->strings, string);
+  if (offset)
+    return GPOINTER_TO_UINT (offset) - 1;
+
+  offset = GUINT_TO_POINTER (table->len + 1);
+  g_byte_array_append (table, (const guint8 *) string, strlen (string) + 1);
+  g_hash_table_insert (ctx->strings, g_strdup (string), offset);
+
+  return GPOINTER_TO_UINT (offset) - 1;
+}
+
+static guint32
+add_source (SaveContext * ctx, const gchar * uri)
+{
+  gpointer index;
+  SourceRecord record;
+  GByteArray *table = ctx->sections[SECTION_SOURCES];
+
+  index = g_hash_table_lookup (ctx->sources, uri);
+  if (index)
+    return GPOINTER_TO_UINT (index) - 1;
+
+  index = GUINT_TO_POINTER (table->len / sizeof (SourceRecord) + 1);
+  record.uri = GUINT32_TO_LE (add_string (ctx, uri));
+  g_byte_array_append (table, (const guint8 *) &record, sizeof (record));
+  g_hash_table_insert (ctx->sources, g_strdup (uri), index);
+
+  return GPOINTER_TO_UINT (index) - 1;
+}
+
+static gboolean
+is_record_property (const gchar * name)
+{
+  guint i;
+
+  for (i = 0; record_properties[i]; i++) {
+    if (!g_strcmp0 (record_properties[i], name))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* Returns %FALSE if @value can not be saved */
+static gboolean
+fill_property_record (SaveContext * ctx, PropertyRecord * record,
+    const GValue * value)
+{
+  guint64 bits;
+  ValueKind kind;
+  gchar *serialized;
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value))) {
+    case G_TYPE_BOOLEAN:
+      kind = VALUE_BOOLEAN;
+      bits = g_value_get_boolean (value);
+      break;
+    case G_TYPE_INT:
+      kind = VALUE_INT;
+      bits = (guint64) (gint64) g_value_get_int (value);
+      break;
+    case G_TYPE_ENUM:
+      kind = VALUE_INT;
+      bits = (guint64) (gint64) g_value_get_enum (value);
+      break;
+    case G_TYPE_UINT:
+      kind = VALUE_UINT;
+      bits = g_value_get_uint (value);
+      break;
+    case G_TYPE_FLAGS:
+      kind = VALUE_UINT;
+      bits = g_value_get_flags (value);
+      break;
+    case G_TYPE_INT64:
+      kind = VALUE_INT64;
+      bits = (guint64) g_value_get_int64 (value);
+      break;
+    case G_TYPE_UINT64:
+      kind = VALUE_UINT64;
+      bits = g_value_get_uint64 (value);
+      break;
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    {
+      union
+      {
+        gdouble d;
+        guint64 u;
+      } u;
+
+      u.d = G_VALUE_HOLDS_FLOAT (value) ? g_value_get_float (value) :
+          g_value_get_double (value);
+      kind = VALUE_DOUBLE;
+      bits = u.u;
+      break;
+    }
+    case G_TYPE_STRING:
+      kind = VALUE_STRING;
+      bits = add_string (ctx, g_value_get_string (value));
+      break;
+    default:
+      if (!(serialized = gst_value_serialize (value)))
+        return FALSE;
+
+      kind = VALUE_SERIALIZED;
+      bits = add_string (ctx, serialized);
+      g_free (serialized);
+      break;
+  }
+
+  record->kind = GUINT32_TO_LE (kind);
+  record->value = GUINT64_TO_LE (bits);
+
+  return TRUE;
+}
+
+static void
+save_object (SaveContext * ctx, GESTimelineObject * obj)
+{
+  ObjectRecord record;
+  GParamSpec **pspecs;
+  guint i, n_pspecs, n_properties = 0;
+  GByteArray *properties = ctx->sections[SECTION_PROPERTIES];
+  guint32 source = NO_REF;
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (obj),
+      &n_pspecs);
+
+  if (GES_IS_TIMELINE_FILE_SOURCE (obj))
+    source = add_source (ctx,
+        ges_timeline_filesource_get_uri (GES_TIMELINE_FILE_SOURCE (obj)));
+
+  record.first_property = GUINT32_TO_LE (properties->len /
+      sizeof (PropertyRecord));
+
+  for (i = 0; i < n_pspecs; i++) {
+    GValue v = { 0 };
+    PropertyRecord prop;
+    GParamSpec *p = pspecs[i];
+
+    if (!(p->flags & G_PARAM_READABLE) || !(p->flags & G_PARAM_WRITABLE) ||
+        is_record_property (p->name) ||
+        (source != NO_REF && !g_strcmp0 (p->name, "uri")))
+      continue;
+
+    g_value_init (&v, p->value_type);
+    g_object_get_property (G_OBJECT (obj), p->name, &v);
+
+    prop.name = GUINT32_TO_LE (add_string (ctx, p->name));
+    if (fill_property_record (ctx, &prop, &v)) {
+      g_byte_array_append (properties, (const guint8 *) &prop, sizeof (prop));
+      n_properties++;
+    }
+
+    g_value_unset (&v);
+  }
+  g_free (pspecs);
+
+  record.start = GUINT64_TO_LE (obj->start);
+  record.inpoint = GUINT64_TO_LE (obj->inpoint);
+  record.duration = GUINT64_TO_LE (obj->duration);
+  record.priority = GUINT32_TO_LE (obj->priority);
+  record.type = GUINT32_TO_LE (add_string (ctx, G_OBJECT_TYPE_NAME (obj)));
+  record.source = GUINT32_TO_LE (source);
+  record.n_properties = GUINT32_TO_LE (n_properties);
+  record.reserved = 0;
+
+  g_byte_array_append (ctx->sections[SECTION_OBJECTS],
+      (const guint8 *) &record, sizeof (record));
+}
+
+static gboolean
+save_binary (GESFormatter * formatter, GESTimeline * timeline)
+{
+  SaveContext ctx;
+  GList *tmp, *tracks, *layers;
+  GByteArray *data;
+  FileHeader header;
+  guint i;
+  guint64 offset;
+
+  GST_DEBUG ("saving binary formatter");
+
+  for (i = 0; i < SECTION_LAST; i++)
+    ctx.sections[i] = g_byte_array_new ();
+  ctx.strings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  ctx.sources = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  tracks = ges_timeline_get_tracks (timeline);
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    TrackRecord record;
+    GESTrack *track = GES_TRACK (tmp->data);
+    gchar *caps = gst_caps_to_string (ges_track_get_caps (track));
+
+    record.type = GUINT32_TO_LE (track->type);
+    record.caps = GUINT32_TO_LE (add_string (&ctx, caps));
+    g_byte_array_append (ctx.sections[SECTION_TRACKS],
+        (const guint8 *) &record, sizeof (record));
+
+    g_free (caps);
+    gst_object_unref (track);
+  }
+  g_list_free (tracks);
+
+  layers = ges_timeline_get_layers (timeline);
+  for (tmp = layers; tmp; tmp = tmp->next) {
+    LayerRecord record;
+    GList *objs, *cur;
+    GESTimelineLayer *layer = tmp->data;
+    guint n_objects = 0;
+
+    record.priority = GUINT32_TO_LE (ges_timeline_layer_get_priority (layer));
+    record.flags = GUINT32_TO_LE (GES_IS_SIMPLE_TIMELINE_LAYER (layer) ?
+        LAYER_FLAG_SIMPLE : 0);
+    record.first_object = GUINT32_TO_LE (ctx.sections[SECTION_OBJECTS]->len /
+        sizeof (ObjectRecord));
+
+    objs = ges_timeline_layer_get_objects (layer);
+    for (cur = objs; cur; cur = cur->next) {
+      save_object (&ctx, GES_TIMELINE_OBJECT (cur->data));
+      n_objects++;
+    }
+    g_list_free_full (objs, g_object_unref);
+
+    record.n_objects = GUINT32_TO_LE (n_objects);
+    g_byte_array_append (ctx.sections[SECTION_LAYERS],
+        (const guint8 *) &record, sizeof (record));
+  }
+  g_list_free_full (layers, g_object_unref);
+
+  /* Assemble the header, the index and the sections */
+  data = g_byte_array_new ();
+
+  memcpy (header.magic, BINARY_MAGIC, 4);
+  header.version = GUINT32_TO_LE (BINARY_VERSION);
+  header.n_sections = GUINT32_TO_LE (N_SECTIONS);
+  header.reserved = 0;
+  g_byte_array_append (data, (const guint8 *) &header, sizeof (header));
+
+  offset = sizeof (FileHeader) + N_SECTIONS * sizeof (SectionEntry);
+  for (i = SECTION_STRINGS; i < SECTION_LAST; i++) {
+    SectionEntry entry;
+
+    entry.id = GUINT32_TO_LE (i);
+    entry.reserved = 0;
+    entry.offset = GUINT64_TO_LE (offset);
+    entry.size = GUINT64_TO_LE (ctx.sections[i]->len);
+    g_byte_array_append (data, (const guint8 *) &entry, sizeof (entry));
+
+    offset += GST_ROUND_UP_8 (ctx.sections[i]->len);
+  }
+
+  for (i = SECTION_STRINGS; i < SECTION_LAST; i++) {
+    static const guint8 padding[8] = { 0, };
+    guint len = ctx.sections[i]->len;
+
+    g_byte_array_append (data, ctx.sections[i]->data, len);
+    g_byte_array_append (data, padding, GST_ROUND_UP_8 (len) - len);
+  }
+
+  for (i = 0; i < SECTION_LAST; i++)
+    g_byte_array_free (ctx.sections[i], TRUE);
+  g_hash_table_unref (ctx.strings);
+  g_hash_table_unref (ctx.sources);
+
+  offset = data->len;
+  ges_formatter_set_data (formatter, g_byte_array_free (data, FALSE), offset);
+
+  return TRUE;
+}
+
+/* Loading */
+
+typedef struct
+{
+  const gchar *strings;
+  gsize strings_size;
+
+  const TrackRecord *tracks;
+  guint n_tracks;
+  const LayerRecord *layers;
+  guint n_layers;
+  const SourceRecord *sources;
+  guint n_sources;
+  const ObjectRecord *objects;
+  guint n_objects;
+  const PropertyRecord *properties;
+  guint n_properties;
+} LoadContext;
+
+static const gchar *
+get_string (LoadContext * ctx, guint32 ref)
+{
+  ref = GUINT32_FROM_LE (ref);
+
+  if (ref >= ctx->strings_size)
+    return NULL;
+
+  return ctx->strings + ref;
+}
+
+/* Points @ctx to the sections of @data, checking they are all in it */
+static gboolean
+map_sections (LoadContext * ctx, const gchar * data, gsize length)
+{
+  const FileHeader *header = (const FileHeader *) data;
+  const SectionEntry *entries;
+  guint i, n_sections;
+
+  if (length < sizeof (FileHeader) || memcmp (header->magic, BINARY_MAGIC, 4)) {
+    GST_ERROR ("Not a binary project");
+    return FALSE;
+  }
+
+  if (GUINT32_FROM_LE (header->version) != BINARY_VERSION) {
+    GST_ERROR ("Unsupported binary project version %u",
+        GUINT32_FROM_LE (header->version));
+    return FALSE;
+  }
+
+  n_sections = GUINT32_FROM_LE (header->n_sections);
+  if (n_sections > (length - sizeof (FileHeader)) / sizeof (SectionEntry)) {
+    GST_ERROR ("Truncated section index");
+    return FALSE;
+  }
+
+  entries = (const SectionEntry *) (data + sizeof (FileHeader));
+  for (i = 0; i < n_sections; i++) {
+    guint64 offset = GUINT64_FROM_LE (entries[i].offset);
+    guint64 size = GUINT64_FROM_LE (entries[i].size);
+    const gchar *section = data + offset;
+
+    /* Sections are aligned so that we can read the records in place */
+    if (offset > length || size > length - offset || offset % 8) {
+      GST_ERROR ("Section %u is out of the file", i);
+      return FALSE;
+    }
+
+#define MAP_RECORDS(records, n_records, type) G_STMT_START {  \
+      if (size % sizeof (type) || size / sizeof (type) > G_MAXUINT) { \
+        GST_ERROR ("Invalid " #records " section");           \
+        return FALSE;                                         \
+      }                                                       \
+      ctx->records = (const type *) section;                  \
+      ctx->n_records = size / sizeof (type);                  \
+    } G_STMT_END
+
+    switch (GUINT32_FROM_LE (entries[i].id)) {
+      case SECTION_STRINGS:
+        if (size == 0 || section[size - 1] != '\0') {
+          GST_ERROR ("Invalid string table");
+          return FALSE;
+        }
+        ctx->strings = section;
+        ctx->strings_size = size;
+        break;
+      case SECTION_TRACKS:
+        MAP_RECORDS (tracks, n_tracks, TrackRecord);
+        break;
+      case SECTION_LAYERS:
+        MAP_RECORDS (layers, n_layers, LayerRecord);
+        break;
+      case SECTION_SOURCES:
+        MAP_RECORDS (sources, n_sources, SourceRecord);
+        break;
+      case SECTION_OBJECTS:
+        MAP_RECORDS (objects, n_objects, ObjectRecord);
+        break;
+      case SECTION_PROPERTIES:
+        MAP_RECORDS (properties, n_properties, PropertyRecord);
+        break;
+      default:
+        GST_DEBUG ("Ignoring unknown section %u",
+            GUINT32_FROM_LE (entries[i].id));
+        break;
+    }
+
+#undef MAP_RECORDS
+  }
+
+  return TRUE;
+}
+
+static gboolean
+read_property_value (LoadContext * ctx, const PropertyRecord * record,
+    GValue * value)
+{
+  guint64 bits = GUINT64_FROM_LE (record->value);
+  ValueKind kind = GUINT32_FROM_LE (record->kind);
+  GType fundamental = G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value));
+
+  switch (kind) {
+    case VALUE_BOOLEAN:
+      if (fundamental != G_TYPE_BOOLEAN)
+        return FALSE;
+      g_value_set_boolean (value, bits != 0);
+      break;
+    case VALUE_INT:
+      if (fundamental == G_TYPE_INT)
+        g_value_set_int (value, (gint) (gint64) bits);
+      else if (fundamental == G_TYPE_ENUM)
+        g_value_set_enum (value, (gint) (gint64) bits);
+      else
+        return FALSE;
+      break;
+    case VALUE_UINT:
+      if (fundamental == G_TYPE_UINT)
+        g_value_set_uint (value, (guint) bits);
+      else if (fundamental == G_TYPE_FLAGS)
+        g_value_set_flags (value, (guint) bits);
+      else
+        return FALSE;
+      break;
+    case VALUE_INT64:
+      if (fundamental != G_TYPE_INT64)
+        return FALSE;
+      g_value_set_int64 (value, (gint64) bits);
+      break;
+    case VALUE_UINT64:
+      if (fundamental != G_TYPE_UINT64)
+        return FALSE;
+      g_value_set_uint64 (value, bits);
+      break;
+    case VALUE_DOUBLE:
+    {
+      union
+      {
+        gdouble d;
+        guint64 u;
+      } u;
+
+      u.u = bits;
+      if (fundamental == G_TYPE_DOUBLE)
+        g_value_set_double (value, u.d);
+      else if (fundamental == G_TYPE_FLOAT)
+        g_value_set_float (value, u.d);
+      else
+        return FALSE;
+      break;
+    }
+    case VALUE_STRING:
+      if (fundamental != G_TYPE_STRING)
+        return FALSE;
+      /* The strings are copied by g_object_newv() */
+      g_value_set_static_string (value, bits == NO_REF ? NULL :
+          get_string (ctx, GUINT32_TO_LE ((guint32) bits)));
+      break;
+    case VALUE_SERIALIZED:
+    {
+      const gchar *serialized = get_string (ctx,
+          GUINT32_TO_LE ((guint32) bits));
+
+      if (!serialized || !gst_value_deserialize (value, serialized))
+        return FALSE;
+      break;
+    }
+    default:
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static GESTimelineObject *
+create_object (LoadContext * ctx, const ObjectRecord * record)
+{
+  GType type;
+  GObject *obj = NULL;
+  GObjectClass *klass;
+  GParameter *params;
+  const gchar *type_name, *uri = NULL;
+  guint i, n_params = 0;
+  guint32 first = GUINT32_FROM_LE (record->first_property);
+  guint32 n_properties = GUINT32_FROM_LE (record->n_properties);
+  guint32 source = GUINT32_FROM_LE (record->source);
+
+  type_name = get_string (ctx, record->type);
+  if (!type_name || !(type = g_type_from_name (type_name)) ||
+      !g_type_is_a (type, GES_TYPE_TIMELINE_OBJECT)) {
+    GST_ERROR ("Invalid object type '%s'", GST_STR_NULL (type_name));
+    return NULL;
+  }
+
+  if (first > ctx->n_properties || n_properties > ctx->n_properties - first) {
+    GST_ERROR ("Properties of %s out of the properties table", type_name);
+    return NULL;
+  }
+
+  if (source != NO_REF) {
+    if (source >= ctx->n_sources ||
+        !(uri = get_string (ctx, ctx->sources[source].uri))) {
+      GST_ERROR ("Invalid source for %s", type_name);
+      return NULL;
+    }
+  }
+
+  klass = g_type_class_ref (type);
+  params = g_new0 (GParameter, n_properties + 5);
+
+  for (i = 0; record_properties[i]; i++) {
+    params[n_params].name = record_properties[i];
+    g_value_init (&params[n_params].value, i == 3 ? G_TYPE_UINT :
+        G_TYPE_UINT64);
+    n_params++;
+  }
+  g_value_set_uint64 (&params[0].value, GUINT64_FROM_LE (record->start));
+  g_value_set_uint64 (&params[1].value, GUINT64_FROM_LE (record->inpoint));
+  g_value_set_uint64 (&params[2].value, GUINT64_FROM_LE (record->duration));
+  g_value_set_uint (&params[3].value, GUINT32_FROM_LE (record->priority));
+
+  if (uri) {
+    params[n_params].name = "uri";
+    g_value_init (&params[n_params].value, G_TYPE_STRING);
+    g_value_set_static_string (&params[n_params].value, uri);
+    n_params++;
+  }
+
+  for (i = first; i < first + n_properties; i++) {
+    GParamSpec *pspec;
+    const gchar *name = get_string (ctx, ctx->properties[i].name);
+
+    if (!name || !(pspec = g_object_class_find_property (klass, name))) {
+      GST_ERROR ("Object type %s has no property %s", type_name,
+          GST_STR_NULL (name));
+      goto done;
+    }
+
+    params[n_params].name = pspec->name;
+    g_value_init (&params[n_params].value, pspec->value_type);
+    n_params++;
+
+    if (!read_property_value (ctx, &ctx->properties[i],
+            &params[n_params - 1].value)) {
+      GST_ERROR ("Couldn't read property value for property '%s'", name);
+      goto done;
+    }
+  }
+
+  obj = g_object_newv (type, n_params, params);
+
+done:
+  for (i = 0; i < n_params; i++)
+    g_value_unset (&params[i].value);
+  g_free (params);
+  g_type_class_unref (klass);
+
+  return (GESTimelineObject *) obj;
+}
+
+static gboolean
+load_data (GESFormatter * formatter, GESTimeline * timeline,
+    const gchar * data, gsize length)
+{
+  LoadContext ctx = { NULL, };
+  guint i, j;
+
+  if (!map_sections (&ctx, data, length))
+    return FALSE;
+
+  for (i = 0; i < ctx.n_tracks; i++) {
+    GESTrack *track;
+    GstCaps *caps;
+    const gchar *caps_str = get_string (&ctx, ctx.tracks[i].caps);
+
+    if (!caps_str || !(caps = gst_caps_from_string (caps_str))) {
+      GST_ERROR ("Invalid caps for track %u", i);
+      return FALSE;
+    }
+
+    track = ges_track_new (GUINT32_FROM_LE (ctx.tracks[i].type), caps);
+    if (!ges_formatter_add_track (formatter, timeline, track)) {
+      g_object_unref (track);
+      return FALSE;
+    }
+  }
+
+  for (i = 0; i < ctx.n_layers; i++) {
+    GESTimelineLayer *layer;
+    const LayerRecord *record = &ctx.layers[i];
+    guint32 first = GUINT32_FROM_LE (record->first_object);
+    guint32 n_objects = GUINT32_FROM_LE (record->n_objects);
+
+    if (first > ctx.n_objects || n_objects > ctx.n_objects - first) {
+      GST_ERROR ("Objects of layer %u out of the objects table", i);
+      return FALSE;
+    }
+
+    if (GUINT32_FROM_LE (record->flags) & LAYER_FLAG_SIMPLE)
+      layer = (GESTimelineLayer *) ges_simple_timeline_layer_new ();
+    else
+      layer = ges_timeline_layer_new ();
+
+    ges_timeline_layer_set_priority (layer,
+        GUINT32_FROM_LE (record->priority));
+    if (!ges_formatter_add_layer (formatter, timeline, layer)) {
+      g_object_unref (layer);
+      return FALSE;
+    }
+
+    for (j = first; j < first + n_objects; j++) {
+      GESTimelineObject *obj = create_object (&ctx, &ctx.objects[j]);
+
+      if (obj == NULL)
+        return FALSE;
+
+      if (!ges_formatter_add_object (formatter, layer, obj)) {
+        g_object_unref (obj);
+        return FALSE;
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+static gboolean
+load_binary (GESFormatter * formatter, GESTimeline * timeline)
+{
+  gchar *data;
+  gsize length;
+
+  data = ges_formatter_get_data (formatter, &length);
+
+  return load_data (formatter, timeline, data, length);
+}
+
+static gboolean
+load_binary_from_uri (GESFormatter * formatter, GESTimeline * timeline,
+    const gchar * uri)
+{
+  gchar *location;
+  GMappedFile *file;
+  GError *e = NULL;
+  gboolean ret;
+
+  if (!(location = gst_uri_get_location (uri)))
+    return FALSE;
+
+  /* The records are read in place, the file is never copied */
+  file = g_mapped_file_new (location, FALSE, &e);
+  if (file == NULL) {
+    GST_ERROR ("couldn't map file '%s': %s", location, e->message);
+    g_error_free (e);
+    g_free (location);
+
+    return FALSE;
+  }
+
+  ret = load_data (formatter, timeline, g_mapped_file_get_contents (file),
+      g_mapped_file_get_length (file));
+
+  g_mapped_file_unref (file);
+  g_free (location);
+
+  return ret;
+}
+
+/* ges_binary_formatter_can_load_location:
+ * @location: a local file name
+ *
+ * Returns: %TRUE if @location starts like a binary project.
+ */
+gboolean
+ges_binary_formatter_can_load_location (const gchar * location)
+{
+  FILE *file;
+  gchar magic[4];
+  gboolean ret = FALSE;
+
+  if ((file = g_fopen (location, "rb"))) {
+    ret = fread (magic, 1, 4, file) == 4 && !memcmp (magic, BINARY_MAGIC, 4);
+    fclose (file);
+  }
+
+  return ret;
+}
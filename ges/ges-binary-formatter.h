@@ -0,0 +1,68 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _GES_BINARY_FORMATTER
+#define _GES_BINARY_FORMATTER
+
+#include <glib-object.h>
+#include <ges/ges-timeline.h>
+
+#define GES_TYPE_BINARY_FORMATTER ges_binary_formatter_get_type()
+
+#define GES_BINARY_FORMATTER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), GES_TYPE_BINARY_FORMATTER, GESBinaryFormatter))
+
+#define GES_BINARY_FORMATTER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST ((klass), GES_TYPE_BINARY_FORMATTER, GESBinaryFormatterClass))
+
+#define GES_IS_BINARY_FORMATTER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GES_TYPE_BINARY_FORMATTER))
+
+#define GES_IS_BINARY_FORMATTER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE ((klass), GES_TYPE_BINARY_FORMATTER))
+
+#define GES_BINARY_FORMATTER_GET_CLASS(obj) \
+  (G_TYPE_INSTANCE_GET_CLASS ((obj), GES_TYPE_BINARY_FORMATTER, GESBinaryFormatterClass))
+
+/**
+ * GESBinaryFormatter:
+ *
+ * Serializes a #GESTimeline to a compact binary file
+ */
+
+struct _GESBinaryFormatter {
+  /*< private >*/
+  GESFormatter parent;
+
+  /* Padding for API extension */
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+struct _GESBinaryFormatterClass {
+  /*< private >*/
+  GESFormatterClass parent_class;
+
+  /* Padding for API extension */
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+GType ges_binary_formatter_get_type (void);
+
+GESBinaryFormatter *ges_binary_formatter_new (void);
+
+#endif /* _GES_BINARY_FORMATTER */
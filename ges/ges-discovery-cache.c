@@ -0,0 +1,365 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Cache of the discovery results the timeline needs to complete
+ * GESTimelineFileSource-s (supported formats, duration and whether the file
+ * is a still image).
+ *
+ * Entries are keyed by URI and are only valid as long as the size and
+ * modification time of the file did not change. Only local files are cached
+ * as we do not want to do network round trips to validate an entry.
+ *
+ * The cache can optionally be backed by a GKeyFile stored in the user cache
+ * directory so that the results are kept between sessions. */
+
+#include <errno.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#include "ges-internal.h"
+
+#define CACHE_FILE_VERSION 1
+
+typedef struct
+{
+  guint64 size;
+  guint64 mtime;                /* in microseconds */
+
+  GESTrackType supported_formats;
+  GstClockTime duration;
+  gboolean is_image;
+} CacheEntry;
+
+struct _GESDiscoveryCache
+{
+  GMutex lock;
+
+  GHashTable *entries;          /* {uri: CacheEntry} */
+
+  gboolean persistent;
+  gboolean loaded;
+  gboolean dirty;
+};
+
+static gchar *
+get_cache_filename (void)
+{
+  return g_build_filename (g_get_user_cache_dir (),
+      "gstreamer-editing-services", "discovery.cache", NULL);
+}
+
+static void
+free_entry (CacheEntry * entry)
+{
+  g_slice_free (CacheEntry, entry);
+}
+
+/* Retrieves the size and modification time of @uri, returns %FALSE if the
+ * file is not local or could not be queried */
+gboolean
+ges_query_file_stamp (const gchar * uri, guint64 * size, guint64 * mtime)
+{
+  GFile *file;
+  GFileInfo *info;
+
+  file = g_file_new_for_uri (uri);
+  if (!g_file_is_native (file)) {
+    g_object_unref (file);
+
+    return FALSE;
+  }
+
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+      G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+      G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  g_object_unref (file);
+
+  if (info == NULL)
+    return FALSE;
+
+  *size = g_file_info_get_attribute_uint64 (info,
+      G_FILE_ATTRIBUTE_STANDARD_SIZE);
+  *mtime = g_file_info_get_attribute_uint64 (info,
+      G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+      g_file_info_get_attribute_uint32 (info,
+      G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+  g_object_unref (info);
+
+  return TRUE;
+}
+
+static void
+load_cache_file (GESDiscoveryCache * cache)
+{
+  GKeyFile *keyfile;
+  gchar **groups, *filename;
+  gsize i, n_groups;
+  GError *error = NULL;
+
+  cache->loaded = TRUE;
+
+  filename = get_cache_filename ();
+  keyfile = g_key_file_new ();
+
+  if (!g_key_file_load_from_file (keyfile, filename, G_KEY_FILE_NONE, &error)) {
+    GST_DEBUG ("Could not load discovery cache %s: %s", filename,
+        error->message);
+    goto done;
+  }
+
+  if (g_key_file_get_integer (keyfile, "General", "version",
+          NULL) != CACHE_FILE_VERSION) {
+    GST_DEBUG ("Discovery cache %s has an unknown version, ignoring it",
+        filename);
+    goto done;
+  }
+
+  groups = g_key_file_get_groups (keyfile, &n_groups);
+  for (i = 0; i < n_groups; i++) {
+    gchar *uri;
+    CacheEntry *entry;
+
+    if (!g_strcmp0 (groups[i], "General"))
+      continue;
+
+    uri = g_key_file_get_string (keyfile, groups[i], "uri", NULL);
+    if (uri == NULL)
+      continue;
+
+    /* Entries added during this session are more recent */
+    if (g_hash_table_lookup (cache->entries, uri)) {
+      g_free (uri);
+      continue;
+    }
+
+    entry = g_slice_new (CacheEntry);
+    entry->size = g_key_file_get_uint64 (keyfile, groups[i], "size", NULL);
+    entry->mtime = g_key_file_get_uint64 (keyfile, groups[i], "mtime", NULL);
+    entry->supported_formats = g_key_file_get_integer (keyfile, groups[i],
+        "supported-formats", NULL);
+    entry->duration = g_key_file_get_uint64 (keyfile, groups[i],
+        "duration", NULL);
+    entry->is_image = g_key_file_get_boolean (keyfile, groups[i],
+        "is-image", NULL);
+
+    g_hash_table_insert (cache->entries, uri, entry);
+  }
+  g_strfreev (groups);
+
+  GST_DEBUG ("Loaded %u entries from discovery cache %s",
+      g_hash_table_size (cache->entries), filename);
+
+done:
+  g_clear_error (&error);
+  g_key_file_free (keyfile);
+  g_free (filename);
+}
+
+/* ges_discovery_cache_new:
+ * @persistent: Whether the cache should be backed by a file in the user
+ * cache directory
+ *
+ * Returns: A new #GESDiscoveryCache, free it with ges_discovery_cache_free()
+ */
+GESDiscoveryCache *
+ges_discovery_cache_new (gboolean persistent)
+{
+  GESDiscoveryCache *cache = g_slice_new0 (GESDiscoveryCache);
+
+  g_mutex_init (&cache->lock);
+  cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) free_entry);
+
+  ges_discovery_cache_set_persistent (cache, persistent);
+
+  return cache;
+}
+
+void
+ges_discovery_cache_free (GESDiscoveryCache * cache)
+{
+  ges_discovery_cache_save (cache);
+
+  g_hash_table_unref (cache->entries);
+  g_mutex_clear (&cache->lock);
+
+  g_slice_free (GESDiscoveryCache, cache);
+}
+
+void
+ges_discovery_cache_set_persistent (GESDiscoveryCache * cache,
+    gboolean persistent)
+{
+  g_mutex_lock (&cache->lock);
+  cache->persistent = persistent;
+  if (persistent && !cache->loaded)
+    load_cache_file (cache);
+  g_mutex_unlock (&cache->lock);
+}
+
+gboolean
+ges_discovery_cache_is_persistent (GESDiscoveryCache * cache)
+{
+  return cache->persistent;
+}
+
+/* ges_discovery_cache_lookup:
+ * @cache: a #GESDiscoveryCache
+ * @uri: The uri to look up
+ * @supported_formats: (out): The formats supported by the file
+ * @duration: (out): The duration of the file
+ * @is_image: (out): Whether the file is a still image
+ *
+ * Returns: %TRUE if the discovery results for @uri are known and the file
+ * did not change since then, %FALSE otherwise.
+ */
+gboolean
+ges_discovery_cache_lookup (GESDiscoveryCache * cache, const gchar * uri,
+    GESTrackType * supported_formats, GstClockTime * duration,
+    gboolean * is_image)
+{
+  CacheEntry *entry;
+  guint64 size, mtime;
+  gboolean ret = FALSE;
+
+  g_mutex_lock (&cache->lock);
+  entry = g_hash_table_lookup (cache->entries, uri);
+  g_mutex_unlock (&cache->lock);
+
+  /* Do not stat the file if we know nothing about it */
+  if (entry == NULL || !ges_query_file_stamp (uri, &size, &mtime))
+    return FALSE;
+
+  g_mutex_lock (&cache->lock);
+  /* The entry might have been replaced while we were querying the file */
+  entry = g_hash_table_lookup (cache->entries, uri);
+  if (entry && entry->size == size && entry->mtime == mtime) {
+    *supported_formats = entry->supported_formats;
+    *duration = entry->duration;
+    *is_image = entry->is_image;
+    ret = TRUE;
+  }
+  g_mutex_unlock (&cache->lock);
+
+  GST_DEBUG ("Discovery cache %s for %s", ret ? "hit" : "miss", uri);
+
+  return ret;
+}
+
+/* ges_discovery_cache_store:
+ * @cache: a #GESDiscoveryCache
+ * @uri: The discovered uri
+ * @supported_formats: The formats supported by the file
+ * @duration: The duration of the file
+ * @is_image: Whether the file is a still image
+ *
+ * Adds the discovery results of @uri to @cache. Nothing happens if @uri
+ * is not a local file.
+ */
+void
+ges_discovery_cache_store (GESDiscoveryCache * cache, const gchar * uri,
+    GESTrackType supported_formats, GstClockTime duration, gboolean is_image)
+{
+  CacheEntry *entry;
+  guint64 size, mtime;
+
+  if (!ges_query_file_stamp (uri, &size, &mtime))
+    return;
+
+  entry = g_slice_new (CacheEntry);
+  entry->size = size;
+  entry->mtime = mtime;
+  entry->supported_formats = supported_formats;
+  entry->duration = duration;
+  entry->is_image = is_image;
+
+  g_mutex_lock (&cache->lock);
+  g_hash_table_insert (cache->entries, g_strdup (uri), entry);
+  cache->dirty = TRUE;
+  g_mutex_unlock (&cache->lock);
+}
+
+/* ges_discovery_cache_save:
+ * @cache: a #GESDiscoveryCache
+ *
+ * Writes @cache to the user cache directory if it is persistent and
+ * changed since the last save.
+ *
+ * Returns: %TRUE if nothing needed to be saved or on success, %FALSE
+ * otherwise.
+ */
+gboolean
+ges_discovery_cache_save (GESDiscoveryCache * cache)
+{
+  GKeyFile *keyfile;
+  GHashTableIter iter;
+  gpointer uri, value;
+  gchar *filename, *dirname, *data;
+  gsize length;
+  gboolean ret = TRUE;
+  GError *error = NULL;
+
+  g_mutex_lock (&cache->lock);
+  if (!cache->persistent || !cache->dirty) {
+    g_mutex_unlock (&cache->lock);
+
+    return TRUE;
+  }
+
+  keyfile = g_key_file_new ();
+  g_key_file_set_integer (keyfile, "General", "version", CACHE_FILE_VERSION);
+
+  g_hash_table_iter_init (&iter, cache->entries);
+  while (g_hash_table_iter_next (&iter, &uri, &value)) {
+    CacheEntry *entry = (CacheEntry *) value;
+    /* Uris can contain characters not allowed in group names */
+    gchar *group = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+
+    g_key_file_set_string (keyfile, group, "uri", uri);
+    g_key_file_set_uint64 (keyfile, group, "size", entry->size);
+    g_key_file_set_uint64 (keyfile, group, "mtime", entry->mtime);
+    g_key_file_set_integer (keyfile, group, "supported-formats",
+        entry->supported_formats);
+    g_key_file_set_uint64 (keyfile, group, "duration", entry->duration);
+    g_key_file_set_boolean (keyfile, group, "is-image", entry->is_image);
+
+    g_free (group);
+  }
+  cache->dirty = FALSE;
+  g_mutex_unlock (&cache->lock);
+
+  data = g_key_file_to_data (keyfile, &length, NULL);
+  g_key_file_free (keyfile);
+
+  filename = get_cache_filename ();
+  dirname = g_path_get_dirname (filename);
+
+  if (g_mkdir_with_parents (dirname, 0755) != 0 ||
+      !g_file_set_contents (filename, data, length, &error)) {
+    GST_WARNING ("Could not save discovery cache to %s: %s", filename,
+        error ? error->message : g_strerror (errno));
+    g_clear_error (&error);
+    ret = FALSE;
+  }
+
+  g_free (dirname);
+  g_free (filename);
+  g_free (data);
+
+  return ret;
+}
@@ -63,6 +63,8 @@ register_ges_pipeline_flags (GType * id)
     {C_ENUM (TIMELINE_MODE_RENDER), "TIMELINE_MODE_RENDER", "render"},
     {C_ENUM (TIMELINE_MODE_SMART_RENDER), "TIMELINE_MODE_SMART_RENDER",
         "smart_render"},
+    {C_ENUM (TIMELINE_MODE_THUMBNAIL), "TIMELINE_MODE_THUMBNAIL",
+        "thumbnail"},
     {0, NULL, NULL}
   };
 
@@ -137,6 +139,30 @@ ges_edge_get_type (void)
   return id;
 }
 
+static void
+register_ges_audio_transition_curve (GType * id)
+{
+  static const GEnumValue curves[] = {
+    {C_ENUM (GES_AUDIO_TRANSITION_CURVE_LINEAR),
+        "GES_AUDIO_TRANSITION_CURVE_LINEAR", "linear"},
+    {C_ENUM (GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER),
+        "GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER", "equal-power"},
+    {0, NULL, NULL}
+  };
+
+  *id = g_enum_register_static ("GESAudioTransitionCurve", curves);
+}
+
+GType
+ges_audio_transition_curve_get_type (void)
+{
+  static GType id;
+  static GOnce once = G_ONCE_INIT;
+
+  g_once (&once, (GThreadFunc) register_ges_audio_transition_curve, &id);
+  return id;
+}
+
 static GEnumValue transition_types[] = {
   {
         0,
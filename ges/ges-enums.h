@@ -307,6 +307,8 @@ GType ges_video_test_pattern_get_type (void);
  * @TIMELINE_MODE_PREVIEW: output audio/video to soundcard/screen (default)
  * @TIMELINE_MODE_RENDER: render timeline (forces decoding)
  * @TIMELINE_MODE_SMART_RENDER: render timeline (tries to avoid decoding/reencoding)
+ * @TIMELINE_MODE_THUMBNAIL: output scaled video frames to an internal sink, see
+ * ges_timeline_pipeline_generate_thumbnails()
  *
  * The various modes the #GESTimelinePipeline can be configured to.
  */
@@ -315,7 +317,8 @@ typedef enum {
   TIMELINE_MODE_PREVIEW_VIDEO	= 1 << 1,
   TIMELINE_MODE_PREVIEW		= TIMELINE_MODE_PREVIEW_AUDIO | TIMELINE_MODE_PREVIEW_VIDEO,
   TIMELINE_MODE_RENDER		= 1 << 2,
-  TIMELINE_MODE_SMART_RENDER	= 1 << 3
+  TIMELINE_MODE_SMART_RENDER	= 1 << 3,
+  TIMELINE_MODE_THUMBNAIL	= 1 << 4
 } GESPipelineFlags;
 
 #define GES_TYPE_PIPELINE_FLAGS\
@@ -387,6 +390,26 @@ typedef enum {
 
 GType ges_edge_get_type (void);
 
+/**
+ * GESAudioTransitionCurve:
+ * @GES_AUDIO_TRANSITION_CURVE_LINEAR: The gains of both inputs change
+ *  linearly, their sum stays constant.
+ * @GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER: The gains of both inputs follow
+ *  a quarter of a sine wave, the sum of their powers stays constant. This
+ *  avoids the dip in loudness of linear crossfades between uncorrelated
+ *  signals.
+ *
+ * The shape of the gains of a #GESTrackAudioTransition.
+ */
+typedef enum {
+    GES_AUDIO_TRANSITION_CURVE_LINEAR,
+    GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER
+} GESAudioTransitionCurve;
+
+#define GES_TYPE_AUDIO_TRANSITION_CURVE ges_audio_transition_curve_get_type()
+
+GType ges_audio_transition_curve_get_type (void);
+
 G_END_DECLS
 
 #endif /* __GES_ENUMS_H__ */
@@ -49,6 +49,7 @@
 
 #include "ges-formatter.h"
 #include "ges-keyfile-formatter.h"
+#include "ges-binary-formatter.h"
 #include "ges-internal.h"
 #include "ges.h"
 
@@ -63,6 +64,10 @@ struct _GESFormatterPrivate
    * provided the new source URI. */
   GHashTable *uri_newuri_table;
   GHashTable *parent_newparent_table;
+
+  /* GESStagedItem-s, when loading on a worker thread, see
+   * ges_formatter_stage_from_uri() */
+  GQueue *staged;
 };
 
 static void ges_formatter_dispose (GObject * object);
@@ -158,9 +163,20 @@ ges_formatter_dispose (GObject * object)
 GESFormatter *
 ges_formatter_new_for_uri (const gchar * uri)
 {
-  if (ges_formatter_can_load_uri (uri))
-    return GES_FORMATTER (ges_keyfile_formatter_new ());
-  return NULL;
+  gchar *location;
+  gboolean binary;
+
+  if (!ges_formatter_can_load_uri (uri))
+    return NULL;
+
+  location = gst_uri_get_location (uri);
+  binary = location && ges_binary_formatter_can_load_location (location);
+  g_free (location);
+
+  if (binary)
+    return GES_FORMATTER (ges_binary_formatter_new ());
+
+  return GES_FORMATTER (ges_keyfile_formatter_new ());
 }
 
 /**
@@ -381,6 +397,16 @@ ges_formatter_save (GESFormatter * formatter, GESTimeline * timeline)
   return FALSE;
 }
 
+/* Common to the synchronous loading and the staging of a project, the
+ * handler lives as long as @formatter */
+static void
+prepare_load (GESFormatter * formatter, GESTimeline * timeline)
+{
+  g_signal_connect_object (timeline, "discovery-error",
+      G_CALLBACK (discovery_error_cb), formatter, 0);
+  formatter->timeline = timeline;
+}
+
 /**
  * ges_formatter_load_from_uri:
  * @formatter: a #GESFormatter
@@ -403,11 +429,9 @@ ges_formatter_load_from_uri (GESFormatter * formatter, GESTimeline * timeline,
   g_return_val_if_fail (GES_IS_FORMATTER (formatter), FALSE);
   g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
 
-  g_signal_connect (timeline, "discovery-error",
-      G_CALLBACK (discovery_error_cb), formatter);
   if (klass->load_from_uri) {
     ges_timeline_enable_update (timeline, FALSE);
-    formatter->timeline = timeline;
+    prepare_load (formatter, timeline);
     ret = klass->load_from_uri (formatter, timeline, uri);
     ges_timeline_enable_update (timeline, TRUE);
   }
@@ -608,3 +632,109 @@ ges_formatter_emit_loaded (GESFormatter * formatter)
 
   return TRUE;
 }
+
+/* Staging
+ *
+ * Formatters that only create tracks, layers and objects go through the
+ * following functions instead of adding them to the timeline directly. When
+ * loading asynchronously, the formatter runs on a worker thread that must not
+ * touch the timeline, the items are then staged to be inserted from the main
+ * thread, see ges_timeline_load_from_uri_async(). */
+
+static void
+stage_item (GESFormatter * formatter, gpointer item, GESTimelineLayer * layer)
+{
+  GESStagedItem *staged = g_slice_new (GESStagedItem);
+
+  staged->item = g_object_ref_sink (item);
+  staged->layer = layer ? g_object_ref (layer) : NULL;
+
+  g_queue_push_tail (formatter->priv->staged, staged);
+}
+
+void
+ges_staged_item_free (GESStagedItem * staged)
+{
+  g_object_unref (staged->item);
+  if (staged->layer)
+    g_object_unref (staged->layer);
+
+  g_slice_free (GESStagedItem, staged);
+}
+
+gboolean
+ges_formatter_add_track (GESFormatter * formatter, GESTimeline * timeline,
+    GESTrack * track)
+{
+  if (formatter->priv->staged) {
+    stage_item (formatter, track, NULL);
+    return TRUE;
+  }
+
+  return ges_timeline_add_track (timeline, track);
+}
+
+gboolean
+ges_formatter_add_layer (GESFormatter * formatter, GESTimeline * timeline,
+    GESTimelineLayer * layer)
+{
+  if (formatter->priv->staged) {
+    stage_item (formatter, layer, NULL);
+    return TRUE;
+  }
+
+  return ges_timeline_add_layer (timeline, layer);
+}
+
+gboolean
+ges_formatter_add_object (GESFormatter * formatter, GESTimelineLayer * layer,
+    GESTimelineObject * object)
+{
+  if (formatter->priv->staged) {
+    stage_item (formatter, object, layer);
+    return TRUE;
+  }
+
+  if (GES_IS_SIMPLE_TIMELINE_LAYER (layer))
+    return ges_simple_timeline_layer_add_object ((GESSimpleTimelineLayer *)
+        layer, object, -1);
+
+  return ges_timeline_layer_add_object (layer, object);
+}
+
+/* Whether @formatter creates everything through the functions above */
+gboolean
+ges_formatter_can_stage (GESFormatter * formatter)
+{
+  return GES_IS_KEYFILE_FORMATTER (formatter) ||
+      GES_IS_BINARY_FORMATTER (formatter);
+}
+
+/* Runs the loading of @uri by @formatter, which can happen from any thread as
+ * @timeline is not touched.
+ *
+ * Returns: the #GESStagedItem-s to insert in @timeline, in order, or %NULL if
+ * @uri could not be loaded. */
+GQueue *
+ges_formatter_stage_from_uri (GESFormatter * formatter, GESTimeline * timeline,
+    const gchar * uri)
+{
+  GESFormatterClass *klass = GES_FORMATTER_GET_CLASS (formatter);
+  GQueue *staged = g_queue_new ();
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (ges_formatter_can_stage (formatter), NULL);
+
+  formatter->priv->staged = staged;
+  prepare_load (formatter, timeline);
+  if (klass->load_from_uri)
+    ret = klass->load_from_uri (formatter, timeline, uri);
+  formatter->priv->staged = NULL;
+
+  if (!ret) {
+    g_queue_free_full (staged, (GDestroyNotify) ges_staged_item_free);
+    return NULL;
+  }
+
+  return staged;
+}
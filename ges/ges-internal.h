@@ -24,6 +24,7 @@
 #include <gst/gst.h>
 #include "ges-timeline.h"
 #include "ges-track-object.h"
+#include "ges-enums.h"
 
 GST_DEBUG_CATEGORY_EXTERN (_ges_debug);
 #define GST_CAT_DEFAULT _ges_debug
@@ -59,4 +60,214 @@ timeline_move_object           (GESTimeline *timeline, GESTrackObject * object,
 gboolean
 timeline_context_to_layer      (GESTimeline *timeline, gint offset);
 
+gboolean
+ges_timeline_is_discovering    (GESTimeline *timeline);
+
+/* Lazy element creation, see GESTrack:lazy-elements */
+gboolean
+ges_track_get_lazy_elements    (GESTrack *track);
+
+gboolean
+ges_track_object_materialize   (GESTrackObject *object);
+
+gboolean
+ges_track_object_dematerialize (GESTrackObject *object);
+
+/* Discovery results cache, see ges-discovery-cache.c */
+typedef struct _GESDiscoveryCache GESDiscoveryCache;
+
+GESDiscoveryCache *
+ges_discovery_cache_new            (gboolean persistent);
+
+void
+ges_discovery_cache_free           (GESDiscoveryCache *cache);
+
+void
+ges_discovery_cache_set_persistent (GESDiscoveryCache *cache, gboolean persistent);
+
+gboolean
+ges_discovery_cache_is_persistent  (GESDiscoveryCache *cache);
+
+gboolean
+ges_discovery_cache_lookup         (GESDiscoveryCache *cache, const gchar *uri,
+                                    GESTrackType *supported_formats,
+                                    GstClockTime *duration, gboolean *is_image);
+
+void
+ges_discovery_cache_store          (GESDiscoveryCache *cache, const gchar *uri,
+                                    GESTrackType supported_formats,
+                                    GstClockTime duration, gboolean is_image);
+
+gboolean
+ges_discovery_cache_save           (GESDiscoveryCache *cache);
+
+gboolean
+ges_query_file_stamp               (const gchar *uri, guint64 *size,
+                                    guint64 *mtime);
+
+/* Preview proxies, see ges-proxy-cache.c */
+typedef struct _GESProxyCache GESProxyCache;
+
+typedef void (*GESProxyReadyFunc)  (const gchar *uri, const gchar *proxy_uri,
+                                    gpointer user_data);
+
+GESProxyCache *
+ges_proxy_cache_new                (GESProxyReadyFunc func, gpointer user_data);
+
+void
+ges_proxy_cache_free               (GESProxyCache *cache);
+
+gchar *
+ges_proxy_cache_lookup             (GESProxyCache *cache, const gchar *uri);
+
+void
+ges_proxy_cache_request            (GESProxyCache *cache, const gchar *uri);
+
+gboolean
+ges_timeline_allow_proxies         (GESTimeline *timeline, gboolean allow);
+
+gboolean
+ges_track_filesource_set_proxy_uri (GESTrackFileSource *source,
+                                    const gchar *proxy_uri);
+
+/* Staged loading, see ges_timeline_load_from_uri_async() */
+typedef struct
+{
+  gpointer item;                /* GESTrack, GESTimelineLayer or GESTimelineObject */
+  GESTimelineLayer *layer;      /* The layer of GESTimelineObject-s */
+} GESStagedItem;
+
+void
+ges_staged_item_free               (GESStagedItem *staged);
+
+gboolean
+ges_formatter_add_track            (GESFormatter *formatter,
+                                    GESTimeline *timeline, GESTrack *track);
+
+gboolean
+ges_formatter_add_layer            (GESFormatter *formatter,
+                                    GESTimeline *timeline,
+                                    GESTimelineLayer *layer);
+
+gboolean
+ges_formatter_add_object           (GESFormatter *formatter,
+                                    GESTimelineLayer *layer,
+                                    GESTimelineObject *object);
+
+gboolean
+ges_formatter_can_stage            (GESFormatter *formatter);
+
+GQueue *
+ges_formatter_stage_from_uri       (GESFormatter *formatter,
+                                    GESTimeline *timeline, const gchar *uri);
+
+/* Edit journal, see ges-timeline-journal.c */
+typedef struct _GESTimelineJournal GESTimelineJournal;
+
+GESTimelineJournal *
+ges_timeline_journal_new           (GESTimeline *timeline,
+                                    const gchar *location);
+
+void
+ges_timeline_journal_free          (GESTimelineJournal *journal);
+
+gboolean
+ges_timeline_journal_compact       (GESTimelineJournal *journal);
+
+void
+ges_timeline_journal_begin_batch   (GESTimelineJournal *journal);
+
+void
+ges_timeline_journal_end_batch     (GESTimelineJournal *journal);
+
+gboolean
+ges_timeline_journal_replay        (GESTimeline *timeline,
+                                    const gchar *location);
+
+gboolean
+ges_binary_formatter_can_load_location (const gchar *location);
+
+/* Size bounded LRU caches, see ges-lru-cache.c */
+typedef struct _GESLruCache GESLruCache;
+
+GESLruCache *
+ges_lru_cache_new                  (gsize max_size, GHashFunc hash_func,
+                                    GEqualFunc key_equal_func,
+                                    GDestroyNotify key_destroy_func,
+                                    GBoxedCopyFunc value_ref_func,
+                                    GDestroyNotify value_unref_func);
+
+void
+ges_lru_cache_free                 (GESLruCache *cache);
+
+gpointer
+ges_lru_cache_lookup               (GESLruCache *cache, gconstpointer key);
+
+void
+ges_lru_cache_insert               (GESLruCache *cache, gpointer key,
+                                    gpointer value, gsize size);
+
+gpointer
+ges_lru_cache_insert_or_lookup     (GESLruCache *cache, gpointer key,
+                                    gpointer value, gsize size);
+
+gsize
+ges_lru_cache_get_size             (GESLruCache *cache);
+
+/* Copy of a video frame in system memory, for the caches of decoded and
+ * rendered frames, see ges-utils.c */
+GstSample *
+ges_video_sample_new_copy          (GstBuffer *buffer, GstCaps *caps);
+
+GESLruCache *
+ges_track_image_source_get_cache   (void);
+
+GESLruCache *
+ges_track_title_source_get_frame_cache (void);
+
+/* SMPTE wipe masks, see ges-smpte-mask.c */
+#define GES_SMPTE_MASK_MAX 65535
+
+typedef struct
+{
+  gint refcount;
+
+  GESVideoStandardTransitionType type;
+  gint width;
+  gint height;
+  guint border;
+  gboolean invert;
+
+  guint32 *ramp;                /* width * height values */
+} GESSmpteMask;
+
+GESSmpteMask *
+ges_smpte_mask_get                 (GESVideoStandardTransitionType type,
+                                    gint width, gint height, guint border,
+                                    gboolean invert);
+
+GESSmpteMask *
+ges_smpte_mask_ref                 (GESSmpteMask *mask);
+
+void
+ges_smpte_mask_unref               (GESSmpteMask *mask);
+
+gint32
+ges_smpte_mask_get_threshold       (GESSmpteMask *mask, gdouble position);
+
+GESLruCache *
+ges_smpte_mask_get_cache           (void);
+
+/* Two inputs video blender used by GESTrackVideoTransition, registered as
+ * "gesvideoblend", see ges-video-blend.c */
+#define GES_TYPE_VIDEO_BLEND (ges_video_blend_get_type ())
+GType
+ges_video_blend_get_type           (void);
+
+/* Two inputs audio crossfade used by GESTrackAudioTransition, registered as
+ * "gesaudiocrossfade", see ges-audio-crossfade.c */
+#define GES_TYPE_AUDIO_CROSSFADE (ges_audio_crossfade_get_type ())
+GType
+ges_audio_crossfade_get_type       (void);
+
 #endif /* __GES_INTERNAL_H__ */
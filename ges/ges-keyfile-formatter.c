@@ -188,7 +188,8 @@ save_keyfile (GESFormatter * keyfile_formatter, GESTimeline * timeline)
 }
 
 static gboolean
-create_track (GKeyFile * kf, gchar * group, GESTimeline * timeline)
+create_track (GESFormatter * formatter, GKeyFile * kf, gchar * group,
+    GESTimeline * timeline)
 {
   GESTrack *track;
   GstCaps *caps;
@@ -214,7 +215,7 @@ create_track (GKeyFile * kf, gchar * group, GESTimeline * timeline)
 
   track = ges_track_new (g_value_get_flags (&v), caps);
 
-  if (!ges_timeline_add_track (timeline, track)) {
+  if (!ges_formatter_add_track (formatter, timeline, track)) {
     g_object_unref (track);
     return FALSE;
   }
@@ -223,7 +224,8 @@ create_track (GKeyFile * kf, gchar * group, GESTimeline * timeline)
 }
 
 static GESTimelineLayer *
-create_layer (GKeyFile * kf, gchar * group, GESTimeline * timeline)
+create_layer (GESFormatter * formatter, GKeyFile * kf, gchar * group,
+    GESTimeline * timeline)
 {
   GESTimelineLayer *ret = NULL;
   gchar *type_field, *priority_field;
@@ -251,7 +253,7 @@ create_layer (GKeyFile * kf, gchar * group, GESTimeline * timeline)
   }
 
   ges_timeline_layer_set_priority (ret, priority);
-  if (!ges_timeline_add_layer (timeline, ret)) {
+  if (!ges_formatter_add_layer (formatter, timeline, ret)) {
     g_object_unref (ret);
     ret = NULL;
   }
@@ -260,7 +262,8 @@ create_layer (GKeyFile * kf, gchar * group, GESTimeline * timeline)
 }
 
 static gboolean
-create_object (GKeyFile * kf, gchar * group, GESTimelineLayer * layer)
+create_object (GESFormatter * formatter, GKeyFile * kf, gchar * group,
+    GESTimelineLayer * layer)
 {
   GType type;
   gchar *type_name;
@@ -351,16 +354,8 @@ create_object (GKeyFile * kf, gchar * group, GESTimelineLayer * layer)
 
   /* add the object to the layer */
 
-  if (GES_IS_SIMPLE_TIMELINE_LAYER (layer)) {
-    if (!ges_simple_timeline_layer_add_object ((GESSimpleTimelineLayer *)
-            layer, timeline_obj, -1)) {
-      goto fail_unref_obj;
-    }
-  } else {
-    if (!ges_timeline_layer_add_object (layer, timeline_obj)) {
-      goto fail_unref_obj;
-    }
-  }
+  if (!ges_formatter_add_object (formatter, layer, timeline_obj))
+    goto fail_unref_obj;
 
   ret = TRUE;
 
@@ -415,7 +410,7 @@ load_keyfile (GESFormatter * keyfile_formatter, GESTimeline * timeline)
     gchar *group = groups[i];
 
     if (g_str_has_prefix (group, "Track")) {
-      if (!create_track (kf, group, timeline)) {
+      if (!create_track (keyfile_formatter, kf, group, timeline)) {
         GST_ERROR ("couldn't create object for %s", group);
         ret = FALSE;
         break;
@@ -423,7 +418,7 @@ load_keyfile (GESFormatter * keyfile_formatter, GESTimeline * timeline)
     }
 
     else if (g_str_has_prefix (group, "Layer")) {
-      if (!(cur_layer = create_layer (kf, group, timeline))) {
+      if (!(cur_layer = create_layer (keyfile_formatter, kf, group, timeline))) {
         GST_ERROR ("couldn't create object for %s", group);
         ret = FALSE;
         break;
@@ -437,7 +432,7 @@ load_keyfile (GESFormatter * keyfile_formatter, GESTimeline * timeline)
         break;
       }
 
-      if (!create_object (kf, group, cur_layer)) {
+      if (!create_object (keyfile_formatter, kf, group, cur_layer)) {
         GST_ERROR ("couldn't create object for %s", group);
         ret = FALSE;
         break;
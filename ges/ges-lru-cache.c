@@ -0,0 +1,210 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Thread safe cache of reference counted values, bounded by the total size
+ * of its values, evicting the least recently used ones first.
+ *
+ * The entries are kept in a queue ordered from the most to the least
+ * recently used, and indexed by key in a hash table pointing to their link
+ * in the queue, so that lookups, insertions and evictions are O(1). Values
+ * are only handed out as new references, evicting an entry does not affect
+ * the users of its value. */
+
+#include "ges-internal.h"
+
+struct _GESLruCache
+{
+  GMutex lock;
+
+  gsize max_size;
+  gsize size;
+
+  GHashTable *entries;          /* {key: GList in lru} */
+  GQueue lru;                   /* Most recently used first */
+
+  GDestroyNotify key_destroy_func;
+  GBoxedCopyFunc value_ref_func;
+  GDestroyNotify value_unref_func;
+};
+
+typedef struct
+{
+  gpointer key;
+  gpointer value;
+  gsize size;
+} GESLruCacheEntry;
+
+static void
+entry_free (GESLruCache * cache, GESLruCacheEntry * entry)
+{
+  if (cache->key_destroy_func)
+    cache->key_destroy_func (entry->key);
+  cache->value_unref_func (entry->value);
+  g_slice_free (GESLruCacheEntry, entry);
+}
+
+/* Must be called with the lock */
+static void
+remove_link (GESLruCache * cache, GList * link)
+{
+  GESLruCacheEntry *entry = link->data;
+
+  g_hash_table_remove (cache->entries, entry->key);
+  g_queue_delete_link (&cache->lru, link);
+  cache->size -= entry->size;
+  entry_free (cache, entry);
+}
+
+/* Must be called with the lock, returns a new reference */
+static gpointer
+lookup_unlocked (GESLruCache * cache, gconstpointer key)
+{
+  GList *link = g_hash_table_lookup (cache->entries, key);
+
+  if (link == NULL)
+    return NULL;
+
+  g_queue_unlink (&cache->lru, link);
+  g_queue_push_head_link (&cache->lru, link);
+
+  return cache->value_ref_func (((GESLruCacheEntry *) link->data)->value);
+}
+
+/* Must be called with the lock, takes ownership of @key and @value */
+static void
+insert_unlocked (GESLruCache * cache, gpointer key, gpointer value, gsize size)
+{
+  GESLruCacheEntry *entry;
+  GList *link;
+
+  if ((link = g_hash_table_lookup (cache->entries, key)))
+    remove_link (cache, link);
+
+  entry = g_slice_new (GESLruCacheEntry);
+  entry->key = key;
+  entry->value = value;
+  entry->size = size;
+
+  g_queue_push_head (&cache->lru, entry);
+  g_hash_table_insert (cache->entries, key, cache->lru.head);
+  cache->size += size;
+
+  /* Evict the least recently used values, but always keep the new one */
+  while (cache->size > cache->max_size && cache->lru.tail != cache->lru.head)
+    remove_link (cache, cache->lru.tail);
+}
+
+/* Creates a cache holding up to @max_size bytes of values, as reported by
+ * the callers of ges_lru_cache_insert(). Keys are hashed and compared with
+ * @hash_func and @key_equal_func, and freed with @key_destroy_func if it is
+ * not %NULL. References to the values are taken with @value_ref_func and
+ * released with @value_unref_func. */
+GESLruCache *
+ges_lru_cache_new (gsize max_size, GHashFunc hash_func,
+    GEqualFunc key_equal_func, GDestroyNotify key_destroy_func,
+    GBoxedCopyFunc value_ref_func, GDestroyNotify value_unref_func)
+{
+  GESLruCache *cache = g_slice_new0 (GESLruCache);
+
+  g_mutex_init (&cache->lock);
+  cache->max_size = max_size;
+  cache->entries = g_hash_table_new (hash_func, key_equal_func);
+  g_queue_init (&cache->lru);
+  cache->key_destroy_func = key_destroy_func;
+  cache->value_ref_func = value_ref_func;
+  cache->value_unref_func = value_unref_func;
+
+  return cache;
+}
+
+void
+ges_lru_cache_free (GESLruCache * cache)
+{
+  while (cache->lru.head)
+    remove_link (cache, cache->lru.head);
+
+  g_hash_table_unref (cache->entries);
+  g_mutex_clear (&cache->lock);
+  g_slice_free (GESLruCache, cache);
+}
+
+/* Returns a new reference to the value of @key, or %NULL if it is not
+ * cached, and marks it as the most recently used */
+gpointer
+ges_lru_cache_lookup (GESLruCache * cache, gconstpointer key)
+{
+  gpointer value;
+
+  g_mutex_lock (&cache->lock);
+  value = lookup_unlocked (cache, key);
+  g_mutex_unlock (&cache->lock);
+
+  return value;
+}
+
+/* Stores @value, which takes @size bytes, as the value of @key, replacing
+ * the previous value of @key if any. Takes ownership of @key and @value. */
+void
+ges_lru_cache_insert (GESLruCache * cache, gpointer key, gpointer value,
+    gsize size)
+{
+  g_mutex_lock (&cache->lock);
+  insert_unlocked (cache, key, value, size);
+  g_mutex_unlock (&cache->lock);
+}
+
+/* Like ges_lru_cache_insert(), but keeps the current value of @key if there
+ * is one, for values computed outside of the cache by several threads at
+ * once. Takes ownership of @key and @value and returns a new reference to
+ * the value now cached for @key. */
+gpointer
+ges_lru_cache_insert_or_lookup (GESLruCache * cache, gpointer key,
+    gpointer value, gsize size)
+{
+  gpointer cached;
+
+  g_mutex_lock (&cache->lock);
+  if ((cached = lookup_unlocked (cache, key)) == NULL) {
+    cached = cache->value_ref_func (value);
+    insert_unlocked (cache, key, value, size);
+    key = value = NULL;
+  }
+  g_mutex_unlock (&cache->lock);
+
+  /* Someone else cached a value in the meantime */
+  if (value) {
+    if (cache->key_destroy_func)
+      cache->key_destroy_func (key);
+    cache->value_unref_func (value);
+  }
+
+  return cached;
+}
+
+/* Total size of the cached values */
+gsize
+ges_lru_cache_get_size (GESLruCache * cache)
+{
+  gsize size;
+
+  g_mutex_lock (&cache->lock);
+  size = cache->size;
+  g_mutex_unlock (&cache->lock);
+
+  return size;
+}
@@ -0,0 +1,807 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:ges-parallel-render
+ * @short_description: Render a timeline with several pipelines at once
+ *
+ * A single #GESTimelinePipeline only uses as many cores as its encoders
+ * can. ges_parallel_render() splits a project in several time ranges,
+ * renders each of them in its own #GESTimelinePipeline, all running at the
+ * same time, and concatenates the resulting chunks.
+ *
+ * The ranges are only split at cut points, that is at positions where no
+ * #GESTimelineObject (including transitions) is playing across, so every
+ * range can be rendered from its own copy of the project without
+ * needing any data from the neighbouring ranges.
+ *
+ * The chunks are then demuxed one after the other and their streams muxed
+ * again into a single file, the timestamps of each chunk being shifted by
+ * the start of its range. This is only supported for some containers, see
+ * ges_parallel_render_can_concatenate().
+ */
+
+#include <gio/gio.h>
+
+#include "ges-internal.h"
+#include "ges-parallel-render.h"
+#include "ges-timeline.h"
+#include "ges-timeline-layer.h"
+#include "ges-simple-timeline-layer.h"
+#include "ges-timeline-object.h"
+#include "ges-timeline-pipeline.h"
+#include "ges-timeline-test-source.h"
+
+/* Containers whose streams can be remuxed with shifted timestamps, the
+ * muxers only rely on the timestamps of the buffers */
+static const gchar *remuxable_formats[] = {
+  "application/ogg",
+  "video/x-matroska",
+  "video/webm",
+  "video/quicktime",
+  NULL
+};
+
+typedef struct
+{
+  GMainLoop *loop;
+  guint n_running;
+  gboolean failed;
+} RenderContext;
+
+typedef struct
+{
+  RenderContext *context;
+  GESTimelinePipeline *pipeline;
+  gchar *uri;                   /* Where the job renders to */
+  gboolean is_chunk;
+  guint watch_id;
+} RenderJob;
+
+/* State of the remuxing of the chunks */
+typedef struct
+{
+  GstElement *pipeline;         /* appsrc-s ! muxer ! sink */
+  GstElement *muxer;
+  GPtrArray *appsrcs;           /* One per stream of the chunks */
+
+  /* The chunk being demuxed */
+  GstElement *chunk;
+  GstClockTime offset;          /* Start of the chunk in the output */
+  guint n_streams;              /* Found so far in the chunk */
+  gboolean first;
+} Remuxer;
+
+/* A stream of a chunk, fed to the muxer */
+typedef struct
+{
+  GstElement *appsrc;
+  GstClockTime offset;
+} RemuxStream;
+
+static gint
+objects_start_compare (GESTimelineObject * a, GESTimelineObject * b)
+{
+  if (a->start < b->start)
+    return -1;
+  if (a->start > b->start)
+    return 1;
+  return 0;
+}
+
+static GList *
+get_timeline_objects (GESTimeline * timeline)
+{
+  GList *layers, *tmp, *objects = NULL;
+
+  layers = ges_timeline_get_layers (timeline);
+  for (tmp = layers; tmp; tmp = tmp->next)
+    objects = g_list_concat (objects,
+        ges_timeline_layer_get_objects (tmp->data));
+  g_list_free_full (layers, g_object_unref);
+
+  return objects;
+}
+
+/**
+ * ges_parallel_render_split:
+ * @timeline: a #GESTimeline
+ * @n_ranges: the number of ranges to split @timeline in
+ * @boundaries: (out) (array): return location for the boundaries of the
+ * ranges, free with g_free()
+ *
+ * Splits @timeline in at most @n_ranges ranges of about the same duration.
+ * The ranges are only split at cut points, so less ranges than requested
+ * will be returned if there are not enough of them.
+ *
+ * The @boundaries contain the returned number of ranges + 1 positions, the
+ * range i going from boundaries[i] to boundaries[i + 1].
+ *
+ * Returns: The number of ranges @timeline was split in.
+ */
+guint
+ges_parallel_render_split (GESTimeline * timeline, guint n_ranges,
+    GstClockTime ** boundaries)
+{
+  guint i, n, next = 0;
+  GList *objects, *tmp;
+  GArray *cuts;
+  GstClockTime max_end = 0, *ret;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), 0);
+  g_return_val_if_fail (n_ranges > 0, 0);
+  g_return_val_if_fail (boundaries != NULL, 0);
+
+  objects = g_list_sort (get_timeline_objects (timeline),
+      (GCompareFunc) objects_start_compare);
+
+  cuts = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    GESTimelineObject *object = tmp->data;
+    GstClockTime start = object->start;
+
+    /* Nothing that started before @start is still playing at @start */
+    if (start > 0 && max_end <= start && (cuts->len == 0 ||
+            g_array_index (cuts, GstClockTime, cuts->len - 1) != start))
+      g_array_append_val (cuts, start);
+
+    max_end = MAX (max_end, object->start + object->duration);
+  }
+  g_list_free_full (objects, g_object_unref);
+
+  /* Cuts at the very end (empty objects) are useless */
+  while (cuts->len &&
+      g_array_index (cuts, GstClockTime, cuts->len - 1) >= max_end)
+    g_array_set_size (cuts, cuts->len - 1);
+
+  ret = g_new (GstClockTime, n_ranges + 1);
+  ret[0] = 0;
+  n = 1;
+
+  for (i = 1; i < n_ranges && next < cuts->len; i++) {
+    GstClockTime ideal = gst_util_uint64_scale (max_end, i, n_ranges);
+    guint j = next;
+
+    while (j < cuts->len && g_array_index (cuts, GstClockTime, j) < ideal)
+      j++;
+
+    /* Take the closest of the cuts around @ideal */
+    if (j == cuts->len || (j > next &&
+            ideal - g_array_index (cuts, GstClockTime, j - 1) <=
+            g_array_index (cuts, GstClockTime, j) - ideal))
+      j--;
+
+    ret[n++] = g_array_index (cuts, GstClockTime, j);
+    next = j + 1;
+  }
+  ret[n] = max_end;
+
+  GST_DEBUG ("Split timeline of duration %" GST_TIME_FORMAT " in %u ranges "
+      "(%u cut points)", GST_TIME_ARGS (max_end), n, cuts->len);
+
+  g_array_free (cuts, TRUE);
+  *boundaries = ret;
+
+  return n;
+}
+
+/**
+ * ges_parallel_render_can_concatenate:
+ * @profile: a #GstEncodingProfile
+ *
+ * Checks whether the chunks rendered with @profile can be remuxed into a
+ * single file. This is required to render with more than one job, and is
+ * the case for the Ogg, Matroska, WebM and MP4/QuickTime containers.
+ *
+ * Returns: %TRUE if the chunks rendered with @profile can be concatenated,
+ * else %FALSE.
+ */
+gboolean
+ges_parallel_render_can_concatenate (GstEncodingProfile * profile)
+{
+  guint i;
+  GstCaps *format;
+  const gchar *name;
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (GST_IS_ENCODING_PROFILE (profile), FALSE);
+
+  format = gst_encoding_profile_get_format (profile);
+  if (format == NULL || gst_caps_get_size (format) == 0)
+    goto done;
+
+  name = gst_structure_get_name (gst_caps_get_structure (format, 0));
+  for (i = 0; remuxable_formats[i]; i++) {
+    if (!g_strcmp0 (name, remuxable_formats[i])) {
+      ret = TRUE;
+      break;
+    }
+  }
+
+done:
+  if (format)
+    gst_caps_unref (format);
+
+  return ret;
+}
+
+/* Fills [0, @duration[ with black and silence, under all the layers of
+ * @timeline, so that it lasts @duration even if it ends with a gap */
+static void
+pad_timeline (GESTimeline * timeline, GstClockTime duration)
+{
+  GList *layers, *tmp;
+  GESTimelineLayer *layer;
+  GESTimelineTestSource *blank;
+  guint priority = 0;
+
+  layers = ges_timeline_get_layers (timeline);
+  for (tmp = layers; tmp; tmp = tmp->next)
+    priority = MAX (priority,
+        ges_timeline_layer_get_priority (tmp->data) + 1);
+  g_list_free_full (layers, g_object_unref);
+
+  layer = ges_timeline_layer_new ();
+  ges_timeline_layer_set_priority (layer, priority);
+  ges_timeline_add_layer (timeline, layer);
+
+  blank = ges_timeline_test_source_new ();
+  ges_timeline_test_source_set_vpattern (blank, GES_VIDEO_TEST_PATTERN_BLACK);
+  ges_timeline_test_source_set_mute (blank, TRUE);
+  g_object_set (blank, "start", (guint64) 0, "duration", duration, NULL);
+  ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (blank));
+}
+
+/* Removes the objects outside of [@start, @stop[ and moves the others so
+ * that @start becomes the beginning of @timeline. A range can end with a
+ * gap, in which case @timeline is padded up to @stop. */
+static void
+crop_timeline (GESTimeline * timeline, GstClockTime start, GstClockTime stop)
+{
+  GList *layers, *ltmp, *objects, *tmp;
+
+  layers = ges_timeline_get_layers (timeline);
+  for (ltmp = layers; ltmp; ltmp = ltmp->next) {
+    GESTimelineLayer *layer = ltmp->data;
+
+    objects = ges_timeline_layer_get_objects (layer);
+    for (tmp = objects; tmp; tmp = tmp->next) {
+      GESTimelineObject *object = tmp->data;
+
+      if (object->start + object->duration <= start || object->start >= stop)
+        ges_timeline_layer_remove_object (layer, object);
+    }
+    g_list_free_full (objects, g_object_unref);
+
+    /* Simple layers pack their objects from 0 by themselves */
+    if (start == 0 || GES_IS_SIMPLE_TIMELINE_LAYER (layer))
+      continue;
+
+    objects = ges_timeline_layer_get_objects (layer);
+    for (tmp = objects; tmp; tmp = tmp->next) {
+      GESTimelineObject *object = tmp->data;
+
+      ges_timeline_object_set_start (object, object->start - start);
+    }
+    g_list_free_full (objects, g_object_unref);
+  }
+  g_list_free_full (layers, g_object_unref);
+
+  pad_timeline (timeline, stop - start);
+}
+
+static gboolean
+job_bus_cb (GstBus * bus, GstMessage * message, RenderJob * job)
+{
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_ERROR:
+    {
+      GError *err = NULL;
+      gchar *dbg_info = NULL;
+
+      gst_message_parse_error (message, &err, &dbg_info);
+      GST_ERROR_OBJECT (job->pipeline, "Could not render %s: %s (%s)",
+          job->uri, err->message, dbg_info ? dbg_info : "no details");
+      g_error_free (err);
+      g_free (dbg_info);
+
+      /* No need to wait for the other jobs */
+      job->context->failed = TRUE;
+      g_main_loop_quit (job->context->loop);
+      job->watch_id = 0;
+
+      return FALSE;
+    }
+    case GST_MESSAGE_EOS:
+      GST_DEBUG_OBJECT (job->pipeline, "Done rendering %s", job->uri);
+
+      if (--job->context->n_running == 0)
+        g_main_loop_quit (job->context->loop);
+      job->watch_id = 0;
+
+      return FALSE;
+    default:
+      break;
+  }
+
+  return TRUE;
+}
+
+static void
+render_job_free (RenderJob * job)
+{
+  if (job->watch_id)
+    g_source_remove (job->watch_id);
+
+  gst_element_set_state (GST_ELEMENT (job->pipeline), GST_STATE_NULL);
+  gst_object_unref (job->pipeline);
+
+  if (job->is_chunk) {
+    GFile *file = g_file_new_for_uri (job->uri);
+
+    g_file_delete (file, NULL, NULL);
+    g_object_unref (file);
+  }
+
+  g_free (job->uri);
+  g_slice_free (RenderJob, job);
+}
+
+static RenderJob *
+render_job_new (RenderContext * context, const gchar * project_uri,
+    GstClockTime start, GstClockTime stop, gchar * uri, gboolean is_chunk,
+    GstEncodingProfile * profile)
+{
+  GstBus *bus;
+  RenderJob *job;
+  GESTimeline *timeline;
+
+  /* Every job has its own copy of the project */
+  if (!(timeline = ges_timeline_new_from_uri (project_uri))) {
+    GST_ERROR ("Could not load %s", project_uri);
+    g_free (uri);
+
+    return NULL;
+  }
+
+  /* Cropping moves the objects, their durations have to be known */
+  if (is_chunk) {
+    while (ges_timeline_is_discovering (timeline))
+      g_main_context_iteration (NULL, TRUE);
+
+    crop_timeline (timeline, start, stop);
+  }
+
+  job = g_slice_new0 (RenderJob);
+  job->context = context;
+  job->uri = uri;
+  job->is_chunk = is_chunk;
+  job->pipeline = ges_timeline_pipeline_new ();
+
+  ges_timeline_pipeline_add_timeline (job->pipeline, timeline);
+  if (!ges_timeline_pipeline_set_render_settings (job->pipeline, uri, profile)
+      || !ges_timeline_pipeline_set_mode (job->pipeline,
+          TIMELINE_MODE_RENDER)) {
+    /* Nothing was written yet */
+    job->is_chunk = FALSE;
+    render_job_free (job);
+
+    return NULL;
+  }
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (job->pipeline));
+  job->watch_id = gst_bus_add_watch (bus, (GstBusFunc) job_bus_cb, job);
+  gst_object_unref (bus);
+
+  GST_DEBUG ("Rendering %" GST_TIME_FORMAT " - %" GST_TIME_FORMAT " to %s",
+      GST_TIME_ARGS (start), GST_TIME_ARGS (stop), uri);
+
+  return job;
+}
+
+/* Creates the highest ranked element of @type handling @format on its pads
+ * of @direction */
+static GstElement *
+make_element_for_format (GstElementFactoryListType type, GstCaps * format,
+    GstPadDirection direction, GstRank minrank)
+{
+  GList *factories, *filtered;
+  GstElement *element = NULL;
+
+  factories = gst_element_factory_list_get_elements (type, minrank);
+  filtered = gst_element_factory_list_filter (factories, format, direction,
+      FALSE);
+  filtered = g_list_sort (filtered, gst_plugin_feature_rank_compare_func);
+
+  if (filtered)
+    element = gst_element_factory_create (filtered->data, NULL);
+
+  gst_plugin_feature_list_free (filtered);
+  gst_plugin_feature_list_free (factories);
+
+  return element;
+}
+
+/* Waits for @pipeline to reach the end of its streams */
+static gboolean
+wait_for_eos (GstElement * pipeline)
+{
+  GstBus *bus;
+  GstMessage *message;
+  gboolean ret = TRUE;
+
+  bus = gst_element_get_bus (pipeline);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  gst_object_unref (bus);
+
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR) {
+    GError *err = NULL;
+    gchar *dbg_info = NULL;
+
+    gst_message_parse_error (message, &err, &dbg_info);
+    GST_ERROR_OBJECT (pipeline, "Could not remux the chunks: %s (%s)",
+        err->message, dbg_info ? dbg_info : "no details");
+    g_error_free (err);
+    g_free (dbg_info);
+    ret = FALSE;
+  }
+  gst_message_unref (message);
+
+  return ret;
+}
+
+static void
+remux_stream_free (RemuxStream * stream)
+{
+  g_slice_free (RemuxStream, stream);
+}
+
+/* Passes the samples of a chunk on to the muxer, at their position in the
+ * output */
+static GstFlowReturn
+new_sample_cb (GstElement * appsink, RemuxStream * stream)
+{
+  GstSample *sample = NULL;
+  GstBuffer *buffer;
+  GstCaps *caps, *current;
+  GstFlowReturn ret;
+
+  g_signal_emit_by_name (appsink, "pull-sample", &sample);
+  if (sample == NULL)
+    return GST_FLOW_ERROR;
+
+  caps = gst_sample_get_caps (sample);
+  g_object_get (stream->appsrc, "caps", &current, NULL);
+  if (caps && (current == NULL || !gst_caps_is_equal (caps, current)))
+    g_object_set (stream->appsrc, "caps", caps, NULL);
+  if (current)
+    gst_caps_unref (current);
+
+  /* Only copies the metadata */
+  buffer = gst_buffer_copy (gst_sample_get_buffer (sample));
+  if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_PTS (buffer)))
+    GST_BUFFER_PTS (buffer) += stream->offset;
+  if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DTS (buffer)))
+    GST_BUFFER_DTS (buffer) += stream->offset;
+
+  g_signal_emit_by_name (stream->appsrc, "push-buffer", buffer, &ret);
+  gst_buffer_unref (buffer);
+  gst_sample_unref (sample);
+
+  return ret;
+}
+
+/* Streams are matched by order of appearance, all the chunks being rendered
+ * with the same profile. The first chunk creates the inputs of the muxer. */
+static void
+chunk_pad_added_cb (GstElement * demuxer, GstPad * pad, Remuxer * remuxer)
+{
+  GstElement *queue, *parser, *appsink, *appsrc;
+  GstPad *sinkpad, *srcpad, *muxpad;
+  RemuxStream *stream;
+  GstCaps *caps;
+  guint index = remuxer->n_streams++;
+
+  caps = gst_pad_query_caps (pad, NULL);
+
+  if (remuxer->first) {
+    appsrc = gst_element_factory_make ("appsrc", NULL);
+    g_object_set (appsrc, "format", GST_FORMAT_TIME, NULL);
+    gst_bin_add (GST_BIN (remuxer->pipeline), appsrc);
+
+    srcpad = gst_element_get_static_pad (appsrc, "src");
+    muxpad = gst_element_get_compatible_pad (remuxer->muxer, srcpad, caps);
+    if (muxpad == NULL || GST_PAD_LINK_FAILED (gst_pad_link (srcpad, muxpad))) {
+      GST_ERROR_OBJECT (remuxer->muxer, "Can not mux %" GST_PTR_FORMAT, caps);
+      if (muxpad)
+        gst_object_unref (muxpad);
+      gst_object_unref (srcpad);
+      goto done;
+    }
+    gst_object_unref (muxpad);
+    gst_object_unref (srcpad);
+
+    g_ptr_array_add (remuxer->appsrcs, gst_object_ref (appsrc));
+  } else if (index >= remuxer->appsrcs->len) {
+    GST_ERROR_OBJECT (demuxer, "More streams than in the first chunk");
+    goto done;
+  }
+
+  /* The queue lets the other streams preroll */
+  queue = gst_element_factory_make ("queue", NULL);
+  parser = make_element_for_format (GST_ELEMENT_FACTORY_TYPE_PARSER, caps,
+      GST_PAD_SINK, GST_RANK_NONE);
+  appsink = gst_element_factory_make ("appsink", NULL);
+  g_object_set (appsink, "sync", FALSE, "emit-signals", TRUE, NULL);
+
+  stream = g_slice_new (RemuxStream);
+  stream->appsrc = g_ptr_array_index (remuxer->appsrcs, index);
+  stream->offset = remuxer->offset;
+  g_signal_connect_data (appsink, "new-sample", G_CALLBACK (new_sample_cb),
+      stream, (GClosureNotify) remux_stream_free, 0);
+
+  gst_bin_add_many (GST_BIN (remuxer->chunk), queue, appsink, NULL);
+  if (parser) {
+    gst_bin_add (GST_BIN (remuxer->chunk), parser);
+    gst_element_link_many (queue, parser, appsink, NULL);
+    gst_element_sync_state_with_parent (appsink);
+    gst_element_sync_state_with_parent (parser);
+  } else {
+    gst_element_link (queue, appsink);
+    gst_element_sync_state_with_parent (appsink);
+  }
+  gst_element_sync_state_with_parent (queue);
+
+  sinkpad = gst_element_get_static_pad (queue, "sink");
+  if (GST_PAD_LINK_FAILED (gst_pad_link (pad, sinkpad)))
+    GST_ERROR_OBJECT (demuxer, "Could not link %" GST_PTR_FORMAT, pad);
+  gst_object_unref (sinkpad);
+
+done:
+  gst_caps_unref (caps);
+}
+
+/* Demuxes the chunk at @uri, shifting its timestamps by @offset */
+static gboolean
+remux_chunk (Remuxer * remuxer, const gchar * uri, GstClockTime offset,
+    GstCaps * format)
+{
+  GstElement *src, *demuxer;
+  gboolean ret = FALSE;
+
+  src = gst_element_make_from_uri (GST_URI_SRC, uri, NULL, NULL);
+  demuxer = make_element_for_format (GST_ELEMENT_FACTORY_TYPE_DEMUXER, format,
+      GST_PAD_SINK, GST_RANK_MARGINAL);
+  if (src == NULL || demuxer == NULL) {
+    GST_ERROR ("Could not create the elements to read %s", uri);
+    if (src)
+      gst_object_unref (src);
+    if (demuxer)
+      gst_object_unref (demuxer);
+
+    return FALSE;
+  }
+
+  remuxer->chunk = gst_pipeline_new (NULL);
+  remuxer->offset = offset;
+  remuxer->n_streams = 0;
+
+  gst_bin_add_many (GST_BIN (remuxer->chunk), src, demuxer, NULL);
+  gst_element_link (src, demuxer);
+  g_signal_connect (demuxer, "pad-added", G_CALLBACK (chunk_pad_added_cb),
+      remuxer);
+
+  /* Once prerolled, all the streams of the chunk are linked */
+  if (gst_element_set_state (remuxer->chunk, GST_STATE_PAUSED) ==
+      GST_STATE_CHANGE_FAILURE ||
+      gst_element_get_state (remuxer->chunk, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE) {
+    GST_ERROR ("Could not demux %s", uri);
+    goto done;
+  }
+
+  if (remuxer->n_streams != remuxer->appsrcs->len) {
+    GST_ERROR ("%s has %u streams instead of %u", uri, remuxer->n_streams,
+        remuxer->appsrcs->len);
+    goto done;
+  }
+
+  /* The muxer has all its inputs once the first chunk is prerolled */
+  if (remuxer->first && gst_element_set_state (remuxer->pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    GST_ERROR ("Could not start muxing");
+    goto done;
+  }
+
+  if (gst_element_set_state (remuxer->chunk, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE) {
+    GST_ERROR ("Could not demux %s", uri);
+    goto done;
+  }
+
+  ret = wait_for_eos (remuxer->chunk);
+
+done:
+  gst_element_set_state (remuxer->chunk, GST_STATE_NULL);
+  gst_object_unref (remuxer->chunk);
+  remuxer->chunk = NULL;
+  remuxer->first = FALSE;
+
+  return ret;
+}
+
+/* Muxes the streams of all the chunks into @output_uri, one chunk after the
+ * other */
+static gboolean
+remux_chunks (GPtrArray * jobs, GstClockTime * boundaries,
+    const gchar * output_uri, GstEncodingProfile * profile)
+{
+  guint i;
+  GstElement *sink;
+  GstCaps *format;
+  Remuxer remuxer = { NULL, };
+  gboolean ret = FALSE;
+
+  format = gst_encoding_profile_get_format (profile);
+  remuxer.pipeline = gst_pipeline_new ("remux-chunks");
+  remuxer.muxer = make_element_for_format (GST_ELEMENT_FACTORY_TYPE_MUXER,
+      format, GST_PAD_SRC, GST_RANK_MARGINAL);
+  remuxer.appsrcs = g_ptr_array_new_with_free_func (gst_object_unref);
+  remuxer.first = TRUE;
+
+  sink = gst_element_make_from_uri (GST_URI_SINK, output_uri, NULL, NULL);
+  if (remuxer.muxer == NULL || sink == NULL) {
+    GST_ERROR ("Could not create the elements to write %s", output_uri);
+    if (remuxer.muxer)
+      gst_object_unref (remuxer.muxer);
+    if (sink)
+      gst_object_unref (sink);
+    goto done;
+  }
+
+  gst_bin_add_many (GST_BIN (remuxer.pipeline), remuxer.muxer, sink, NULL);
+  gst_element_link (remuxer.muxer, sink);
+
+  for (i = 0; i < jobs->len; i++) {
+    RenderJob *job = g_ptr_array_index (jobs, i);
+
+    if (!remux_chunk (&remuxer, job->uri, boundaries[i], format))
+      goto done;
+  }
+
+  for (i = 0; i < remuxer.appsrcs->len; i++) {
+    GstFlowReturn flow;
+
+    g_signal_emit_by_name (g_ptr_array_index (remuxer.appsrcs, i),
+        "end-of-stream", &flow);
+  }
+
+  ret = wait_for_eos (remuxer.pipeline);
+
+done:
+  gst_element_set_state (remuxer.pipeline, GST_STATE_NULL);
+  gst_object_unref (remuxer.pipeline);
+  g_ptr_array_free (remuxer.appsrcs, TRUE);
+  if (format)
+    gst_caps_unref (format);
+
+  return ret;
+}
+
+/**
+ * ges_parallel_render:
+ * @project_uri: the URI of the project to render
+ * @output_uri: the URI to which the project will be rendered
+ * @profile: the #GstEncodingProfile to use to render the project
+ * @n_jobs: the maximum number of pipelines rendering at the same time
+ *
+ * Renders the project at @project_uri to @output_uri, splitting it in up to
+ * @n_jobs ranges rendered at the same time, see ges_parallel_render_split().
+ *
+ * Rendering with more than one job fails if the chunks rendered with
+ * @profile can not be concatenated, see
+ * ges_parallel_render_can_concatenate().
+ *
+ * This method iterates the default #GMainContext and blocks until the
+ * rendering is done.
+ *
+ * Returns: %TRUE if the project was rendered, else %FALSE.
+ */
+gboolean
+ges_parallel_render (const gchar * project_uri, const gchar * output_uri,
+    GstEncodingProfile * profile, guint n_jobs)
+{
+  guint i, n_ranges;
+  GPtrArray *jobs;
+  GESTimeline *timeline;
+  GstClockTime *boundaries;
+  RenderContext context = { NULL, 0, FALSE };
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (project_uri != NULL, FALSE);
+  g_return_val_if_fail (output_uri != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_ENCODING_PROFILE (profile), FALSE);
+  g_return_val_if_fail (n_jobs > 0, FALSE);
+
+  if (n_jobs > 1 && !ges_parallel_render_can_concatenate (profile)) {
+    GST_ERROR ("The chunks rendered with the profile can not be remuxed, "
+        "%u jobs can not be used", n_jobs);
+    return FALSE;
+  }
+
+  if (!(timeline = ges_timeline_new_from_uri (project_uri))) {
+    GST_ERROR ("Could not load %s", project_uri);
+    return FALSE;
+  }
+
+  /* The durations of the objects might only be known once discovered */
+  while (ges_timeline_is_discovering (timeline))
+    g_main_context_iteration (NULL, TRUE);
+
+  n_ranges = ges_parallel_render_split (timeline, n_jobs, &boundaries);
+  gst_object_unref (timeline);
+
+  if (n_ranges < n_jobs)
+    GST_WARNING ("%s only has enough cut points for %u jobs instead of %u",
+        project_uri, n_ranges, n_jobs);
+
+  context.loop = g_main_loop_new (NULL, FALSE);
+  jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) render_job_free);
+
+  for (i = 0; i < n_ranges; i++) {
+    RenderJob *job;
+
+    if (n_ranges == 1)
+      job = render_job_new (&context, project_uri, 0, GST_CLOCK_TIME_NONE,
+          g_strdup (output_uri), FALSE, profile);
+    else
+      job = render_job_new (&context, project_uri, boundaries[i],
+          boundaries[i + 1], g_strdup_printf ("%s.part%u", output_uri, i),
+          TRUE, profile);
+
+    if (job == NULL)
+      goto done;
+
+    g_ptr_array_add (jobs, job);
+  }
+
+  for (i = 0; i < jobs->len; i++) {
+    RenderJob *job = g_ptr_array_index (jobs, i);
+
+    if (gst_element_set_state (GST_ELEMENT (job->pipeline),
+            GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+      GST_ERROR ("Could not start rendering %s", job->uri);
+      goto done;
+    }
+    context.n_running++;
+  }
+
+  g_main_loop_run (context.loop);
+
+  if (!context.failed)
+    ret = (n_ranges == 1) ? TRUE :
+        remux_chunks (jobs, boundaries, output_uri, profile);
+
+done:
+  g_ptr_array_free (jobs, TRUE);
+  g_main_loop_unref (context.loop);
+  g_free (boundaries);
+
+  return ret;
+}
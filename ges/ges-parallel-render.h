@@ -0,0 +1,42 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _GES_PARALLEL_RENDER
+#define _GES_PARALLEL_RENDER
+
+#include <glib-object.h>
+#include <gst/gst.h>
+#include <gst/pbutils/encoding-profile.h>
+#include <ges/ges-types.h>
+
+G_BEGIN_DECLS
+
+guint
+ges_parallel_render_split (GESTimeline * timeline, guint n_ranges,
+    GstClockTime ** boundaries);
+
+gboolean
+ges_parallel_render_can_concatenate (GstEncodingProfile * profile);
+
+gboolean
+ges_parallel_render (const gchar * project_uri, const gchar * output_uri,
+    GstEncodingProfile * profile, guint n_jobs);
+
+G_END_DECLS
+
+#endif /* _GES_PARALLEL_RENDER */
@@ -61,8 +61,6 @@ typedef struct SrcMapping
 
 struct _GESPitiviFormatterPrivate
 {
-  xmlXPathContextPtr xpathCtx;
-
   /* {"sourceId" : {"prop": "value"}} */
   GHashTable *sources_table;
 
@@ -534,22 +532,21 @@ save_pitivi_timeline_to_uri (GESFormatter * formatter,
 
 /* Return: a GHashTable containing:
  *    {attr: value}
+ * for the element @reader is positioned on
  */
 static GHashTable *
-get_nodes_infos (xmlNodePtr node)
+get_nodes_infos (xmlTextReaderPtr reader)
 {
-  xmlAttr *cur_attr;
   GHashTable *props_table;
-  gchar *name, *value;
 
   props_table = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, NULL);
 
-  for (cur_attr = node->properties; cur_attr; cur_attr = cur_attr->next) {
-    name = (gchar *) cur_attr->name;
-    value = (gchar *) xmlGetProp (node, cur_attr->name);
-    g_hash_table_insert (props_table, g_strdup (name), g_strdup (value));
-    xmlFree (value);
+  while (xmlTextReaderMoveToNextAttribute (reader) == 1) {
+    g_hash_table_insert (props_table,
+        g_strdup ((gchar *) xmlTextReaderConstName (reader)),
+        g_strdup ((gchar *) xmlTextReaderConstValue (reader)));
   }
+  xmlTextReaderMoveToElement (reader);
 
   return props_table;
 }
@@ -595,170 +592,230 @@ create_tracks (GESFormatter * self)
   return TRUE;
 }
 
-static void
-list_sources (GESFormatter * self)
+/* State of the single pass over the project file, the tables are filled as
+ * the elements are read so the document is never fully in memory */
+typedef struct
 {
-  GESPitiviFormatterPrivate *priv = GES_PITIVI_FORMATTER (self)->priv;
-  xmlXPathObjectPtr xpathObj;
-  GHashTable *table;
-  int size, j;
-  gchar *id, *filename;
-  xmlNodeSetPtr nodes;
-
-  xpathObj = xmlXPathEvalExpression ((const xmlChar *)
-      "/pitivi/factories/sources/source", priv->xpathCtx);
-  nodes = xpathObj->nodesetval;
-
-  size = (nodes) ? nodes->nodeNr : 0;
-  for (j = 0; j < size; ++j) {
-    table = get_nodes_infos (nodes->nodeTab[j]);
-    id = (gchar *) g_hash_table_lookup (table, (gchar *) "id");
-    filename = (gchar *) g_hash_table_lookup (table, (gchar *) "filename");
-    g_hash_table_insert (priv->sources_table, g_strdup (id), table);
-    g_hash_table_insert (priv->source_uris, g_strdup (filename),
-        g_strdup (filename));
-  }
-
-  xmlXPathFreeObject (xpathObj);
-}
+  /* Names of the current element and its ancestors, owned by the reader
+   * dictionary */
+  GPtrArray *path;
 
-static gboolean
-parse_track_objects (GESFormatter * self)
-{
-  GESPitiviFormatterPrivate *priv = GES_PITIVI_FORMATTER (self)->priv;
-  xmlXPathObjectPtr xpathObj;
-  xmlNodeSetPtr nodes;
-  int size, j;
-  gchar *id, *fac_ref;
-  GHashTable *table = NULL, *effect_table = NULL;
-  xmlNode *first_child;
+  /* <track> being read */
   gchar *media_type;
 
-  /* FIXME Make this whole function cleaner starting from
-   * "/pitivi/timeline/tracks/track/stream" and descending
-   * into the children. */
-  xpathObj = xmlXPathEvalExpression ((const xmlChar *)
-      "/pitivi/timeline/tracks/track/track-objects/track-object",
-      priv->xpathCtx);
+  /* <track-object> being read */
+  gchar *tckobj_id;
+  GHashTable *tckobj_table;
+  guint n_tckobj_children;
+  guint n_effect_children;
+
+  /* <timeline-object> being read */
+  gchar *facref_id;
+} LoadingContext;
 
-  if (xpathObj == NULL) {
-    GST_DEBUG ("No track object found");
+/* Whether the first @depth elements of the path are @names */
+static gboolean
+path_matches (LoadingContext * ctx, const gchar * const *names, guint depth)
+{
+  gint i;
 
+  if (depth != g_strv_length ((gchar **) names))
     return FALSE;
+
+  /* The innermost elements are the most likely to differ */
+  for (i = depth - 1; i >= 0; i--) {
+    if (g_strcmp0 (g_ptr_array_index (ctx->path, i), names[i]))
+      return FALSE;
   }
 
-  nodes = xpathObj->nodesetval;
-  size = (nodes) ? nodes->nodeNr : 0;
+  return TRUE;
+}
 
-  for (j = 0; j < size; ++j) {
-    xmlNodePtr node = nodes->nodeTab[j];
+static inline gboolean
+path_is (LoadingContext * ctx, const gchar * const *names)
+{
+  return path_matches (ctx, names, ctx->path->len);
+}
 
-    table = get_nodes_infos (nodes->nodeTab[j]);
-    id = (gchar *) g_hash_table_lookup (table, (gchar *) "id");
-    first_child = nodes->nodeTab[j]->children->next;
-    fac_ref = (gchar *) xmlGetProp (first_child, (xmlChar *) "id");
+/* Whether the current element is a child of @names */
+static inline gboolean
+parent_is (LoadingContext * ctx, const gchar * const *names)
+{
+  return ctx->path->len > 0 && path_matches (ctx, names, ctx->path->len - 1);
+}
 
-    /* We check if the first child is "effect" */
-    if (!g_strcmp0 ((gchar *) first_child->name, (gchar *) "effect")) {
-      xmlChar *effect_name;
-      xmlNodePtr fact_node = first_child->children->next;
+static const gchar *const source_path[] =
+    { "pitivi", "factories", "sources", "source", NULL };
+static const gchar *const stream_path[] =
+    { "pitivi", "timeline", "tracks", "track", "stream", NULL };
+static const gchar *const tckobj_path[] =
+    { "pitivi", "timeline", "tracks", "track", "track-objects", "track-object",
+  NULL
+};
+static const gchar *const effect_path[] =
+    { "pitivi", "timeline", "tracks", "track", "track-objects", "track-object",
+  "effect", NULL
+};
+static const gchar *const factory_ref_path[] =
+    { "pitivi", "timeline", "timeline-objects", "timeline-object",
+  "factory-ref", NULL
+};
+static const gchar *const tckobj_ref_path[] =
+    { "pitivi", "timeline", "timeline-objects", "timeline-object",
+  "track-object-refs", "track-object-ref", NULL
+};
 
-      /* We have a node called "text" in between thus ->next->next */
-      xmlNodePtr elem_props_node = fact_node->next->next;
+static void
+start_element (GESPitiviFormatterPrivate * priv, LoadingContext * ctx,
+    xmlTextReaderPtr reader)
+{
+  xmlChar *id;
 
-      effect_name = xmlGetProp (fact_node, (xmlChar *) "name");
-      g_hash_table_insert (table, g_strdup ((gchar *) "effect_name"),
-          g_strdup ((gchar *) effect_name));
-      xmlFree (effect_name);
+  if (path_is (ctx, source_path)) {
+    GHashTable *table = get_nodes_infos (reader);
+    gchar *source_id = (gchar *) g_hash_table_lookup (table, (gchar *) "id");
+    gchar *filename = (gchar *) g_hash_table_lookup (table,
+        (gchar *) "filename");
 
-      /* We put the effects properties in an hacktable (Lapsus is on :) */
-      effect_table = get_nodes_infos (elem_props_node);
+    g_hash_table_insert (priv->sources_table, g_strdup (source_id), table);
+    g_hash_table_insert (priv->source_uris, g_strdup (filename),
+        g_strdup (filename));
 
-      g_hash_table_insert (table, g_strdup ((gchar *) "fac_ref"),
+  } else if (path_is (ctx, stream_path)) {
+    g_free (ctx->media_type);
+    ctx->media_type = (gchar *) xmlTextReaderGetAttribute (reader,
+        (xmlChar *) "type");
+
+  } else if (path_is (ctx, tckobj_path)) {
+    ctx->tckobj_table = get_nodes_infos (reader);
+    ctx->tckobj_id = g_strdup (g_hash_table_lookup (ctx->tckobj_table,
+            (gchar *) "id"));
+    ctx->n_tckobj_children = 0;
+    ctx->n_effect_children = 0;
+
+  } else if (ctx->tckobj_table && parent_is (ctx, tckobj_path)) {
+    /* We only care about the first child, either the factory-ref or the
+     * effect */
+    if (ctx->n_tckobj_children++ > 0)
+      return;
+
+    if (!xmlStrcmp (xmlTextReaderConstName (reader), (xmlChar *) "effect")) {
+      g_hash_table_insert (ctx->tckobj_table, g_strdup ((gchar *) "fac_ref"),
           g_strdup ("effect"));
-
-      xmlFree (fac_ref);
     } else {
+      id = xmlTextReaderGetAttribute (reader, (xmlChar *) "id");
+      g_hash_table_insert (ctx->tckobj_table, g_strdup ((gchar *) "fac_ref"),
+          g_strdup ((gchar *) id));
+      xmlFree (id);
+    }
+
+  } else if (ctx->tckobj_table && parent_is (ctx, effect_path)) {
+    /* The factory of the effect followed by the properties of its element */
+    if (ctx->n_effect_children == 0) {
+      xmlChar *effect_name = xmlTextReaderGetAttribute (reader,
+          (xmlChar *) "name");
 
-      g_hash_table_insert (table, g_strdup ((gchar *) "fac_ref"),
-          g_strdup (fac_ref));
-      xmlFree (fac_ref);
+      g_hash_table_insert (ctx->tckobj_table,
+          g_strdup ((gchar *) "effect_name"), g_strdup ((gchar *) effect_name));
+      xmlFree (effect_name);
+    } else if (ctx->n_effect_children == 1) {
+      g_hash_table_insert (ctx->tckobj_table, g_strdup ("effect_props"),
+          get_nodes_infos (reader));
     }
+    ctx->n_effect_children++;
 
-    /* Same as before, we got a text node in between, thus the 2 prev
-     * node->parent is <track-objects>, the one before is <stream>
-     */
-    media_type = (gchar *) xmlGetProp (node->parent->prev->prev,
-        (const xmlChar *) "type");
-    g_hash_table_insert (table, g_strdup ((gchar *) "media_type"),
-        g_strdup (media_type));
-    xmlFree (media_type);
+  } else if (path_is (ctx, factory_ref_path)) {
+    /* We assume that factory-ref is always before the tckobjs-ref */
+    g_free (ctx->facref_id);
+    ctx->facref_id = (gchar *) xmlTextReaderGetAttribute (reader,
+        (xmlChar *) "id");
 
+  } else if (path_is (ctx, tckobj_ref_path)) {
+    GHashTable *tlobjs_table = priv->timeline_objects_table;
+    GList *reflist;
 
-    if (effect_table)
-      g_hash_table_insert (table, g_strdup ("effect_props"), effect_table);
+    if (G_UNLIKELY (ctx->facref_id == NULL)) {
+      GST_WARNING ("track-object-ref without factory-ref, ignoring it");
+      return;
+    }
 
-    g_hash_table_insert (priv->track_objects_table, g_strdup (id), table);
+    /* We add the track object ref ID to the list of the current
+     * TimelineObject tracks, this way we can merge 2
+     * TimelineObject-s into 1 when we have unlinked TrackObject-s */
+    reflist = g_hash_table_lookup (tlobjs_table, ctx->facref_id);
+    id = xmlTextReaderGetAttribute (reader, (xmlChar *) "id");
+    reflist = g_list_append (reflist, g_strdup ((gchar *) id));
+    g_hash_table_insert (tlobjs_table, g_strdup (ctx->facref_id), reflist);
+    xmlFree (id);
   }
+}
 
-  xmlXPathFreeObject (xpathObj);
-  return TRUE;
+static void
+end_element (GESPitiviFormatterPrivate * priv, LoadingContext * ctx)
+{
+  if (ctx->tckobj_table && path_is (ctx, tckobj_path)) {
+    g_hash_table_insert (ctx->tckobj_table, g_strdup ((gchar *) "media_type"),
+        g_strdup (ctx->media_type));
+    g_hash_table_insert (priv->track_objects_table, ctx->tckobj_id,
+        ctx->tckobj_table);
+
+    ctx->tckobj_id = NULL;
+    ctx->tckobj_table = NULL;
+  }
 }
 
+/* Fills the sources, track objects and timeline objects tables reading
+ * @uri once */
 static gboolean
-parse_timeline_objects (GESFormatter * self)
+parse_project (GESFormatter * self, const gchar * uri)
 {
-  int size, j;
-  xmlNodeSetPtr nodes;
-  xmlXPathObjectPtr xpathObj;
-  xmlNodePtr tlobj_nd, tmp_nd, tmp_nd2;
-  xmlChar *tckobjrefId, *facrefId = NULL;
-
-  GList *reflist = NULL;
+  xmlTextReaderPtr reader;
+  LoadingContext ctx = { NULL, };
   GESPitiviFormatterPrivate *priv = GES_PITIVI_FORMATTER (self)->priv;
-  GHashTable *tlobjs_table = priv->timeline_objects_table;
+  gint ret;
 
-  xpathObj = xmlXPathEvalExpression ((const xmlChar *)
-      "/pitivi/timeline/timeline-objects/timeline-object", priv->xpathCtx);
-
-  if (xpathObj == NULL) {
-    xmlXPathFreeObject (xpathObj);
+  reader = xmlReaderForFile (uri, NULL, 0);
+  if (reader == NULL)
     return FALSE;
-  }
-
-  nodes = xpathObj->nodesetval;
-  size = (nodes) ? nodes->nodeNr : 0;
 
-  for (j = 0; j < size; j++) {
-    tlobj_nd = nodes->nodeTab[j];
+  ctx.path = g_ptr_array_new ();
 
-    for (tmp_nd = tlobj_nd->children; tmp_nd; tmp_nd = tmp_nd->next) {
-      /* We assume that factory-ref is always before the tckobjs-ref */
-      if (!xmlStrcmp (tmp_nd->name, (xmlChar *) "factory-ref")) {
-        facrefId = xmlGetProp (tmp_nd, (xmlChar *) "id");
+  while ((ret = xmlTextReaderRead (reader)) == 1) {
+    switch (xmlTextReaderNodeType (reader)) {
+      case XML_READER_TYPE_ELEMENT:
+      {
+        gboolean empty = xmlTextReaderIsEmptyElement (reader);
 
-      } else if (!xmlStrcmp (tmp_nd->name, (xmlChar *) "track-object-refs")) {
+        g_ptr_array_add (ctx.path, (gpointer) xmlTextReaderConstName (reader));
+        start_element (priv, &ctx, reader);
 
-        for (tmp_nd2 = tmp_nd->children; tmp_nd2; tmp_nd2 = tmp_nd2->next) {
-          if (!xmlStrcmp (tmp_nd2->name, (xmlChar *) "track-object-ref")) {
-            /* We add the track object ref ID to the list of the current
-             * TimelineObject tracks, this way we can merge 2
-             * TimelineObject-s into 1 when we have unlinked TrackObject-s */
-            reflist = g_hash_table_lookup (tlobjs_table, facrefId);
-            tckobjrefId = xmlGetProp (tmp_nd2, (xmlChar *) "id");
-            reflist = g_list_append (reflist, g_strdup ((gchar *) tckobjrefId));
-            g_hash_table_insert (tlobjs_table, g_strdup ((gchar *) facrefId),
-                reflist);
-
-            xmlFree (tckobjrefId);
-          }
+        /* No end element will come for <element/> */
+        if (empty) {
+          end_element (priv, &ctx);
+          g_ptr_array_set_size (ctx.path, ctx.path->len - 1);
         }
+        break;
       }
+      case XML_READER_TYPE_END_ELEMENT:
+        end_element (priv, &ctx);
+        if (ctx.path->len)
+          g_ptr_array_set_size (ctx.path, ctx.path->len - 1);
+        break;
+      default:
+        break;
     }
   }
 
-  xmlXPathFreeObject (xpathObj);
-  return TRUE;
+  if (ctx.tckobj_table) {
+    g_hash_table_destroy (ctx.tckobj_table);
+    g_free (ctx.tckobj_id);
+  }
+  g_free (ctx.media_type);
+  g_free (ctx.facref_id);
+  g_ptr_array_free (ctx.path, TRUE);
+  xmlFreeTextReader (reader);
+
+  return ret == 0;
 }
 
 static void
@@ -1052,7 +1109,6 @@ static gboolean
 load_pitivi_file_from_uri (GESFormatter * self,
     GESTimeline * timeline, const gchar * uri)
 {
-  xmlDocPtr doc;
   GESTimelineLayer *layer;
   GESPitiviFormatterPrivate *priv = GES_PITIVI_FORMATTER (self)->priv;
 
@@ -1071,33 +1127,17 @@ load_pitivi_file_from_uri (GESFormatter * self,
     return FALSE;
   }
 
-  if (!(doc = xmlParseFile (uri))) {
+  if (!parse_project (self, uri)) {
     GST_ERROR ("The xptv file for uri %s was badly formed or did not exist",
         uri);
     return FALSE;
   }
 
-  priv->xpathCtx = xmlXPathNewContext (doc);
-
   if (!create_tracks (self)) {
     GST_ERROR ("Couldn't create tracks");
     return FALSE;
   }
 
-  list_sources (self);
-
-  if (!parse_timeline_objects (self)) {
-    GST_ERROR ("Couldn't find timeline objects markup in the xptv file");
-    return FALSE;
-  }
-
-  if (!parse_track_objects (self)) {
-    GST_ERROR ("Couldn't find track objects markup in the xptv file");
-    return FALSE;
-  }
-
-
-
   /* If there are no timeline objects to load we should emit
    * 'project-loaded' signal.
    */
@@ -1110,8 +1150,6 @@ load_pitivi_file_from_uri (GESFormatter * self,
     }
   }
 
-  xmlXPathFreeContext (priv->xpathCtx);
-  xmlFreeDoc (doc);
   return ret;
 }
 
@@ -0,0 +1,419 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Low resolution proxies of the video streams of media files, used instead
+ * of the original files when previewing a timeline (see
+ * GESTimeline:use-proxies).
+ *
+ * Proxies are intra-only (motion JPEG) so that seeking in them is cheap, and
+ * are stored in the user cache directory. They are keyed by the URI, size
+ * and modification time of the original file so that a proxy is never used
+ * for a file that changed. As for the discovery cache, only local files get
+ * a proxy.
+ *
+ * Proxies are created in the background, one file at a time, and the
+ * GESProxyReadyFunc given at creation is called from the main context once
+ * a proxy is ready (or could not be created). */
+
+#include <glib/gstdio.h>
+
+#include "ges-internal.h"
+
+#define PROXY_HEIGHT 360
+
+struct _GESProxyCache
+{
+  GESProxyReadyFunc func;
+  gpointer user_data;
+
+  /* uris that were requested, to only try them once */
+  GHashTable *requested;
+  /* uris waiting for the running job to be done */
+  GQueue queue;
+
+  /* The running job */
+  GstElement *pipeline;
+  gchar *uri;
+  gchar *filename;
+  gchar *tmp_filename;
+  guint bus_watch;
+};
+
+static void start_next_job (GESProxyCache * cache);
+
+/* Returns the file the proxy of @uri is (or would be) stored in, or %NULL if
+ * @uri can not have a proxy */
+static gchar *
+get_proxy_filename (const gchar * uri)
+{
+  guint64 size, mtime;
+  gchar *key, *checksum, *basename, *filename;
+
+  if (!ges_query_file_stamp (uri, &size, &mtime))
+    return NULL;
+
+  key = g_strdup_printf ("%s %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT,
+      uri, size, mtime);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  basename = g_strdup_printf ("%s.mkv", checksum);
+
+  filename = g_build_filename (g_get_user_cache_dir (),
+      "gstreamer-editing-services", "proxies", basename, NULL);
+
+  g_free (basename);
+  g_free (checksum);
+  g_free (key);
+
+  return filename;
+}
+
+static void
+stop_job (GESProxyCache * cache, gboolean success)
+{
+  gchar *proxy_uri = NULL;
+
+  gst_element_set_state (cache->pipeline, GST_STATE_NULL);
+  gst_object_unref (cache->pipeline);
+  cache->pipeline = NULL;
+
+  if (cache->bus_watch) {
+    g_source_remove (cache->bus_watch);
+    cache->bus_watch = 0;
+  }
+
+  /* Only complete proxies get their final name */
+  if (success && g_rename (cache->tmp_filename, cache->filename) == 0)
+    proxy_uri = g_filename_to_uri (cache->filename, NULL, NULL);
+  else
+    g_unlink (cache->tmp_filename);
+
+  g_free (cache->tmp_filename);
+  cache->tmp_filename = NULL;
+  g_free (cache->filename);
+  cache->filename = NULL;
+
+  if (cache->func)
+    cache->func (cache->uri, proxy_uri, cache->user_data);
+
+  g_free (proxy_uri);
+  g_free (cache->uri);
+  cache->uri = NULL;
+}
+
+static gboolean
+bus_message_cb (GstBus * bus, GstMessage * message, GESProxyCache * cache)
+{
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_EOS:
+      GST_DEBUG ("Proxy of %s created in %s", cache->uri, cache->filename);
+
+      /* The watch is removed by returning FALSE */
+      cache->bus_watch = 0;
+      stop_job (cache, TRUE);
+      start_next_job (cache);
+
+      return FALSE;
+    case GST_MESSAGE_ERROR:
+    {
+      GError *err = NULL;
+
+      gst_message_parse_error (message, &err, NULL);
+      GST_WARNING ("Could not create the proxy of %s: %s", cache->uri,
+          err ? err->message : "unknown error");
+      g_clear_error (&err);
+
+      cache->bus_watch = 0;
+      stop_job (cache, FALSE);
+      start_next_job (cache);
+
+      return FALSE;
+    }
+    default:
+      break;
+  }
+
+  return TRUE;
+}
+
+static void
+pad_added_cb (GstElement * decodebin, GstPad * pad, GstElement * convert)
+{
+  GstCaps *caps;
+  GstPad *sinkpad;
+  gboolean is_video;
+
+  caps = gst_pad_query_caps (pad, NULL);
+  is_video = g_str_has_prefix (gst_structure_get_name
+      (gst_caps_get_structure (caps, 0)), "video/");
+  gst_caps_unref (caps);
+
+  sinkpad = gst_element_get_static_pad (convert, "sink");
+
+  if (is_video && !gst_pad_is_linked (sinkpad)) {
+    gst_pad_link (pad, sinkpad);
+  } else {
+    /* We only make proxies of the first video stream */
+    GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+    GstPad *fakepad = gst_element_get_static_pad (fakesink, "sink");
+
+    g_object_set (fakesink, "async", FALSE, NULL);
+    gst_bin_add (GST_BIN (GST_ELEMENT_PARENT (decodebin)), fakesink);
+    gst_element_sync_state_with_parent (fakesink);
+    gst_pad_link (pad, fakepad);
+    gst_object_unref (fakepad);
+  }
+
+  gst_object_unref (sinkpad);
+}
+
+static void
+no_more_pads_cb (GstElement * decodebin, GstElement * convert)
+{
+  GstPad *sinkpad = gst_element_get_static_pad (convert, "sink");
+
+  if (!gst_pad_is_linked (sinkpad)) {
+    GError *err = g_error_new_literal (GST_STREAM_ERROR,
+        GST_STREAM_ERROR_WRONG_TYPE, "No video stream to create a proxy from");
+
+    gst_element_post_message (decodebin,
+        gst_message_new_error (GST_OBJECT (decodebin), err, NULL));
+    g_error_free (err);
+  }
+
+  gst_object_unref (sinkpad);
+}
+
+/* uridecodebin ! videoconvert ! videoscale ! capsfilter ! jpegenc !
+ *     matroskamux ! filesink */
+static gboolean
+start_job (GESProxyCache * cache)
+{
+  GstBus *bus;
+  GstCaps *caps;
+  GstElement *src, *convert, *scale, *capsfilter, *enc, *mux, *sink;
+
+  src = gst_element_factory_make ("uridecodebin", NULL);
+  convert = gst_element_factory_make ("videoconvert", NULL);
+  scale = gst_element_factory_make ("videoscale", NULL);
+  capsfilter = gst_element_factory_make ("capsfilter", NULL);
+  enc = gst_element_factory_make ("jpegenc", NULL);
+  mux = gst_element_factory_make ("matroskamux", NULL);
+  sink = gst_element_factory_make ("filesink", NULL);
+
+  if (!src || !convert || !scale || !capsfilter || !enc || !mux || !sink) {
+    GST_WARNING ("Missing elements to create proxies");
+
+    if (src)
+      gst_object_unref (src);
+    if (convert)
+      gst_object_unref (convert);
+    if (scale)
+      gst_object_unref (scale);
+    if (capsfilter)
+      gst_object_unref (capsfilter);
+    if (enc)
+      gst_object_unref (enc);
+    if (mux)
+      gst_object_unref (mux);
+    if (sink)
+      gst_object_unref (sink);
+
+    return FALSE;
+  }
+
+  /* videoscale keeps the display aspect ratio when fixating the width */
+  caps = gst_caps_new_simple ("video/x-raw", "height", G_TYPE_INT,
+      PROXY_HEIGHT, NULL);
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  g_object_set (src, "uri", cache->uri, NULL);
+  g_object_set (sink, "location", cache->tmp_filename, NULL);
+
+  cache->pipeline = gst_pipeline_new ("proxy-transcoder");
+  gst_bin_add_many (GST_BIN (cache->pipeline), src, convert, scale,
+      capsfilter, enc, mux, sink, NULL);
+
+  if (!gst_element_link_many (convert, scale, capsfilter, enc, mux, sink,
+          NULL)) {
+    GST_WARNING ("Could not link the proxy transcoding pipeline");
+    gst_object_unref (cache->pipeline);
+    cache->pipeline = NULL;
+
+    return FALSE;
+  }
+
+  g_signal_connect (src, "pad-added", G_CALLBACK (pad_added_cb), convert);
+  g_signal_connect (src, "no-more-pads", G_CALLBACK (no_more_pads_cb),
+      convert);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (cache->pipeline));
+  cache->bus_watch = gst_bus_add_watch (bus, (GstBusFunc) bus_message_cb,
+      cache);
+  gst_object_unref (bus);
+
+  if (gst_element_set_state (cache->pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    GST_WARNING ("Could not start creating the proxy of %s", cache->uri);
+    g_source_remove (cache->bus_watch);
+    cache->bus_watch = 0;
+    gst_element_set_state (cache->pipeline, GST_STATE_NULL);
+    gst_object_unref (cache->pipeline);
+    cache->pipeline = NULL;
+
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+start_next_job (GESProxyCache * cache)
+{
+  gchar *uri, *filename, *dirname, *proxy_uri;
+
+  while (cache->pipeline == NULL &&
+      (uri = g_queue_pop_head (&cache->queue)) != NULL) {
+    filename = get_proxy_filename (uri);
+
+    /* The file could have been removed or modified since the request */
+    if (filename == NULL) {
+      if (cache->func)
+        cache->func (uri, NULL, cache->user_data);
+      g_free (uri);
+
+      continue;
+    }
+
+    if (g_file_test (filename, G_FILE_TEST_EXISTS)) {
+      proxy_uri = g_filename_to_uri (filename, NULL, NULL);
+      if (cache->func)
+        cache->func (uri, proxy_uri, cache->user_data);
+      g_free (proxy_uri);
+      g_free (filename);
+      g_free (uri);
+
+      continue;
+    }
+
+    dirname = g_path_get_dirname (filename);
+    g_mkdir_with_parents (dirname, 0755);
+    g_free (dirname);
+
+    cache->uri = uri;
+    cache->filename = filename;
+    cache->tmp_filename = g_strdup_printf ("%s.part", filename);
+
+    GST_DEBUG ("Creating the proxy of %s", uri);
+
+    if (!start_job (cache)) {
+      if (cache->func)
+        cache->func (uri, NULL, cache->user_data);
+
+      g_free (cache->tmp_filename);
+      cache->tmp_filename = NULL;
+      g_free (cache->filename);
+      cache->filename = NULL;
+      g_free (cache->uri);
+      cache->uri = NULL;
+    }
+  }
+}
+
+/* ges_proxy_cache_new:
+ * @func: The function to call once a requested proxy is ready
+ * @user_data: The data to pass to @func
+ *
+ * Returns: A new #GESProxyCache, free it with ges_proxy_cache_free()
+ */
+GESProxyCache *
+ges_proxy_cache_new (GESProxyReadyFunc func, gpointer user_data)
+{
+  GESProxyCache *cache = g_slice_new0 (GESProxyCache);
+
+  cache->func = func;
+  cache->user_data = user_data;
+  cache->requested = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      NULL);
+  g_queue_init (&cache->queue);
+
+  return cache;
+}
+
+/* ges_proxy_cache_free:
+ * @cache: a #GESProxyCache
+ *
+ * Frees @cache, cancelling the proxy being created if any. @func will not
+ * be called for the pending requests.
+ */
+void
+ges_proxy_cache_free (GESProxyCache * cache)
+{
+  g_queue_foreach (&cache->queue, (GFunc) g_free, NULL);
+  g_queue_clear (&cache->queue);
+
+  if (cache->pipeline) {
+    cache->func = NULL;
+    stop_job (cache, FALSE);
+  }
+
+  g_hash_table_unref (cache->requested);
+
+  g_slice_free (GESProxyCache, cache);
+}
+
+/* ges_proxy_cache_lookup:
+ * @cache: a #GESProxyCache
+ * @uri: The uri of the original file
+ *
+ * Returns: The uri of the proxy of @uri if it was already created and @uri
+ * did not change since then, %NULL otherwise. g_free() after usage.
+ */
+gchar *
+ges_proxy_cache_lookup (GESProxyCache * cache, const gchar * uri)
+{
+  gchar *filename, *proxy_uri = NULL;
+
+  filename = get_proxy_filename (uri);
+  if (filename && g_file_test (filename, G_FILE_TEST_EXISTS))
+    proxy_uri = g_filename_to_uri (filename, NULL, NULL);
+  g_free (filename);
+
+  GST_DEBUG ("Proxy cache %s for %s", proxy_uri ? "hit" : "miss", uri);
+
+  return proxy_uri;
+}
+
+/* ges_proxy_cache_request:
+ * @cache: a #GESProxyCache
+ * @uri: The uri of the original file
+ *
+ * Asks for the proxy of @uri to be created in the background. Each uri is
+ * only requested once, whether its proxy could be created or not.
+ */
+void
+ges_proxy_cache_request (GESProxyCache * cache, const gchar * uri)
+{
+  if (g_hash_table_contains (cache->requested, uri))
+    return;
+
+  g_hash_table_add (cache->requested, g_strdup (uri));
+  g_queue_push_tail (&cache->queue, g_strdup (uri));
+
+  start_next_job (cache);
+}
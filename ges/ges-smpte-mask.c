@@ -0,0 +1,416 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Wipe masks for the SMPTE transition types.
+ *
+ * Every pixel of a mask holds the position of the transition, between 0 and
+ * GES_SMPTE_MASK_MAX, at which it switches from the first to the second
+ * input. The patterns follow the descriptions of
+ * #GESVideoStandardTransitionType.
+ *
+ * The border is folded into the stored values so that the blender only has
+ * to compute `CLAMP (threshold - ramp[i], 0, 256)` to get the weight of the
+ * second input for a pixel, see ges_smpte_mask_get_threshold().
+ *
+ * Masks are immutable once generated and shared by all the transitions
+ * through a process wide LRU cache keyed by type, size, border and
+ * direction. */
+
+#include <math.h>
+
+#include "ges-internal.h"
+
+#define ARC_FULL (2 * G_PI)
+#define ARC_HALF (G_PI)
+#define ARC_QUARTER (G_PI / 2)
+
+/* Angles are measured in screen coordinates, 0 pointing right and growing
+ * clockwise, so that up is -ARC_QUARTER */
+#define DIR_RIGHT 0.0
+#define DIR_DOWN ARC_QUARTER
+#define DIR_LEFT ARC_HALF
+#define DIR_UP (-ARC_QUARTER)
+
+#define CW 1
+#define CCW -1
+
+/* A 1080p mask takes about 8MiB */
+#define MASK_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+#define MASK_SIZE(mask) ((gsize) (mask)->width * (mask)->height * \
+    sizeof (guint32))
+
+/* Angle swept around (@px, @py) from the @start direction, clockwise or
+ * counter-clockwise depending on @dir, to reach (@x, @y), in [0, 2π[ */
+static inline gdouble
+sweep_angle (gdouble x, gdouble y, gdouble px, gdouble py, gdouble start,
+    gint dir)
+{
+  gdouble angle = fmod (dir * (atan2 (y - py, x - px) - start), ARC_FULL);
+
+  return angle < 0 ? angle + ARC_FULL : angle;
+}
+
+static inline gdouble
+sweep (gdouble x, gdouble y, gdouble px, gdouble py, gdouble start, gint dir,
+    gdouble span)
+{
+  return MIN (sweep_angle (x, y, px, py, start, dir) / span, 1.0);
+}
+
+/* Angular distance between the direction of (@x, @y) around (@px, @py) and
+ * @axis, relative to @span */
+static inline gdouble
+fan (gdouble x, gdouble y, gdouble px, gdouble py, gdouble axis, gdouble span)
+{
+  gdouble angle = sweep_angle (x, y, px, py, axis, CW);
+
+  if (angle > ARC_HALF)
+    angle = ARC_FULL - angle;
+
+  return MIN (angle / span, 1.0);
+}
+
+/* Position in [0, 1] at which the pixel centered on (@x, @y) is wiped */
+static gdouble
+mask_value (GESVideoStandardTransitionType type, gdouble x, gdouble y,
+    gdouble w, gdouble h)
+{
+  gdouble nx = x / w, ny = y / h;
+  gdouble cx = w / 2, cy = h / 2;
+
+  switch (type) {
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR:
+      return nx;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_TB:
+      return ny;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOX_WIPE_TL:
+      return MAX (nx, ny);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOX_WIPE_TR:
+      return MAX (1 - nx, ny);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOX_WIPE_BR:
+      return MAX (1 - nx, 1 - ny);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOX_WIPE_BL:
+      return MAX (nx, 1 - ny);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_FOUR_BOX_WIPE_CI:
+      return 2 * MAX (MIN (nx, 1 - nx), MIN (ny, 1 - ny));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_FOUR_BOX_WIPE_CO:
+      return 2 * MAX (fabs (fmod (2 * nx, 1) - 0.5),
+          fabs (fmod (2 * ny, 1) - 0.5));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BARNDOOR_V:
+      return 2 * fabs (nx - 0.5);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BARNDOOR_H:
+      return 2 * fabs (ny - 0.5);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOX_WIPE_TC:
+      return MAX (2 * fabs (nx - 0.5), ny);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOX_WIPE_RC:
+      return MAX (2 * fabs (ny - 0.5), 1 - nx);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOX_WIPE_BC:
+      return MAX (2 * fabs (nx - 0.5), 1 - ny);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOX_WIPE_LC:
+      return MAX (2 * fabs (ny - 0.5), nx);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DIAGONAL_TL:
+      return (nx + ny) / 2;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DIAGONAL_TR:
+      return (1 - nx + ny) / 2;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOWTIE_V:
+      return MIN (ny, 1 - ny) + fabs (nx - 0.5);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BOWTIE_H:
+      return MIN (nx, 1 - nx) + fabs (ny - 0.5);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BARNDOOR_DBL:
+      return fabs (nx + ny - 1);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BARNDOOR_DTL:
+      return fabs (nx - ny);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_MISC_DIAGONAL_DBD:
+      return 2 * MIN (fabs (nx - ny), fabs (nx + ny - 1));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_MISC_DIAGONAL_DD:
+      return 2 * fabs (fabs (nx - 0.5) + fabs (ny - 0.5) - 0.5);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_VEE_D:
+      return (ny + fabs (nx - 0.5)) / 1.5;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_VEE_L:
+      return (1 - nx + fabs (ny - 0.5)) / 1.5;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_VEE_U:
+      return (1 - ny + fabs (nx - 0.5)) / 1.5;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_VEE_R:
+      return (nx + fabs (ny - 0.5)) / 1.5;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BARNVEE_D:
+      return fabs (1 - ny - 2 * fabs (nx - 0.5));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BARNVEE_L:
+      return fabs (nx - 2 * fabs (ny - 0.5));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BARNVEE_U:
+      return fabs (ny - 2 * fabs (nx - 0.5));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_BARNVEE_R:
+      return fabs (1 - nx - 2 * fabs (ny - 0.5));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_IRIS_RECT:
+      return 2 * MAX (fabs (nx - 0.5), fabs (ny - 0.5));
+
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_CLOCK_CW12:
+      return sweep (x, y, cx, cy, DIR_UP, CW, ARC_FULL);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_CLOCK_CW3:
+      return sweep (x, y, cx, cy, DIR_RIGHT, CW, ARC_FULL);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_CLOCK_CW6:
+      return sweep (x, y, cx, cy, DIR_DOWN, CW, ARC_FULL);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_CLOCK_CW9:
+      return sweep (x, y, cx, cy, DIR_LEFT, CW, ARC_FULL);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_PINWHEEL_TBV:
+      return fmod (sweep_angle (x, y, cx, cy, DIR_UP, CW), ARC_HALF) / ARC_HALF;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_PINWHEEL_TBH:
+      return fmod (sweep_angle (x, y, cx, cy, DIR_LEFT, CW),
+          ARC_HALF) / ARC_HALF;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_PINWHEEL_FB:
+      return fmod (sweep_angle (x, y, cx, cy, DIR_UP, CW),
+          ARC_QUARTER) / ARC_QUARTER;
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_FAN_CT:
+      return fan (x, y, cx, cy, DIR_UP, ARC_HALF);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_FAN_CR:
+      return fan (x, y, cx, cy, DIR_RIGHT, ARC_HALF);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLEFAN_FOV:
+      return MIN (fan (x, y, cx, cy, DIR_UP, ARC_QUARTER),
+          fan (x, y, cx, cy, DIR_DOWN, ARC_QUARTER));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLEFAN_FOH:
+      return MIN (fan (x, y, cx, cy, DIR_LEFT, ARC_QUARTER),
+          fan (x, y, cx, cy, DIR_RIGHT, ARC_QUARTER));
+
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SINGLESWEEP_CWT:
+      return sweep (x, y, cx, 0, DIR_RIGHT, CW, ARC_HALF);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SINGLESWEEP_CWR:
+      return sweep (x, y, w, cy, DIR_DOWN, CW, ARC_HALF);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SINGLESWEEP_CWB:
+      return sweep (x, y, cx, h, DIR_LEFT, CW, ARC_HALF);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SINGLESWEEP_CWL:
+      return sweep (x, y, 0, cy, DIR_UP, CW, ARC_HALF);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLESWEEP_PV:
+      return MIN (sweep (x, y, cx, 0, DIR_RIGHT, CW, ARC_HALF),
+          sweep (x, y, cx, h, DIR_LEFT, CCW, ARC_HALF));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLESWEEP_PD:
+      return MIN (sweep (x, y, 0, cy, DIR_UP, CW, ARC_HALF),
+          sweep (x, y, w, cy, DIR_DOWN, CCW, ARC_HALF));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLESWEEP_OV:
+      return MIN (sweep (x, y, cx, 0, DIR_RIGHT, CW, ARC_HALF),
+          sweep (x, y, cx, h, DIR_RIGHT, CCW, ARC_HALF));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLESWEEP_OH:
+      return MIN (sweep (x, y, 0, cy, DIR_UP, CW, ARC_HALF),
+          sweep (x, y, w, cy, DIR_UP, CCW, ARC_HALF));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_FAN_T:
+      return fan (x, y, cx, 0, DIR_DOWN, ARC_QUARTER);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_FAN_R:
+      return fan (x, y, w, cy, DIR_LEFT, ARC_QUARTER);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_FAN_B:
+      return fan (x, y, cx, h, DIR_UP, ARC_QUARTER);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_FAN_L:
+      return fan (x, y, 0, cy, DIR_RIGHT, ARC_QUARTER);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLEFAN_FIV:
+      return MIN (fan (x, y, cx, 0, DIR_DOWN, ARC_QUARTER),
+          fan (x, y, cx, h, DIR_UP, ARC_QUARTER));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLEFAN_FIH:
+      return MIN (fan (x, y, 0, cy, DIR_RIGHT, ARC_QUARTER),
+          fan (x, y, w, cy, DIR_LEFT, ARC_QUARTER));
+
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SINGLESWEEP_CWTL:
+      return sweep (x, y, 0, 0, DIR_RIGHT, CW, ARC_QUARTER);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SINGLESWEEP_CWBL:
+      return sweep (x, y, 0, h, DIR_RIGHT, CCW, ARC_QUARTER);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SINGLESWEEP_CWBR:
+      return sweep (x, y, w, h, DIR_LEFT, CW, ARC_QUARTER);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SINGLESWEEP_CWTR:
+      return sweep (x, y, w, 0, DIR_LEFT, CCW, ARC_QUARTER);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLESWEEP_PDTL:
+      return MIN (sweep (x, y, 0, 0, DIR_RIGHT, CW, ARC_QUARTER),
+          sweep (x, y, w, h, DIR_LEFT, CW, ARC_QUARTER));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_DOUBLESWEEP_PDBL:
+      return MIN (sweep (x, y, 0, h, DIR_UP, CW, ARC_QUARTER),
+          sweep (x, y, w, 0, DIR_DOWN, CW, ARC_QUARTER));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SALOONDOOR_T:
+      return MIN (sweep (x, y, 0, 0, DIR_RIGHT, CW, ARC_QUARTER),
+          sweep (x, y, w, 0, DIR_LEFT, CCW, ARC_QUARTER));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SALOONDOOR_L:
+      return MIN (sweep (x, y, 0, 0, DIR_DOWN, CCW, ARC_QUARTER),
+          sweep (x, y, 0, h, DIR_UP, CW, ARC_QUARTER));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SALOONDOOR_B:
+      return MIN (sweep (x, y, 0, h, DIR_RIGHT, CCW, ARC_QUARTER),
+          sweep (x, y, w, h, DIR_LEFT, CW, ARC_QUARTER));
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_SALOONDOOR_R:
+      return MIN (sweep (x, y, w, 0, DIR_DOWN, CW, ARC_QUARTER),
+          sweep (x, y, w, h, DIR_UP, CCW, ARC_QUARTER));
+
+      /* The hands of the windshields are attached at the middle of each
+       * half of the frame */
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_WINDSHIELD_R:
+      if (y < cy)
+        return sweep (x, y, cx, h / 4, DIR_RIGHT, CCW, ARC_FULL);
+      return sweep (x, y, cx, 3 * h / 4, DIR_RIGHT, CW, ARC_FULL);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_WINDSHIELD_U:
+      if (x < cx)
+        return sweep (x, y, w / 4, cy, DIR_UP, CCW, ARC_FULL);
+      return sweep (x, y, 3 * w / 4, cy, DIR_UP, CW, ARC_FULL);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_WINDSHIELD_V:
+      if (y < cy)
+        return fan (x, y, cx, h / 4, DIR_UP, ARC_HALF);
+      return fan (x, y, cx, 3 * h / 4, DIR_DOWN, ARC_HALF);
+    case GES_VIDEO_STANDARD_TRANSITION_TYPE_WINDSHIELD_H:
+      if (x < cx)
+        return fan (x, y, w / 4, cy, DIR_LEFT, ARC_HALF);
+      return fan (x, y, 3 * w / 4, cy, DIR_RIGHT, ARC_HALF);
+
+    default:
+      return nx;
+  }
+}
+
+static GESSmpteMask *
+generate_mask (GESVideoStandardTransitionType type, gint width, gint height,
+    guint border, gboolean invert)
+{
+  GESSmpteMask *mask;
+  guint32 *ramp;
+  guint64 divisor;
+  gint x, y;
+
+  GST_DEBUG ("Generating mask %d %dx%d border:%u invert:%d", type, width,
+      height, border, invert);
+
+  mask = g_slice_new (GESSmpteMask);
+  mask->refcount = 1;
+  mask->type = type;
+  mask->width = width;
+  mask->height = height;
+  mask->border = border;
+  mask->invert = invert;
+  mask->ramp = ramp = g_new (guint32, width * height);
+
+  divisor = MAX (border, 1);
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      gdouble value = mask_value (type, x + 0.5, y + 0.5, width, height);
+      guint64 scaled;
+
+      value = CLAMP (value, 0.0, 1.0);
+      if (invert)
+        value = 1.0 - value;
+
+      scaled = (guint64) (value * GES_SMPTE_MASK_MAX + 0.5);
+      *ramp++ = (guint32) ((scaled << 8) / divisor);
+    }
+  }
+
+  return mask;
+}
+
+static guint
+mask_hash (const GESSmpteMask * mask)
+{
+  return ((guint) mask->type << 20) ^ ((guint) mask->width << 10) ^
+      (guint) mask->height ^ (mask->border * 31) ^ ((guint) mask->invert << 31);
+}
+
+static gboolean
+mask_equal (const GESSmpteMask * mask, const GESSmpteMask * other)
+{
+  return mask->type == other->type && mask->width == other->width &&
+      mask->height == other->height && mask->border == other->border &&
+      mask->invert == other->invert;
+}
+
+/* The masks are their own keys. The transitions still using evicted masks
+ * keep their own reference. */
+GESLruCache *
+ges_smpte_mask_get_cache (void)
+{
+  static gsize cache = 0;
+
+  if (g_once_init_enter (&cache))
+    g_once_init_leave (&cache, (gsize) ges_lru_cache_new (MASK_CACHE_MAX_SIZE,
+            (GHashFunc) mask_hash, (GEqualFunc) mask_equal, NULL,
+            (GBoxedCopyFunc) ges_smpte_mask_ref,
+            (GDestroyNotify) ges_smpte_mask_unref));
+
+  return (GESLruCache *) cache;
+}
+
+/* Returns a reference to the mask of a SMPTE transition of @type, with a
+ * soft border of @border mask units, generating it if it is not cached.
+ * The mask is shared and must not be modified, release it with
+ * ges_smpte_mask_unref() */
+GESSmpteMask *
+ges_smpte_mask_get (GESVideoStandardTransitionType type, gint width,
+    gint height, guint border, gboolean invert)
+{
+  GESSmpteMask key, *mask;
+
+  g_return_val_if_fail (width > 0 && height > 0, NULL);
+
+  if (type == GES_VIDEO_STANDARD_TRANSITION_TYPE_NONE ||
+      type == GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE) {
+    GST_WARNING ("%d is not a SMPTE transition type, using a bar wipe", type);
+    type = GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR;
+  }
+
+  invert = ! !invert;
+
+  key.type = type;
+  key.width = width;
+  key.height = height;
+  key.border = border;
+  key.invert = invert;
+
+  mask = ges_lru_cache_lookup (ges_smpte_mask_get_cache (), &key);
+  if (mask)
+    return mask;
+
+  /* Generating a mask takes a while, do not block the other transitions.
+   * If another one generated the same mask in the meantime, use it. */
+  mask = generate_mask (type, width, height, border, invert);
+
+  return ges_lru_cache_insert_or_lookup (ges_smpte_mask_get_cache (), mask,
+      mask, MASK_SIZE (mask));
+}
+
+GESSmpteMask *
+ges_smpte_mask_ref (GESSmpteMask * mask)
+{
+  g_atomic_int_inc (&mask->refcount);
+
+  return mask;
+}
+
+void
+ges_smpte_mask_unref (GESSmpteMask * mask)
+{
+  if (g_atomic_int_dec_and_test (&mask->refcount)) {
+    g_free (mask->ramp);
+    g_slice_free (GESSmpteMask, mask);
+  }
+}
+
+/* Returns the threshold of @mask at @position, between 0 and 1. The weight
+ * of the second input for a pixel, in 1/256th, is
+ * CLAMP (threshold - mask->ramp[pixel], 0, 256) */
+gint32
+ges_smpte_mask_get_threshold (GESSmpteMask * mask, gdouble position)
+{
+  guint64 divisor = MAX (mask->border, 1);
+  guint64 threshold;
+
+  /* Go through the whole border so that the first input is entirely
+   * covered at the end */
+  position = CLAMP (position, 0.0, 1.0);
+  threshold = (guint64) (position * ((guint64) GES_SMPTE_MASK_MAX + 1 +
+          mask->border));
+
+  return (gint32) MIN ((threshold << 8) / divisor, G_MAXINT32);
+}
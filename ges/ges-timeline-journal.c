@@ -0,0 +1,1115 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Append-only journal of the edits made to a GESTimeline, see
+ * ges_timeline_start_journal().
+ *
+ * The journal is a text file with one serialized GstStructure per line. It
+ * starts with a snapshot of the timeline, that is the records recreating its
+ * tracks, layers and objects, followed by the records of the edits made since
+ * then, in order:
+ *
+ *   track, type=(uint)4, caps=(string)...
+ *   layer, journal-layer=(uint)1, priority=(uint)0, simple=(boolean)false
+ *   add, journal-id=(uint)2, journal-layer=(uint)1,
+ *       journal-type=(string)GESTimelineTestSource, start=(string)0, ...
+ *   set, journal-id=(uint)2, duration=(string)1000000000
+ *   remove, journal-id=(uint)2
+ *
+ * Layers and objects are referenced by an id that is only valid in the
+ * journal. Property values are stored as gst_value_serialize() strings and
+ * deserialized against the type of the property when replayed.
+ *
+ * Each edit only costs one line appended to the file. The records of the
+ * edits made between ges_timeline_begin_edit() and ges_timeline_commit_edit()
+ * are appended at once when the batch is committed.
+ *
+ * Once enough records accumulated the journal is compacted, that is rewritten
+ * as a new snapshot of the timeline. The compaction is started from an idle
+ * callback, once the edit being recorded is over: the snapshot is serialized
+ * from the main thread and written to a separate file by a worker thread.
+ * The records appended meanwhile are added after it, and the new file then
+ * replaces the journal. */
+
+#include <stdio.h>
+#include <string.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#include "ges.h"
+#include "ges-internal.h"
+
+#define JOURNAL_HEADER "ges-journal"
+#define JOURNAL_VERSION 1
+
+/* Number of edit records after which the journal is compacted */
+#define COMPACT_RECORDS 4096
+
+typedef struct _SnapshotWriter SnapshotWriter;
+
+struct _GESTimelineJournal
+{
+  GESTimeline *timeline;        /* Not reffed, the timeline owns the journal */
+  gchar *location;
+  FILE *file;
+
+  /* {GESTimelineLayer or GESTimelineObject: id} of the tracked instances */
+  GHashTable *ids;
+  guint next_id;
+
+  /* Records appended since the last snapshot */
+  guint n_records;
+
+  /* Records of the current ges_timeline_begin_edit() batch */
+  gboolean batching;
+  GString *batch;
+  guint n_batched;
+
+  /* Background compaction, see schedule_compaction() */
+  guint compact_source;
+  gboolean compact_after_batch;
+  gboolean compact_again;
+  SnapshotWriter *writer;
+  /* Records appended while @writer runs, to add after its snapshot */
+  GString *tail;
+  guint n_tail;
+};
+
+/* Writes a snapshot to a separate file from a worker thread */
+struct _SnapshotWriter
+{
+  GESTimelineJournal *journal;
+  GThread *thread;
+  gchar *location;
+  GString *snapshot;
+  gboolean written;
+  guint done_source;
+};
+
+static void layer_added_cb (GESTimeline * timeline, GESTimelineLayer * layer,
+    GESTimelineJournal * journal);
+static void layer_removed_cb (GESTimeline * timeline, GESTimelineLayer * layer,
+    GESTimelineJournal * journal);
+static void track_added_cb (GESTimeline * timeline, GESTrack * track,
+    GESTimelineJournal * journal);
+static void track_removed_cb (GESTimeline * timeline, GESTrack * track,
+    GESTimelineJournal * journal);
+static void layer_notify_cb (GESTimelineLayer * layer, GParamSpec * pspec,
+    GESTimelineJournal * journal);
+static void object_added_cb (GESTimelineLayer * layer, GESTimelineObject * obj,
+    GESTimelineJournal * journal);
+static void object_removed_cb (GESTimelineLayer * layer,
+    GESTimelineObject * obj, GESTimelineJournal * journal);
+static void object_moved_cb (GESSimpleTimelineLayer * layer,
+    GESTimelineObject * obj, gint old, gint new, GESTimelineJournal * journal);
+static void object_notify_cb (GESTimelineObject * obj, GParamSpec * pspec,
+    GESTimelineJournal * journal);
+
+/* Recording */
+
+static guint
+get_id (GESTimelineJournal * journal, gpointer instance)
+{
+  return GPOINTER_TO_UINT (g_hash_table_lookup (journal->ids, instance));
+}
+
+static guint
+track_instance (GESTimelineJournal * journal, gpointer instance)
+{
+  guint id = get_id (journal, instance);
+
+  if (id)
+    return id;
+
+  id = journal->next_id++;
+  g_hash_table_insert (journal->ids, instance, GUINT_TO_POINTER (id));
+
+  if (GES_IS_TIMELINE_LAYER (instance)) {
+    g_signal_connect (instance, "object-added", G_CALLBACK (object_added_cb),
+        journal);
+    g_signal_connect (instance, "object-removed",
+        G_CALLBACK (object_removed_cb), journal);
+    g_signal_connect (instance, "notify", G_CALLBACK (layer_notify_cb),
+        journal);
+    if (GES_IS_SIMPLE_TIMELINE_LAYER (instance))
+      g_signal_connect (instance, "object-moved",
+          G_CALLBACK (object_moved_cb), journal);
+  } else {
+    g_signal_connect (instance, "notify", G_CALLBACK (object_notify_cb),
+        journal);
+  }
+
+  return id;
+}
+
+static void
+untrack_instance (GESTimelineJournal * journal, gpointer instance)
+{
+  if (g_hash_table_remove (journal->ids, instance))
+    g_signal_handlers_disconnect_by_data (instance, journal);
+}
+
+/* Whether changes of @pspec are part of the state of the timeline */
+static gboolean
+is_recorded_property (GParamSpec * pspec)
+{
+  if (!(pspec->flags & G_PARAM_READABLE) || !(pspec->flags & G_PARAM_WRITABLE))
+    return FALSE;
+
+  switch (G_TYPE_FUNDAMENTAL (pspec->value_type)) {
+    case G_TYPE_OBJECT:
+    case G_TYPE_POINTER:
+    case G_TYPE_INTERFACE:
+      return FALSE;
+    default:
+      return TRUE;
+  }
+}
+
+static void
+set_property_field (GstStructure * record, GObject * object,
+    GParamSpec * pspec)
+{
+  GValue v = { 0 };
+  gchar *serialized;
+
+  g_value_init (&v, pspec->value_type);
+  g_object_get_property (object, pspec->name, &v);
+
+  if ((serialized = gst_value_serialize (&v))) {
+    gst_structure_set (record, pspec->name, G_TYPE_STRING, serialized, NULL);
+    g_free (serialized);
+  } else {
+    GST_DEBUG ("Can not serialize property %s of %s", pspec->name,
+        G_OBJECT_TYPE_NAME (object));
+  }
+
+  g_value_unset (&v);
+}
+
+static void
+append_record (GString * out, GstStructure * record)
+{
+  gchar *line = gst_structure_to_string (record);
+
+  g_string_append (out, line);
+  g_string_append_c (out, '\n');
+
+  g_free (line);
+  gst_structure_free (record);
+}
+
+static void
+append_track (GString * out, GESTrack * track)
+{
+  gchar *caps = gst_caps_to_string (ges_track_get_caps (track));
+
+  append_record (out, gst_structure_new ("track", "type", G_TYPE_UINT,
+          track->type, "caps", G_TYPE_STRING, caps, NULL));
+  g_free (caps);
+}
+
+static void
+append_object (GESTimelineJournal * journal, GString * out,
+    GESTimelineLayer * layer, GESTimelineObject * obj)
+{
+  GstStructure *record;
+  GParamSpec **pspecs;
+  guint i, n_pspecs;
+
+  record = gst_structure_new ("add",
+      "journal-id", G_TYPE_UINT, track_instance (journal, obj),
+      "journal-layer", G_TYPE_UINT, get_id (journal, layer),
+      "journal-type", G_TYPE_STRING, G_OBJECT_TYPE_NAME (obj), NULL);
+
+  if (GES_IS_SIMPLE_TIMELINE_LAYER (layer))
+    gst_structure_set (record, "journal-position", G_TYPE_INT,
+        ges_simple_timeline_layer_index ((GESSimpleTimelineLayer *) layer,
+            obj), NULL);
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (obj),
+      &n_pspecs);
+  for (i = 0; i < n_pspecs; i++) {
+    if (is_recorded_property (pspecs[i]))
+      set_property_field (record, G_OBJECT (obj), pspecs[i]);
+  }
+  g_free (pspecs);
+
+  append_record (out, record);
+}
+
+/* Appends the records recreating @layer and its objects */
+static void
+append_layer (GESTimelineJournal * journal, GString * out,
+    GESTimelineLayer * layer)
+{
+  GList *objs, *tmp;
+
+  append_record (out, gst_structure_new ("layer",
+          "journal-layer", G_TYPE_UINT, track_instance (journal, layer),
+          "simple", G_TYPE_BOOLEAN, GES_IS_SIMPLE_TIMELINE_LAYER (layer),
+          "priority", G_TYPE_UINT, ges_timeline_layer_get_priority (layer),
+          "auto-transition", G_TYPE_BOOLEAN,
+          ges_timeline_layer_get_auto_transition (layer), NULL));
+
+  objs = ges_timeline_layer_get_objects (layer);
+  for (tmp = objs; tmp; tmp = tmp->next)
+    append_object (journal, out, layer, GES_TIMELINE_OBJECT (tmp->data));
+  g_list_free_full (objs, g_object_unref);
+}
+
+/* Serializes the records recreating the current state of the timeline */
+static GString *
+serialize_snapshot (GESTimelineJournal * journal)
+{
+  GString *out;
+  GList *tmp, *tracks, *layers;
+
+  out = g_string_new (NULL);
+  append_record (out, gst_structure_new (JOURNAL_HEADER, "version",
+          G_TYPE_UINT, JOURNAL_VERSION, NULL));
+
+  tracks = ges_timeline_get_tracks (journal->timeline);
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    append_track (out, GES_TRACK (tmp->data));
+    gst_object_unref (tmp->data);
+  }
+  g_list_free (tracks);
+
+  layers = ges_timeline_get_layers (journal->timeline);
+  for (tmp = layers; tmp; tmp = tmp->next)
+    append_layer (journal, out, GES_TIMELINE_LAYER (tmp->data));
+  g_list_free_full (layers, g_object_unref);
+
+  return out;
+}
+
+static void schedule_compaction (GESTimelineJournal * journal);
+
+/* Replaces the journal with the snapshot of @journal->writer followed by
+ * the records appended meanwhile. @from_source is %TRUE when called from the
+ * callback the writer queued once done. */
+static void
+finish_compaction (GESTimelineJournal * journal, gboolean from_source)
+{
+  SnapshotWriter *writer = journal->writer;
+  FILE *file;
+  gboolean ret = FALSE;
+
+  g_thread_join (writer->thread);
+  journal->writer = NULL;
+  if (!from_source)
+    g_source_remove (writer->done_source);
+
+  if (writer->written && (file = g_fopen (writer->location, "ab"))) {
+    ret = fwrite (journal->tail->str, 1, journal->tail->len, file) ==
+        journal->tail->len;
+    ret &= fclose (file) == 0;
+    ret = ret && g_rename (writer->location, journal->location) == 0;
+  }
+
+  if (ret) {
+    GST_DEBUG ("Compacted journal %s, %u records appended meanwhile",
+        journal->location, journal->n_tail);
+
+    if (journal->file)
+      fclose (journal->file);
+    if (!(journal->file = g_fopen (journal->location, "ab")))
+      GST_ERROR ("Could not open journal %s", journal->location);
+    journal->n_records = journal->n_tail;
+  } else {
+    GST_ERROR ("Could not compact journal %s", journal->location);
+    g_unlink (writer->location);
+  }
+
+  g_string_truncate (journal->tail, 0);
+  journal->n_tail = 0;
+
+  g_string_free (writer->snapshot, TRUE);
+  g_free (writer->location);
+  g_slice_free (SnapshotWriter, writer);
+
+  if (journal->compact_again) {
+    journal->compact_again = FALSE;
+    schedule_compaction (journal);
+  }
+}
+
+static gboolean
+compaction_done_cb (GESTimelineJournal * journal)
+{
+  finish_compaction (journal, TRUE);
+
+  return FALSE;
+}
+
+static gpointer
+write_snapshot_thread (SnapshotWriter * writer)
+{
+  GError *err = NULL;
+
+  writer->written = g_file_set_contents (writer->location,
+      writer->snapshot->str, writer->snapshot->len, &err);
+  if (!writer->written) {
+    GST_ERROR ("Could not write snapshot %s: %s", writer->location,
+        err->message);
+    g_error_free (err);
+  }
+
+  writer->done_source = g_idle_add ((GSourceFunc) compaction_done_cb,
+      writer->journal);
+
+  return NULL;
+}
+
+static gboolean
+compact_idle_cb (GESTimelineJournal * journal)
+{
+  SnapshotWriter *writer;
+
+  journal->compact_source = 0;
+
+  /* The snapshot would include edits whose records are not written yet */
+  if (journal->batching) {
+    journal->compact_after_batch = TRUE;
+    return FALSE;
+  }
+
+  GST_DEBUG ("Compacting journal %s, %u records", journal->location,
+      journal->n_records);
+
+  writer = g_slice_new0 (SnapshotWriter);
+  writer->journal = journal;
+  writer->location = g_strconcat (journal->location, ".compact", NULL);
+  writer->snapshot = serialize_snapshot (journal);
+
+  journal->writer = writer;
+  writer->thread = g_thread_new ("ges-journal",
+      (GThreadFunc) write_snapshot_thread, writer);
+
+  return FALSE;
+}
+
+/* Compacts the journal once back in the main loop, outside of the signal
+ * handlers recording the edits */
+static void
+schedule_compaction (GESTimelineJournal * journal)
+{
+  if (journal->writer)
+    journal->compact_again = TRUE;
+  else if (journal->compact_source == 0)
+    journal->compact_source = g_idle_add ((GSourceFunc) compact_idle_cb,
+        journal);
+}
+
+/* Cancels the pending compactions, waiting for the running one */
+static void
+stop_compaction (GESTimelineJournal * journal)
+{
+  if (journal->writer)
+    finish_compaction (journal, FALSE);
+
+  if (journal->compact_source) {
+    g_source_remove (journal->compact_source);
+    journal->compact_source = 0;
+  }
+  journal->compact_again = FALSE;
+  journal->compact_after_batch = FALSE;
+}
+
+/* Rewrites the journal as a snapshot of the timeline, right away */
+static gboolean
+write_snapshot (GESTimelineJournal * journal)
+{
+  GString *out;
+  GError *err = NULL;
+  gboolean ret;
+
+  stop_compaction (journal);
+
+  out = serialize_snapshot (journal);
+
+  if (journal->file) {
+    fclose (journal->file);
+    journal->file = NULL;
+  }
+
+  /* Replaces the previous journal atomically */
+  ret = g_file_set_contents (journal->location, out->str, out->len, &err);
+  g_string_free (out, TRUE);
+
+  if (!ret) {
+    GST_ERROR ("Could not write journal %s: %s", journal->location,
+        err->message);
+    g_error_free (err);
+    return FALSE;
+  }
+
+  if (!(journal->file = g_fopen (journal->location, "ab"))) {
+    GST_ERROR ("Could not open journal %s", journal->location);
+    return FALSE;
+  }
+
+  journal->n_records = 0;
+
+  return TRUE;
+}
+
+static void
+append_to_file (GESTimelineJournal * journal, const gchar * str, gsize len,
+    guint n_records)
+{
+  if (journal->file == NULL)
+    return;
+
+  if (fwrite (str, 1, len, journal->file) != len ||
+      fflush (journal->file) != 0)
+    GST_WARNING ("Could not append to journal %s", journal->location);
+
+  if (journal->writer) {
+    g_string_append_len (journal->tail, str, len);
+    journal->n_tail += n_records;
+  } else if ((journal->n_records += n_records) >= COMPACT_RECORDS) {
+    schedule_compaction (journal);
+  }
+}
+
+static void
+write_string (GESTimelineJournal * journal, GString * out)
+{
+  if (journal->batching) {
+    g_string_append_len (journal->batch, out->str, out->len);
+    journal->n_batched++;
+    return;
+  }
+
+  append_to_file (journal, out->str, out->len, 1);
+}
+
+static void
+write_record (GESTimelineJournal * journal, GstStructure * record)
+{
+  GString *out = g_string_new (NULL);
+
+  append_record (out, record);
+  write_string (journal, out);
+  g_string_free (out, TRUE);
+}
+
+static void
+layer_added_cb (GESTimeline * timeline, GESTimelineLayer * layer,
+    GESTimelineJournal * journal)
+{
+  GString *out = g_string_new (NULL);
+
+  append_layer (journal, out, layer);
+  write_string (journal, out);
+  g_string_free (out, TRUE);
+}
+
+static void
+layer_removed_cb (GESTimeline * timeline, GESTimelineLayer * layer,
+    GESTimelineJournal * journal)
+{
+  GList *objs, *tmp;
+  guint id = get_id (journal, layer);
+
+  if (!id)
+    return;
+
+  objs = ges_timeline_layer_get_objects (layer);
+  for (tmp = objs; tmp; tmp = tmp->next)
+    untrack_instance (journal, tmp->data);
+  g_list_free_full (objs, g_object_unref);
+  untrack_instance (journal, layer);
+
+  write_record (journal, gst_structure_new ("remove-layer",
+          "journal-layer", G_TYPE_UINT, id, NULL));
+}
+
+static void
+track_added_cb (GESTimeline * timeline, GESTrack * track,
+    GESTimelineJournal * journal)
+{
+  GString *out = g_string_new (NULL);
+
+  append_track (out, track);
+  write_string (journal, out);
+  g_string_free (out, TRUE);
+}
+
+static void
+track_removed_cb (GESTimeline * timeline, GESTrack * track,
+    GESTimelineJournal * journal)
+{
+  /* Tracks have no id in the journal, removals are rare enough to simply
+   * start from a new snapshot */
+  schedule_compaction (journal);
+}
+
+static void
+layer_notify_cb (GESTimelineLayer * layer, GParamSpec * pspec,
+    GESTimelineJournal * journal)
+{
+  GstStructure *record;
+
+  if (!is_recorded_property (pspec) || pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+    return;
+
+  record = gst_structure_new ("set-layer",
+      "journal-layer", G_TYPE_UINT, get_id (journal, layer), NULL);
+  set_property_field (record, G_OBJECT (layer), pspec);
+  write_record (journal, record);
+}
+
+static void
+object_added_cb (GESTimelineLayer * layer, GESTimelineObject * obj,
+    GESTimelineJournal * journal)
+{
+  GString *out = g_string_new (NULL);
+
+  append_object (journal, out, layer, obj);
+  write_string (journal, out);
+  g_string_free (out, TRUE);
+}
+
+static void
+object_removed_cb (GESTimelineLayer * layer, GESTimelineObject * obj,
+    GESTimelineJournal * journal)
+{
+  guint id = get_id (journal, obj);
+
+  if (!id)
+    return;
+
+  untrack_instance (journal, obj);
+  write_record (journal, gst_structure_new ("remove",
+          "journal-id", G_TYPE_UINT, id, NULL));
+}
+
+static void
+object_moved_cb (GESSimpleTimelineLayer * layer, GESTimelineObject * obj,
+    gint old, gint new, GESTimelineJournal * journal)
+{
+  write_record (journal, gst_structure_new ("move-in-layer",
+          "journal-id", G_TYPE_UINT, get_id (journal, obj),
+          "journal-position", G_TYPE_INT, new, NULL));
+}
+
+static void
+object_notify_cb (GESTimelineObject * obj, GParamSpec * pspec,
+    GESTimelineJournal * journal)
+{
+  GstStructure *record;
+  GESTimelineLayer *layer;
+  gboolean derived = FALSE;
+
+  if (!is_recorded_property (pspec) || pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+    return;
+
+  /* The position of the objects of simple layers is derived from their
+   * index, which "move-in-layer" records */
+  if (!g_strcmp0 (pspec->name, "start") ||
+      !g_strcmp0 (pspec->name, "priority")) {
+    if ((layer = ges_timeline_object_get_layer (obj))) {
+      derived = GES_IS_SIMPLE_TIMELINE_LAYER (layer);
+      g_object_unref (layer);
+    }
+  }
+
+  if (derived)
+    return;
+
+  record = gst_structure_new ("set",
+      "journal-id", G_TYPE_UINT, get_id (journal, obj), NULL);
+  set_property_field (record, G_OBJECT (obj), pspec);
+  write_record (journal, record);
+}
+
+/* Writes a snapshot of @timeline to @location and starts appending the
+ * edits made to @timeline after it. Returns %NULL if @location could not be
+ * written. */
+GESTimelineJournal *
+ges_timeline_journal_new (GESTimeline * timeline, const gchar * location)
+{
+  GESTimelineJournal *journal = g_slice_new0 (GESTimelineJournal);
+
+  journal->timeline = timeline;
+  journal->location = g_strdup (location);
+  journal->ids = g_hash_table_new (g_direct_hash, g_direct_equal);
+  journal->next_id = 1;
+  journal->batch = g_string_new (NULL);
+  journal->tail = g_string_new (NULL);
+
+  if (!write_snapshot (journal)) {
+    ges_timeline_journal_free (journal);
+    return NULL;
+  }
+
+  g_signal_connect (timeline, "layer-added", G_CALLBACK (layer_added_cb),
+      journal);
+  g_signal_connect (timeline, "layer-removed", G_CALLBACK (layer_removed_cb),
+      journal);
+  g_signal_connect (timeline, "track-added", G_CALLBACK (track_added_cb),
+      journal);
+  g_signal_connect (timeline, "track-removed", G_CALLBACK (track_removed_cb),
+      journal);
+
+  return journal;
+}
+
+void
+ges_timeline_journal_free (GESTimelineJournal * journal)
+{
+  GHashTableIter iter;
+  gpointer instance;
+
+  ges_timeline_journal_end_batch (journal);
+  stop_compaction (journal);
+
+  g_signal_handlers_disconnect_by_data (journal->timeline, journal);
+
+  g_hash_table_iter_init (&iter, journal->ids);
+  while (g_hash_table_iter_next (&iter, &instance, NULL))
+    g_signal_handlers_disconnect_by_data (instance, journal);
+  g_hash_table_unref (journal->ids);
+
+  if (journal->file)
+    fclose (journal->file);
+  g_free (journal->location);
+  g_string_free (journal->batch, TRUE);
+  g_string_free (journal->tail, TRUE);
+
+  g_slice_free (GESTimelineJournal, journal);
+}
+
+gboolean
+ges_timeline_journal_compact (GESTimelineJournal * journal)
+{
+  GST_DEBUG ("compacting %u records", journal->n_records);
+
+  return write_snapshot (journal);
+}
+
+/* Keeps the records of the edits in memory until
+ * ges_timeline_journal_end_batch() */
+void
+ges_timeline_journal_begin_batch (GESTimelineJournal * journal)
+{
+  journal->batching = TRUE;
+}
+
+/* Appends the records of the edits made since
+ * ges_timeline_journal_begin_batch() at once */
+void
+ges_timeline_journal_end_batch (GESTimelineJournal * journal)
+{
+  if (!journal->batching)
+    return;
+
+  journal->batching = FALSE;
+  if (journal->batch->len)
+    append_to_file (journal, journal->batch->str, journal->batch->len,
+        journal->n_batched);
+  g_string_truncate (journal->batch, 0);
+  journal->n_batched = 0;
+
+  if (journal->compact_after_batch) {
+    journal->compact_after_batch = FALSE;
+    schedule_compaction (journal);
+  }
+}
+
+/* Replaying */
+
+typedef struct
+{
+  GESTimeline *timeline;
+
+  /* {id: GESTimelineLayer or GESTimelineObject}, not reffed */
+  GHashTable *instances;
+
+  /* {layer id: auto-transition}, only applied once everything is replayed.
+   * The transitions the layers created are journaled like any object, so
+   * letting the layers create them again would duplicate them. */
+  GHashTable *auto_transitions;
+} ReplayContext;
+
+static gpointer
+lookup_instance (ReplayContext * ctx, const GstStructure * record,
+    const gchar * field, GType type)
+{
+  guint id;
+  gpointer instance;
+
+  if (!gst_structure_get_uint (record, field, &id))
+    return NULL;
+
+  instance = g_hash_table_lookup (ctx->instances, GUINT_TO_POINTER (id));
+  if (instance && !G_TYPE_CHECK_INSTANCE_TYPE (instance, type))
+    return NULL;
+
+  return instance;
+}
+
+static gboolean
+deserialize_field (GObjectClass * klass, const gchar * name,
+    const GValue * field, GValue * value)
+{
+  GParamSpec *pspec = g_object_class_find_property (klass, name);
+
+  if (pspec == NULL || !G_VALUE_HOLDS_STRING (field)) {
+    GST_ERROR ("%s has no property %s", G_OBJECT_CLASS_NAME (klass), name);
+    return FALSE;
+  }
+
+  g_value_init (value, pspec->value_type);
+  if (!gst_value_deserialize (value, g_value_get_string (field))) {
+    GST_ERROR ("Invalid value for property %s: %s", name,
+        g_value_get_string (field));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Sets the properties stored in @record, other than the journal ones */
+static gboolean
+set_properties (GObject * object, const GstStructure * record)
+{
+  guint i;
+
+  for (i = 0; i < gst_structure_n_fields (record); i++) {
+    GValue v = { 0 };
+    const gchar *name = gst_structure_nth_field_name (record, i);
+
+    if (g_str_has_prefix (name, "journal-"))
+      continue;
+
+    if (!deserialize_field (G_OBJECT_GET_CLASS (object), name,
+            gst_structure_get_value (record, name), &v))
+      return FALSE;
+
+    g_object_set_property (object, name, &v);
+    g_value_unset (&v);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+replay_add (ReplayContext * ctx, const GstStructure * record)
+{
+  GType type;
+  guint id, i, n_params = 0;
+  gint position = -1;
+  gboolean ret = FALSE;
+  GObjectClass *klass;
+  GParameter *params;
+  GESTimelineObject *obj;
+  GESTimelineLayer *layer;
+  const gchar *type_name;
+
+  layer = lookup_instance (ctx, record, "journal-layer",
+      GES_TYPE_TIMELINE_LAYER);
+  type_name = gst_structure_get_string (record, "journal-type");
+
+  if (!layer || !type_name || !gst_structure_get_uint (record, "journal-id",
+          &id) || !(type = g_type_from_name (type_name)) ||
+      !g_type_is_a (type, GES_TYPE_TIMELINE_OBJECT))
+    return FALSE;
+
+  gst_structure_get_int (record, "journal-position", &position);
+
+  klass = g_type_class_ref (type);
+  params = g_new0 (GParameter, gst_structure_n_fields (record));
+
+  for (i = 0; i < gst_structure_n_fields (record); i++) {
+    const gchar *name = gst_structure_nth_field_name (record, i);
+
+    if (g_str_has_prefix (name, "journal-"))
+      continue;
+
+    params[n_params].name = name;
+    if (!deserialize_field (klass, name, gst_structure_get_value (record,
+                name), &params[n_params++].value))
+      goto done;
+  }
+
+  obj = g_object_newv (type, n_params, params);
+
+  if (GES_IS_SIMPLE_TIMELINE_LAYER (layer))
+    ret = ges_simple_timeline_layer_add_object ((GESSimpleTimelineLayer *)
+        layer, obj, position);
+  else
+    ret = ges_timeline_layer_add_object (layer, obj);
+
+  if (ret)
+    g_hash_table_insert (ctx->instances, GUINT_TO_POINTER (id), obj);
+  else
+    g_object_unref (obj);
+
+done:
+  for (i = 0; i < n_params; i++) {
+    if (G_IS_VALUE (&params[i].value))
+      g_value_unset (&params[i].value);
+  }
+  g_free (params);
+  g_type_class_unref (klass);
+
+  return ret;
+}
+
+static gboolean
+replay_record (ReplayContext * ctx, const GstStructure * record)
+{
+  guint id;
+  gpointer instance;
+
+  if (gst_structure_has_name (record, "add"))
+    return replay_add (ctx, record);
+
+  if (gst_structure_has_name (record, "set")) {
+    if (!(instance = lookup_instance (ctx, record, "journal-id",
+                GES_TYPE_TIMELINE_OBJECT)))
+      return FALSE;
+
+    return set_properties (instance, record);
+  }
+
+  if (gst_structure_has_name (record, "remove")) {
+    GESTimelineLayer *layer;
+    gboolean ret;
+
+    if (!(instance = lookup_instance (ctx, record, "journal-id",
+                GES_TYPE_TIMELINE_OBJECT)) ||
+        !(layer = ges_timeline_object_get_layer (instance)))
+      return FALSE;
+
+    gst_structure_get_uint (record, "journal-id", &id);
+    g_hash_table_remove (ctx->instances, GUINT_TO_POINTER (id));
+
+    ret = ges_timeline_layer_remove_object (layer, instance);
+    g_object_unref (layer);
+
+    return ret;
+  }
+
+  if (gst_structure_has_name (record, "move-in-layer")) {
+    GESTimelineLayer *layer;
+    gint position;
+    gboolean ret;
+
+    if (!(instance = lookup_instance (ctx, record, "journal-id",
+                GES_TYPE_TIMELINE_OBJECT)) ||
+        !gst_structure_get_int (record, "journal-position", &position) ||
+        !(layer = ges_timeline_object_get_layer (instance)))
+      return FALSE;
+
+    ret = GES_IS_SIMPLE_TIMELINE_LAYER (layer) &&
+        ges_simple_timeline_layer_move_object ((GESSimpleTimelineLayer *)
+        layer, instance, position);
+    g_object_unref (layer);
+
+    return ret;
+  }
+
+  if (gst_structure_has_name (record, "layer")) {
+    GESTimelineLayer *layer;
+    gboolean simple = FALSE, auto_transition = FALSE;
+    guint priority = 0;
+
+    if (!gst_structure_get_uint (record, "journal-layer", &id))
+      return FALSE;
+
+    gst_structure_get_boolean (record, "simple", &simple);
+    gst_structure_get_uint (record, "priority", &priority);
+    gst_structure_get_boolean (record, "auto-transition", &auto_transition);
+
+    if (simple)
+      layer = (GESTimelineLayer *) ges_simple_timeline_layer_new ();
+    else
+      layer = ges_timeline_layer_new ();
+
+    ges_timeline_layer_set_priority (layer, priority);
+    g_hash_table_insert (ctx->auto_transitions, GUINT_TO_POINTER (id),
+        GINT_TO_POINTER (auto_transition));
+
+    if (!ges_timeline_add_layer (ctx->timeline, layer)) {
+      g_object_unref (layer);
+      return FALSE;
+    }
+
+    g_hash_table_insert (ctx->instances, GUINT_TO_POINTER (id), layer);
+
+    return TRUE;
+  }
+
+  if (gst_structure_has_name (record, "set-layer")) {
+    GstStructure *copy;
+    gboolean ret;
+    const gchar *auto_transition;
+
+    if (!(instance = lookup_instance (ctx, record, "journal-layer",
+                GES_TYPE_TIMELINE_LAYER)))
+      return FALSE;
+
+    if (!(auto_transition = gst_structure_get_string (record,
+                "auto-transition")))
+      return set_properties (instance, record);
+
+    gst_structure_get_uint (record, "journal-layer", &id);
+    g_hash_table_insert (ctx->auto_transitions, GUINT_TO_POINTER (id),
+        GINT_TO_POINTER (!g_strcmp0 (auto_transition, "true")));
+
+    copy = gst_structure_copy (record);
+    gst_structure_remove_field (copy, "auto-transition");
+    ret = set_properties (instance, copy);
+    gst_structure_free (copy);
+
+    return ret;
+  }
+
+  if (gst_structure_has_name (record, "remove-layer")) {
+    if (!(instance = lookup_instance (ctx, record, "journal-layer",
+                GES_TYPE_TIMELINE_LAYER)))
+      return FALSE;
+
+    gst_structure_get_uint (record, "journal-layer", &id);
+    g_hash_table_remove (ctx->instances, GUINT_TO_POINTER (id));
+
+    return ges_timeline_remove_layer (ctx->timeline, instance);
+  }
+
+  if (gst_structure_has_name (record, "track")) {
+    GstCaps *caps;
+    GESTrack *track;
+    guint type;
+    const gchar *caps_str = gst_structure_get_string (record, "caps");
+
+    if (!gst_structure_get_uint (record, "type", &type) || !caps_str ||
+        !(caps = gst_caps_from_string (caps_str)))
+      return FALSE;
+
+    track = ges_track_new (type, caps);
+    if (!ges_timeline_add_track (ctx->timeline, track)) {
+      g_object_unref (track);
+      return FALSE;
+    }
+
+    return TRUE;
+  }
+
+  GST_DEBUG ("Ignoring unknown record %s", gst_structure_get_name (record));
+
+  return TRUE;
+}
+
+/* Recreates in @timeline the state recorded in the journal at @location.
+ *
+ * A truncated last record, as left by a crash while it was being written, is
+ * ignored. */
+gboolean
+ges_timeline_journal_replay (GESTimeline * timeline, const gchar * location)
+{
+  ReplayContext ctx;
+  gchar *contents, **lines;
+  GError *err = NULL;
+  GstStructure *header;
+  GHashTableIter iter;
+  gpointer id, auto_transition;
+  gsize length;
+  guint version = 0, i;
+  gboolean ret = TRUE;
+
+  if (!g_file_get_contents (location, &contents, &length, &err)) {
+    GST_ERROR ("Could not read journal %s: %s", location, err->message);
+    g_error_free (err);
+    return FALSE;
+  }
+
+  /* Every complete record ends with a newline, a torn write can still
+   * parse, with a cut value, so only the complete lines are kept */
+  if (length > 0 && contents[length - 1] != '\n') {
+    gchar *last = strrchr (contents, '\n');
+
+    GST_WARNING ("Ignoring truncated last record of %s", location);
+    if (last)
+      last[1] = '\0';
+    else
+      contents[0] = '\0';
+  }
+
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  header = lines[0] ? gst_structure_from_string (lines[0], NULL) : NULL;
+  if (header == NULL || !gst_structure_has_name (header, JOURNAL_HEADER) ||
+      !gst_structure_get_uint (header, "version", &version) ||
+      version != JOURNAL_VERSION) {
+    GST_ERROR ("%s is not a journal of a supported version", location);
+    if (header)
+      gst_structure_free (header);
+    g_strfreev (lines);
+    return FALSE;
+  }
+  gst_structure_free (header);
+
+  ctx.timeline = timeline;
+  ctx.instances = g_hash_table_new (g_direct_hash, g_direct_equal);
+  ctx.auto_transitions = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (i = 1; lines[i] && ret; i++) {
+    GstStructure *record;
+
+    if (lines[i][0] == '\0')
+      continue;
+
+    if (!(record = gst_structure_from_string (lines[i], NULL))) {
+      GST_ERROR ("Invalid record %u of %s: %s", i, location, lines[i]);
+      ret = FALSE;
+      break;
+    }
+
+    if (!replay_record (&ctx, record)) {
+      GST_ERROR ("Could not replay record %u of %s: %s", i, location,
+          lines[i]);
+      ret = FALSE;
+    }
+
+    gst_structure_free (record);
+  }
+
+  g_hash_table_iter_init (&iter, ctx.auto_transitions);
+  while (ret && g_hash_table_iter_next (&iter, &id, &auto_transition)) {
+    GESTimelineLayer *layer = g_hash_table_lookup (ctx.instances, id);
+
+    /* Removed later in the journal */
+    if (layer == NULL)
+      continue;
+
+    ges_timeline_layer_set_auto_transition (layer,
+        GPOINTER_TO_INT (auto_transition));
+  }
+
+  g_hash_table_unref (ctx.auto_transitions);
+  g_hash_table_unref (ctx.instances);
+  g_strfreev (lines);
+
+  return ret;
+}
@@ -57,6 +57,12 @@ struct _GESTimelineLayerPrivate
   guint32 priority;             /* The priority of the layer within the
                                  * containing timeline */
   gboolean auto_transition;
+
+  /* Neighbour index used to calculate the transitions, it contains the
+   * TrackObject-s of our TimelineObject-s sorted the same way as in their
+   * track */
+  GHashTable *tckobjs_by_track; /* {GESTrack: GSequence of GESTrackObject} */
+  GHashTable *tckobjs_iters;    /* {GESTrackObject: GSequenceIter} */
 };
 
 enum
@@ -126,6 +132,16 @@ ges_timeline_layer_dispose (GObject * object)
     ges_timeline_layer_remove_object (layer,
         (GESTimelineObject *) priv->objects_start->data);
 
+  if (priv->tckobjs_by_track) {
+    g_hash_table_unref (priv->tckobjs_by_track);
+    priv->tckobjs_by_track = NULL;
+  }
+
+  if (priv->tckobjs_iters) {
+    g_hash_table_unref (priv->tckobjs_iters);
+    priv->tckobjs_iters = NULL;
+  }
+
   G_OBJECT_CLASS (ges_timeline_layer_parent_class)->dispose (object);
 }
 
@@ -202,6 +218,9 @@ ges_timeline_layer_init (GESTimelineLayer * self)
 
   self->priv->priority = 0;
   self->priv->auto_transition = FALSE;
+  self->priv->tckobjs_by_track = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, NULL, (GDestroyNotify) g_sequence_free);
+  self->priv->tckobjs_iters = g_hash_table_new (g_direct_hash, g_direct_equal);
   self->min_gnl_priority = 0;
   self->max_gnl_priority = LAYER_HEIGHT;
 }
@@ -224,43 +243,62 @@ objects_start_compare (GESTimelineObject * a, GESTimelineObject * b)
   return 0;
 }
 
-static GList *
-track_get_by_layer (GESTimelineLayer * layer, GESTrack * track)
+/* Same order as the objects in a GESTrack */
+static gint
+track_objects_start_compare (GESTrackObject * a, GESTrackObject * b,
+    gpointer user_data)
 {
-  GESTrackObject *tckobj;
-  guint32 layer_prio = layer->priv->priority;
+  if (a->start == b->start) {
+    if (a->priority < b->priority)
+      return -1;
+    if (a->priority > b->priority)
+      return 1;
+    return 0;
+  }
+  if (a->start < b->start)
+    return -1;
+  if (a->start > b->start)
+    return 1;
+  return 0;
+}
 
-  GList *tck_objects_list = NULL, *tmp = NULL, *return_list = NULL;
+static inline GSequenceIter *
+iter_prev (GSequenceIter * iter)
+{
+  if (g_sequence_iter_is_begin (iter))
+    return NULL;
 
-  tck_objects_list = ges_track_get_objects (track);
-  for (tmp = tck_objects_list; tmp; tmp = tmp->next) {
-    tckobj = GES_TRACK_OBJECT (tmp->data);
+  return g_sequence_iter_prev (iter);
+}
 
-    if (tckobj->priority / LAYER_HEIGHT == layer_prio) {
-      /*  We steal the reference from tck_objects_list */
-      return_list = g_list_append (return_list, tmp->data);
-    } else
-      g_object_unref (tmp->data);
-  }
+static inline GSequenceIter *
+iter_next (GSequenceIter * iter)
+{
+  iter = g_sequence_iter_next (iter);
 
-  return return_list;
+  return g_sequence_iter_is_end (iter) ? NULL : iter;
 }
 
+#define ITER_TCKOBJ(iter) (GES_TRACK_OBJECT (g_sequence_get (iter)))
+
 /* Compare:
- * @compared: The #GList of #GESTrackObjects that we compare with @track_object
+ * @compared: The #GSequenceIter of the #GESTrackObject that we compare with
+ * @track_object
  * @track_object: The #GESTrackObject that serves as a reference
  * @ahead: %TRUE if we are comparing frontward %FALSE if we are comparing
  * backward*/
 static void
-compare (GList * compared, GESTrackObject * track_object, gboolean ahead)
+compare (GSequenceIter * compared, GESTrackObject * track_object,
+    gboolean ahead)
 {
-  GList *tmp;
+  GSequenceIter *tmp;
   gint64 start, duration, compared_start, compared_duration, end, compared_end,
       tr_start, tr_duration;
   GESTimelineStandardTransition *trans = NULL;
   GESTrack *track;
   GESTimelineLayer *layer;
   GESTimelineObject *object, *compared_object, *first_object, *second_object;
+  GESTrackObject *compared_tckobj;
   gint priority;
 
   g_return_if_fail (compared);
@@ -276,38 +314,45 @@ compare (GList * compared, GESTrackObject * track_object, gboolean ahead)
     return;
   }
 
-  compared_object = ges_track_object_get_timeline_object (compared->data);
+  compared_tckobj = ITER_TCKOBJ (compared);
+  compared_object = ges_track_object_get_timeline_object (compared_tckobj);
   layer = ges_timeline_object_get_layer (object);
 
   start = ges_track_object_get_start (track_object);
   duration = ges_track_object_get_duration (track_object);
-  compared_start = ges_track_object_get_start (compared->data);
-  compared_duration = ges_track_object_get_duration (compared->data);
+  compared_start = ges_track_object_get_start (compared_tckobj);
+  compared_duration = ges_track_object_get_duration (compared_tckobj);
   end = start + duration;
   compared_end = compared_start + compared_duration;
 
   if (ahead) {
     /* Make sure we remove the last transition we created it is not needed
      * FIXME make it a smarter way */
-    if (compared->prev && GES_IS_TRACK_TRANSITION (compared->prev->data)) {
+    tmp = iter_prev (compared);
+    if (tmp && GES_IS_TRACK_TRANSITION (ITER_TCKOBJ (tmp))) {
       trans = GES_TIMELINE_STANDARD_TRANSITION
-          (ges_track_object_get_timeline_object (compared->prev->data));
-      g_object_get (compared->prev->data, "start", &tr_start, "duration",
+          (ges_track_object_get_timeline_object (ITER_TCKOBJ (tmp)));
+      g_object_get (ITER_TCKOBJ (tmp), "start", &tr_start, "duration",
           &tr_duration, NULL);
       if (tr_start >= compared_start && tr_start + tr_duration <= compared_end)
         ges_timeline_layer_remove_object (layer, GES_TIMELINE_OBJECT (trans));
       trans = NULL;
     }
 
-    for (tmp = compared->next; tmp; tmp = tmp->next) {
+    for (tmp = iter_next (compared); tmp; tmp = iter_next (tmp)) {
+      /* Objects are sorted by start, nothing after that can end with
+       * @compared */
+      if (GES_TRACK_OBJECT_START (ITER_TCKOBJ (tmp)) > compared_end)
+        break;
+
       /* If we have a transitionmnmnm we recaluculuculate its values */
-      if (GES_IS_TRACK_TRANSITION (tmp->data)) {
-        g_object_get (tmp->data, "start", &tr_start, "duration", &tr_duration,
-            NULL);
+      if (GES_IS_TRACK_TRANSITION (ITER_TCKOBJ (tmp))) {
+        g_object_get (ITER_TCKOBJ (tmp), "start", &tr_start, "duration",
+            &tr_duration, NULL);
 
         if (tr_start + tr_duration == compared_start + compared_duration) {
           GESTimelineObject *tlobj;
-          tlobj = ges_track_object_get_timeline_object (tmp->data);
+          tlobj = ges_track_object_get_timeline_object (ITER_TCKOBJ (tmp));
 
           trans = GES_TIMELINE_STANDARD_TRANSITION (tlobj);
           break;
@@ -338,26 +383,31 @@ compare (GList * compared, GESTrackObject * track_object, gboolean ahead)
     }
 
   } else {
-    if (compared->next && GES_IS_TRACK_TRANSITION (compared->next->data)) {
+    tmp = iter_next (compared);
+    if (tmp && GES_IS_TRACK_TRANSITION (ITER_TCKOBJ (tmp))) {
       trans = GES_TIMELINE_STANDARD_TRANSITION
-          (ges_track_object_get_timeline_object (compared->next->data));
-      g_object_get (compared->prev->data, "start", &tr_start, "duration",
+          (ges_track_object_get_timeline_object (ITER_TCKOBJ (tmp)));
+      g_object_get (ITER_TCKOBJ (tmp), "start", &tr_start, "duration",
           &tr_duration, NULL);
       if (tr_start >= compared_start && tr_start + tr_duration <= compared_end)
         ges_timeline_layer_remove_object (layer, GES_TIMELINE_OBJECT (trans));
       trans = NULL;
     }
-    for (tmp = compared->prev; tmp; tmp = tmp->prev) {
-      if GES_IS_TRACK_TRANSITION
-        (tmp->data) {
-        g_object_get (tmp->data, "start", &tr_start, "duration", &tr_duration,
-            NULL);
+    for (tmp = iter_prev (compared); tmp; tmp = iter_prev (tmp)) {
+      /* Objects are sorted by start, nothing before that can start with
+       * @compared */
+      if (GES_TRACK_OBJECT_START (ITER_TCKOBJ (tmp)) < compared_start)
+        break;
+
+      if (GES_IS_TRACK_TRANSITION (ITER_TCKOBJ (tmp))) {
+        g_object_get (ITER_TCKOBJ (tmp), "start", &tr_start, "duration",
+            &tr_duration, NULL);
         if (tr_start == compared_start) {
           trans = GES_TIMELINE_STANDARD_TRANSITION
-              (ges_track_object_get_timeline_object (tmp->data));
+              (ges_track_object_get_timeline_object (ITER_TCKOBJ (tmp)));
           break;
         }
-        }
+      }
     }
 
     if (start + duration <= compared_start) {
@@ -395,10 +445,10 @@ compare (GList * compared, GESTrackObject * track_object, gboolean ahead)
     ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (trans));
 
     if (ahead) {
-      first_object = ges_track_object_get_timeline_object (compared->data);
+      first_object = compared_object;
       second_object = object;
     } else {
-      second_object = ges_track_object_get_timeline_object (compared->data);
+      second_object = compared_object;
       first_object = object;
     }
 
@@ -421,117 +471,97 @@ clean:
 }
 
 static void
-calculate_next_transition_with_list (GESTrackObject * track_object,
-    GList * tckobjs_in_layer, GESTimelineLayer * layer)
+calculate_next_transition (GESTrackObject * track_object,
+    GESTimelineLayer * layer)
 {
-  GList *compared;
-
-  if (!(compared = g_list_find (tckobjs_in_layer, track_object)))
-    return;
+  GSequenceIter *compared;
 
+  compared = g_hash_table_lookup (layer->priv->tckobjs_iters, track_object);
   if (compared == NULL)
-    /* This is the last TrackObject of the Track */
     return;
 
   do {
-    compared = compared->next;
+    compared = iter_next (compared);
     if (compared == NULL)
+      /* This is the last TrackObject of the Track */
       return;
-  } while (!GES_IS_TRACK_SOURCE (compared->data));
+  } while (!GES_IS_TRACK_SOURCE (ITER_TCKOBJ (compared)));
 
   compare (compared, track_object, FALSE);
 }
 
-
 static void
-calculate_next_transition (GESTrackObject * track_object,
-    GESTimelineLayer * layer)
+calculate_transitions (GESTrackObject * track_object, GESTimelineLayer * layer)
 {
-  GESTrack *track;
-  GList *tckobjs_in_layer;
-
-  if ((track = ges_track_object_get_track (track_object))) {
-    tckobjs_in_layer = track_get_by_layer (layer, track);
-    calculate_next_transition_with_list (track_object, tckobjs_in_layer, layer);
-
-    g_list_foreach (tckobjs_in_layer, (GFunc) g_object_unref, NULL);
-    g_list_free (tckobjs_in_layer);
-  }
-}
-
-static void
-calculate_transitions (GESTrackObject * track_object)
-{
-  GList *tckobjs_in_layer, *compared;
-  GESTimelineLayer *layer;
-  GESTimelineObject *tlobj;
-
-  GESTrack *track = ges_track_object_get_track (track_object);
+  GSequenceIter *compared;
 
-  if (track == NULL)
+  compared = g_hash_table_lookup (layer->priv->tckobjs_iters, track_object);
+  if (compared == NULL)
     return;
 
-  tlobj = ges_track_object_get_timeline_object (track_object);
-  layer = ges_timeline_object_get_layer (tlobj);
-  tckobjs_in_layer = track_get_by_layer (layer, track);
-  if (!(compared = g_list_find (tckobjs_in_layer, track_object)))
-    return;
   do {
-    compared = compared->prev;
+    compared = iter_prev (compared);
 
     if (compared == NULL) {
       /* Nothing before, let's check after */
-      calculate_next_transition_with_list (track_object, tckobjs_in_layer,
-          layer);
-      goto done;
+      calculate_next_transition (track_object, layer);
 
+      return;
     }
-  } while (!GES_IS_TRACK_SOURCE (compared->data));
+  } while (!GES_IS_TRACK_SOURCE (ITER_TCKOBJ (compared)));
 
   compare (compared, track_object, TRUE);
 
-  calculate_next_transition_with_list (track_object, tckobjs_in_layer, layer);
-
-done:
-  g_list_foreach (tckobjs_in_layer, (GFunc) g_object_unref, NULL);
-  g_list_free (tckobjs_in_layer);
+  calculate_next_transition (track_object, layer);
 }
 
-
-static void
-look_for_transition (GESTrackObject * track_object, GESTimelineLayer * layer)
+/* Returns the transitions between @track_object and the sources before and
+ * after it */
+static GList *
+get_surrounding_transitions (GESTrackObject * track_object,
+    GESTimelineLayer * layer)
 {
-  GESTrack *track;
-  GList *track_objects, *tmp, *cur;
-
-  track = ges_track_object_get_track (track_object);
-  track_objects = ges_track_get_objects (track);
+  GSequenceIter *cur, *tmp;
+  GList *transitions = NULL;
 
-  cur = g_list_find (track_objects, track_object);
+  cur = g_hash_table_lookup (layer->priv->tckobjs_iters, track_object);
+  if (cur == NULL)
+    return NULL;
 
-  for (tmp = cur->next; tmp; tmp = tmp->next) {
-    if (GES_IS_TRACK_SOURCE (tmp->data)) {
+  for (tmp = iter_next (cur); tmp; tmp = iter_next (tmp)) {
+    if (GES_IS_TRACK_SOURCE (ITER_TCKOBJ (tmp)))
       break;
-    }
-    if (GES_IS_TRACK_AUDIO_TRANSITION (tmp->data)
-        || GES_IS_TRACK_VIDEO_TRANSITION (tmp->data)) {
-      ges_timeline_layer_remove_object (layer,
-          ges_track_object_get_timeline_object (tmp->data));
-    }
+
+    if (GES_IS_TRACK_AUDIO_TRANSITION (ITER_TCKOBJ (tmp))
+        || GES_IS_TRACK_VIDEO_TRANSITION (ITER_TCKOBJ (tmp)))
+      transitions = g_list_prepend (transitions,
+          ges_track_object_get_timeline_object (ITER_TCKOBJ (tmp)));
   }
 
-  for (tmp = cur->prev; tmp; tmp = tmp->prev) {
-    if (GES_IS_TRACK_SOURCE (tmp->data)) {
+  for (tmp = iter_prev (cur); tmp; tmp = iter_prev (tmp)) {
+    if (GES_IS_TRACK_SOURCE (ITER_TCKOBJ (tmp)))
       break;
-    }
-    if (GES_IS_TRACK_AUDIO_TRANSITION (tmp->data)
-        || GES_IS_TRACK_VIDEO_TRANSITION (tmp->data)) {
-      ges_timeline_layer_remove_object (layer,
-          ges_track_object_get_timeline_object (tmp->data));
-    }
+
+    if (GES_IS_TRACK_AUDIO_TRANSITION (ITER_TCKOBJ (tmp))
+        || GES_IS_TRACK_VIDEO_TRANSITION (ITER_TCKOBJ (tmp)))
+      transitions = g_list_prepend (transitions,
+          ges_track_object_get_timeline_object (ITER_TCKOBJ (tmp)));
   }
-  g_list_foreach (track_objects, (GFunc) g_object_unref, NULL);
-  g_list_free (track_objects);
+
+  return transitions;
+}
+
+static void
+look_for_transition (GESTrackObject * track_object, GESTimelineLayer * layer)
+{
+  GList *transitions, *tmp;
+
+  /* Removing the transitions modifies the index, so collect them first */
+  transitions = get_surrounding_transitions (track_object, layer);
+  for (tmp = transitions; tmp; tmp = tmp->next)
+    ges_timeline_layer_remove_object (layer, tmp->data);
+
+  g_list_free (transitions);
 }
 
 /**
@@ -565,103 +595,194 @@ ges_timeline_layer_resync_priorities (GESTimelineLayer * layer)
 
 static void
 track_object_duration_cb (GESTrackObject * track_object,
-    GParamSpec * arg G_GNUC_UNUSED)
+    GParamSpec * arg G_GNUC_UNUSED, GESTimelineLayer * layer)
 {
-  GESTimelineLayer *layer;
-  GESTimelineObject *tlobj;
-
-  tlobj = ges_track_object_get_timeline_object (track_object);
-  layer = ges_timeline_object_get_layer (tlobj);
   if (G_LIKELY (GES_IS_TRACK_SOURCE (track_object)))
     calculate_next_transition (track_object, layer);
 }
 
 static void
-track_object_removed_cb (GESTrack * track, GESTrackObject * track_object)
+track_object_priority_cb (GESTrackObject * track_object,
+    GParamSpec * arg G_GNUC_UNUSED, GESTimelineLayer * layer)
 {
-  GList *track_objects, *tmp, *cur;
-  GESTimelineLayer *layer;
+  GSequenceIter *iter;
 
-  track_objects = ges_track_get_objects (track);
-  cur = g_list_find (track_objects, track_object);
-  for (tmp = cur->next; tmp; tmp = tmp->next) {
-    if (GES_IS_TRACK_SOURCE (tmp->data)) {
-      break;
-    }
-    if (GES_IS_TRACK_AUDIO_TRANSITION (tmp->data)
-        || GES_IS_TRACK_VIDEO_TRANSITION (tmp->data)) {
-      layer =
-          ges_timeline_object_get_layer (ges_track_object_get_timeline_object
-          (tmp->data));
-      if (ges_timeline_layer_get_auto_transition (layer)) {
-        ges_track_enable_update (track, FALSE);
-        ges_timeline_layer_remove_object (layer,
-            ges_track_object_get_timeline_object (tmp->data));
-        ges_track_enable_update (track, TRUE);
-      }
-      g_object_unref (layer);
-    }
+  iter = g_hash_table_lookup (layer->priv->tckobjs_iters, track_object);
+  if (iter)
+    g_sequence_sort_changed (iter,
+        (GCompareDataFunc) track_objects_start_compare, NULL);
+}
+
+static void
+track_object_changed_cb (GESTrackObject * track_object,
+    GParamSpec * arg G_GNUC_UNUSED, GESTimelineLayer * layer)
+{
+  GSequenceIter *iter;
+
+  iter = g_hash_table_lookup (layer->priv->tckobjs_iters, track_object);
+  if (iter == NULL)
+    return;
+
+  g_sequence_sort_changed (iter,
+      (GCompareDataFunc) track_objects_start_compare, NULL);
+
+  if (G_LIKELY (GES_IS_TRACK_SOURCE (track_object)))
+    calculate_transitions (track_object, layer);
+}
+
+/* Neighbour index handling */
+static void
+index_track_object (GESTimelineLayer * layer, GESTrackObject * track_object)
+{
+  GSequence *tckobjs;
+  GSequenceIter *iter;
+  GESTimelineLayerPrivate *priv = layer->priv;
+  GESTrack *track = ges_track_object_get_track (track_object);
+
+  if (track == NULL ||
+      g_hash_table_lookup (priv->tckobjs_iters, track_object) != NULL)
+    return;
+
+  tckobjs = g_hash_table_lookup (priv->tckobjs_by_track, track);
+  if (tckobjs == NULL) {
+    tckobjs = g_sequence_new (NULL);
+    g_hash_table_insert (priv->tckobjs_by_track, track, tckobjs);
   }
 
-  for (tmp = cur->prev; tmp; tmp = tmp->prev) {
-    if (GES_IS_TRACK_SOURCE (tmp->data)) {
-      break;
-    }
-    if (GES_IS_TRACK_AUDIO_TRANSITION (tmp->data)
-        || GES_IS_TRACK_VIDEO_TRANSITION (tmp->data)) {
-      layer =
-          ges_timeline_object_get_layer (ges_track_object_get_timeline_object
-          (tmp->data));
-      if (ges_timeline_layer_get_auto_transition (layer)) {
-        ges_track_enable_update (track, FALSE);
-        ges_timeline_layer_remove_object (layer,
-            ges_track_object_get_timeline_object (tmp->data));
-        ges_track_enable_update (track, TRUE);
-      }
-      g_object_unref (layer);
-    }
+  iter = g_sequence_insert_sorted (tckobjs, track_object,
+      (GCompareDataFunc) track_objects_start_compare, NULL);
+  g_hash_table_insert (priv->tckobjs_iters, track_object, iter);
+
+  g_signal_connect (G_OBJECT (track_object), "notify::start",
+      G_CALLBACK (track_object_changed_cb), layer);
+  g_signal_connect (G_OBJECT (track_object), "notify::duration",
+      G_CALLBACK (track_object_duration_cb), layer);
+  g_signal_connect (G_OBJECT (track_object), "notify::priority",
+      G_CALLBACK (track_object_priority_cb), layer);
+}
+
+static void
+unindex_track_object (GESTimelineLayer * layer, GESTrackObject * track_object)
+{
+  GSequenceIter *iter;
+
+  iter = g_hash_table_lookup (layer->priv->tckobjs_iters, track_object);
+  if (iter == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (track_object,
+      track_object_changed_cb, layer);
+  g_signal_handlers_disconnect_by_func (track_object,
+      track_object_duration_cb, layer);
+  g_signal_handlers_disconnect_by_func (track_object,
+      track_object_priority_cb, layer);
+
+  g_hash_table_remove (layer->priv->tckobjs_iters, track_object);
+  g_sequence_remove (iter);
+}
+
+static void
+index_timeline_object (GESTimelineLayer * layer, GESTimelineObject * object,
+    gboolean index)
+{
+  GList *tmp, *trackobjects = ges_timeline_object_get_track_objects (object);
+
+  for (tmp = trackobjects; tmp; tmp = tmp->next) {
+    if (index)
+      index_track_object (layer, tmp->data);
+    else
+      unindex_track_object (layer, tmp->data);
   }
-  g_object_unref (track_object);
+
+  g_list_free_full (trackobjects, g_object_unref);
+}
+
+static gboolean
+track_object_in_layer (GESTrackObject * track_object, GESTimelineLayer * layer)
+{
+  gboolean ret;
+  GESTimelineLayer *tckobj_layer;
+  GESTimelineObject *tlobj = ges_track_object_get_timeline_object (track_object);
+
+  if (tlobj == NULL)
+    return FALSE;
+
+  tckobj_layer = ges_timeline_object_get_layer (tlobj);
+  ret = (tckobj_layer == layer);
+  if (tckobj_layer)
+    g_object_unref (tckobj_layer);
+
+  return ret;
 }
 
 static void
-track_object_changed_cb (GESTrackObject * track_object,
-    GParamSpec * arg G_GNUC_UNUSED)
+track_object_removed_cb (GESTrack * track, GESTrackObject * track_object,
+    GESTimelineLayer * layer)
 {
-  if (G_LIKELY (GES_IS_TRACK_SOURCE (track_object)))
-    calculate_transitions (track_object);
+  GList *transitions, *tmp;
+
+  if (!g_hash_table_lookup (layer->priv->tckobjs_iters, track_object))
+    return;
+
+  /* Only the transitions around a source depend on it, removing a
+   * transition must not cascade to its neighbours.
+   * Removing the transitions modifies the index, so collect them first */
+  if (GES_IS_TRACK_SOURCE (track_object))
+    transitions = get_surrounding_transitions (track_object, layer);
+  else
+    transitions = NULL;
+  unindex_track_object (layer, track_object);
+
+  for (tmp = transitions; tmp; tmp = tmp->next) {
+    ges_track_enable_update (track, FALSE);
+    ges_timeline_layer_remove_object (layer, tmp->data);
+    ges_track_enable_update (track, TRUE);
+  }
+  g_list_free (transitions);
 }
 
 static void
 track_object_added_cb (GESTrack * track, GESTrackObject * track_object,
     GESTimelineLayer * layer)
 {
-  if (GES_IS_TRACK_SOURCE (track_object)) {
-    g_signal_connect (G_OBJECT (track_object), "notify::start",
-        G_CALLBACK (track_object_changed_cb), NULL);
-    g_signal_connect (G_OBJECT (track_object), "notify::duration",
-        G_CALLBACK (track_object_duration_cb), NULL);
-    calculate_transitions (track_object);
-  }
+  if (!track_object_in_layer (track_object, layer))
+    return;
+
+  index_track_object (layer, track_object);
 
+  if (GES_IS_TRACK_SOURCE (track_object))
+    calculate_transitions (track_object, layer);
 }
 
 static void
-track_removed_cb (GESTrack * track, GESTrackObject * track_object,
+track_removed_cb (GESTimeline * timeline, GESTrack * track,
     GESTimelineLayer * layer)
 {
+  GSequence *tckobjs;
+  GSequenceIter *iter;
+
   g_signal_handlers_disconnect_by_func (track, track_object_added_cb, layer);
-  g_signal_handlers_disconnect_by_func (track, track_object_removed_cb, NULL);
+  g_signal_handlers_disconnect_by_func (track, track_object_removed_cb, layer);
+
+  tckobjs = g_hash_table_lookup (layer->priv->tckobjs_by_track, track);
+  if (tckobjs == NULL)
+    return;
+
+  while (!g_sequence_iter_is_end ((iter =
+              g_sequence_get_begin_iter (tckobjs))))
+    unindex_track_object (layer, g_sequence_get (iter));
+
+  g_hash_table_remove (layer->priv->tckobjs_by_track, track);
 }
 
 static void
-track_added_cb (GESTrack * track, GESTrackObject * track_object,
+track_added_cb (GESTimeline * timeline, GESTrack * track,
     GESTimelineLayer * layer)
 {
   g_signal_connect (track, "track-object-removed",
-      (GCallback) track_object_removed_cb, NULL);
+      (GCallback) track_object_removed_cb, layer);
   g_signal_connect (track, "track-object-added",
-      (GCallback) track_object_added_cb, NULL);
+      (GCallback) track_object_added_cb, layer);
 }
 
 static void
@@ -687,14 +808,62 @@ start_calculating_transitions (GESTimelineLayer * layer)
     g_signal_connect (G_OBJECT (tmp->data), "track-object-added",
         G_CALLBACK (track_object_added_cb), layer);
     g_signal_connect (G_OBJECT (tmp->data), "track-object-removed",
-        G_CALLBACK (track_object_removed_cb), NULL);
+        G_CALLBACK (track_object_removed_cb), layer);
   }
 
   g_list_free_full (tracks, g_object_unref);
 
+  /* Index the objects we already contain */
+  for (tmp = layer->priv->objects_start; tmp; tmp = tmp->next)
+    index_timeline_object (layer, tmp->data, TRUE);
+
   /* FIXME calculate all the transitions at that time */
 }
 
+static void
+stop_calculating_transitions (GESTimelineLayer * layer)
+{
+  GList *tmp, *tracks = ges_timeline_get_tracks (layer->timeline);
+
+  g_signal_handlers_disconnect_by_func (layer->timeline, track_added_cb,
+      layer);
+  g_signal_handlers_disconnect_by_func (layer->timeline, track_removed_cb,
+      layer);
+
+  /* Also drops the index of the track */
+  for (tmp = tracks; tmp; tmp = tmp->next)
+    track_removed_cb (layer->timeline, tmp->data, layer);
+
+  g_list_free_full (tracks, g_object_unref);
+}
+
+/* Makes @object ours, the caller keeps objects_start sorted */
+static void
+take_object (GESTimelineLayer * layer, GESTimelineObject * object)
+{
+  guint32 maxprio, minprio, prio;
+
+  /* Inform the object it's now in this layer */
+  ges_timeline_object_set_layer (object, layer);
+
+  GST_DEBUG ("current object priority : %d, layer min/max : %d/%d",
+      GES_TIMELINE_OBJECT_PRIORITY (object),
+      layer->min_gnl_priority, layer->max_gnl_priority);
+
+  /* Set the priority. */
+  maxprio = layer->max_gnl_priority;
+  minprio = layer->min_gnl_priority;
+  prio = GES_TIMELINE_OBJECT_PRIORITY (object);
+  if (minprio + prio > (maxprio)) {
+    GST_WARNING ("%p is out of the layer %p space, setting its priority to "
+        "setting its priority %d to failthe maximum priority of the layer %d",
+        object, layer, prio, maxprio - minprio);
+    ges_timeline_object_set_priority (object, LAYER_HEIGHT - 1);
+  }
+  /* If the object has an acceptable priority, we just let it with its current
+   * priority */
+}
+
 /* Public methods */
 /**
  * ges_timeline_layer_remove_object:
@@ -746,6 +915,10 @@ ges_timeline_layer_remove_object (GESTimelineLayer * layer,
   /* emit 'object-removed' */
   g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_REMOVED], 0, object);
 
+  /* The track objects of an object moving to another layer stay in their
+   * track, but are not ours anymore */
+  index_timeline_object (layer, object, FALSE);
+
   /* inform the object it's no longer in a layer */
   ges_timeline_object_set_layer (object, NULL);
 
@@ -815,7 +988,7 @@ ges_timeline_layer_set_auto_transition (GESTimelineLayer * layer,
 
   g_return_if_fail (GES_IS_TIMELINE_LAYER (layer));
 
-  if (auto_transition && layer->timeline)
+  if (auto_transition && !layer->priv->auto_transition && layer->timeline)
     start_calculating_transitions (layer);
 
   layer->priv->auto_transition = auto_transition;
@@ -913,7 +1086,6 @@ ges_timeline_layer_add_object (GESTimelineLayer * layer,
     GESTimelineObject * object)
 {
   GESTimelineLayer *tl_obj_layer;
-  guint32 maxprio, minprio, prio;
 
   GST_DEBUG ("layer:%p, object:%p", layer, object);
 
@@ -932,32 +1104,140 @@ ges_timeline_layer_add_object (GESTimelineLayer * layer,
       g_list_insert_sorted (layer->priv->objects_start, object,
       (GCompareFunc) objects_start_compare);
 
-  /* Inform the object it's now in this layer */
-  ges_timeline_object_set_layer (object, layer);
+  take_object (layer, object);
 
-  GST_DEBUG ("current object priority : %d, layer min/max : %d/%d",
-      GES_TIMELINE_OBJECT_PRIORITY (object),
-      layer->min_gnl_priority, layer->max_gnl_priority);
+  ges_timeline_layer_resync_priorities (layer);
 
-  /* Set the priority. */
-  maxprio = layer->max_gnl_priority;
-  minprio = layer->min_gnl_priority;
-  prio = GES_TIMELINE_OBJECT_PRIORITY (object);
-  if (minprio + prio > (maxprio)) {
-    GST_WARNING ("%p is out of the layer %p space, setting its priority to "
-        "setting its priority %d to failthe maximum priority of the layer %d",
-        object, layer, prio, maxprio - minprio);
-    ges_timeline_object_set_priority (object, LAYER_HEIGHT - 1);
+  /* Objects moving from another layer already have their track objects
+   * in the tracks */
+  if (layer->priv->auto_transition && layer->timeline)
+    index_timeline_object (layer, object, TRUE);
+
+  /* emit 'object-added' */
+  g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_ADDED], 0, object);
+
+  return TRUE;
+}
+
+/**
+ * ges_timeline_layer_add_objects:
+ * @layer: a #GESTimelineLayer
+ * @objects: (transfer container) (element-type GESTimelineObject): the
+ * #GESTimelineObject-s to add
+ *
+ * Adds all the @objects to @layer at once, taking ownership of them as
+ * ges_timeline_layer_add_object() does.
+ *
+ * This is much faster than adding the objects one by one when there are a
+ * lot of them: the batch is sorted once and merged into the layer, the
+ * priorities are resynced once, and if @layer is in a #GESTimeline, the
+ * #GESTrackObject-s of all the @objects are created inside a single
+ * ges_timeline_begin_edit() / ges_timeline_commit_edit() batch so the
+ * tracks are resorted and their compositions updated only once.
+ *
+ * The ::object-added signal is emitted for each object, by increasing
+ * start.
+ *
+ * Returns: %TRUE if the objects were added to the layer, or %FALSE if one
+ * of them already belongs to a layer or is in @objects more than once, in
+ * which case none is added.
+ *
+ * Since: 0.10.XX
+ */
+gboolean
+ges_timeline_layer_add_objects (GESTimelineLayer * layer, GList * objects)
+{
+  GESTimelineLayerPrivate *priv;
+  GESTimelineLayer *tl_obj_layer;
+  GList *tmp, *merged = NULL, *current, *batch;
+  GHashTable *seen;
+  GESTimeline *timeline;
+
+  g_return_val_if_fail (GES_IS_TIMELINE_LAYER (layer), FALSE);
+
+  GST_DEBUG ("layer:%p, %u objects", layer, g_list_length (objects));
+
+  /* Nothing is taken unless the whole batch can be added */
+  seen = g_hash_table_new (NULL, NULL);
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    if (G_UNLIKELY (!GES_IS_TIMELINE_OBJECT (tmp->data))) {
+      g_critical ("%s: %p is not a GESTimelineObject", G_STRFUNC, tmp->data);
+      goto fail;
+    }
+
+    if (G_UNLIKELY (g_hash_table_contains (seen, tmp->data))) {
+      GST_WARNING ("TimelineObject %p is in the batch more than once",
+          tmp->data);
+      goto fail;
+    }
+    g_hash_table_add (seen, tmp->data);
+
+    tl_obj_layer = ges_timeline_object_get_layer (tmp->data);
+    if (G_UNLIKELY (tl_obj_layer)) {
+      GST_WARNING ("TimelineObject %p already belongs to another layer",
+          tmp->data);
+      g_object_unref (tl_obj_layer);
+      goto fail;
+    }
   }
-  /* If the object has an acceptable priority, we just let it with its current
-   * priority */
+  g_hash_table_unref (seen);
+
+  timeline = layer->timeline;
+  priv = layer->priv;
+
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    g_object_ref_sink (tmp->data);
+    take_object (layer, tmp->data);
+  }
+
+  /* Merge the sorted batch with the objects we already have */
+  objects = g_list_sort (objects, (GCompareFunc) objects_start_compare);
+
+  current = priv->objects_start;
+  batch = objects;
+  while (current && batch) {
+    if (objects_start_compare (batch->data, current->data) < 0) {
+      merged = g_list_prepend (merged, batch->data);
+      batch = batch->next;
+    } else {
+      merged = g_list_prepend (merged, current->data);
+      current = current->next;
+    }
+  }
+  for (; current; current = current->next)
+    merged = g_list_prepend (merged, current->data);
+  for (; batch; batch = batch->next)
+    merged = g_list_prepend (merged, batch->data);
+
+  g_list_free (priv->objects_start);
+  priv->objects_start = g_list_reverse (merged);
 
   ges_timeline_layer_resync_priorities (layer);
 
-  /* emit 'object-added' */
-  g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_ADDED], 0, object);
+  /* The tracks are only resorted once all the track objects exist */
+  if (timeline)
+    ges_timeline_begin_edit (timeline);
+
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    if (priv->auto_transition && timeline)
+      index_timeline_object (layer, tmp->data, TRUE);
+
+    g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_ADDED], 0,
+        tmp->data);
+  }
+
+  if (timeline)
+    ges_timeline_commit_edit (timeline);
+
+  g_list_free (objects);
 
   return TRUE;
+
+fail:
+  g_hash_table_unref (seen);
+  g_list_free (objects);
+
+  return FALSE;
 }
 
 /**
@@ -997,12 +1277,8 @@ ges_timeline_layer_set_timeline (GESTimelineLayer * layer,
   GST_DEBUG ("layer:%p, timeline:%p", layer, timeline);
 
   if (layer->priv->auto_transition == TRUE) {
-    if (layer->timeline != NULL) {
-      g_signal_handlers_disconnect_by_func (layer->timeline, track_added_cb,
-          layer);
-      g_signal_handlers_disconnect_by_func (layer->timeline, track_removed_cb,
-          layer);
-    }
+    if (layer->timeline != NULL)
+      stop_calculating_transitions (layer);
 
     layer->timeline = timeline;
     if (timeline != NULL)
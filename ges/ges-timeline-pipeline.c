@@ -29,12 +29,19 @@
 
 #include <gst/gst.h>
 #include <stdio.h>
+#include <string.h>
 #include "ges-internal.h"
 #include "ges-timeline-pipeline.h"
 #include "ges-screenshot.h"
 
 #define DEFAULT_TIMELINE_MODE  TIMELINE_MODE_PREVIEW
 
+/* How far ahead of the position the sources of tracks with
+ * GESTrack:lazy-elements get their elements created, and how often the
+ * position is checked while playing */
+#define MATERIALIZATION_LOOKAHEAD (10 * GST_SECOND)
+#define MATERIALIZATION_INTERVAL  500
+
 /* Structure corresponding to a timeline - sink link */
 
 typedef struct
@@ -44,6 +51,10 @@ typedef struct
   GstPad *srcpad;               /* Timeline source pad */
   GstPad *playsinkpad;
   GstPad *encodebinpad;
+  GstPad *playsink_teepad;      /* Tee source pads feeding the branches */
+  GstPad *encodebin_teepad;
+  GstElement *thumbbranch;      /* The thumbnail sink or a fakesink */
+  GstPad *thumbbranch_teepad;
   GstPad *blocked_pad;
   gulong probe_id;
 } OutputChain;
@@ -57,16 +68,29 @@ struct _GESTimelinePipelinePrivate
   GstElement *encodebin;
   /* Note : urisink is only created when a URI has been provided */
   GstElement *urisink;
+  /* Note : thumbsink is only created when the thumbnail mode is used */
+  GstElement *thumbsink;
+  GstElement *thumbcapsfilter;
+  GstElement *thumbappsink;
 
   GESPipelineFlags mode;
 
   GList *chains;
 
   GstEncodingProfile *profile;
+
+  /* The materialization window set on the lazy tracks, and the rate of the
+   * last seek which tells in which direction it has to look ahead */
+  GstClockTime window_start;
+  GstClockTime window_stop;
+  gdouble rate;
+  guint window_source;
 };
 
 static GstStateChangeReturn ges_timeline_pipeline_change_state (GstElement *
     element, GstStateChange transition);
+static gboolean ges_timeline_pipeline_send_event (GstElement * element,
+    GstEvent * event);
 
 static OutputChain *get_output_chain_for_track (GESTimelinePipeline * self,
     GESTrack * track);
@@ -80,6 +104,11 @@ ges_timeline_pipeline_dispose (GObject * object)
 {
   GESTimelinePipeline *self = GES_TIMELINE_PIPELINE (object);
 
+  if (self->priv->window_source) {
+    g_source_remove (self->priv->window_source);
+    self->priv->window_source = 0;
+  }
+
   if (self->priv->playsink) {
     if (self->priv->mode & (TIMELINE_MODE_PREVIEW))
       gst_bin_remove (GST_BIN (object), self->priv->playsink);
@@ -96,6 +125,14 @@ ges_timeline_pipeline_dispose (GObject * object)
     self->priv->encodebin = NULL;
   }
 
+  if (self->priv->thumbsink) {
+    /* We always keep a reference on it */
+    if (self->priv->mode & TIMELINE_MODE_THUMBNAIL)
+      gst_bin_remove (GST_BIN (object), self->priv->thumbsink);
+    gst_object_unref (self->priv->thumbsink);
+    self->priv->thumbsink = NULL;
+  }
+
   if (self->priv->profile) {
     gst_encoding_profile_unref (self->priv->profile);
     self->priv->profile = NULL;
@@ -116,6 +153,8 @@ ges_timeline_pipeline_class_init (GESTimelinePipelineClass * klass)
 
   element_class->change_state =
       GST_DEBUG_FUNCPTR (ges_timeline_pipeline_change_state);
+  element_class->send_event =
+      GST_DEBUG_FUNCPTR (ges_timeline_pipeline_send_event);
 
   /* TODO : Add state_change handlers
    * Don't change state if we don't have a timeline */
@@ -130,6 +169,11 @@ ges_timeline_pipeline_init (GESTimelinePipeline * self)
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_TIMELINE_PIPELINE, GESTimelinePipelinePrivate);
 
+  self->priv->window_start = 0;
+  self->priv->window_stop = GST_CLOCK_TIME_NONE;
+  self->priv->rate = 1.0;
+  self->priv->window_source = 0;
+
   self->priv->playsink =
       gst_element_factory_make ("playsink", "internal-sinks");
   self->priv->encodebin =
@@ -214,6 +258,9 @@ ges_timeline_pipeline_update_caps (GESTimelinePipeline * self)
         if (self->priv->mode == TIMELINE_MODE_SMART_RENDER) {
           GstCaps *ocaps, *rcaps;
 
+          /* The track will let the file sources playing alone output the
+           * compressed format, encodebin only reencodes the GOPs around
+           * cuts and decoded segments */
           GST_DEBUG ("Smart Render mode, setting input caps");
           ocaps = gst_encoding_profile_get_input_caps (prof);
           if (track->type == GES_TRACK_TYPE_AUDIO)
@@ -222,6 +269,7 @@ ges_timeline_pipeline_update_caps (GESTimelinePipeline * self)
             rcaps = gst_caps_new_empty_simple ("video/x-raw");
           gst_caps_append (ocaps, rcaps);
           ges_track_set_caps (track, ocaps);
+          gst_caps_unref (ocaps);
         } else {
           GstCaps *caps = NULL;
 
@@ -251,6 +299,98 @@ ges_timeline_pipeline_update_caps (GESTimelinePipeline * self)
   return TRUE;
 }
 
+/* Moves the materialization window of the lazy tracks around @position,
+ * looking ahead in the playback direction */
+static void
+move_materialization_window (GESTimelinePipeline * self,
+    GstClockTime position)
+{
+  GList *tracks, *tmp;
+
+  if (self->priv->timeline == NULL)
+    return;
+
+  if (self->priv->rate < 0) {
+    self->priv->window_start = position > MATERIALIZATION_LOOKAHEAD ?
+        position - MATERIALIZATION_LOOKAHEAD : 0;
+    self->priv->window_stop = position + 1;
+  } else {
+    self->priv->window_start = position;
+    self->priv->window_stop = position + MATERIALIZATION_LOOKAHEAD;
+  }
+
+  GST_DEBUG_OBJECT (self, "Moving the materialization window to %"
+      GST_TIME_FORMAT " -- %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (self->priv->window_start),
+      GST_TIME_ARGS (self->priv->window_stop));
+
+  tracks = ges_timeline_get_tracks (self->priv->timeline);
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    GESTrack *track = (GESTrack *) tmp->data;
+
+    if (ges_track_get_lazy_elements (track))
+      ges_track_set_materialization_window (track, self->priv->window_start,
+          self->priv->window_stop);
+    gst_object_unref (track);
+  }
+  g_list_free (tracks);
+}
+
+static gboolean
+materialization_window_cb (GESTimelinePipeline * self)
+{
+  gint64 position;
+  GstClockTime margin = MATERIALIZATION_LOOKAHEAD / 2;
+
+  if (!gst_element_query_position (GST_ELEMENT_CAST (self), GST_FORMAT_TIME,
+          &position) || position < 0)
+    return TRUE;
+
+  /* Only move it once the position got close to its edge, so that the
+   * tracks update a whole batch of objects at once */
+  if (self->priv->rate < 0) {
+    if (position > self->priv->window_stop ||
+        position < self->priv->window_start + margin)
+      move_materialization_window (self, position);
+  } else if (position < self->priv->window_start ||
+      position + margin > self->priv->window_stop) {
+    move_materialization_window (self, position);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+ges_timeline_pipeline_send_event (GstElement * element, GstEvent * event)
+{
+  GESTimelinePipeline *self = GES_TIMELINE_PIPELINE (element);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK) {
+    gdouble rate;
+    GstFormat format;
+    GstSeekFlags flags;
+    GstSeekType start_type, stop_type;
+    gint64 start, stop;
+
+    gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
+        &stop_type, &stop);
+
+    /* Create the elements around the seek target before the composition
+     * gets there */
+    if (format == GST_FORMAT_TIME) {
+      self->priv->rate = rate;
+      if (rate < 0 && stop_type == GST_SEEK_TYPE_SET && stop >= 0)
+        move_materialization_window (self, stop);
+      else if (rate > 0 && start_type == GST_SEEK_TYPE_SET && start >= 0)
+        move_materialization_window (self, start);
+    }
+  }
+
+  return
+      GST_ELEMENT_CLASS (ges_timeline_pipeline_parent_class)->send_event
+      (element, event);
+}
+
 static GstStateChangeReturn
 ges_timeline_pipeline_change_state (GstElement * element,
     GstStateChange transition)
@@ -277,7 +417,19 @@ ges_timeline_pipeline_change_state (GstElement * element,
         goto done;
       }
       /* Set caps on all tracks according to profile if present */
-      /* FIXME : Add a new SMART_RENDER mode to avoid decoding */
+      self->priv->rate = 1.0;
+      move_materialization_window (self, 0);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
+      if (self->priv->window_source == 0)
+        self->priv->window_source = g_timeout_add (MATERIALIZATION_INTERVAL,
+            (GSourceFunc) materialization_window_cb, self);
+      break;
+    case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
+      if (self->priv->window_source) {
+        g_source_remove (self->priv->window_source);
+        self->priv->window_source = 0;
+      }
       break;
     default:
       break;
@@ -391,6 +543,320 @@ pad_blocked (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
   return GST_PAD_PROBE_OK;
 }
 
+/* Links @chain to a new sink pad of playsink */
+static gboolean
+chain_link_playsink (GESTimelinePipeline * self, OutputChain * chain)
+{
+  const gchar *sinkpad_name;
+  GstPad *sinkpad, *teepad;
+
+  switch (chain->track->type) {
+    case GES_TRACK_TYPE_VIDEO:
+      sinkpad_name = "video_sink";
+      break;
+    case GES_TRACK_TYPE_AUDIO:
+      sinkpad_name = "audio_sink";
+      break;
+    case GES_TRACK_TYPE_TEXT:
+      sinkpad_name = "text_sink";
+      break;
+    default:
+      GST_WARNING_OBJECT (self, "Can't handle tracks of type %d yet",
+          chain->track->type);
+      return FALSE;
+  }
+
+  /* Request a sinkpad from playsink */
+  if (G_UNLIKELY (!(sinkpad =
+              gst_element_get_request_pad (self->priv->playsink,
+                  sinkpad_name)))) {
+    GST_ERROR_OBJECT (self, "Couldn't get a pad from the playsink !");
+    return FALSE;
+  }
+
+  teepad = gst_element_get_request_pad (chain->tee, "src_%u");
+  if (G_UNLIKELY (gst_pad_link_full (teepad, sinkpad,
+              GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
+    GST_ERROR_OBJECT (self, "Couldn't link track pad to playsink");
+    gst_element_release_request_pad (chain->tee, teepad);
+    gst_object_unref (teepad);
+    gst_element_release_request_pad (self->priv->playsink, sinkpad);
+    gst_object_unref (sinkpad);
+    return FALSE;
+  }
+
+  /* We still hold a reference on both pads */
+  chain->playsinkpad = sinkpad;
+  chain->playsink_teepad = teepad;
+
+  return TRUE;
+}
+
+/* Links @chain to encodebin, reusing the encodebin pad from a previous
+ * link if any */
+static gboolean
+chain_link_encodebin (GESTimelinePipeline * self, OutputChain * chain)
+{
+  GstPad *sinkpad, *teepad;
+
+  if (!chain->encodebinpad) {
+    /* Check for unused static pads */
+    sinkpad = get_compatible_unlinked_pad (self->priv->encodebin,
+        chain->srcpad);
+
+    if (sinkpad == NULL) {
+      GstCaps *caps = gst_pad_query_caps (chain->srcpad, NULL);
+
+      /* If no compatible static pad is available, request a pad */
+      g_signal_emit_by_name (self->priv->encodebin, "request-pad", caps,
+          &sinkpad);
+      gst_caps_unref (caps);
+
+      if (G_UNLIKELY (sinkpad == NULL)) {
+        GST_ERROR_OBJECT (self, "Couldn't get a pad from encodebin !");
+        return FALSE;
+      }
+    }
+    chain->encodebinpad = sinkpad;
+  }
+
+  teepad = gst_element_get_request_pad (chain->tee, "src_%u");
+  if (G_UNLIKELY (gst_pad_link_full (teepad,
+              chain->encodebinpad,
+              GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
+    GST_WARNING_OBJECT (self, "Couldn't link track pad to encodebin");
+    gst_element_release_request_pad (chain->tee, teepad);
+    gst_object_unref (teepad);
+    return FALSE;
+  }
+  chain->encodebin_teepad = teepad;
+
+  return TRUE;
+}
+
+typedef struct
+{
+  GstPad *sinkpad;
+
+  GMutex lock;
+  GCond cond;
+  gboolean unlinked;
+} TeePadUnlink;
+
+static GstPadProbeReturn
+tee_pad_idle (GstPad * teepad, GstPadProbeInfo * info, TeePadUnlink * data)
+{
+  GST_DEBUG_OBJECT (teepad, "idle, unlinking");
+
+  gst_pad_unlink (teepad, data->sinkpad);
+
+  g_mutex_lock (&data->lock);
+  data->unlinked = TRUE;
+  g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->lock);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+/* Unlinks @teepad from @sinkpad once nothing is pushed through it anymore,
+ * then releases @teepad.
+ *
+ * The pipeline might be running. A streaming thread waiting downstream of
+ * @teepad, for example for the sink to preroll, is woken up by flushing the
+ * branch, which is going away anyway. The idle probe is called right away
+ * if nothing is being pushed, or as soon as the current push returns. The
+ * pipeline has to be resynchronized with a flushing seek afterwards, see
+ * ges_timeline_pipeline_set_mode(). */
+static void
+unlink_tee_pad (OutputChain * chain, GstPad * teepad, GstPad * sinkpad)
+{
+  TeePadUnlink data;
+
+  GST_DEBUG_OBJECT (teepad, "flushing and unlinking pad");
+
+  data.sinkpad = sinkpad;
+  data.unlinked = FALSE;
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+
+  gst_pad_send_event (sinkpad, gst_event_new_flush_start ());
+  gst_pad_add_probe (teepad, GST_PAD_PROBE_TYPE_IDLE,
+      (GstPadProbeCallback) tee_pad_idle, &data, NULL);
+
+  g_mutex_lock (&data.lock);
+  while (!data.unlinked)
+    g_cond_wait (&data.cond, &data.lock);
+  g_mutex_unlock (&data.lock);
+
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+
+  gst_element_release_request_pad (chain->tee, teepad);
+  gst_object_unref (teepad);
+}
+
+static void
+chain_unlink_playsink (GESTimelinePipeline * self, OutputChain * chain)
+{
+  if (chain->playsinkpad == NULL)
+    return;
+
+  if (chain->blocked_pad) {
+    GST_DEBUG_OBJECT (chain->blocked_pad, "unblocking pad");
+    if (chain->probe_id)
+      gst_pad_remove_probe (chain->blocked_pad, chain->probe_id);
+    gst_object_unref (chain->blocked_pad);
+    chain->blocked_pad = NULL;
+    chain->probe_id = 0;
+  }
+
+  unlink_tee_pad (chain, chain->playsink_teepad, chain->playsinkpad);
+  chain->playsink_teepad = NULL;
+
+  gst_element_release_request_pad (self->priv->playsink, chain->playsinkpad);
+  gst_object_unref (chain->playsinkpad);
+  chain->playsinkpad = NULL;
+}
+
+/* The encodebin pad is kept so that it can be reused if we link to
+ * encodebin again */
+static void
+chain_unlink_encodebin (GESTimelinePipeline * self, OutputChain * chain)
+{
+  if (chain->encodebin_teepad == NULL)
+    return;
+
+  unlink_tee_pad (chain, chain->encodebin_teepad, chain->encodebinpad);
+  chain->encodebin_teepad = NULL;
+}
+
+/* videoconvert ! videoscale ! capsfilter ! appsink, the scaling is done once
+ * in the pipeline and the application pulls the prerolled samples */
+static GstElement *
+get_thumbnail_sink (GESTimelinePipeline * self)
+{
+  GstPad *pad;
+  GstElement *convert, *scale;
+
+  if (self->priv->thumbsink)
+    return self->priv->thumbsink;
+
+  convert = gst_element_factory_make ("videoconvert", NULL);
+  scale = gst_element_factory_make ("videoscale", NULL);
+  self->priv->thumbcapsfilter = gst_element_factory_make ("capsfilter", NULL);
+  self->priv->thumbappsink = gst_element_factory_make ("appsink", NULL);
+
+  if (G_UNLIKELY (!convert || !scale || !self->priv->thumbcapsfilter ||
+          !self->priv->thumbappsink)) {
+    GST_ERROR_OBJECT (self, "Can't create the thumbnail sink elements !");
+    if (convert)
+      gst_object_unref (convert);
+    if (scale)
+      gst_object_unref (scale);
+    if (self->priv->thumbcapsfilter)
+      gst_object_unref (self->priv->thumbcapsfilter);
+    if (self->priv->thumbappsink)
+      gst_object_unref (self->priv->thumbappsink);
+    self->priv->thumbcapsfilter = self->priv->thumbappsink = NULL;
+
+    return NULL;
+  }
+
+  /* We only ever pull the prerolled sample */
+  g_object_set (self->priv->thumbappsink, "sync", FALSE, "max-buffers", 1,
+      "enable-last-sample", FALSE, NULL);
+
+  self->priv->thumbsink = gst_bin_new ("internal-thumbnailsink");
+  gst_bin_add_many (GST_BIN (self->priv->thumbsink), convert, scale,
+      self->priv->thumbcapsfilter, self->priv->thumbappsink, NULL);
+  gst_element_link_many (convert, scale, self->priv->thumbcapsfilter,
+      self->priv->thumbappsink, NULL);
+
+  pad = gst_element_get_static_pad (convert, "sink");
+  gst_element_add_pad (self->priv->thumbsink, gst_ghost_pad_new ("sink", pad));
+  gst_object_unref (pad);
+
+  /* Keep our own reference, it is only in the pipeline in thumbnail mode */
+  gst_object_ref_sink (self->priv->thumbsink);
+
+  return self->priv->thumbsink;
+}
+
+/* Links @chain to the thumbnail sink if it is the first video track, the
+ * other tracks are linked to a fakesink so that they do not return
+ * not-linked */
+static gboolean
+chain_link_thumbnail (GESTimelinePipeline * self, OutputChain * chain)
+{
+  GstPad *sinkpad, *teepad;
+  GstElement *branch = NULL;
+
+  if (chain->track->type == GES_TRACK_TYPE_VIDEO) {
+    sinkpad = gst_element_get_static_pad (self->priv->thumbsink, "sink");
+    if (!gst_pad_is_linked (sinkpad))
+      branch = gst_object_ref (self->priv->thumbsink);
+    gst_object_unref (sinkpad);
+  }
+
+  if (branch == NULL) {
+    GST_DEBUG_OBJECT (self, "Linking track %p to a fakesink", chain->track);
+
+    branch = gst_element_factory_make ("fakesink", NULL);
+    if (G_UNLIKELY (branch == NULL)) {
+      GST_ERROR_OBJECT (self, "Couldn't create fakesink");
+      return FALSE;
+    }
+
+    gst_object_ref_sink (branch);
+    g_object_set (branch, "sync", FALSE, "async", FALSE, NULL);
+    gst_bin_add (GST_BIN_CAST (self), branch);
+  }
+
+  sinkpad = gst_element_get_static_pad (branch, "sink");
+  teepad = gst_element_get_request_pad (chain->tee, "src_%u");
+  if (G_UNLIKELY (gst_pad_link_full (teepad, sinkpad,
+              GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
+    GST_WARNING_OBJECT (self, "Couldn't link track pad to thumbnail sink");
+    gst_object_unref (sinkpad);
+    gst_element_release_request_pad (chain->tee, teepad);
+    gst_object_unref (teepad);
+    if (branch != self->priv->thumbsink)
+      gst_bin_remove (GST_BIN_CAST (self), branch);
+    gst_object_unref (branch);
+    return FALSE;
+  }
+  gst_object_unref (sinkpad);
+
+  chain->thumbbranch = branch;
+  chain->thumbbranch_teepad = teepad;
+
+  if (branch != self->priv->thumbsink)
+    gst_element_sync_state_with_parent (branch);
+
+  return TRUE;
+}
+
+static void
+chain_unlink_thumbnail (GESTimelinePipeline * self, OutputChain * chain)
+{
+  GstPad *sinkpad;
+
+  if (chain->thumbbranch == NULL)
+    return;
+
+  sinkpad = gst_element_get_static_pad (chain->thumbbranch, "sink");
+  unlink_tee_pad (chain, chain->thumbbranch_teepad, sinkpad);
+  gst_object_unref (sinkpad);
+  chain->thumbbranch_teepad = NULL;
+
+  if (chain->thumbbranch != self->priv->thumbsink) {
+    gst_bin_remove (GST_BIN_CAST (self), chain->thumbbranch);
+    gst_element_set_state (chain->thumbbranch, GST_STATE_NULL);
+  }
+  gst_object_unref (chain->thumbbranch);
+  chain->thumbbranch = NULL;
+}
+
 static void
 pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
 {
@@ -417,6 +883,7 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
   /* Don't connect track if it's not going to be used */
   if (track->type == GES_TRACK_TYPE_VIDEO &&
       !(self->priv->mode & TIMELINE_MODE_PREVIEW_VIDEO) &&
+      !(self->priv->mode & TIMELINE_MODE_THUMBNAIL) &&
       !(self->priv->mode & TIMELINE_MODE_RENDER) &&
       !(self->priv->mode & TIMELINE_MODE_SMART_RENDER)) {
     GST_DEBUG_OBJECT (self, "Video track... but we don't need it. Not linking");
@@ -445,91 +912,37 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
 
   /* Connect playsink */
   if (self->priv->mode & TIMELINE_MODE_PREVIEW) {
-    const gchar *sinkpad_name;
-    GstPad *tmppad;
-
     GST_DEBUG_OBJECT (self, "Connecting to playsink");
 
-    switch (track->type) {
-      case GES_TRACK_TYPE_VIDEO:
-        sinkpad_name = "video_sink";
-        break;
-      case GES_TRACK_TYPE_AUDIO:
-        sinkpad_name = "audio_sink";
-        break;
-      case GES_TRACK_TYPE_TEXT:
-        sinkpad_name = "text_sink";
-        break;
-      default:
-        GST_WARNING_OBJECT (self, "Can't handle tracks of type %d yet",
-            track->type);
-        goto error;
-    }
-
-    /* Request a sinkpad from playsink */
-    if (G_UNLIKELY (!(sinkpad =
-                gst_element_get_request_pad (self->priv->playsink,
-                    sinkpad_name)))) {
-      GST_ERROR_OBJECT (self, "Couldn't get a pad from the playsink !");
+    if (!chain_link_playsink (self, chain))
       goto error;
-    }
 
-    tmppad = gst_element_get_request_pad (chain->tee, "src_%u");
-    if (G_UNLIKELY (gst_pad_link_full (tmppad, sinkpad,
-                GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
-      GST_ERROR_OBJECT (self, "Couldn't link track pad to playsink");
-      gst_object_unref (tmppad);
-      goto error;
-    }
-    chain->blocked_pad = tmppad;
-    GST_DEBUG_OBJECT (tmppad, "blocking pad");
-    chain->probe_id = gst_pad_add_probe (tmppad, GST_PAD_PROBE_TYPE_BLOCK,
-        pad_blocked, NULL, NULL);
+    chain->blocked_pad = gst_object_ref (chain->playsink_teepad);
+    GST_DEBUG_OBJECT (chain->blocked_pad, "blocking pad");
+    chain->probe_id = gst_pad_add_probe (chain->blocked_pad,
+        GST_PAD_PROBE_TYPE_BLOCK, pad_blocked, NULL, NULL);
 
     GST_DEBUG ("Reconfiguring playsink");
 
     /* reconfigure playsink */
     g_signal_emit_by_name (self->priv->playsink, "reconfigure", &reconfigured);
     GST_DEBUG ("'reconfigure' returned %d", reconfigured);
-
-    /* We still hold a reference on the sinkpad */
-    chain->playsinkpad = sinkpad;
   }
 
   /* Connect to encodebin */
   if (self->priv->mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER)) {
-    GstPad *tmppad;
     GST_DEBUG_OBJECT (self, "Connecting to encodebin");
 
-    if (!chain->encodebinpad) {
-      /* Check for unused static pads */
-      sinkpad = get_compatible_unlinked_pad (self->priv->encodebin, pad);
-
-      if (sinkpad == NULL) {
-        GstCaps *caps = gst_pad_query_caps (pad, NULL);
-
-        /* If no compatible static pad is available, request a pad */
-        g_signal_emit_by_name (self->priv->encodebin, "request-pad", caps,
-            &sinkpad);
-        gst_caps_unref (caps);
+    if (!chain_link_encodebin (self, chain))
+      goto error;
+  }
 
-        if (G_UNLIKELY (sinkpad == NULL)) {
-          GST_ERROR_OBJECT (self, "Couldn't get a pad from encodebin !");
-          goto error;
-        }
-      }
-      chain->encodebinpad = sinkpad;
-    }
+  /* Connect to the thumbnail sink */
+  if (self->priv->mode & TIMELINE_MODE_THUMBNAIL) {
+    GST_DEBUG_OBJECT (self, "Connecting to thumbnail sink");
 
-    tmppad = gst_element_get_request_pad (chain->tee, "src_%u");
-    if (G_UNLIKELY (gst_pad_link_full (tmppad,
-                chain->encodebinpad,
-                GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
-      GST_WARNING_OBJECT (self, "Couldn't link track pad to playsink");
+    if (!chain_link_thumbnail (self, chain))
       goto error;
-    }
-    gst_object_unref (tmppad);
-
   }
 
   /* If chain wasn't already present, insert it in list */
@@ -541,11 +954,14 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
 
 error:
   {
+    chain_unlink_playsink (self, chain);
+    chain_unlink_encodebin (self, chain);
     if (chain->tee) {
+      gst_element_set_state (chain->tee, GST_STATE_NULL);
       gst_bin_remove (GST_BIN_CAST (self), chain->tee);
     }
-    if (sinkpad)
-      gst_object_unref (sinkpad);
+    if (chain->encodebinpad)
+      gst_object_unref (chain->encodebinpad);
     g_free (chain);
   }
 }
@@ -571,30 +987,18 @@ pad_removed_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
   }
 
   /* Unlink encodebin */
+  chain_unlink_encodebin (self, chain);
   if (chain->encodebinpad) {
-    peer = gst_pad_get_peer (chain->encodebinpad);
-    gst_pad_unlink (peer, chain->encodebinpad);
-    gst_object_unref (peer);
     gst_element_release_request_pad (self->priv->encodebin,
         chain->encodebinpad);
+    gst_object_unref (chain->encodebinpad);
   }
 
   /* Unlink playsink */
-  if (chain->playsinkpad) {
-    peer = gst_pad_get_peer (chain->playsinkpad);
-    gst_pad_unlink (peer, chain->playsinkpad);
-    gst_object_unref (peer);
-    gst_element_release_request_pad (self->priv->playsink, chain->playsinkpad);
-    gst_object_unref (chain->playsinkpad);
-  }
+  chain_unlink_playsink (self, chain);
 
-  if (chain->blocked_pad) {
-    GST_DEBUG_OBJECT (chain->blocked_pad, "unblocking pad");
-    gst_pad_remove_probe (chain->blocked_pad, chain->probe_id);
-    gst_object_unref (chain->blocked_pad);
-    chain->blocked_pad = NULL;
-    chain->probe_id = 0;
-  }
+  /* Unlink thumbnail sink */
+  chain_unlink_thumbnail (self, chain);
 
   /* Unlike/remove tee */
   peer = gst_element_get_static_pad (chain->tee, "sink");
@@ -654,6 +1058,9 @@ ges_timeline_pipeline_add_timeline (GESTimelinePipeline * pipeline,
   }
   pipeline->priv->timeline = timeline;
 
+  ges_timeline_allow_proxies (timeline, !(pipeline->priv->mode &
+          (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER)));
+
   /* Connect to pipeline */
   g_signal_connect (timeline, "pad-added", (GCallback) pad_added_cb, pipeline);
   g_signal_connect (timeline, "pad-removed", (GCallback) pad_removed_cb,
@@ -723,9 +1130,19 @@ ges_timeline_pipeline_set_render_settings (GESTimelinePipeline * pipeline,
  * switches the @pipeline to the specified @mode. The default mode when
  * creating a #GESTimelinePipeline is #TIMELINE_MODE_PREVIEW.
  *
- * Note: The @pipeline will be set to #GST_STATE_NULL during this call due to
- * the internal changes that happen. The caller will therefore have to 
- * set the @pipeline to the requested state after calling this method.
+ * The preview and rendering branches are linked and unlinked while the
+ * @pipeline keeps running, so the state of the timeline is preserved. If
+ * the @pipeline is in %GST_STATE_PAUSED or %GST_STATE_PLAYING, a flushing
+ * seek to the current position is done so that the newly added branches
+ * preroll. When rendering gets enabled, the seek goes to the start of the
+ * timeline instead, so that the whole timeline is rendered.
+ *
+ * Note: Toggling #TIMELINE_MODE_SMART_RENDER changes the caps of the tracks,
+ * and switching between previewing and rendering a timeline using
+ * #GESTimeline:use-proxies changes the files played. The @pipeline will
+ * therefore be set to #GST_STATE_NULL if it is running in those cases, and
+ * the caller will have to set the @pipeline to the requested state after
+ * calling this method.
  *
  * Returns: %TRUE if the mode was properly set, else %FALSE.
  **/
@@ -733,6 +1150,11 @@ gboolean
 ges_timeline_pipeline_set_mode (GESTimelinePipeline * pipeline,
     GESPipelineFlags mode)
 {
+  GList *tmp;
+  GstState state;
+  gint64 position = -1;
+  gboolean relinked = FALSE, unlinked = FALSE, proxies_changed = FALSE;
+
   GST_DEBUG_OBJECT (pipeline, "current mode : %d, mode : %d",
       pipeline->priv->mode, mode);
 
@@ -740,35 +1162,75 @@ ges_timeline_pipeline_set_mode (GESTimelinePipeline * pipeline,
   if (mode == pipeline->priv->mode)
     return TRUE;
 
-  /* FIXME: It would be nice if we are only (de)activating preview
-   * modes to not set the whole pipeline to NULL, but instead just
-   * do the proper (un)linking to playsink. */
+  gst_element_get_state (GST_ELEMENT_CAST (pipeline), &state, NULL, 0);
+
+  /* Always render the original files */
+  if (pipeline->priv->timeline)
+    proxies_changed = ges_timeline_allow_proxies (pipeline->priv->timeline,
+        !(mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER)));
+
+  if (state > GST_STATE_READY && (proxies_changed ||
+          ((pipeline->priv->mode ^ mode) & TIMELINE_MODE_SMART_RENDER))) {
+    /* The track caps and the sources uris can only be changed when not
+     * running */
+    GST_DEBUG_OBJECT (pipeline, "Smart rendering or proxies toggled, "
+        "resetting pipeline");
+    gst_element_set_state (GST_ELEMENT_CAST (pipeline), GST_STATE_NULL);
+    state = GST_STATE_NULL;
+  }
 
-  /* Switch pipeline to NULL since we're changing the configuration */
-  gst_element_set_state (GST_ELEMENT_CAST (pipeline), GST_STATE_NULL);
+  /* The sinks we might remove are the ones answering the query */
+  if (state >= GST_STATE_PAUSED &&
+      !gst_element_query_position (GST_ELEMENT_CAST (pipeline),
+          GST_FORMAT_TIME, &position))
+    position = -1;
 
   /* remove no-longer needed components */
   if (pipeline->priv->mode & TIMELINE_MODE_PREVIEW &&
       !(mode & TIMELINE_MODE_PREVIEW)) {
     /* Disable playsink */
     GST_DEBUG ("Disabling playsink");
+    for (tmp = pipeline->priv->chains; tmp; tmp = tmp->next)
+      chain_unlink_playsink (pipeline, (OutputChain *) tmp->data);
+    unlinked = TRUE;
+
     g_object_ref (pipeline->priv->playsink);
     gst_bin_remove (GST_BIN_CAST (pipeline), pipeline->priv->playsink);
+    gst_element_set_state (pipeline->priv->playsink, GST_STATE_NULL);
   }
   if ((pipeline->priv->mode &
           (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER)) &&
       !(mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER))) {
     /* Disable render bin */
     GST_DEBUG ("Disabling rendering bin");
+    for (tmp = pipeline->priv->chains; tmp; tmp = tmp->next)
+      chain_unlink_encodebin (pipeline, (OutputChain *) tmp->data);
+    unlinked = TRUE;
+
     g_object_ref (pipeline->priv->encodebin);
     g_object_ref (pipeline->priv->urisink);
     gst_bin_remove_many (GST_BIN_CAST (pipeline),
         pipeline->priv->encodebin, pipeline->priv->urisink, NULL);
+    gst_element_set_state (pipeline->priv->encodebin, GST_STATE_NULL);
+    gst_element_set_state (pipeline->priv->urisink, GST_STATE_NULL);
+  }
+  if (pipeline->priv->mode & TIMELINE_MODE_THUMBNAIL &&
+      !(mode & TIMELINE_MODE_THUMBNAIL)) {
+    /* Disable thumbnail sink */
+    GST_DEBUG ("Disabling thumbnail sink");
+    for (tmp = pipeline->priv->chains; tmp; tmp = tmp->next)
+      chain_unlink_thumbnail (pipeline, (OutputChain *) tmp->data);
+    unlinked = TRUE;
+
+    gst_bin_remove (GST_BIN_CAST (pipeline), pipeline->priv->thumbsink);
+    gst_element_set_state (pipeline->priv->thumbsink, GST_STATE_NULL);
   }
 
   /* Add new elements */
   if (!(pipeline->priv->mode & TIMELINE_MODE_PREVIEW) &&
       (mode & TIMELINE_MODE_PREVIEW)) {
+    gboolean reconfigured = FALSE;
+
     /* Add playsink */
     GST_DEBUG ("Adding playsink");
 
@@ -776,6 +1238,18 @@ ges_timeline_pipeline_set_mode (GESTimelinePipeline * pipeline,
       GST_ERROR_OBJECT (pipeline, "Couldn't add playsink");
       return FALSE;
     }
+
+    for (tmp = pipeline->priv->chains; tmp; tmp = tmp->next) {
+      if (chain_link_playsink (pipeline, (OutputChain *) tmp->data))
+        relinked = TRUE;
+    }
+
+    if (relinked) {
+      g_signal_emit_by_name (pipeline->priv->playsink, "reconfigure",
+          &reconfigured);
+      GST_DEBUG ("'reconfigure' returned %d", reconfigured);
+    }
+    gst_element_sync_state_with_parent (pipeline->priv->playsink);
   }
   if (!(pipeline->priv->mode &
           (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER)) &&
@@ -800,6 +1274,38 @@ ges_timeline_pipeline_set_mode (GESTimelinePipeline * pipeline,
 
     gst_element_link_pads_full (pipeline->priv->encodebin, "src",
         pipeline->priv->urisink, "sink", GST_PAD_LINK_CHECK_NOTHING);
+
+    for (tmp = pipeline->priv->chains; tmp; tmp = tmp->next) {
+      if (chain_link_encodebin (pipeline, (OutputChain *) tmp->data))
+        relinked = TRUE;
+    }
+
+    /* The encoded file has to cover the whole timeline */
+    if (state >= GST_STATE_PAUSED)
+      position = 0;
+
+    /* Downstream first so that the sink is ready to receive data */
+    gst_element_sync_state_with_parent (pipeline->priv->urisink);
+    gst_element_sync_state_with_parent (pipeline->priv->encodebin);
+  }
+  if (!(pipeline->priv->mode & TIMELINE_MODE_THUMBNAIL) &&
+      (mode & TIMELINE_MODE_THUMBNAIL)) {
+    /* Add thumbnail sink */
+    GST_DEBUG ("Adding thumbnail sink");
+
+    if (G_UNLIKELY (get_thumbnail_sink (pipeline) == NULL))
+      return FALSE;
+    if (!gst_bin_add (GST_BIN_CAST (pipeline), pipeline->priv->thumbsink)) {
+      GST_ERROR_OBJECT (pipeline, "Couldn't add thumbnail sink");
+      return FALSE;
+    }
+
+    for (tmp = pipeline->priv->chains; tmp; tmp = tmp->next) {
+      if (chain_link_thumbnail (pipeline, (OutputChain *) tmp->data))
+        relinked = TRUE;
+    }
+
+    gst_element_sync_state_with_parent (pipeline->priv->thumbsink);
   }
 
   /* FIXUPS */
@@ -809,6 +1315,15 @@ ges_timeline_pipeline_set_mode (GESTimelinePipeline * pipeline,
 
   pipeline->priv->mode = mode;
 
+  /* New branches only got the sticky events, make them preroll. Flushing
+   * the removed branches might also have stopped the streaming threads. */
+  if ((relinked || unlinked) && position != -1) {
+    GST_DEBUG_OBJECT (pipeline, "Prerolling branches at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (position));
+    gst_element_seek_simple (GST_ELEMENT_CAST (pipeline), GST_FORMAT_TIME,
+        GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, position);
+  }
+
   return TRUE;
 }
 
@@ -899,6 +1414,125 @@ ges_timeline_pipeline_save_thumbnail (GESTimelinePipeline * self, int width, int
   return res;
 }
 
+static gint
+compare_clock_time (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a, tb = *(const GstClockTime *) b;
+
+  if (ta < tb)
+    return -1;
+  if (ta > tb)
+    return 1;
+  return 0;
+}
+
+/**
+ * ges_timeline_pipeline_generate_thumbnails:
+ * @self: a #GESTimelinePipeline in #TIMELINE_MODE_THUMBNAIL
+ * @caps: (transfer none) (allow-none): caps specifying the format of the
+ * thumbnails, for example video/x-raw,format=RGB,width=160. Use %NULL or
+ * %GST_CAPS_ANY for native format and size.
+ * @timestamps: (array length=n_timestamps): the timestamps to generate
+ * thumbnails for
+ * @n_timestamps: the number of @timestamps
+ * @accurate: %TRUE to get the frame at exactly each timestamp, %FALSE to
+ * get the previous keyframe which is a lot faster
+ * @func: (scope call): the #GESTimelinePipelineThumbnailFunc to call for each
+ * generated thumbnail
+ * @user_data: user data passed to @func
+ *
+ * Generates a thumbnail at each of @timestamps without going through the
+ * preview sinks. The frames are scaled to @caps in the pipeline and @func
+ * is called for each of them, in increasing timestamp order.
+ *
+ * The @self will be set to %GST_STATE_PAUSED if it is not already, and is
+ * left in that state. This method blocks until all the thumbnails are
+ * generated or @func returns %FALSE.
+ *
+ * Returns: %TRUE if all the thumbnails were generated, else %FALSE.
+ */
+gboolean
+ges_timeline_pipeline_generate_thumbnails (GESTimelinePipeline * self,
+    GstCaps * caps, const GstClockTime * timestamps, guint n_timestamps,
+    gboolean accurate, GESTimelinePipelineThumbnailFunc func,
+    gpointer user_data)
+{
+  guint i;
+  GstSeekFlags flags;
+  GstClockTime *sorted;
+  gboolean res = TRUE;
+
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (self), FALSE);
+  g_return_val_if_fail (timestamps != NULL || n_timestamps == 0, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  if (!(self->priv->mode & TIMELINE_MODE_THUMBNAIL)) {
+    GST_WARNING_OBJECT (self, "thumbnails can only be generated in "
+        "TIMELINE_MODE_THUMBNAIL");
+    return FALSE;
+  }
+
+  g_object_set (self->priv->thumbcapsfilter, "caps", caps, NULL);
+
+  if (gst_element_set_state (GST_ELEMENT_CAST (self),
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE ||
+      gst_element_get_state (GST_ELEMENT_CAST (self), NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE) {
+    GST_ERROR_OBJECT (self, "Could not preroll");
+    return FALSE;
+  }
+
+  /* Seeking in order lets the decoders go forward as much as possible */
+  sorted = g_new (GstClockTime, n_timestamps);
+  memcpy (sorted, timestamps, n_timestamps * sizeof (GstClockTime));
+  g_qsort_with_data (sorted, n_timestamps, sizeof (GstClockTime),
+      (GCompareDataFunc) compare_clock_time, NULL);
+
+  flags = GST_SEEK_FLAG_FLUSH;
+  if (accurate)
+    flags |= GST_SEEK_FLAG_ACCURATE;
+  else
+    flags |= GST_SEEK_FLAG_KEY_UNIT;
+
+  for (i = 0; i < n_timestamps; i++) {
+    GstSample *sample = NULL;
+    gboolean cont;
+
+    GST_DEBUG_OBJECT (self, "Generating thumbnail at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (sorted[i]));
+
+    if (!gst_element_seek_simple (GST_ELEMENT_CAST (self), GST_FORMAT_TIME,
+            flags, sorted[i]) ||
+        gst_element_get_state (GST_ELEMENT_CAST (self), NULL, NULL,
+            GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE) {
+      GST_WARNING_OBJECT (self, "Could not seek to %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (sorted[i]));
+      res = FALSE;
+      break;
+    }
+
+    g_signal_emit_by_name (self->priv->thumbappsink, "pull-preroll", &sample);
+    if (G_UNLIKELY (sample == NULL)) {
+      GST_WARNING_OBJECT (self, "No frame at %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (sorted[i]));
+      res = FALSE;
+      break;
+    }
+
+    cont = func (self, sorted[i], sample, user_data);
+    gst_sample_unref (sample);
+
+    if (!cont) {
+      res = FALSE;
+      break;
+    }
+  }
+
+  g_free (sorted);
+
+  return res;
+}
+
 /**
  * ges_timeline_pipeline_get_thumbnail_rgb24:
  * @self: a #GESTimelinePipeline in %GST_STATE_PLAYING or %GST_STATE_PAUSED
@@ -75,6 +75,22 @@ struct _GESTimelinePipelineClass {
   gpointer _ges_reserved[GES_PADDING];
 };
 
+/**
+ * GESTimelinePipelineThumbnailFunc:
+ * @pipeline: the #GESTimelinePipeline generating the thumbnails
+ * @timestamp: the requested timestamp
+ * @sample: (transfer none): the #GstSample of the frame at @timestamp
+ * @user_data: the user data passed to
+ * ges_timeline_pipeline_generate_thumbnails()
+ *
+ * Called for each thumbnail generated by
+ * ges_timeline_pipeline_generate_thumbnails().
+ *
+ * Returns: %FALSE to stop generating thumbnails, %TRUE otherwise.
+ */
+typedef gboolean (*GESTimelinePipelineThumbnailFunc) (GESTimelinePipeline *pipeline,
+    GstClockTime timestamp, GstSample *sample, gpointer user_data);
+
 GType ges_timeline_pipeline_get_type (void);
 
 GESTimelinePipeline* ges_timeline_pipeline_new (void);
@@ -99,6 +115,12 @@ gboolean
 ges_timeline_pipeline_save_thumbnail(GESTimelinePipeline *self,
     int width, int height, const gchar *format, const gchar *location);
 
+gboolean
+ges_timeline_pipeline_generate_thumbnails (GESTimelinePipeline *self,
+    GstCaps *caps, const GstClockTime *timestamps, guint n_timestamps,
+    gboolean accurate, GESTimelinePipelineThumbnailFunc func,
+    gpointer user_data);
+
 GstElement *
 ges_timeline_pipeline_preview_get_video_sink (GESTimelinePipeline * self);
 
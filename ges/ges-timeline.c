@@ -104,11 +104,26 @@ struct _GESTimelinePrivate
   /* The duration of the timeline */
   gint64 duration;
 
-  /* discoverer used for virgin sources */
-  GstDiscoverer *discoverer;
-  GList *pendingobjects;
+  /* discoverers used for virgin sources, created on demand up to
+   * discovery_workers so that several files are probed in parallel */
+  GPtrArray *discoverers;       /* DiscovererWorker-s */
+  guint discovery_workers;
+  /* {uri: GList of GESTimelineFileSource-s waiting for its discovery} */
+  GHashTable *pendingobjects;
   /* lock to avoid discovery of objects that will be removed */
   GMutex pendingobjects_lock;
+  /* Results of previous discoveries */
+  GESDiscoveryCache *discovery_cache;
+
+  /* Preview proxies, see GESTimeline:use-proxies */
+  gboolean use_proxies;
+  /* %FALSE while rendering, the original files are always used then */
+  gboolean proxies_allowed;
+  GESProxyCache *proxy_cache;   /* created the first time proxies are used */
+  GHashTable *proxies;          /* {uri: proxy uri} of the proxies ready */
+
+  /* Edit journal, see ges_timeline_start_journal() */
+  GESTimelineJournal *journal;
 
   /* Whether we are changing state asynchronously or not */
   gboolean async_pending;
@@ -121,18 +136,53 @@ struct _GESTimelinePrivate
    * be tracked? */
 
   /* Snapping fields */
-  GHashTable *by_start;         /* {TrackSource: start} */
-  GHashTable *by_end;           /* {TrackSource: end} */
-  GHashTable *by_object;        /* {timecode: TrackSource} */
-  GSequence *starts_ends;       /* Sorted list of starts/ends */
+  GHashTable *sources_data;     /* {TrackSource: TrackSourceData} */
+  GSequence *edges;             /* TrackObjectEdge-s sorted by timecode */
   /* We keep 1 reference to our trackobject here */
   GSequence *tracksources;      /* TrackSource-s sorted by start/priorities */
 
   MoveContext movecontext;
+
+  /* Batch edition, see ges_timeline_begin_edit() */
+  guint edit_depth;
+  gboolean updating_before_edit;
+  /* %TRUE if some TrackSource moved while editing and we did not resort
+   * tracksources and edges yet */
+  gboolean needs_resort;
 };
 
+/* An edge (start or end) of a TrackSource as stored in the snapping index.
+ *
+ * The snapping code hands out pointers to @timecode, so it has to stay the
+ * first field of the structure */
+typedef struct
+{
+  guint64 timecode;
+  GESTrackObject *tckobj;
+  GSequenceIter *iter;          /* Position in priv->edges */
+} TrackObjectEdge;
+
+/* Everything the timeline keeps about a tracked TrackSource, the iterators
+ * let us resort it in O(log n) without having to look it up first */
+typedef struct
+{
+  TrackObjectEdge start;
+  TrackObjectEdge end;
+  GSequenceIter *iter;          /* Position in priv->tracksources */
+} TrackSourceData;
+
 /* private structure to contain our track-related information */
 
+/* A discoverer and the number of uris it has been asked to discover
+ * and did not return yet */
+typedef struct
+{
+  GstDiscoverer *discoverer;
+  guint n_pending;
+} DiscovererWorker;
+
+#define DEFAULT_DISCOVERY_WORKERS 4
+
 typedef struct
 {
   GESTimeline *timeline;
@@ -147,6 +197,9 @@ enum
   PROP_DURATION,
   PROP_SNAPPING_DISTANCE,
   PROP_UPDATE,
+  PROP_PERSISTENT_DISCOVERY_CACHE,
+  PROP_DISCOVERY_WORKERS,
+  PROP_USE_PROXIES,
   PROP_LAST
 };
 
@@ -161,6 +214,7 @@ enum
   DISCOVERY_ERROR,
   SNAPING_STARTED,
   SNAPING_ENDED,
+  LOAD_PROGRESS,
   LAST_SIGNAL
 };
 
@@ -169,6 +223,8 @@ static GstBinClass *parent_class;
 static guint ges_timeline_signals[LAST_SIGNAL] = { 0 };
 
 static gint custom_find_track (TrackPrivate * tr_priv, GESTrack * track);
+static void free_discoverer_worker (DiscovererWorker * worker);
+static void free_track_source_data (TrackSourceData * data);
 static GstStateChangeReturn
 ges_timeline_change_state (GstElement * element, GstStateChange transition);
 static void
@@ -176,6 +232,7 @@ discoverer_finished_cb (GstDiscoverer * discoverer, GESTimeline * timeline);
 static void
 discoverer_discovered_cb (GstDiscoverer * discoverer,
     GstDiscovererInfo * info, GError * err, GESTimeline * timeline);
+static gboolean update_proxies (GESTimeline * timeline);
 
 /* Internal methods */
 static gboolean
@@ -216,6 +273,16 @@ ges_timeline_get_property (GObject * object, guint property_id,
     case PROP_UPDATE:
       g_value_set_boolean (value, ges_timeline_is_updating (timeline));
       break;
+    case PROP_PERSISTENT_DISCOVERY_CACHE:
+      g_value_set_boolean (value,
+          ges_discovery_cache_is_persistent (timeline->priv->discovery_cache));
+      break;
+    case PROP_DISCOVERY_WORKERS:
+      g_value_set_uint (value, timeline->priv->discovery_workers);
+      break;
+    case PROP_USE_PROXIES:
+      g_value_set_boolean (value, timeline->priv->use_proxies);
+      break;
   }
 }
 
@@ -233,6 +300,17 @@ ges_timeline_set_property (GObject * object, guint property_id,
       ges_timeline_enable_update_internal (timeline,
           g_value_get_boolean (value));
       break;
+    case PROP_PERSISTENT_DISCOVERY_CACHE:
+      ges_discovery_cache_set_persistent (timeline->priv->discovery_cache,
+          g_value_get_boolean (value));
+      break;
+    case PROP_DISCOVERY_WORKERS:
+      timeline->priv->discovery_workers = g_value_get_uint (value);
+      break;
+    case PROP_USE_PROXIES:
+      timeline->priv->use_proxies = g_value_get_boolean (value);
+      update_proxies (timeline);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -243,10 +321,21 @@ ges_timeline_dispose (GObject * object)
 {
   GESTimelinePrivate *priv = GES_TIMELINE (object)->priv;
 
-  if (priv->discoverer) {
-    gst_discoverer_stop (priv->discoverer);
-    g_object_unref (priv->discoverer);
-    priv->discoverer = NULL;
+  if (priv->discoverers) {
+    g_ptr_array_unref (priv->discoverers);
+    priv->discoverers = NULL;
+  }
+
+  /* Removing the layers below is not an edit */
+  if (priv->journal) {
+    ges_timeline_journal_free (priv->journal);
+    priv->journal = NULL;
+  }
+
+  /* Stop creating proxies, nobody will use them */
+  if (priv->proxy_cache) {
+    ges_proxy_cache_free (priv->proxy_cache);
+    priv->proxy_cache = NULL;
   }
 
   while (priv->layers) {
@@ -264,11 +353,9 @@ ges_timeline_dispose (GObject * object)
     ges_timeline_remove_track (GES_TIMELINE (object), tr_priv->track);
   }
 
-  g_hash_table_unref (priv->by_start);
-  g_hash_table_unref (priv->by_end);
-  g_hash_table_unref (priv->by_object);
-  g_sequence_free (priv->starts_ends);
+  g_sequence_free (priv->edges);
   g_sequence_free (priv->tracksources);
+  g_hash_table_unref (priv->sources_data);
 
   G_OBJECT_CLASS (ges_timeline_parent_class)->dispose (object);
 }
@@ -278,6 +365,9 @@ ges_timeline_finalize (GObject * object)
 {
   GESTimeline *timeline = GES_TIMELINE (object);
 
+  g_hash_table_unref (timeline->priv->pendingobjects);
+  ges_discovery_cache_free (timeline->priv->discovery_cache);
+  g_hash_table_unref (timeline->priv->proxies);
   g_mutex_clear (&timeline->priv->pendingobjects_lock);
 
   G_OBJECT_CLASS (ges_timeline_parent_class)->finalize (object);
@@ -346,6 +436,59 @@ ges_timeline_class_init (GESTimelineClass * klass)
   g_object_class_install_property (object_class, PROP_UPDATE,
       properties[PROP_UPDATE]);
 
+  /**
+   * GESTimeline:persistent-discovery-cache:
+   *
+   * The results of the discovery of #GESTimelineFileSource-s are cached by the
+   * timeline, so files used by several sources are only discovered once.
+   * If %TRUE, the cache is also stored in the user cache directory so that
+   * files discovered in a previous session do not need to be discovered again
+   * as long as they did not change.
+   */
+  properties[PROP_PERSISTENT_DISCOVERY_CACHE] =
+      g_param_spec_boolean ("persistent-discovery-cache",
+      "Persistent discovery cache",
+      "Keep the discovery results between sessions", FALSE,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class,
+      PROP_PERSISTENT_DISCOVERY_CACHE,
+      properties[PROP_PERSISTENT_DISCOVERY_CACHE]);
+
+  /**
+   * GESTimeline:discovery-workers:
+   *
+   * Maximum number of files the timeline discovers in parallel when
+   * completing #GESTimelineFileSource-s.
+   */
+  properties[PROP_DISCOVERY_WORKERS] =
+      g_param_spec_uint ("discovery-workers", "Discovery workers",
+      "Maximum number of files discovered in parallel", 1, G_MAXUINT,
+      DEFAULT_DISCOVERY_WORKERS, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_DISCOVERY_WORKERS,
+      properties[PROP_DISCOVERY_WORKERS]);
+
+  /**
+   * GESTimeline:use-proxies:
+   *
+   * Whether to play low resolution, intra-only proxies of the video streams
+   * of the #GESTimelineFileSource-s instead of the original files, making
+   * previewing high resolution material much lighter.
+   *
+   * Proxies are stored in the user cache directory and created in the
+   * background the first time a local file is used with this property set.
+   * Until its proxy is ready, the original file is played. A proxy is
+   * only picked up by a running pipeline the next time it goes through
+   * %GST_STATE_READY.
+   *
+   * #GESTimelinePipeline always uses the original files when rendering.
+   */
+  properties[PROP_USE_PROXIES] =
+      g_param_spec_boolean ("use-proxies", "Use proxies",
+      "Preview low resolution proxies instead of the original files", FALSE,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_USE_PROXIES,
+      properties[PROP_USE_PROXIES]);
+
   /**
    * GESTimeline::track-added:
    * @timeline: the #GESTimeline
@@ -442,6 +585,20 @@ ges_timeline_class_init (GESTimelineClass * klass)
       G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
       G_TYPE_NONE, 3, GES_TYPE_TRACK_OBJECT, GES_TYPE_TRACK_OBJECT,
       G_TYPE_UINT64);
+
+  /**
+   * GESTimeline::load-progress:
+   * @timeline: the #GESTimeline
+   * @created: the number of objects inserted in @timeline so far
+   * @total: the number of objects of the project
+   *
+   * Will be emitted while a project loaded with
+   * ges_timeline_load_from_uri_async() is inserted in @timeline.
+   */
+  ges_timeline_signals[LOAD_PROGRESS] =
+      g_signal_new ("load-progress", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
+      G_TYPE_NONE, 2, G_TYPE_UINT, G_TYPE_UINT);
 }
 
 static void
@@ -465,20 +622,21 @@ ges_timeline_init (GESTimeline * self)
   init_movecontext (&self->priv->movecontext);
   priv->movecontext.ignore_needs_ctx = FALSE;
 
-  priv->by_start = g_hash_table_new (g_direct_hash, g_direct_equal);
-  priv->by_end = g_hash_table_new (g_direct_hash, g_direct_equal);
-  priv->by_object = g_hash_table_new (g_direct_hash, g_direct_equal);
-  priv->starts_ends = g_sequence_new (g_free);
+  priv->sources_data = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) free_track_source_data);
+  priv->edges = g_sequence_new (NULL);
   priv->tracksources = g_sequence_new (g_object_unref);
 
   g_mutex_init (&priv->pendingobjects_lock);
-  /* New discoverer with a 15s timeout */
-  priv->discoverer = gst_discoverer_new (15 * GST_SECOND, NULL);
-  g_signal_connect (priv->discoverer, "finished",
-      G_CALLBACK (discoverer_finished_cb), self);
-  g_signal_connect (priv->discoverer, "discovered",
-      G_CALLBACK (discoverer_discovered_cb), self);
-  gst_discoverer_start (priv->discoverer);
+  priv->pendingobjects = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) g_list_free);
+  priv->discovery_cache = ges_discovery_cache_new (FALSE);
+  priv->discoverers = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      free_discoverer_worker);
+  priv->discovery_workers = DEFAULT_DISCOVERY_WORKERS;
+  priv->proxies_allowed = TRUE;
+  priv->proxies = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      g_free);
 }
 
 /* Private methods */
@@ -507,20 +665,19 @@ sort_layers (gpointer a, gpointer b)
 static void
 timeline_update_duration (GESTimeline * timeline)
 {
-  GstClockTime *cduration;
-  GSequenceIter *it = g_sequence_get_end_iter (timeline->priv->starts_ends);
+  TrackObjectEdge *last;
+  GSequenceIter *it = g_sequence_get_end_iter (timeline->priv->edges);
 
-  it = g_sequence_iter_prev (it);
-  if (g_sequence_iter_is_end (it))
+  if (g_sequence_iter_is_begin (it))
     return;
 
-  cduration = g_sequence_get (it);
-  if (cduration && timeline->priv->duration != *cduration) {
+  last = g_sequence_get (g_sequence_iter_prev (it));
+  if (timeline->priv->duration != last->timecode) {
     GST_DEBUG ("track duration : %" GST_TIME_FORMAT " current : %"
-        GST_TIME_FORMAT, GST_TIME_ARGS (*cduration),
+        GST_TIME_FORMAT, GST_TIME_ARGS (last->timecode),
         GST_TIME_ARGS (timeline->priv->duration));
 
-    timeline->priv->duration = *cduration;
+    timeline->priv->duration = last->timecode;
 
     g_object_notify_by_pspec (G_OBJECT (timeline), properties[PROP_DURATION]);
   }
@@ -543,19 +700,12 @@ objects_start_compare (GESTrackObject * a, GESTrackObject * b)
   return 0;
 }
 
-static inline void
-sort_track_objects (GESTimeline * timeline)
-{
-  g_sequence_sort (timeline->priv->tracksources,
-      (GCompareDataFunc) objects_start_compare, NULL);
-}
-
 static gint
-compare_uint64 (guint64 * a, guint64 * b, gpointer user_data)
+compare_edges (TrackObjectEdge * a, TrackObjectEdge * b, gpointer user_data)
 {
-  if (*a > *b)
+  if (a->timecode > b->timecode)
     return 1;
-  else if (*a == *b)
+  else if (a->timecode == b->timecode)
     return 0;
   else
     return -1;
@@ -569,114 +719,101 @@ custom_find_track (TrackPrivate * tr_priv, GESTrack * track)
   return -1;
 }
 
-/* Look for the pointer passed as @value */
-static GSequenceIter *
-lookup_pointer_uint (GSequence * seq, guint64 * value)
+static void
+free_track_source_data (TrackSourceData * data)
 {
-  GSequenceIter *iter, *tmpiter;
-  guint64 *found, *tmpval;
-
-  iter = g_sequence_lookup (seq, value,
-      (GCompareDataFunc) compare_uint64, NULL);
-
-  found = g_sequence_get (iter);
-
-  /* We have the same pointer so we are all fine */
-  if (found == value)
-    return iter;
-
-  if (!g_sequence_iter_is_end (iter)) {
-    /* Looking frontward for the good pointer */
-    tmpiter = iter;
-    while ((tmpiter = g_sequence_iter_next (tmpiter))) {
-      if (g_sequence_iter_is_end (tmpiter))
-        break;
-
-      tmpval = g_sequence_get (tmpiter);
-      if (tmpval == value)
-        return tmpiter;
-      else if (*tmpval != *value)
-        break;
-    }
-  }
+  g_slice_free (TrackSourceData, data);
+}
 
-  if (!g_sequence_iter_is_begin (iter)) {
-    /* Looking backward for the good pointer */
-    tmpiter = iter;
-    while ((tmpiter = g_sequence_iter_prev (tmpiter))) {
-      tmpval = g_sequence_get (tmpiter);
-      if (tmpval == value)
-        return tmpiter;
-      else if (*tmpval != *value || g_sequence_iter_is_begin (tmpiter))
-        break;
-    }
-  }
+/* Returns a pointer to the timecode of @edge of @tckobj in the snapping
+ * index, or %NULL if @tckobj is not tracked */
+static inline guint64 *
+lookup_edge_timecode (GESTimeline * timeline, GESTrackObject * tckobj,
+    GESEdge edge)
+{
+  TrackSourceData *data = g_hash_table_lookup (timeline->priv->sources_data,
+      tckobj);
 
-  GST_ERROR ("Missing timecode %p %" GST_TIME_FORMAT
-      " this should never happen", value, GST_TIME_ARGS (*value));
+  if (data == NULL)
+    return NULL;
 
-  return NULL;
+  return edge == GES_EDGE_START ? &data->start.timecode : &data->end.timecode;
 }
 
 static inline void
-sort_starts_ends_end (GESTimeline * timeline, GESTrackObject * obj)
+sort_track_source (GESTimeline * timeline, GESTrackObject * obj)
 {
-  GSequenceIter *iter;
+  TrackSourceData *data = g_hash_table_lookup (timeline->priv->sources_data,
+      obj);
 
-  GESTimelinePrivate *priv = timeline->priv;
-  guint64 *end = g_hash_table_lookup (priv->by_end, obj);
+  g_sequence_sort_changed (data->iter,
+      (GCompareDataFunc) objects_start_compare, NULL);
+}
 
-  iter = lookup_pointer_uint (priv->starts_ends, end);
-  *end = obj->start + obj->duration;
+static inline void
+sort_edges_end (GESTimeline * timeline, GESTrackObject * obj)
+{
+  TrackSourceData *data = g_hash_table_lookup (timeline->priv->sources_data,
+      obj);
 
-  g_sequence_sort_changed (iter, (GCompareDataFunc) compare_uint64, NULL);
+  data->end.timecode = obj->start + obj->duration;
+  g_sequence_sort_changed (data->end.iter, (GCompareDataFunc) compare_edges,
+      NULL);
   timeline_update_duration (timeline);
 }
 
 static inline void
-sort_starts_ends_start (GESTimeline * timeline, GESTrackObject * obj)
+sort_edges_start (GESTimeline * timeline, GESTrackObject * obj)
 {
-  GSequenceIter *iter;
-
-  GESTimelinePrivate *priv = timeline->priv;
-  guint64 *start = g_hash_table_lookup (priv->by_start, obj);
+  TrackSourceData *data = g_hash_table_lookup (timeline->priv->sources_data,
+      obj);
 
-  iter = lookup_pointer_uint (priv->starts_ends, start);
-  *start = obj->start;
-
-  g_sequence_sort_changed (iter, (GCompareDataFunc) compare_uint64, NULL);
+  data->start.timecode = obj->start;
+  g_sequence_sort_changed (data->start.iter, (GCompareDataFunc) compare_edges,
+      NULL);
   timeline_update_duration (timeline);
 }
 
 static inline void
-resort_all_starts_ends (GESTimeline * timeline)
+resort_all_edges (GESTimeline * timeline)
 {
   GSequenceIter *iter;
   GESTrackObject *tckobj;
-  guint64 *start, *end;
+  TrackSourceData *data;
 
   GESTimelinePrivate *priv = timeline->priv;
 
   for (iter = g_sequence_get_begin_iter (priv->tracksources);
       !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
     tckobj = GES_TRACK_OBJECT (g_sequence_get (iter));
+    data = g_hash_table_lookup (priv->sources_data, tckobj);
 
-    start = g_hash_table_lookup (priv->by_start, tckobj);
-    end = g_hash_table_lookup (priv->by_end, tckobj);
-
-    *start = tckobj->start;
-    *end = tckobj->start + tckobj->duration;
+    data->start.timecode = tckobj->start;
+    data->end.timecode = tckobj->start + tckobj->duration;
   }
 
-  g_sequence_sort (priv->starts_ends, (GCompareDataFunc) compare_uint64, NULL);
+  g_sequence_sort (priv->edges, (GCompareDataFunc) compare_edges, NULL);
   timeline_update_duration (timeline);
 }
 
 static inline void
 sort_all (GESTimeline * timeline)
 {
-  sort_track_objects (timeline);
-  resort_all_starts_ends (timeline);
+  g_sequence_sort (timeline->priv->tracksources,
+      (GCompareDataFunc) objects_start_compare, NULL);
+  resort_all_edges (timeline);
+}
+
+/* Resort everything that was left unsorted during a batch edition */
+static inline void
+ensure_sorted (GESTimeline * timeline)
+{
+  if (G_UNLIKELY (timeline->priv->needs_resort)) {
+    GST_DEBUG_OBJECT (timeline, "Resorting track sources");
+
+    timeline->priv->needs_resort = FALSE;
+    sort_all (timeline);
+  }
 }
 
 /* Timeline edition functions */
@@ -704,52 +841,53 @@ clean_movecontext (MoveContext * mv_ctx)
 static void
 stop_tracking_for_snapping (GESTimeline * timeline, GESTrackObject * tckobj)
 {
-  guint64 *start, *end;
+  TrackSourceData *data;
   GESTimelinePrivate *priv = timeline->priv;
-  GSequenceIter *iter_start, *iter_end, *tckobj_iter;
-
+  MoveContext *mv_ctx = &priv->movecontext;
 
-  start = g_hash_table_lookup (priv->by_start, tckobj);
-  end = g_hash_table_lookup (priv->by_end, tckobj);
+  data = g_hash_table_lookup (priv->sources_data, tckobj);
+  if (G_UNLIKELY (data == NULL)) {
+    GST_ERROR_OBJECT (timeline, "%p is not tracked, this should never happen",
+        tckobj);
+    return;
+  }
 
-  iter_start = lookup_pointer_uint (priv->starts_ends, start);
-  iter_end = lookup_pointer_uint (priv->starts_ends, end);
-  tckobj_iter = g_sequence_lookup (timeline->priv->tracksources, tckobj,
-      (GCompareDataFunc) objects_start_compare, NULL);
+  /* Make sure we do not keep pointers to the timecodes we are freeing */
+  if (mv_ctx->last_snap_ts == &data->start.timecode ||
+      mv_ctx->last_snap_ts == &data->end.timecode) {
+    mv_ctx->last_snap_ts = NULL;
+    mv_ctx->last_snaped1 = NULL;
+    mv_ctx->last_snaped2 = NULL;
+  }
 
-  g_hash_table_remove (priv->by_start, tckobj);
-  g_hash_table_remove (priv->by_end, tckobj);
-  g_hash_table_remove (priv->by_object, end);
-  g_hash_table_remove (priv->by_object, start);
+  g_sequence_remove (data->start.iter);
+  g_sequence_remove (data->end.iter);
+  g_sequence_remove (data->iter);
 
-  g_sequence_remove (iter_start);
-  g_sequence_remove (iter_end);
-  g_sequence_remove (tckobj_iter);
+  g_hash_table_remove (priv->sources_data, tckobj);
   timeline_update_duration (timeline);
 }
 
 static void
 start_tracking_track_obj (GESTimeline * timeline, GESTrackObject * tckobj)
 {
-  guint64 *pstart, *pend;
+  TrackSourceData *data;
   GESTimelinePrivate *priv = timeline->priv;
 
-  pstart = g_malloc (sizeof (guint64));
-  pend = g_malloc (sizeof (guint64));
-  *pstart = tckobj->start;
-  *pend = *pstart + tckobj->duration;
+  data = g_slice_new (TrackSourceData);
+  data->start.timecode = tckobj->start;
+  data->start.tckobj = tckobj;
+  data->end.timecode = tckobj->start + tckobj->duration;
+  data->end.tckobj = tckobj;
 
-  g_sequence_insert_sorted (priv->starts_ends, pstart,
-      (GCompareDataFunc) compare_uint64, NULL);
-  g_sequence_insert_sorted (priv->starts_ends, pend,
-      (GCompareDataFunc) compare_uint64, NULL);
-  g_sequence_insert_sorted (priv->tracksources, g_object_ref (tckobj),
-      (GCompareDataFunc) objects_start_compare, NULL);
+  data->start.iter = g_sequence_insert_sorted (priv->edges, &data->start,
+      (GCompareDataFunc) compare_edges, NULL);
+  data->end.iter = g_sequence_insert_sorted (priv->edges, &data->end,
+      (GCompareDataFunc) compare_edges, NULL);
+  data->iter = g_sequence_insert_sorted (priv->tracksources,
+      g_object_ref (tckobj), (GCompareDataFunc) objects_start_compare, NULL);
 
-  g_hash_table_insert (priv->by_start, tckobj, pstart);
-  g_hash_table_insert (priv->by_object, pstart, tckobj);
-  g_hash_table_insert (priv->by_end, tckobj, pend);
-  g_hash_table_insert (priv->by_object, pend, tckobj);
+  g_hash_table_insert (priv->sources_data, tckobj, data);
 
   timeline->priv->movecontext.needs_move_ctx = TRUE;
 
@@ -782,7 +920,8 @@ ges_timeline_emit_snappig (GESTimeline * timeline, GESTrackObject * obj1,
     return;
   }
 
-  obj2 = g_hash_table_lookup (timeline->priv->by_object, timecode);
+  /* timecode is always the first field of a TrackObjectEdge */
+  obj2 = ((TrackObjectEdge *) timecode)->tckobj;
 
   if (last_snap_ts != *timecode) {
     g_signal_emit (timeline, ges_timeline_signals[SNAPING_ENDED], 0,
@@ -809,19 +948,20 @@ ges_timeline_snap_position (GESTimeline * timeline, GESTrackObject * trackobj,
     guint64 * current, guint64 timecode, gboolean emit)
 {
   GESTimelinePrivate *priv = timeline->priv;
-  GSequenceIter *iter, *prev_iter, *nxt_iter;
-  GESTrackObject *tmp_tckobj;
-  GESTimelineObject *tmp_tlobj, *tlobj;
+  GSequenceIter *iter, *tmpiter;
+  TrackObjectEdge *edge, key = { timecode, NULL, NULL };
+  GESTimelineObject *tlobj;
 
   GstClockTime *last_snap_ts = priv->movecontext.last_snap_ts;
   guint64 snap_distance = timeline->priv->snapping_distance;
-  guint64 *prev_tc, *next_tc, *ret = NULL, off = G_MAXUINT64, off1 =
-      G_MAXUINT64;
+  guint64 *ret = NULL, off = G_MAXUINT64, off1;
 
   /* Avoid useless calculations */
   if (snap_distance == 0)
     return NULL;
 
+  ensure_sorted (timeline);
+
   /* If we can just resnap as last snap... do it */
   if (last_snap_ts) {
     off = timecode > *last_snap_ts ?
@@ -834,45 +974,45 @@ ges_timeline_snap_position (GESTimeline * timeline, GESTrackObject * trackobj,
 
   tlobj = ges_track_object_get_timeline_object (trackobj);
 
-  iter = g_sequence_search (priv->starts_ends, &timecode,
-      (GCompareDataFunc) compare_uint64, NULL);
-
-  /* Getting the next/previous  values, and use the closest one if any "respects"
-   * the snap_distance value */
-  nxt_iter = iter;
-  while (!g_sequence_iter_is_end (nxt_iter)) {
-    next_tc = g_sequence_get (iter);
-    tmp_tckobj = g_hash_table_lookup (timeline->priv->by_object, next_tc);
-    tmp_tlobj = ges_track_object_get_timeline_object (tmp_tckobj);
-
-    off = timecode > *next_tc ? timecode - *next_tc : *next_tc - timecode;
-    if (next_tc != current && off <= snap_distance && tlobj != tmp_tlobj) {
+  iter = g_sequence_search (priv->edges, &key,
+      (GCompareDataFunc) compare_edges, NULL);
+
+  /* Getting the next/previous values, and use the closest one if any "respects"
+   * the snap_distance value. The edges are sorted so we can stop looking as
+   * soon as we are further than snap_distance, we only have to skip the
+   * edges of the object being moved */
+  off = G_MAXUINT64;
+  for (tmpiter = iter; !g_sequence_iter_is_end (tmpiter);
+      tmpiter = g_sequence_iter_next (tmpiter)) {
+    edge = g_sequence_get (tmpiter);
+
+    off1 = timecode > edge->timecode ?
+        timecode - edge->timecode : edge->timecode - timecode;
+    if (off1 > snap_distance)
+      break;
 
-      ret = next_tc;
+    if (&edge->timecode != current &&
+        ges_track_object_get_timeline_object (edge->tckobj) != tlobj) {
+      ret = &edge->timecode;
+      off = off1;
       break;
     }
-
-    nxt_iter = g_sequence_iter_next (nxt_iter);
   }
 
-  if (ret == NULL)
-    off = G_MAXUINT64;
+  for (tmpiter = iter; !g_sequence_iter_is_begin (tmpiter);) {
+    tmpiter = g_sequence_iter_prev (tmpiter);
+    edge = g_sequence_get (tmpiter);
 
-  prev_iter = g_sequence_iter_prev (iter);
-  while (!g_sequence_iter_is_begin (prev_iter)) {
-    prev_tc = g_sequence_get (prev_iter);
-    tmp_tckobj = g_hash_table_lookup (timeline->priv->by_object, prev_tc);
-    tmp_tlobj = ges_track_object_get_timeline_object (tmp_tckobj);
-
-    off1 = timecode > *prev_tc ? timecode - *prev_tc : *prev_tc - timecode;
-    if (prev_tc != current && off1 < off && off1 <= snap_distance &&
-        tlobj != tmp_tlobj) {
-      ret = prev_tc;
+    off1 = timecode > edge->timecode ?
+        timecode - edge->timecode : edge->timecode - timecode;
+    if (off1 >= off || off1 > snap_distance)
+      break;
 
+    if (&edge->timecode != current &&
+        ges_track_object_get_timeline_object (edge->tckobj) != tlobj) {
+      ret = &edge->timecode;
       break;
     }
-
-    prev_iter = g_sequence_iter_prev (prev_iter);
   }
 
 done:
@@ -928,11 +1068,16 @@ ges_move_context_set_objects (GESTimeline * timeline, GESTrackObject * obj,
   GSequenceIter *iter, *tckobj_iter;
   guint64 start, end, tmpend;
   GESTrackObject *tmptckobj;
+  TrackSourceData *data;
 
   MoveContext *mv_ctx = &timeline->priv->movecontext;
 
-  tckobj_iter = g_sequence_lookup (timeline->priv->tracksources, obj,
-      (GCompareDataFunc) objects_start_compare, NULL);
+  data = g_hash_table_lookup (timeline->priv->sources_data, obj);
+  if (G_UNLIKELY (data == NULL)) {
+    GST_DEBUG_OBJECT (obj, "Not tracked, can not set moving context");
+    return FALSE;
+  }
+  tckobj_iter = data->iter;
 
   switch (edge) {
     case GES_EDGE_START:
@@ -998,6 +1143,9 @@ ges_timeline_set_moving_context (GESTimeline * timeline, GESTrackObject * obj,
   MoveContext *mv_ctx = &timeline->priv->movecontext;
   GESTimelineObject *tlobj = ges_track_object_get_timeline_object (obj);
 
+  /* Editing modes need the real order of objects */
+  ensure_sorted (timeline);
+
   /* Still in the same mv_ctx */
   if ((mv_ctx->obj == tlobj && mv_ctx->mode == mode &&
           mv_ctx->edge == edge && !mv_ctx->needs_move_ctx)) {
@@ -1053,7 +1201,7 @@ ges_timeline_trim_object_simple (GESTimeline * timeline, GESTrackObject * obj,
       duration = obj->duration;
 
       if (snapping) {
-        cur = g_hash_table_lookup (timeline->priv->by_start, obj);
+        cur = lookup_edge_timecode (timeline, obj, GES_EDGE_START);
 
         snapped = ges_timeline_snap_position (timeline, obj, cur, position,
             TRUE);
@@ -1079,7 +1227,7 @@ ges_timeline_trim_object_simple (GESTimeline * timeline, GESTrackObject * obj,
       break;
     case GES_EDGE_END:
     {
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
+      cur = lookup_edge_timecode (timeline, obj, GES_EDGE_END);
       snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
       if (snapped)
         position = *snapped;
@@ -1122,7 +1270,7 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackObject * obj,
     case GES_EDGE_NONE:
       GST_DEBUG ("Simply rippling");
 
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
+      cur = lookup_edge_timecode (timeline, obj, GES_EDGE_END);
       snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
       if (snapped)
         position = *snapped;
@@ -1154,7 +1302,7 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackObject * obj,
     case GES_EDGE_END:
       GST_DEBUG ("Rippling end");
 
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
+      cur = lookup_edge_timecode (timeline, obj, GES_EDGE_END);
       snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
       if (snapped)
         position = *snapped;
@@ -1269,7 +1417,7 @@ timeline_roll_object (GESTimeline * timeline, GESTrackObject * obj,
       if (position < mv_ctx->max_trim_pos || position > end)
         goto error;
 
-      cur = g_hash_table_lookup (timeline->priv->by_start, obj);
+      cur = lookup_edge_timecode (timeline, obj, GES_EDGE_START);
       snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
       if (snapped)
         position = *snapped;
@@ -1307,7 +1455,7 @@ timeline_roll_object (GESTimeline * timeline, GESTrackObject * obj,
 
       end = obj->start + obj->duration;
 
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
+      cur = lookup_edge_timecode (timeline, obj, GES_EDGE_END);
       snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
       if (snapped)
         position = *snapped;
@@ -1376,7 +1524,7 @@ ges_timeline_move_object_simple (GESTimeline * timeline,
   guint64 *snap_end, *snap_st, *cur, off1, off2, end;
 
   end = position + object->duration;
-  cur = g_hash_table_lookup (timeline->priv->by_end, object);
+  cur = lookup_edge_timecode (timeline, object, GES_EDGE_END);
 
   GST_DEBUG_OBJECT (timeline, "Moving to %" GST_TIME_FORMAT " (end %"
       GST_TIME_FORMAT ")", GST_TIME_ARGS (position), GST_TIME_ARGS (end));
@@ -1387,7 +1535,7 @@ ges_timeline_move_object_simple (GESTimeline * timeline,
   else
     off1 = G_MAXUINT64;
 
-  cur = g_hash_table_lookup (timeline->priv->by_start, object);
+  cur = lookup_edge_timecode (timeline, object, GES_EDGE_START);
   snap_st = ges_timeline_snap_position (timeline, object, cur, position, FALSE);
   if (snap_st)
     off2 = position > *snap_st ? position - *snap_st : *snap_st - position;
@@ -1484,6 +1632,82 @@ add_object_to_tracks (GESTimeline * timeline, GESTimelineObject * object)
   }
 }
 
+static void
+free_discoverer_worker (DiscovererWorker * worker)
+{
+  gst_discoverer_stop (worker->discoverer);
+  g_object_unref (worker->discoverer);
+
+  g_slice_free (DiscovererWorker, worker);
+}
+
+static DiscovererWorker *
+find_discoverer_worker (GESTimeline * timeline, GstDiscoverer * discoverer)
+{
+  guint i;
+  GPtrArray *discoverers = timeline->priv->discoverers;
+
+  for (i = 0; i < discoverers->len; i++) {
+    DiscovererWorker *worker = g_ptr_array_index (discoverers, i);
+
+    if (worker->discoverer == discoverer)
+      return worker;
+  }
+
+  return NULL;
+}
+
+/* Returns the least busy discoverer, creating a new one if they are all
+ * busy and we did not reach the maximum number of workers yet.
+ *
+ * Must be called with the pendingobjects lock */
+static DiscovererWorker *
+get_discoverer_worker (GESTimeline * timeline)
+{
+  guint i, n_workers;
+  GstDiscoverer *discoverer;
+  DiscovererWorker *worker = NULL;
+  GESTimelinePrivate *priv = timeline->priv;
+  GError *error = NULL;
+
+  n_workers = MIN (priv->discoverers->len, priv->discovery_workers);
+  for (i = 0; i < n_workers; i++) {
+    DiscovererWorker *tmp = g_ptr_array_index (priv->discoverers, i);
+
+    if (worker == NULL || tmp->n_pending < worker->n_pending)
+      worker = tmp;
+  }
+
+  if (worker && (worker->n_pending == 0 ||
+          priv->discoverers->len >= priv->discovery_workers))
+    return worker;
+
+  /* New discoverer with a 15s timeout */
+  discoverer = gst_discoverer_new (15 * GST_SECOND, &error);
+  if (G_UNLIKELY (discoverer == NULL)) {
+    GST_WARNING_OBJECT (timeline, "Could not create discoverer: %s",
+        error->message);
+    g_error_free (error);
+
+    return worker;
+  }
+
+  g_signal_connect (discoverer, "finished",
+      G_CALLBACK (discoverer_finished_cb), timeline);
+  g_signal_connect (discoverer, "discovered",
+      G_CALLBACK (discoverer_discovered_cb), timeline);
+  gst_discoverer_start (discoverer);
+
+  worker = g_slice_new0 (DiscovererWorker);
+  worker->discoverer = discoverer;
+  g_ptr_array_add (priv->discoverers, worker);
+
+  GST_DEBUG_OBJECT (timeline, "Created discovery worker %u",
+      priv->discoverers->len);
+
+  return worker;
+}
+
 static void
 do_async_start (GESTimeline * timeline)
 {
@@ -1524,10 +1748,134 @@ do_async_done (GESTimeline * timeline)
   }
 }
 
+/* Completes @tfs with the discovery results of its file and adds it to
+ * the tracks */
+static void
+apply_discovery_results (GESTimeline * timeline, GESTimelineFileSource * tfs,
+    GESTrackType supported_formats, GstClockTime file_duration,
+    gboolean is_image)
+{
+  GESTimelineObject *tlobj = GES_TIMELINE_OBJECT (tfs);
+
+  /* The timeline file source will be updated with discovered information
+   * so it needs to not be finalized during this process */
+  g_object_ref (tfs);
+
+  /* Only complete the formats (and image-ness) of sources that did not
+   * specify them */
+  if (ges_timeline_filesource_get_supported_formats (tfs) ==
+      GES_TRACK_TYPE_UNKNOWN)
+    ges_timeline_filesource_set_supported_formats (tfs, supported_formats);
+  else
+    is_image = FALSE;
+
+  if (is_image) {
+    /* don't set max-duration on still images */
+    g_object_set (tfs, "is_image", (gboolean) TRUE, NULL);
+  } else {
+    GstClockTime tlobj_max_duration;
+
+    /* Properly set duration informations from the discovery */
+    tlobj_max_duration = ges_timeline_object_get_max_duration (tlobj);
+
+    if (tlobj_max_duration == G_MAXUINT64)
+      ges_timeline_object_set_max_duration (tlobj, file_duration);
+
+    if (GST_CLOCK_TIME_IS_VALID (tlobj->duration) == FALSE)
+      ges_timeline_object_set_duration (tlobj, file_duration);
+  }
+
+  /* Continue the processing on tfs */
+  add_object_to_tracks (timeline, tlobj);
+
+  /* Remove the ref as the timeline file source is no longer needed here */
+  g_object_unref (tfs);
+}
+
+static void
+proxy_ready_cb (const gchar * uri, const gchar * proxy_uri,
+    GESTimeline * timeline)
+{
+  if (proxy_uri == NULL) {
+    GST_INFO_OBJECT (timeline, "No proxy for %s, using the original file", uri);
+    return;
+  }
+
+  g_hash_table_insert (timeline->priv->proxies, g_strdup (uri),
+      g_strdup (proxy_uri));
+  update_proxies (timeline);
+}
+
+/* Makes @source play the proxy of its file if we should and it is ready,
+ * requesting it otherwise. Returns %TRUE if the uri played changed */
+static gboolean
+update_track_filesource_proxy (GESTimeline * timeline,
+    GESTrackFileSource * source)
+{
+  gchar *cached;
+  const gchar *proxy_uri = NULL;
+  GESTimelinePrivate *priv = timeline->priv;
+  GESTrack *track = ges_track_object_get_track (GES_TRACK_OBJECT (source));
+
+  /* Proxies only contain the video stream */
+  if (priv->use_proxies && priv->proxies_allowed && track &&
+      track->type == GES_TRACK_TYPE_VIDEO) {
+    proxy_uri = g_hash_table_lookup (priv->proxies, source->uri);
+
+    if (proxy_uri == NULL) {
+      if (priv->proxy_cache == NULL)
+        priv->proxy_cache = ges_proxy_cache_new ((GESProxyReadyFunc)
+            proxy_ready_cb, timeline);
+
+      cached = ges_proxy_cache_lookup (priv->proxy_cache, source->uri);
+      if (cached)
+        g_hash_table_insert (priv->proxies, g_strdup (source->uri), cached);
+      else
+        ges_proxy_cache_request (priv->proxy_cache, source->uri);
+
+      /* The request might have been answered right away */
+      proxy_uri = g_hash_table_lookup (priv->proxies, source->uri);
+    }
+  }
+
+  return ges_track_filesource_set_proxy_uri (source, proxy_uri);
+}
+
+static gboolean
+update_proxies (GESTimeline * timeline)
+{
+  GSequenceIter *iter;
+  gboolean changed = FALSE;
+
+  for (iter = g_sequence_get_begin_iter (timeline->priv->tracksources);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+    GESTrackObject *tckobj = g_sequence_get (iter);
+
+    if (GES_IS_TRACK_FILESOURCE (tckobj) &&
+        update_track_filesource_proxy (timeline,
+            GES_TRACK_FILESOURCE (tckobj)))
+      changed = TRUE;
+  }
+
+  return changed;
+}
+
 /* Callbacks  */
 static void
 discoverer_finished_cb (GstDiscoverer * discoverer, GESTimeline * timeline)
 {
+  gboolean done;
+
+  /* Other discoverers might still be working */
+  GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
+  done = (g_hash_table_size (timeline->priv->pendingobjects) == 0);
+  GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+
+  if (!done)
+    return;
+
+  ges_discovery_cache_save (timeline->priv->discovery_cache);
+
   do_async_done (timeline);
 }
 
@@ -1535,46 +1883,37 @@ static void
 discoverer_discovered_cb (GstDiscoverer * discoverer,
     GstDiscovererInfo * info, GError * err, GESTimeline * timeline)
 {
-  GList *tmp;
+  GList *tmp, *tfss = NULL;
   GList *stream_list;
-  GESTimelineObject *tlobj;
-  GESTrackType tfs_supportedformats;
+  GstClockTime file_duration;
+  gchar *pending_uri;
+  DiscovererWorker *worker;
 
-  gboolean found = FALSE;
   gboolean is_image = FALSE;
-  GESTimelineFileSource *tfs = NULL;
+  GESTrackType supported_formats = GES_TRACK_TYPE_UNKNOWN;
   GESTimelinePrivate *priv = timeline->priv;
   const gchar *uri = gst_discoverer_info_get_uri (info);
 
+  /* Take all the sources waiting for that uri */
   GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
+  worker = find_discoverer_worker (timeline, discoverer);
+  if (worker)
+    worker->n_pending--;
 
-  /* Find corresponding TimelineFileSource in the sources */
-  for (tmp = priv->pendingobjects; tmp; tmp = tmp->next) {
-    tfs = (GESTimelineFileSource *) tmp->data;
-
-    if (!g_strcmp0 (ges_timeline_filesource_get_uri (tfs), uri)) {
-      found = TRUE;
-      break;
-    }
-  }
-
-  if (!found) {
-    GST_WARNING ("Discovered %s, that seems not to be in the list of sources"
-        "to discover", uri);
-    GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
-    return;
+  if (g_hash_table_lookup_extended (priv->pendingobjects, uri,
+          (gpointer *) & pending_uri, (gpointer *) & tfss)) {
+    g_hash_table_steal (priv->pendingobjects, uri);
+    g_free (pending_uri);
   }
+  GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
 
   if (err) {
-    GError *propagate_error = NULL;
-
-    priv->pendingobjects = g_list_delete_link (priv->pendingobjects, tmp);
-    GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
     GST_WARNING ("Error while discovering %s: %s", uri, err->message);
 
-    g_propagate_error (&propagate_error, err);
-    g_signal_emit (timeline, ges_timeline_signals[DISCOVERY_ERROR], 0, tfs,
-        propagate_error);
+    for (tmp = tfss; tmp; tmp = tmp->next)
+      g_signal_emit (timeline, ges_timeline_signals[DISCOVERY_ERROR], 0,
+          tmp->data, err);
+    g_list_free (tfss);
 
     return;
   }
@@ -1582,36 +1921,19 @@ discoverer_discovered_cb (GstDiscoverer * discoverer,
   /* Everything went fine... let's do our job! */
   GST_DEBUG ("Discovered uri %s", uri);
 
-  /* The timeline file source will be updated with discovered information
-   * so it needs to not be finalized during this process */
-  g_object_ref (tfs);
-
-  /* Remove object from list */
-  priv->pendingobjects = g_list_delete_link (priv->pendingobjects, tmp);
-  GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
-
   /* FIXME : Handle errors in discovery */
   stream_list = gst_discoverer_info_get_stream_list (info);
 
-  tfs_supportedformats = ges_timeline_filesource_get_supported_formats (tfs);
-  if (tfs_supportedformats != GES_TRACK_TYPE_UNKNOWN)
-    goto check_image;
-
-  /* Update timelinefilesource properties based on info */
   for (tmp = stream_list; tmp; tmp = tmp->next) {
     GstDiscovererStreamInfo *sinf = (GstDiscovererStreamInfo *) tmp->data;
 
     if (GST_IS_DISCOVERER_AUDIO_INFO (sinf)) {
-      tfs_supportedformats |= GES_TRACK_TYPE_AUDIO;
-      ges_timeline_filesource_set_supported_formats (tfs, tfs_supportedformats);
+      supported_formats |= GES_TRACK_TYPE_AUDIO;
     } else if (GST_IS_DISCOVERER_VIDEO_INFO (sinf)) {
-      tfs_supportedformats |= GES_TRACK_TYPE_VIDEO;
-      ges_timeline_filesource_set_supported_formats (tfs, tfs_supportedformats);
+      supported_formats |= GES_TRACK_TYPE_VIDEO;
       if (gst_discoverer_video_info_is_image ((GstDiscovererVideoInfo *)
               sinf)) {
-        tfs_supportedformats |= GES_TRACK_TYPE_AUDIO;
-        ges_timeline_filesource_set_supported_formats (tfs,
-            tfs_supportedformats);
+        supported_formats |= GES_TRACK_TYPE_AUDIO;
         is_image = TRUE;
       }
     }
@@ -1620,31 +1942,22 @@ discoverer_discovered_cb (GstDiscoverer * discoverer,
   if (stream_list)
     gst_discoverer_stream_info_list_free (stream_list);
 
-check_image:
+  file_duration = gst_discoverer_info_get_duration (info);
 
-  tlobj = GES_TIMELINE_OBJECT (tfs);
-  if (is_image) {
-    /* don't set max-duration on still images */
-    g_object_set (tfs, "is_image", (gboolean) TRUE, NULL);
-  } else {
-    GstClockTime file_duration, tlobj_max_duration;
+  /* Even if nobody waits for it anymore, the result might be useful later */
+  ges_discovery_cache_store (priv->discovery_cache, uri, supported_formats,
+      file_duration, is_image);
 
-    /* Properly set duration informations from the discovery */
-    file_duration = gst_discoverer_info_get_duration (info);
-    tlobj_max_duration = ges_timeline_object_get_max_duration (tlobj);
-
-    if (tlobj_max_duration == G_MAXUINT64)
-      ges_timeline_object_set_max_duration (tlobj, file_duration);
-
-    if (GST_CLOCK_TIME_IS_VALID (tlobj->duration) == FALSE)
-      ges_timeline_object_set_duration (tlobj, file_duration);
+  if (tfss == NULL) {
+    GST_DEBUG ("Discovered %s, but no source is waiting for it anymore", uri);
+    return;
   }
 
-  /* Continue the processing on tfs */
-  add_object_to_tracks (timeline, tlobj);
+  for (tmp = tfss; tmp; tmp = tmp->next)
+    apply_discovery_results (timeline, GES_TIMELINE_FILE_SOURCE (tmp->data),
+        supported_formats, file_duration, is_image);
 
-  /* Remove the ref as the timeline file source is no longer needed here */
-  g_object_unref (tfs);
+  g_list_free (tfss);
 }
 
 static void
@@ -1674,15 +1987,52 @@ layer_object_added_cb (GESTimelineLayer * layer, GESTimelineObject * object,
 
     if (tfs_supportedformats == GES_TRACK_TYPE_UNKNOWN ||
         tfs_maxdur == GST_CLOCK_TIME_NONE || object->duration == 0) {
-      GST_LOG ("Incomplete TimelineFileSource, discovering it");
+      GESTrackType supported_formats;
+      GstClockTime file_duration;
+      gboolean is_image;
+      gchar *pending_uri;
+      GList *waiting;
+
       tfs_uri = ges_timeline_filesource_get_uri (tfs);
 
+      /* The lookup stats the file, do not block the discoverers meanwhile */
+      if (ges_discovery_cache_lookup (timeline->priv->discovery_cache,
+              tfs_uri, &supported_formats, &file_duration, &is_image)) {
+        GST_LOG ("Incomplete TimelineFileSource, using cached discovery");
+        apply_discovery_results (timeline, tfs, supported_formats,
+            file_duration, is_image);
+
+        return;
+      }
+
       GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
-      timeline->priv->pendingobjects =
-          g_list_append (timeline->priv->pendingobjects, object);
-      GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+      if (g_hash_table_lookup_extended (timeline->priv->pendingobjects,
+              tfs_uri, (gpointer *) & pending_uri, (gpointer *) & waiting)) {
+        /* Already being discovered, just wait for the results */
+        g_hash_table_steal (timeline->priv->pendingobjects, tfs_uri);
+        g_hash_table_insert (timeline->priv->pendingobjects, pending_uri,
+            g_list_append (waiting, object));
+        GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+
+        GST_LOG ("Incomplete TimelineFileSource, already being discovered");
+      } else {
+        DiscovererWorker *worker = get_discoverer_worker (timeline);
+
+        if (G_UNLIKELY (worker == NULL)) {
+          GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+          GST_ERROR_OBJECT (timeline, "No discoverer to discover %s", tfs_uri);
+
+          return;
+        }
+
+        worker->n_pending++;
+        g_hash_table_insert (timeline->priv->pendingobjects,
+            g_strdup (tfs_uri), g_list_append (NULL, object));
+        GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
 
-      gst_discoverer_discover_uri_async (timeline->priv->discoverer, tfs_uri);
+        GST_LOG ("Incomplete TimelineFileSource, discovering it");
+        gst_discoverer_discover_uri_async (worker->discoverer, tfs_uri);
+      }
     } else
       add_object_to_tracks (timeline, object);
   } else {
@@ -1740,9 +2090,21 @@ layer_object_removed_cb (GESTimelineLayer * layer, GESTimelineObject * object,
    * it no longer needs to be discovered so remove it from the pendingobjects
    * list if it belongs to this layer */
   if (GES_IS_TIMELINE_FILE_SOURCE (object)) {
+    const gchar *uri =
+        ges_timeline_filesource_get_uri (GES_TIMELINE_FILE_SOURCE (object));
+    gchar *pending_uri;
+    GList *waiting;
+
     GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
-    timeline->priv->pendingobjects =
-        g_list_remove_all (timeline->priv->pendingobjects, object);
+    if (g_hash_table_lookup_extended (timeline->priv->pendingobjects, uri,
+            (gpointer *) & pending_uri, (gpointer *) & waiting)) {
+      g_hash_table_steal (timeline->priv->pendingobjects, uri);
+
+      /* Keep the uri even if no source waits for it anymore, its discovery
+       * is still in progress */
+      g_hash_table_insert (timeline->priv->pendingobjects, pending_uri,
+          g_list_remove_all (waiting, object));
+    }
     GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
   }
 
@@ -1753,9 +2115,14 @@ static void
 trackobj_start_changed_cb (GESTrackObject * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
 {
-  sort_track_objects (timeline);
-  sort_starts_ends_start (timeline, child);
-  sort_starts_ends_end (timeline, child);
+  if (timeline->priv->edit_depth) {
+    /* Everything will be resorted once at commit time */
+    timeline->priv->needs_resort = TRUE;
+  } else {
+    sort_track_source (timeline, child);
+    sort_edges_start (timeline, child);
+    sort_edges_end (timeline, child);
+  }
 
   /* If the timeline is set to snap objects together, we
    * are sure that all movement of TrackObject-s are done within
@@ -1770,7 +2137,10 @@ static void
 trackobj_duration_changed_cb (GESTrackObject * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
 {
-  sort_starts_ends_end (timeline, child);
+  if (timeline->priv->edit_depth)
+    timeline->priv->needs_resort = TRUE;
+  else
+    sort_edges_end (timeline, child);
 
   /* If the timeline is set to snap objects together, we
    * are sure that all movement of TrackObject-s are done within
@@ -1781,6 +2151,16 @@ trackobj_duration_changed_cb (GESTrackObject * child,
     timeline->priv->movecontext.needs_move_ctx = TRUE;
 }
 
+static void
+trackobj_priority_changed_cb (GESTrackObject * child,
+    GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
+{
+  if (timeline->priv->edit_depth)
+    timeline->priv->needs_resort = TRUE;
+  else
+    sort_track_source (timeline, child);
+}
+
 static void
 track_object_added_cb (GESTrack * track, GESTrackObject * object,
     GESTimeline * timeline)
@@ -1789,10 +2169,15 @@ track_object_added_cb (GESTrack * track, GESTrackObject * object,
   if (GES_IS_TRACK_SOURCE (object)) {
     start_tracking_track_obj (timeline, object);
 
+    if (GES_IS_TRACK_FILESOURCE (object) && timeline->priv->use_proxies)
+      update_track_filesource_proxy (timeline, GES_TRACK_FILESOURCE (object));
+
     g_signal_connect (GES_TRACK_OBJECT (object), "notify::start",
         G_CALLBACK (trackobj_start_changed_cb), timeline);
     g_signal_connect (GES_TRACK_OBJECT (object), "notify::duration",
         G_CALLBACK (trackobj_duration_changed_cb), timeline);
+    g_signal_connect (GES_TRACK_OBJECT (object), "notify::priority",
+        G_CALLBACK (trackobj_priority_changed_cb), timeline);
   }
 }
 
@@ -1803,9 +2188,11 @@ track_object_removed_cb (GESTrack * track, GESTrackObject * object,
   /* We only work with sources */
   if (GES_IS_TRACK_SOURCE (object)) {
     g_signal_handlers_disconnect_by_func (object, trackobj_start_changed_cb,
-        NULL);
+        timeline);
     g_signal_handlers_disconnect_by_func (object, trackobj_duration_changed_cb,
-        NULL);
+        timeline);
+    g_signal_handlers_disconnect_by_func (object, trackobj_priority_changed_cb,
+        timeline);
 
     /* Make sure to reinitialise the moving context next time */
     timeline->priv->movecontext.needs_move_ctx = TRUE;
@@ -1878,6 +2265,39 @@ pad_removed_cb (GESTrack * track, GstPad * pad, TrackPrivate * tr_priv)
   tr_priv->pad = NULL;
 }
 
+/* ges_timeline_allow_proxies:
+ * @timeline: a #GESTimeline
+ * @allow: %FALSE to play the original files even if #GESTimeline:use-proxies
+ * is set, as needed when rendering
+ *
+ * Returns: %TRUE if some sources changed the uri they play, meaning the
+ * elements need to go through %GST_STATE_READY for it to be taken into
+ * account.
+ */
+gboolean
+ges_timeline_allow_proxies (GESTimeline * timeline, gboolean allow)
+{
+  if (timeline->priv->proxies_allowed == allow)
+    return FALSE;
+
+  timeline->priv->proxies_allowed = allow;
+
+  return update_proxies (timeline);
+}
+
+/* Returns %TRUE if some objects of @timeline are still being discovered */
+gboolean
+ges_timeline_is_discovering (GESTimeline * timeline)
+{
+  gboolean ret;
+
+  GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
+  ret = (g_hash_table_size (timeline->priv->pendingobjects) != 0);
+  GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+
+  return ret;
+}
+
 
 /* GstElement Virtual methods */
 static GstStateChangeReturn
@@ -1889,7 +2309,7 @@ ges_timeline_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_READY_TO_PAUSED:
       GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
-      if (timeline->priv->pendingobjects) {
+      if (g_hash_table_size (timeline->priv->pendingobjects)) {
         GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
         do_async_start (timeline);
         ret = GST_STATE_CHANGE_ASYNC;
@@ -2007,6 +2427,255 @@ fail:
   return ret;
 }
 
+/* Asynchronous loading
+ *
+ * The project is read and parsed, and its objects created, on a worker
+ * thread. The resulting GESStagedItem-s are then inserted in the timeline
+ * from the main context by batches, so that it keeps running meanwhile. */
+
+/* Number of objects inserted per main context iteration */
+#define LOAD_BATCH_SIZE 64
+
+typedef struct
+{
+  GESTimeline *timeline;
+  gchar *uri;
+  GCancellable *cancellable;
+  GSimpleAsyncResult *result;
+
+  /* Set by the worker thread */
+  GESFormatter *formatter;
+  GQueue *staged;               /* GESStagedItem-s, NULL if not supported */
+
+  guint n_objects;
+  guint n_created;
+
+  /* Whether the timeline was updating before the insertion */
+  gboolean was_updating;
+} LoadData;
+
+static void
+load_data_free (LoadData * data)
+{
+  if (data->staged)
+    g_queue_free_full (data->staged, (GDestroyNotify) ges_staged_item_free);
+  if (data->formatter)
+    g_object_unref (data->formatter);
+  if (data->cancellable)
+    g_object_unref (data->cancellable);
+  g_object_unref (data->result);
+  gst_object_unref (data->timeline);
+  g_free (data->uri);
+
+  g_slice_free (LoadData, data);
+}
+
+static void
+load_complete (LoadData * data, GError * error)
+{
+  if (error) {
+    g_simple_async_result_take_error (data->result, error);
+  }
+
+  g_simple_async_result_complete (data->result);
+  load_data_free (data);
+}
+
+static gboolean
+insert_staged_batch (LoadData * data)
+{
+  GESStagedItem *staged;
+  GError *error = NULL;
+  guint n = 0;
+
+  if (g_cancellable_set_error_if_cancelled (data->cancellable, &error))
+    goto done;
+
+  while (n < LOAD_BATCH_SIZE && (staged = g_queue_pop_head (data->staged))) {
+    gboolean ret;
+
+    if (GES_IS_TRACK (staged->item)) {
+      ret = ges_timeline_add_track (data->timeline, staged->item);
+    } else if (GES_IS_TIMELINE_LAYER (staged->item)) {
+      ret = ges_timeline_add_layer (data->timeline, staged->item);
+    } else if (GES_IS_SIMPLE_TIMELINE_LAYER (staged->layer)) {
+      ret = ges_simple_timeline_layer_add_object ((GESSimpleTimelineLayer *)
+          staged->layer, staged->item, -1);
+      n++;
+    } else {
+      ret = ges_timeline_layer_add_object (staged->layer, staged->item);
+      n++;
+    }
+
+    ges_staged_item_free (staged);
+
+    if (!ret) {
+      g_set_error (&error, G_IO_ERROR, G_IO_ERROR_FAILED,
+          "Could not insert the content of %s in the timeline", data->uri);
+      goto done;
+    }
+  }
+
+  data->n_created += n;
+  g_signal_emit (data->timeline, ges_timeline_signals[LOAD_PROGRESS], 0,
+      data->n_created, data->n_objects);
+
+  if (!g_queue_is_empty (data->staged))
+    return TRUE;
+
+done:
+  if (data->was_updating)
+    ges_timeline_enable_update (data->timeline, TRUE);
+  load_complete (data, error);
+
+  return FALSE;
+}
+
+static void
+load_thread_func (GSimpleAsyncResult * res, GObject * object,
+    GCancellable * cancellable)
+{
+  GList *tmp;
+  GError *error = NULL;
+  LoadData *data = g_simple_async_result_get_op_res_gpointer (res);
+
+  if (!(data->formatter = ges_formatter_new_for_uri (data->uri))) {
+    g_simple_async_result_set_error (res, G_IO_ERROR,
+        G_IO_ERROR_NOT_SUPPORTED, "Unsupported uri %s", data->uri);
+    return;
+  }
+
+  /* Other formatters are run from the main context */
+  if (!ges_formatter_can_stage (data->formatter))
+    return;
+
+  data->staged = ges_formatter_stage_from_uri (data->formatter,
+      data->timeline, data->uri);
+  if (data->staged == NULL) {
+    g_simple_async_result_set_error (res, G_IO_ERROR, G_IO_ERROR_FAILED,
+        "Could not load %s", data->uri);
+    return;
+  }
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, &error)) {
+    g_simple_async_result_take_error (res, error);
+    return;
+  }
+
+  for (tmp = data->staged->head; tmp; tmp = tmp->next) {
+    if (GES_IS_TIMELINE_OBJECT (((GESStagedItem *) tmp->data)->item))
+      data->n_objects++;
+  }
+}
+
+static void
+load_thread_done_cb (GObject * object, GAsyncResult * res, LoadData * data)
+{
+  GSource *source;
+  GError *error = NULL;
+
+  if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res),
+          &error)) {
+    load_complete (data, error);
+    return;
+  }
+
+  if (data->staged == NULL) {
+    if (!ges_formatter_load_from_uri (data->formatter, data->timeline,
+            data->uri))
+      error = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED,
+          "Could not load %s", data->uri);
+
+    load_complete (data, error);
+    return;
+  }
+
+  /* The timeline is only updated once everything got inserted */
+  data->was_updating = ges_timeline_is_updating (data->timeline);
+  if (data->was_updating)
+    ges_timeline_enable_update (data->timeline, FALSE);
+
+  source = g_idle_source_new ();
+  g_source_set_callback (source, (GSourceFunc) insert_staged_batch, data,
+      NULL);
+  g_source_attach (source, g_main_context_get_thread_default ());
+  g_source_unref (source);
+}
+
+/**
+ * ges_timeline_load_from_uri_async:
+ * @timeline: an empty #GESTimeline into which to load the project
+ * @uri: The URI to load from
+ * @cancellable: (allow-none): optional #GCancellable object, %NULL to ignore
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the project is
+ * loaded
+ * @user_data: (closure): the data to pass to @callback
+ *
+ * Asynchronously loads the contents of @uri into @timeline.
+ *
+ * The project is read and parsed on a worker thread, its objects are then
+ * inserted in @timeline from the thread default main context in small
+ * batches, emitting #GESTimeline::load-progress after each of them. Updates
+ * of @timeline are disabled until all the objects are inserted, and then
+ * restored to their previous state.
+ *
+ * Projects whose formatter can not be run from a worker thread are loaded in
+ * one go from the main context.
+ *
+ * If the operation is cancelled, the objects inserted so far are left in
+ * @timeline.
+ *
+ * When the operation is finished, @callback will be called. You can then call
+ * ges_timeline_load_from_uri_finish() to get the result of the operation.
+ */
+void
+ges_timeline_load_from_uri_async (GESTimeline * timeline, const gchar * uri,
+    GCancellable * cancellable, GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  LoadData *data;
+  GSimpleAsyncResult *thread_res;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+  g_return_if_fail (uri != NULL);
+
+  data = g_slice_new0 (LoadData);
+  data->timeline = gst_object_ref (timeline);
+  data->uri = g_strdup (uri);
+  data->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+  data->result = g_simple_async_result_new (G_OBJECT (timeline), callback,
+      user_data, ges_timeline_load_from_uri_async);
+
+  thread_res = g_simple_async_result_new (G_OBJECT (timeline),
+      (GAsyncReadyCallback) load_thread_done_cb, data, NULL);
+  g_simple_async_result_set_op_res_gpointer (thread_res, data, NULL);
+  g_simple_async_result_set_check_cancellable (thread_res, cancellable);
+  g_simple_async_result_run_in_thread (thread_res, load_thread_func,
+      G_PRIORITY_DEFAULT, cancellable);
+  g_object_unref (thread_res);
+}
+
+/**
+ * ges_timeline_load_from_uri_finish:
+ * @timeline: a #GESTimeline
+ * @result: a #GAsyncResult
+ * @error: a #GError location to store the error occurring, or %NULL to ignore
+ *
+ * Finishes an operation started with ges_timeline_load_from_uri_async().
+ *
+ * Returns: %TRUE if the project was loaded, else %FALSE.
+ */
+gboolean
+ges_timeline_load_from_uri_finish (GESTimeline * timeline,
+    GAsyncResult * result, GError ** error)
+{
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+          G_OBJECT (timeline), ges_timeline_load_from_uri_async), FALSE);
+
+  return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT
+      (result), error);
+}
+
 /**
  * ges_timeline_save_to_uri:
  * @timeline: a #GESTimeline
@@ -2053,6 +2722,120 @@ fail:
   return ret;
 }
 
+/**
+ * ges_timeline_start_journal:
+ * @timeline: a #GESTimeline
+ * @uri: The location of the journal
+ *
+ * Starts recording the edits made to @timeline in a journal at @uri.
+ *
+ * The journal starts with a snapshot of @timeline and each edit made after it
+ * (adding, removing, moving or trimming objects, changing their properties,
+ * adding or removing layers and tracks) is appended to it as it happens, or
+ * when the batch started with ges_timeline_begin_edit() is committed. This
+ * is much cheaper than saving the whole timeline after each edit, which makes
+ * it suited to autosaving. Once enough edits were recorded, the journal is
+ * compacted into a new snapshot from the default #GMainContext.
+ *
+ * Use ges_timeline_replay_journal() to recover the timeline from the journal.
+ *
+ * If a journal was already being recorded, it is stopped first.
+ *
+ * Returns: %TRUE if the journal could be written to @uri, else %FALSE.
+ */
+gboolean
+ges_timeline_start_journal (GESTimeline * timeline, const gchar * uri)
+{
+  gchar *location;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (uri != NULL, FALSE);
+
+  ges_timeline_stop_journal (timeline);
+
+  if (!(location = gst_uri_get_location (uri))) {
+    GST_ERROR ("unsupported uri '%s'", uri);
+    return FALSE;
+  }
+
+  timeline->priv->journal = ges_timeline_journal_new (timeline, location);
+  g_free (location);
+
+  return timeline->priv->journal != NULL;
+}
+
+/**
+ * ges_timeline_stop_journal:
+ * @timeline: a #GESTimeline
+ *
+ * Stops recording the edits made to @timeline. The journal is left as is, it
+ * can still be replayed.
+ */
+void
+ges_timeline_stop_journal (GESTimeline * timeline)
+{
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  if (timeline->priv->journal) {
+    ges_timeline_journal_free (timeline->priv->journal);
+    timeline->priv->journal = NULL;
+  }
+}
+
+/**
+ * ges_timeline_compact_journal:
+ * @timeline: a #GESTimeline
+ *
+ * Rewrites the journal started with ges_timeline_start_journal() as a
+ * snapshot of the current state of @timeline, dropping the edits it recorded.
+ *
+ * Returns: %TRUE if the journal was compacted, %FALSE if there is no journal
+ * or if it could not be written.
+ */
+gboolean
+ges_timeline_compact_journal (GESTimeline * timeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+
+  if (timeline->priv->journal == NULL)
+    return FALSE;
+
+  return ges_timeline_journal_compact (timeline->priv->journal);
+}
+
+/**
+ * ges_timeline_replay_journal:
+ * @timeline: an empty #GESTimeline
+ * @uri: The location of the journal
+ *
+ * Recovers in @timeline the state recorded in the journal at @uri, that is
+ * its last snapshot with the edits recorded after it applied on top of it.
+ *
+ * Returns: %TRUE if the journal was replayed, else %FALSE.
+ */
+gboolean
+ges_timeline_replay_journal (GESTimeline * timeline, const gchar * uri)
+{
+  gchar *location;
+  gboolean ret;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (uri != NULL, FALSE);
+
+  if (!(location = gst_uri_get_location (uri))) {
+    GST_ERROR ("unsupported uri '%s'", uri);
+    return FALSE;
+  }
+
+  ges_timeline_enable_update (timeline, FALSE);
+  ret = ges_timeline_journal_replay (timeline, location);
+  ges_timeline_enable_update (timeline, TRUE);
+
+  g_free (location);
+
+  return ret;
+}
+
 /**
  * ges_timeline_append_layer:
  * @timeline: a #GESTimeline
@@ -2479,3 +3262,79 @@ ges_timeline_get_duration (GESTimeline * timeline)
 
   return timeline->priv->duration;
 }
+
+/**
+ * ges_timeline_begin_edit:
+ * @timeline: a #GESTimeline
+ *
+ * Starts a batch of modifications of @timeline. Until the matching call to
+ * ges_timeline_commit_edit(), moving, trimming, adding or removing objects
+ * only records what changed: the objects of the #GESTrack-s, the gaps and
+ * the snapping data are resorted only once when the batch is committed, and
+ * each GNonLin composition is updated a single time.
+ *
+ * Calls can be nested, only the outermost ges_timeline_commit_edit()
+ * applies the changes.
+ *
+ * Since: 0.10.XX
+ */
+void
+ges_timeline_begin_edit (GESTimeline * timeline)
+{
+  GESTimelinePrivate *priv;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+
+  if (priv->edit_depth++ > 0)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "Beginning batch edition");
+
+  if (priv->journal)
+    ges_timeline_journal_begin_batch (priv->journal);
+
+  priv->updating_before_edit = ges_timeline_is_updating (timeline);
+  if (priv->updating_before_edit)
+    ges_timeline_enable_update_internal (timeline, FALSE);
+}
+
+/**
+ * ges_timeline_commit_edit:
+ * @timeline: a #GESTimeline
+ *
+ * Ends a batch of modifications started with ges_timeline_begin_edit(). If
+ * this was the outermost batch, everything that was changed meanwhile is
+ * resorted at once and the GNonLin compositions are updated.
+ *
+ * Returns: %TRUE if the changes could be committed, else %FALSE.
+ *
+ * Since: 0.10.XX
+ */
+gboolean
+ges_timeline_commit_edit (GESTimeline * timeline)
+{
+  GESTimelinePrivate *priv;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (timeline->priv->edit_depth > 0, FALSE);
+
+  priv = timeline->priv;
+
+  if (--priv->edit_depth > 0)
+    return TRUE;
+
+  GST_DEBUG_OBJECT (timeline, "Committing batch edition");
+
+  if (priv->journal)
+    ges_timeline_journal_end_batch (priv->journal);
+
+  ensure_sorted (timeline);
+  timeline_update_duration (timeline);
+
+  if (priv->updating_before_edit)
+    return ges_timeline_enable_update_internal (timeline, TRUE);
+
+  return TRUE;
+}
@@ -22,6 +22,7 @@
 #define _GES_TIMELINE
 
 #include <glib-object.h>
+#include <gio/gio.h>
 #include <gst/gst.h>
 #include <gst/pbutils/gstdiscoverer.h>
 #include <ges/ges-types.h>
@@ -86,8 +87,20 @@ GESTimeline* ges_timeline_new (void);
 GESTimeline* ges_timeline_new_from_uri (const gchar *uri);
 
 gboolean ges_timeline_load_from_uri (GESTimeline *timeline, const gchar *uri);
+void ges_timeline_load_from_uri_async (GESTimeline *timeline, const gchar *uri,
+                                       GCancellable *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data);
+gboolean ges_timeline_load_from_uri_finish (GESTimeline *timeline,
+                                            GAsyncResult *result,
+                                            GError **error);
 gboolean ges_timeline_save_to_uri (GESTimeline *timeline, const gchar *uri);
 
+gboolean ges_timeline_start_journal (GESTimeline *timeline, const gchar *uri);
+void ges_timeline_stop_journal (GESTimeline *timeline);
+gboolean ges_timeline_compact_journal (GESTimeline *timeline);
+gboolean ges_timeline_replay_journal (GESTimeline *timeline, const gchar *uri);
+
 gboolean ges_timeline_add_layer (GESTimeline *timeline, GESTimelineLayer *layer);
 GESTimelineLayer * ges_timeline_append_layer (GESTimeline * timeline);
 gboolean ges_timeline_remove_layer (GESTimeline *timeline, GESTimelineLayer *layer);
@@ -102,6 +115,9 @@ GList *ges_timeline_get_tracks (GESTimeline *timeline);
 gboolean ges_timeline_enable_update(GESTimeline * timeline, gboolean enabled);
 gboolean ges_timeline_is_updating (GESTimeline * timeline);
 
+void ges_timeline_begin_edit (GESTimeline * timeline);
+gboolean ges_timeline_commit_edit (GESTimeline * timeline);
+
 GstClockTime ges_timeline_get_duration (GESTimeline *timeline);
 
 G_END_DECLS
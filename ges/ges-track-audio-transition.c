@@ -27,26 +27,26 @@
 #include "ges-track-object.h"
 #include "ges-track-audio-transition.h"
 
-#include <gst/controller/gstdirectcontrolbinding.h>
-
 G_DEFINE_TYPE (GESTrackAudioTransition, ges_track_audio_transition,
     GES_TYPE_TRACK_TRANSITION);
 
 struct _GESTrackAudioTransitionPrivate
 {
-  /* these enable volume interpolation. Unlike video, both inputs are adjusted
-   * simultaneously */
-  GstControlSource *a_control_source;
-
-  GstControlSource *b_control_source;
+  /* Applies the gains of both inputs and mixes them in a single pass */
+  GstElement *crossfade;
 
+  GESAudioTransitionCurve curve;
+  guint64 dur;
 };
 
 enum
 {
   PROP_0,
+  PROP_CURVE,
+  PROP_LAST
 };
 
+static GParamSpec *properties[PROP_LAST];
 
 #define fast_element_link(a,b) gst_element_link_pads_full((a),"src",(b),"sink",GST_PAD_LINK_CHECK_NOTHING)
 
@@ -66,6 +66,10 @@ static void ges_track_audio_transition_get_property (GObject * object, guint
 static void ges_track_audio_transition_set_property (GObject * object, guint
     property_id, const GValue * value, GParamSpec * pspec);
 
+static inline void
+ges_track_audio_transition_set_curve_internal (GESTrackAudioTransition * self,
+    GESAudioTransitionCurve curve);
+
 static void
 ges_track_audio_transition_class_init (GESTrackAudioTransitionClass * klass)
 {
@@ -82,6 +86,18 @@ ges_track_audio_transition_class_init (GESTrackAudioTransitionClass * klass)
   object_class->dispose = ges_track_audio_transition_dispose;
   object_class->finalize = ges_track_audio_transition_finalize;
 
+  /**
+   * GESTrackAudioTransition:curve:
+   *
+   * The #GESAudioTransitionCurve the gains of both inputs follow.
+   */
+  properties[PROP_CURVE] =
+      g_param_spec_enum ("curve", "Curve", "The shape of the crossfade",
+      GES_TYPE_AUDIO_TRANSITION_CURVE, GES_AUDIO_TRANSITION_CURVE_LINEAR,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_CURVE,
+      properties[PROP_CURVE]);
+
   toclass->duration_changed = ges_track_audio_transition_duration_changed;
 
   toclass->create_element = ges_track_audio_transition_create_element;
@@ -94,6 +110,10 @@ ges_track_audio_transition_init (GESTrackAudioTransition * self)
 
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_TRACK_AUDIO_TRANSITION, GESTrackAudioTransitionPrivate);
+
+  self->priv->crossfade = NULL;
+  self->priv->curve = GES_AUDIO_TRANSITION_CURVE_LINEAR;
+  self->priv->dur = GST_CLOCK_TIME_NONE;
 }
 
 static void
@@ -103,16 +123,9 @@ ges_track_audio_transition_dispose (GObject * object)
 
   self = GES_TRACK_AUDIO_TRANSITION (object);
 
-  if (self->priv->a_control_source) {
-    if (self->priv->a_control_source)
-      gst_object_unref (self->priv->a_control_source);
-    self->priv->a_control_source = NULL;
-  }
-
-  if (self->priv->b_control_source) {
-    if (self->priv->b_control_source)
-      gst_object_unref (self->priv->b_control_source);
-    self->priv->b_control_source = NULL;
+  if (self->priv->crossfade) {
+    gst_object_unref (self->priv->crossfade);
+    self->priv->crossfade = NULL;
   }
 
   G_OBJECT_CLASS (ges_track_audio_transition_parent_class)->dispose (object);
@@ -128,7 +141,12 @@ static void
 ges_track_audio_transition_get_property (GObject * object,
     guint property_id, GValue * value, GParamSpec * pspec)
 {
+  GESTrackAudioTransition *self = GES_TRACK_AUDIO_TRANSITION (object);
+
   switch (property_id) {
+    case PROP_CURVE:
+      g_value_set_enum (value, self->priv->curve);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -138,64 +156,51 @@ static void
 ges_track_audio_transition_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec)
 {
+  GESTrackAudioTransition *self = GES_TRACK_AUDIO_TRANSITION (object);
+
   switch (property_id) {
+    case PROP_CURVE:
+      ges_track_audio_transition_set_curve_internal (self,
+          g_value_get_enum (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
 }
 
-static GObject *
-link_element_to_mixer_with_volume (GstBin * bin, GstElement * element,
-    GstElement * mixer)
-{
-  GstElement *volume = gst_element_factory_make ("volume", NULL);
-
-  gst_bin_add (bin, volume);
-
-  if (!fast_element_link (element, volume) ||
-      !gst_element_link_pads_full (volume, "src", mixer, "sink_%u",
-          GST_PAD_LINK_CHECK_NOTHING))
-    GST_ERROR_OBJECT (bin, "Error linking volume to mixer");
-
-  return G_OBJECT (volume);
-}
-
+/* Each input goes through a converter, which is passthrough when the input
+ * already has the format the crossfade negotiated with the track, so the
+ * samples are only touched once, by the crossfade itself. */
 static GstElement *
 ges_track_audio_transition_create_element (GESTrackObject * object)
 {
   GESTrackAudioTransition *self;
-  GstElement *topbin, *iconva, *iconvb, *oconv;
-  GObject *atarget, *btarget = NULL;
-  const gchar *propname = "volume";
-  GstElement *mixer = NULL;
+  GstElement *topbin, *iconva, *iconvb, *crossfade;
   GstPad *sinka_target, *sinkb_target, *src_target, *sinka, *sinkb, *src;
-  GstControlSource *acontrol_source, *bcontrol_source;
 
   self = GES_TRACK_AUDIO_TRANSITION (object);
 
-
   GST_LOG ("creating an audio bin");
 
   topbin = gst_bin_new ("transition-bin");
   iconva = gst_element_factory_make ("audioconvert", "tr-aconv-a");
   iconvb = gst_element_factory_make ("audioconvert", "tr-aconv-b");
-  oconv = gst_element_factory_make ("audioconvert", "tr-aconv-output");
-
-  gst_bin_add_many (GST_BIN (topbin), iconva, iconvb, oconv, NULL);
+  crossfade = gst_element_factory_make ("gesaudiocrossfade", "tr-crossfade");
+  g_assert (crossfade);
 
-  mixer = gst_element_factory_make ("adder", NULL);
-  gst_bin_add (GST_BIN (topbin), mixer);
+  g_object_set (crossfade, "curve", self->priv->curve, "duration",
+      self->priv->dur, NULL);
 
-  atarget = link_element_to_mixer_with_volume (GST_BIN (topbin), iconva, mixer);
-  btarget = link_element_to_mixer_with_volume (GST_BIN (topbin), iconvb, mixer);
+  gst_bin_add_many (GST_BIN (topbin), iconva, iconvb, crossfade, NULL);
 
-  g_assert (atarget && btarget);
-
-  fast_element_link (mixer, oconv);
+  gst_element_link_pads_full (iconva, "src", crossfade, "sink_a",
+      GST_PAD_LINK_CHECK_NOTHING);
+  gst_element_link_pads_full (iconvb, "src", crossfade, "sink_b",
+      GST_PAD_LINK_CHECK_NOTHING);
 
   sinka_target = gst_element_get_static_pad (iconva, "sink");
   sinkb_target = gst_element_get_static_pad (iconvb, "sink");
-  src_target = gst_element_get_static_pad (oconv, "src");
+  src_target = gst_element_get_static_pad (crossfade, "src");
 
   sinka = gst_ghost_pad_new ("sinka", sinka_target);
   sinkb = gst_ghost_pad_new ("sinkb", sinkb_target);
@@ -205,26 +210,11 @@ ges_track_audio_transition_create_element (GESTrackObject * object)
   gst_element_add_pad (topbin, sinka);
   gst_element_add_pad (topbin, sinkb);
 
-  /* set up interpolation */
-
   gst_object_unref (sinka_target);
   gst_object_unref (sinkb_target);
   gst_object_unref (src_target);
 
-  acontrol_source = gst_interpolation_control_source_new ();
-  gst_object_add_control_binding (GST_OBJECT (atarget),
-      gst_direct_control_binding_new (GST_OBJECT (atarget), propname,
-          acontrol_source));
-  g_object_set (acontrol_source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
-
-  bcontrol_source = gst_interpolation_control_source_new ();
-  gst_object_add_control_binding (GST_OBJECT (btarget),
-      gst_direct_control_binding_new (GST_OBJECT (btarget), propname,
-          bcontrol_source));
-  g_object_set (acontrol_source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
-
-  self->priv->a_control_source = acontrol_source;
-  self->priv->b_control_source = bcontrol_source;
+  self->priv->crossfade = gst_object_ref (crossfade);
 
   return topbin;
 }
@@ -234,32 +224,60 @@ ges_track_audio_transition_duration_changed (GESTrackObject * object,
     guint64 duration)
 {
   GESTrackAudioTransition *self;
-  GstElement *gnlobj = ges_track_object_get_gnlobject (object);
-  GstTimedValueControlSource *ta, *tb;
 
   self = GES_TRACK_AUDIO_TRANSITION (object);
 
-  GST_LOG ("updating controller: gnlobj (%p)", gnlobj);
+  GST_INFO ("duration: %" G_GUINT64_FORMAT, duration);
 
-  if (G_UNLIKELY ((!gnlobj || !self->priv->a_control_source ||
-              !self->priv->b_control_source)))
-    return;
+  self->priv->dur = duration;
+  if (self->priv->crossfade)
+    g_object_set (self->priv->crossfade, "duration", duration, NULL);
+}
 
-  GST_INFO ("duration: %" G_GUINT64_FORMAT, duration);
+static inline void
+ges_track_audio_transition_set_curve_internal (GESTrackAudioTransition * self,
+    GESAudioTransitionCurve curve)
+{
+  self->priv->curve = curve;
+  if (self->priv->crossfade)
+    g_object_set (self->priv->crossfade, "curve", curve, NULL);
+}
+
+/**
+ * ges_track_audio_transition_set_curve:
+ * @self: The #GESTrackAudioTransition to set the curve on
+ * @curve: The #GESAudioTransitionCurve to use
+ *
+ * Sets the shape of the gains applied to both inputs of @self. Equal power
+ * crossfades keep the loudness constant when the inputs are not correlated,
+ * which is the common case between two clips.
+ */
+void
+ges_track_audio_transition_set_curve (GESTrackAudioTransition * self,
+    GESAudioTransitionCurve curve)
+{
+  g_return_if_fail (GES_IS_TRACK_AUDIO_TRANSITION (self));
 
-  GST_LOG ("setting values on controller");
-  ta = GST_TIMED_VALUE_CONTROL_SOURCE (self->priv->a_control_source);
-  tb = GST_TIMED_VALUE_CONTROL_SOURCE (self->priv->b_control_source);
+  ges_track_audio_transition_set_curve_internal (self, curve);
 
-  gst_timed_value_control_source_unset_all (ta);
-  gst_timed_value_control_source_set (ta, 0, 1.0);
-  gst_timed_value_control_source_set (ta, duration, 0.0);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CURVE]);
+}
 
-  gst_timed_value_control_source_unset_all (tb);
-  gst_timed_value_control_source_set (tb, 0, 0.0);
-  gst_timed_value_control_source_set (tb, duration, 1.0);
+/**
+ * ges_track_audio_transition_get_curve:
+ * @self: The #GESTrackAudioTransition to get the curve from
+ *
+ * Get the shape of the gains applied to both inputs of @self.
+ *
+ * Returns: The #GESAudioTransitionCurve of @self
+ */
+GESAudioTransitionCurve
+ges_track_audio_transition_get_curve (GESTrackAudioTransition * self)
+{
+  g_return_val_if_fail (GES_IS_TRACK_AUDIO_TRANSITION (self),
+      GES_AUDIO_TRANSITION_CURVE_LINEAR);
 
-  GST_LOG ("done updating controller");
+  return self->priv->curve;
 }
 
 /**
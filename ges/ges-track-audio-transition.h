@@ -72,6 +72,12 @@ GType ges_track_audio_transition_get_type (void);
 
 GESTrackAudioTransition* ges_track_audio_transition_new (void);
 
+void ges_track_audio_transition_set_curve (GESTrackAudioTransition * self,
+                                           GESAudioTransitionCurve curve);
+
+GESAudioTransitionCurve
+ges_track_audio_transition_get_curve      (GESTrackAudioTransition * self);
+
 G_END_DECLS
 
 #endif /* _GES_TRACK_AUDIO_transition */
@@ -34,7 +34,8 @@ G_DEFINE_TYPE (GESTrackFileSource, ges_track_filesource, GES_TYPE_TRACK_SOURCE);
 
 struct _GESTrackFileSourcePrivate
 {
-  void *dummy;
+  /* The uri actually played, if not @uri, see GESTimeline:use-proxies */
+  gchar *proxy_uri;
 };
 
 enum
@@ -80,6 +81,10 @@ ges_track_filesource_dispose (GObject * object)
 
   if (tfs->uri)
     g_free (tfs->uri);
+  tfs->uri = NULL;
+
+  g_free (tfs->priv->proxy_uri);
+  tfs->priv->proxy_uri = NULL;
 
   G_OBJECT_CLASS (ges_track_filesource_parent_class)->dispose (object);
 }
@@ -88,9 +93,11 @@ static GstElement *
 ges_track_filesource_create_gnl_object (GESTrackObject * object)
 {
   GstElement *gnlobject;
+  GESTrackFileSource *tfs = (GESTrackFileSource *) object;
 
   gnlobject = gst_element_factory_make ("gnlurisource", NULL);
-  g_object_set (gnlobject, "uri", ((GESTrackFileSource *) object)->uri, NULL);
+  g_object_set (gnlobject, "uri",
+      tfs->priv->proxy_uri ? tfs->priv->proxy_uri : tfs->uri, NULL);
 
   return gnlobject;
 }
@@ -139,3 +146,36 @@ ges_track_filesource_new (gchar * uri)
 {
   return g_object_new (GES_TYPE_TRACK_FILESOURCE, "uri", uri, NULL);
 }
+
+/* ges_track_filesource_set_proxy_uri:
+ * @source: a #GESTrackFileSource
+ * @proxy_uri: (allow-none): The uri to play instead of #GESTrackFileSource:uri
+ * or %NULL to play the original file
+ *
+ * The new uri is only used by the gnlobject the next time it goes to
+ * %GST_STATE_READY.
+ *
+ * Returns: %TRUE if the uri to play changed, %FALSE otherwise.
+ */
+gboolean
+ges_track_filesource_set_proxy_uri (GESTrackFileSource * source,
+    const gchar * proxy_uri)
+{
+  GstElement *gnlobject;
+  GESTrackFileSourcePrivate *priv = source->priv;
+
+  if (!g_strcmp0 (priv->proxy_uri, proxy_uri))
+    return FALSE;
+
+  GST_DEBUG_OBJECT (source, "Playing %s", proxy_uri ? proxy_uri : source->uri);
+
+  g_free (priv->proxy_uri);
+  priv->proxy_uri = g_strdup (proxy_uri);
+
+  gnlobject = ges_track_object_get_gnlobject (GES_TRACK_OBJECT (source));
+  if (gnlobject)
+    g_object_set (gnlobject, "uri", proxy_uri ? proxy_uri : source->uri,
+        NULL);
+
+  return TRUE;
+}
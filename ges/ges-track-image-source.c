@@ -26,6 +26,11 @@
  * Outputs the video stream from a given file as a still frame. The frame
  * chosen will be determined by the in-point property on the track object. For
  * image files, do not set the in-point property.
+ *
+ * The frames, decoded and scaled to the caps of the track, are kept in a
+ * cache shared by all the #GESTrackImageSource-s of the process, so a file
+ * used several times with the same in-point in tracks with the same caps
+ * (or prerolled again) is only decoded and scaled once.
  */
 
 #include "ges-internal.h"
@@ -37,10 +42,42 @@ G_DEFINE_TYPE (GESTrackImageSource, ges_track_image_source,
 
 struct _GESTrackImageSourcePrivate
 {
-  /*  Dummy variable */
-  void *nothing;
+  /* The cached frame played, if any */
+  GstSample *sample;
 };
 
+/* Process wide LRU cache of the frames as output by the sources, keyed by
+ * uri, in-point, which picks the frame of video files, and track caps */
+#define IMAGE_CACHE_MAX_SIZE (128 * 1024 * 1024)
+
+GESLruCache *
+ges_track_image_source_get_cache (void)
+{
+  static gsize cache = 0;
+
+  if (g_once_init_enter (&cache))
+    g_once_init_leave (&cache, (gsize) ges_lru_cache_new (IMAGE_CACHE_MAX_SIZE,
+            g_str_hash, g_str_equal, g_free, (GBoxedCopyFunc) gst_sample_ref,
+            (GDestroyNotify) gst_sample_unref));
+
+  return (GESLruCache *) cache;
+}
+
+static gchar *
+image_cache_key (GESTrackImageSource * self)
+{
+  GESTrack *track = ges_track_object_get_track (GES_TRACK_OBJECT (self));
+  const GstCaps *caps = track ? ges_track_get_caps (track) : NULL;
+  gchar *caps_str, *key;
+
+  caps_str = caps ? gst_caps_to_string (caps) : g_strdup ("ANY");
+  key = g_strdup_printf ("%s %" G_GUINT64_FORMAT " %s", self->uri,
+      ges_track_object_get_inpoint (GES_TRACK_OBJECT (self)), caps_str);
+  g_free (caps_str);
+
+  return key;
+}
+
 enum
 {
   PROP_0,
@@ -84,6 +121,12 @@ ges_track_image_source_dispose (GObject * object)
 
   if (tfs->uri)
     g_free (tfs->uri);
+  tfs->uri = NULL;
+
+  if (tfs->priv->sample) {
+    gst_sample_unref (tfs->priv->sample);
+    tfs->priv->sample = NULL;
+  }
 
   G_OBJECT_CLASS (ges_track_image_source_parent_class)->dispose (object);
 }
@@ -110,14 +153,80 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GstElement * scale)
   GST_DEBUG ("pad failed to link properly");
 }
 
+/* Keeps the frame shown at the in-point, as output by this source */
+static GstPadProbeReturn
+store_frame_probe (GstPad * pad, GstPadProbeInfo * info,
+    GESTrackImageSource * self)
+{
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  guint64 inpoint = ges_track_object_get_inpoint (GES_TRACK_OBJECT (self));
+  GstSample *sample;
+  GstCaps *caps;
+
+  /* Skip the frames decoded before gnlsource seeked to the in-point */
+  if (inpoint != 0) {
+    GstClockTime end = GST_BUFFER_TIMESTAMP (buffer);
+
+    if (!GST_CLOCK_TIME_IS_VALID (end))
+      return GST_PAD_PROBE_OK;
+
+    if (GST_BUFFER_DURATION_IS_VALID (buffer))
+      end += GST_BUFFER_DURATION (buffer);
+    if (end <= inpoint)
+      return GST_PAD_PROBE_OK;
+  }
+
+  caps = gst_pad_get_current_caps (pad);
+  if (caps == NULL)
+    return GST_PAD_PROBE_OK;
+
+  /* In system memory, so that the decoder's buffer pool can be freed */
+  if ((sample = ges_video_sample_new_copy (buffer, caps)))
+    ges_lru_cache_insert (ges_track_image_source_get_cache (),
+        image_cache_key (self), sample,
+        gst_buffer_get_size (gst_sample_get_buffer (sample)));
+  gst_caps_unref (caps);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+/* Pushes the cached frame once */
+static void
+need_data_cb (GstElement * appsrc, guint length, GESTrackImageSource * self)
+{
+  GstFlowReturn ret;
+
+  g_signal_emit_by_name (appsrc, "push-buffer",
+      gst_sample_get_buffer (self->priv->sample), &ret);
+  g_signal_emit_by_name (appsrc, "end-of-stream", &ret);
+}
+
 static GstElement *
 ges_track_image_source_create_element (GESTrackObject * object)
 {
   GstElement *bin, *source, *scale, *freeze, *iconv;
   GstPad *src, *target;
+  GESTrackImageSource *self = (GESTrackImageSource *) object;
+  gchar *key;
+
+  if (self->priv->sample)
+    gst_sample_unref (self->priv->sample);
+  key = image_cache_key (self);
+  self->priv->sample = ges_lru_cache_lookup (ges_track_image_source_get_cache
+      (), key);
+  GST_DEBUG_OBJECT (self, "Image cache %s for %s",
+      self->priv->sample ? "hit" : "miss", key);
+  g_free (key);
 
   bin = GST_ELEMENT (gst_bin_new ("still-image-bin"));
-  source = gst_element_factory_make ("uridecodebin", NULL);
+  if (self->priv->sample) {
+    /* The frame is already decoded and scaled, videoscale and videoconvert
+     * are passthrough unless downstream negotiates other caps */
+    source = gst_element_factory_make ("appsrc", NULL);
+    g_object_set (source, "caps", gst_sample_get_caps (self->priv->sample),
+        "format", GST_FORMAT_TIME, "emit-signals", TRUE, NULL);
+  } else
+    source = gst_element_factory_make ("uridecodebin", NULL);
   scale = gst_element_factory_make ("videoscale", NULL);
   freeze = gst_element_factory_make ("imagefreeze", NULL);
   iconv = gst_element_factory_make ("videoconvert", NULL);
@@ -139,10 +248,26 @@ ges_track_image_source_create_element (GESTrackObject * object)
   gst_element_add_pad (bin, src);
   gst_object_unref (target);
 
-  g_object_set (source, "uri", ((GESTrackImageSource *) object)->uri, NULL);
+  if (self->priv->sample) {
+    gst_element_link_pads_full (source, "src", scale, "sink",
+        GST_PAD_LINK_CHECK_NOTHING);
+
+    g_signal_connect (G_OBJECT (source), "need-data",
+        G_CALLBACK (need_data_cb), self);
+  } else {
+    GstPad *freezesink = gst_element_get_static_pad (freeze, "sink");
 
-  g_signal_connect (G_OBJECT (source), "pad-added",
-      G_CALLBACK (pad_added_cb), scale);
+    /* Cache the frame scaled and converted, so that the next sources with
+     * the same caps do not have to process it again */
+    gst_pad_add_probe (freezesink, GST_PAD_PROBE_TYPE_BUFFER,
+        (GstPadProbeCallback) store_frame_probe, self, NULL);
+    gst_object_unref (freezesink);
+
+    g_object_set (source, "uri", self->uri, NULL);
+
+    g_signal_connect (G_OBJECT (source), "pad-added",
+        G_CALLBACK (pad_added_cb), scale);
+  }
 
   return bin;
 }
@@ -33,6 +33,7 @@
 #include "ges-internal.h"
 #include "ges-track-object.h"
 #include "ges-timeline-object.h"
+#include "ges-track-source.h"
 #include <gobject/gvaluecollector.h>
 
 G_DEFINE_ABSTRACT_TYPE (GESTrackObject, ges_track_object,
@@ -50,10 +51,21 @@ struct _GESTrackObjectPrivate
   GstElement *gnlobject;        /* The GnlObject */
   GstElement *element;          /* The element contained in the gnlobject (can be NULL) */
 
+  /* %TRUE if the track we are in creates elements lazily and we can release
+   * our element, see ges_track_object_materialize() */
+  gboolean lazy;
+  /* %TRUE if create_element has not been called yet (or its result has been
+   * released) */
+  gboolean element_pending;
+
   /* We keep a link between properties name and elements internally
    * The hashtable should look like
    * {GParamaSpec ---> element,}*/
   GHashTable *properties_hashtable;
+  /* Index of the children properties by name, the keys are interned
+   * "property-name" and "ClassName::property-name" strings
+   * {name ---> ChildProperty,} */
+  GHashTable *children_props;
 
   GESTimelineObject *timelineobj;
   GESTrack *track;
@@ -66,6 +78,13 @@ struct _GESTrackObjectPrivate
                                  * GESTimelineObject */
 };
 
+/* A property of a child of the gnlobject as stored in children_props */
+typedef struct
+{
+  GstElement *element;
+  GParamSpec *pspec;
+} ChildProperty;
+
 enum
 {
   PROP_0,
@@ -198,6 +217,9 @@ ges_track_object_dispose (GObject * object)
 {
   GESTrackObjectPrivate *priv = GES_TRACK_OBJECT (object)->priv;
 
+  if (priv->children_props)
+    g_hash_table_destroy (priv->children_props);
+
   if (priv->properties_hashtable)
     g_hash_table_destroy (priv->properties_hashtable);
 
@@ -368,6 +390,7 @@ ges_track_object_init (GESTrackObject * self)
   priv->pending_active = TRUE;
   priv->locked = TRUE;
   priv->properties_hashtable = NULL;
+  priv->children_props = NULL;
   priv->maxduration = GST_CLOCK_TIME_NONE;
 }
 
@@ -573,16 +596,50 @@ gst_element_prop_changed_cb (GstElement * element, GParamSpec * arg
       GST_ELEMENT (element), arg);
 }
 
+static void
+free_child_property (ChildProperty * prop)
+{
+  g_slice_free (ChildProperty, prop);
+}
+
+static void
+index_child_property (GHashTable * children_props, const gchar * name,
+    GstElement * element, GParamSpec * pspec)
+{
+  ChildProperty *prop;
+
+  name = g_intern_string (name);
+
+  /* Unqualified names resolve to the first element found */
+  if (g_hash_table_lookup (children_props, name))
+    return;
+
+  prop = g_slice_new (ChildProperty);
+  prop->element = element;
+  prop->pspec = pspec;
+  g_hash_table_insert (children_props, (gpointer) name, prop);
+}
+
 static void
 connect_signal (gpointer key, gpointer value, gpointer user_data)
 {
-  gchar *signame = g_strconcat ("notify::", G_PARAM_SPEC (key)->name, NULL);
+  GESTrackObject *object = GES_TRACK_OBJECT (user_data);
+  GParamSpec *pspec = G_PARAM_SPEC (key);
+  gchar *signame = g_strconcat ("notify::", pspec->name, NULL);
+  gchar *fullname;
 
   g_signal_connect (G_OBJECT (value),
-      signame, G_CALLBACK (gst_element_prop_changed_cb),
-      GES_TRACK_OBJECT (user_data));
+      signame, G_CALLBACK (gst_element_prop_changed_cb), object);
 
   g_free (signame);
+
+  /* Index the property both as "name" and "ClassName::name" */
+  fullname = g_strconcat (G_OBJECT_TYPE_NAME (value), "::", pspec->name, NULL);
+  index_child_property (object->priv->children_props, fullname,
+      GST_ELEMENT (value), pspec);
+  index_child_property (object->priv->children_props, pspec->name,
+      GST_ELEMENT (value), pspec);
+  g_free (fullname);
 }
 
 static void
@@ -593,11 +650,26 @@ connect_properties_signals (GESTrackObject * object)
     return;
   }
 
+  if (object->priv->children_props)
+    g_hash_table_destroy (object->priv->children_props);
+  /* The keys are interned strings so we can use them as they are */
+  object->priv->children_props = g_hash_table_new_full (g_str_hash,
+      g_str_equal, NULL, (GDestroyNotify) free_child_property);
+
   g_hash_table_foreach (object->priv->properties_hashtable,
       (GHFunc) connect_signal, object);
 
 }
 
+static inline ChildProperty *
+lookup_child_property (GESTrackObject * object, const gchar * prop_name)
+{
+  if (G_UNLIKELY (object->priv->children_props == NULL))
+    return NULL;
+
+  return g_hash_table_lookup (object->priv->children_props, prop_name);
+}
+
 /* Callbacks from the GNonLin object */
 static void
 gnlobject_media_start_cb (GstElement * gnlobject,
@@ -706,7 +778,10 @@ ges_track_object_create_gnl_object_func (GESTrackObject * self)
   if (G_UNLIKELY (gnlobject == NULL))
     goto no_gnlobject;
 
-  if (klass->create_element) {
+  if (klass->create_element && self->priv->lazy) {
+    GST_DEBUG ("Lazy object, the element will be created later");
+    self->priv->element_pending = TRUE;
+  } else if (klass->create_element) {
     GST_DEBUG ("Calling subclass 'create_element' vmethod");
     child = klass->create_element (self);
 
@@ -788,6 +863,13 @@ ensure_gnl_object (GESTrackObject * object)
   /* 2. Fill in the GnlObject */
   if (object->priv->gnlobject == NULL) {
 
+    /* Only sources are materialized lazily, effects and transitions are
+     * cheap compared to them and their children properties must stay
+     * available */
+    object->priv->lazy = (object->priv->track != NULL &&
+        ges_track_get_lazy_elements (object->priv->track) &&
+        GES_IS_TRACK_SOURCE (object));
+
     /* call the create_gnl_object virtual method */
     gnlobject = class->create_gnl_object (object);
 
@@ -879,6 +961,85 @@ ges_track_object_set_track (GESTrackObject * object, GESTrack * track)
   return TRUE;
 }
 
+/* ges_track_object_materialize:
+ * @object: a #GESTrackObject
+ *
+ * Makes sure the element of a lazily created @object exists.
+ *
+ * Returns: %TRUE if @object has its element, %FALSE otherwise
+ */
+gboolean
+ges_track_object_materialize (GESTrackObject * object)
+{
+  GstElement *child;
+  GESTrackObjectPrivate *priv = object->priv;
+  GESTrackObjectClass *klass = GES_TRACK_OBJECT_GET_CLASS (object);
+
+  if (!priv->element_pending)
+    return TRUE;
+
+  if (G_UNLIKELY (priv->gnlobject == NULL))
+    return FALSE;
+
+  GST_DEBUG_OBJECT (object, "Creating element");
+
+  child = klass->create_element (object);
+  if (G_UNLIKELY (child == NULL)) {
+    GST_ERROR_OBJECT (object, "create_element returned NULL");
+    return FALSE;
+  }
+
+  if (G_UNLIKELY (!gst_bin_add (GST_BIN (priv->gnlobject), child))) {
+    GST_ERROR_OBJECT (object, "Error adding the contents to the gnlobject");
+    gst_object_unref (child);
+    return FALSE;
+  }
+
+  priv->element = child;
+  priv->element_pending = FALSE;
+
+  return TRUE;
+}
+
+/* ges_track_object_dematerialize:
+ * @object: a #GESTrackObject
+ *
+ * Releases the element of a lazily created @object if it is not in use,
+ * it will be recreated by the next ges_track_object_materialize() call.
+ *
+ * Returns: %FALSE if the element is in use and could not be released.
+ */
+gboolean
+ges_track_object_dematerialize (GESTrackObject * object)
+{
+  GstElement *child;
+  GESTrackObjectPrivate *priv = object->priv;
+  GESTrackObjectClass *klass = GES_TRACK_OBJECT_GET_CLASS (object);
+
+  if (!priv->lazy || priv->element == NULL)
+    return TRUE;
+
+  /* The composition is currently using it */
+  if (GST_STATE (priv->gnlobject) > GST_STATE_READY) {
+    GST_DEBUG_OBJECT (object, "Element in use, not releasing it");
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (object, "Releasing element");
+
+  child = priv->element;
+  priv->element = NULL;
+  priv->element_pending = TRUE;
+
+  if (klass->release_element)
+    klass->release_element (object);
+
+  gst_element_set_state (child, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN (priv->gnlobject), child);
+
+  return TRUE;
+}
+
 /**
  * ges_track_object_get_track:
  * @object: a #GESTrackObject
@@ -952,7 +1113,8 @@ ges_track_object_get_gnlobject (GESTrackObject * object)
  * Get the #GstElement this track object is controlling within GNonLin.
  *
  * Returns: (transfer none): the #GstElement this track object is controlling
- * within GNonLin.
+ * within GNonLin. Can be %NULL if the object is in a #GESTrack with
+ * #GESTrack:lazy-elements set and is outside its materialization window.
  */
 GstElement *
 ges_track_object_get_element (GESTrackObject * object)
@@ -1143,44 +1305,22 @@ gboolean
 ges_track_object_lookup_child (GESTrackObject * object, const gchar * prop_name,
     GstElement ** element, GParamSpec ** pspec)
 {
-  GHashTableIter iter;
-  gpointer key, value;
-  gchar **names, *name, *classename;
-  gboolean res;
-  GESTrackObjectPrivate *priv;
+  ChildProperty *prop;
 
   g_return_val_if_fail (GES_IS_TRACK_OBJECT (object), FALSE);
 
-  priv = object->priv;
+  prop = lookup_child_property (object, prop_name);
+  if (prop == NULL)
+    return FALSE;
 
-  classename = NULL;
-  res = FALSE;
+  GST_DEBUG ("The %s property has been found", prop_name);
+  if (element)
+    *element = g_object_ref (prop->element);
 
-  names = g_strsplit (prop_name, "::", 2);
-  if (names[1] != NULL) {
-    classename = names[0];
-    name = names[1];
-  } else
-    name = names[0];
+  if (pspec)
+    *pspec = g_param_spec_ref (prop->pspec);
 
-  g_hash_table_iter_init (&iter, priv->properties_hashtable);
-  while (g_hash_table_iter_next (&iter, &key, &value)) {
-    if (g_strcmp0 (G_PARAM_SPEC (key)->name, name) == 0) {
-      if (classename == NULL ||
-          g_strcmp0 (G_OBJECT_TYPE_NAME (G_OBJECT (value)), classename) == 0) {
-        GST_DEBUG ("The %s property from %s has been found", name, classename);
-        if (element)
-          *element = g_object_ref (value);
-
-        *pspec = g_param_spec_ref (key);
-        res = TRUE;
-        break;
-      }
-    }
-  }
-  g_strfreev (names);
-
-  return res;
+  return TRUE;
 }
 
 /**
@@ -1248,6 +1388,7 @@ ges_track_object_set_child_property_valist (GESTrackObject * object,
   const gchar *name;
   GParamSpec *pspec;
   GstElement *element;
+  ChildProperty *prop;
 
   gchar *error = NULL;
   GValue value = { 0, };
@@ -1261,9 +1402,12 @@ ges_track_object_set_child_property_valist (GESTrackObject * object,
 
   /* iterate over pairs */
   while (name) {
-    if (!ges_track_object_lookup_child (object, name, &element, &pspec))
+    if (!(prop = lookup_child_property (object, name)))
       goto not_found;
 
+    element = prop->element;
+    pspec = prop->pspec;
+
 #if GLIB_CHECK_VERSION(2,23,3)
     G_VALUE_COLLECT_INIT (&value, pspec->value_type, var_args,
         G_VALUE_NOCOPY_CONTENTS, &error);
@@ -1277,7 +1421,6 @@ ges_track_object_set_child_property_valist (GESTrackObject * object,
 
     g_object_set_property (G_OBJECT (element), pspec->name, &value);
 
-    g_object_unref (element);
     g_value_unset (&value);
 
     name = va_arg (var_args, gchar *);
@@ -1326,6 +1469,47 @@ ges_track_object_set_child_property (GESTrackObject * object,
   va_end (var_args);
 }
 
+static gboolean
+set_child_property_foreach (GQuark field_id, const GValue * value,
+    GESTrackObject * object)
+{
+  const gchar *name = g_quark_to_string (field_id);
+  ChildProperty *prop = lookup_child_property (object, name);
+
+  if (G_UNLIKELY (prop == NULL)) {
+    GST_WARNING_OBJECT (object, "No property %s in object", name);
+    return TRUE;
+  }
+
+  g_object_set_property (G_OBJECT (prop->element), prop->pspec->name, value);
+
+  return TRUE;
+}
+
+/**
+ * ges_track_object_set_child_properties:
+ * @object: The #GESTrackObject parent object
+ * @properties: A #GstStructure whose fields are the names of the children
+ * properties to set and their values
+ *
+ * Sets several properties of children of @object at once. Field names follow
+ * the same syntax as in ges_track_object_set_child_property(), which means
+ * you can use 'ClassName::property-name' field names.
+ *
+ * This is the fastest way to set many children properties, for example
+ * when applying keyframes.
+ */
+void
+ges_track_object_set_child_properties (GESTrackObject * object,
+    const GstStructure * properties)
+{
+  g_return_if_fail (GES_IS_TRACK_OBJECT (object));
+  g_return_if_fail (properties != NULL);
+
+  gst_structure_foreach (properties,
+      (GstStructureForeachFunc) set_child_property_foreach, object);
+}
+
 /**
  * ges_track_object_get_child_property_valist:
  * @object: The #GESTrackObject parent object
@@ -1348,7 +1532,7 @@ ges_track_object_get_child_property_valist (GESTrackObject * object,
   gchar *error = NULL;
   GValue value = { 0, };
   GParamSpec *pspec;
-  GstElement *element;
+  ChildProperty *prop;
 
   g_return_if_fail (G_IS_OBJECT (object));
 
@@ -1356,12 +1540,12 @@ ges_track_object_get_child_property_valist (GESTrackObject * object,
 
   /* This part is in big part copied from the gst_child_object_get_valist method */
   while (name) {
-    if (!ges_track_object_lookup_child (object, name, &element, &pspec))
+    if (!(prop = lookup_child_property (object, name)))
       goto not_found;
 
+    pspec = prop->pspec;
     g_value_init (&value, pspec->value_type);
-    g_object_get_property (G_OBJECT (element), pspec->name, &value);
-    g_object_unref (element);
+    g_object_get_property (G_OBJECT (prop->element), pspec->name, &value);
 
     G_VALUE_LCOPY (&value, var_args, 0, &error);
     if (error)
@@ -110,6 +110,12 @@ struct _GESTrackObject {
  *                            The default implementation will create an object
  *                            of type @gnlobject_factorytype and call
  *                            @create_element. Since: 0.10.2
+ * @release_element: called when the element returned by @create_element is
+ *                   released because the object is outside the
+ *                   materialization window of a #GESTrack with
+ *                   #GESTrack:lazy-elements set. Subclasses must drop the
+ *                   references they keep on its children, @create_element
+ *                   will be called again when needed.
  *
  * Subclasses can override the @create_gnl_object method to override what type
  * of GNonLin object will be created.
@@ -139,9 +145,10 @@ struct _GESTrackObjectClass {
   GHashTable*  (*get_props_hastable)       (GESTrackObject * object);
   GParamSpec** (*list_children_properties) (GESTrackObject * object,
               guint *n_properties);
+  void         (*release_element)          (GESTrackObject * object);
   /*< private >*/
   /* Padding for API extension */
-  gpointer _ges_reserved[GES_PADDING - 2];
+  gpointer _ges_reserved[GES_PADDING - 3];
 };
 
 GType ges_track_object_get_type               (void);
@@ -226,6 +233,10 @@ void ges_track_object_set_child_property     (GESTrackObject * object,
                                               const gchar * first_property_name,
                                               ...) G_GNUC_NULL_TERMINATED;
 
+void
+ges_track_object_set_child_properties        (GESTrackObject * object,
+                                              const GstStructure * properties);
+
 GESTrackObject * ges_track_object_copy       (GESTrackObject * object,
                                               gboolean deep);
 
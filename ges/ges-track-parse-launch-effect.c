@@ -21,6 +21,11 @@
  * SECTION:ges-track-parse-launch-effect
  * @short_description: adds an effect build from a parse-launch style 
  * bin description to a stream in a #GESTimelineSource or a #GESTimelineLayer
+ *
+ * Each bin description is only parsed once per process, the following
+ * effects using it are instantiated from the elements, properties and links
+ * of the first one. Converters are added around the effect only if its
+ * elements do not accept all the formats of the track.
  */
 
 #include "ges-internal.h"
@@ -47,6 +52,43 @@ enum
   PROP_BIN_DESCRIPTION,
 };
 
+/* What is needed to instantiate a parsed bin description again */
+typedef struct
+{
+  GstElementFactory *factory;
+  gchar *name;
+  GArray *properties;           /* PropertyTemplate-s */
+} ElementTemplate;
+
+typedef struct
+{
+  const gchar *name;            /* Interned */
+  GValue value;
+} PropertyTemplate;
+
+typedef struct
+{
+  guint src, sink;              /* Indices in EffectTemplate.elements */
+  gchar *srcpad, *sinkpad;
+} LinkTemplate;
+
+typedef struct
+{
+  GPtrArray *elements;          /* ElementTemplate-s */
+  GArray *links;                /* LinkTemplate-s */
+
+  /* The pads the effect is ghosted from */
+  guint sink_element, src_element;
+  gchar *sinkpad, *srcpad;
+
+  /* The formats accepted and output by the effect */
+  GstCaps *sink_caps, *src_caps;
+} EffectTemplate;
+
+/* {bin description: EffectTemplate or %NULL if it has to be parsed} */
+static GHashTable *effect_templates = NULL;
+static GMutex effect_templates_lock;
+
 static void
 ges_track_parse_launch_effect_get_property (GObject * object,
     guint property_id, GValue * value, GParamSpec * pspec)
@@ -138,11 +180,455 @@ ges_track_parse_launch_effect_finalize (GObject * object)
       (object);
 }
 
+static gint
+find_element (GPtrArray * elements, GstElement * element)
+{
+  guint i;
+
+  for (i = 0; i < elements->len; i++) {
+    if (g_ptr_array_index (elements, i) == element)
+      return i;
+  }
+
+  return -1;
+}
+
+/* Elements with sometimes pads are linked once their pads appear, we can
+ * not replay that */
+static gboolean
+has_sometimes_pads (GstElementFactory * factory)
+{
+  const GList *tmp;
+
+  for (tmp = gst_element_factory_get_static_pad_templates (factory); tmp;
+      tmp = tmp->next) {
+    if (((GstStaticPadTemplate *) tmp->data)->presence == GST_PAD_SOMETIMES)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+static ElementTemplate *
+element_template_new (GstElement * element)
+{
+  guint i, n_pspecs;
+  GParamSpec **pspecs;
+  GstElement *reference;
+  ElementTemplate *etmpl = g_slice_new (ElementTemplate);
+
+  etmpl->factory = gst_object_ref (gst_element_get_factory (element));
+  etmpl->name = gst_element_get_name (element);
+  etmpl->properties = g_array_new (FALSE, TRUE, sizeof (PropertyTemplate));
+
+  /* Only keep what differs from a new element of the same factory, that is
+   * what was set in the description and not what the element sets itself */
+  reference = gst_element_factory_create (etmpl->factory, NULL);
+  if (reference)
+    gst_object_ref_sink (reference);
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (element),
+      &n_pspecs);
+  for (i = 0; i < n_pspecs; i++) {
+    PropertyTemplate ptmpl = { NULL, G_VALUE_INIT };
+    GValue initial = G_VALUE_INIT;
+    GParamSpec *pspec = pspecs[i];
+    gboolean set;
+
+    if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+        pspec->flags & G_PARAM_CONSTRUCT_ONLY ||
+        G_TYPE_IS_OBJECT (pspec->value_type) ||
+        !g_strcmp0 (pspec->name, "name"))
+      continue;
+
+    g_value_init (&ptmpl.value, pspec->value_type);
+    g_object_get_property (G_OBJECT (element), pspec->name, &ptmpl.value);
+
+    if (reference) {
+      g_value_init (&initial, pspec->value_type);
+      g_object_get_property (G_OBJECT (reference), pspec->name, &initial);
+      set = g_param_values_cmp (pspec, &ptmpl.value, &initial) != 0;
+      g_value_unset (&initial);
+    } else {
+      set = !g_param_value_defaults (pspec, &ptmpl.value);
+    }
+
+    if (!set) {
+      g_value_unset (&ptmpl.value);
+      continue;
+    }
+
+    ptmpl.name = g_intern_string (pspec->name);
+    g_array_append_val (etmpl->properties, ptmpl);
+  }
+  g_free (pspecs);
+
+  if (reference)
+    gst_object_unref (reference);
+
+  return etmpl;
+}
+
+static void
+element_template_free (ElementTemplate * etmpl)
+{
+  guint i;
+
+  for (i = 0; i < etmpl->properties->len; i++)
+    g_value_unset (&g_array_index (etmpl->properties, PropertyTemplate,
+            i).value);
+  g_array_free (etmpl->properties, TRUE);
+  gst_object_unref (etmpl->factory);
+  g_free (etmpl->name);
+  g_slice_free (ElementTemplate, etmpl);
+}
+
+static void
+effect_template_free (EffectTemplate * tmpl)
+{
+  guint i;
+
+  for (i = 0; i < tmpl->links->len; i++) {
+    LinkTemplate *ltmpl = &g_array_index (tmpl->links, LinkTemplate, i);
+
+    g_free (ltmpl->srcpad);
+    g_free (ltmpl->sinkpad);
+  }
+  g_array_free (tmpl->links, TRUE);
+  g_ptr_array_unref (tmpl->elements);
+  g_free (tmpl->sinkpad);
+  g_free (tmpl->srcpad);
+  if (tmpl->sink_caps)
+    gst_caps_unref (tmpl->sink_caps);
+  if (tmpl->src_caps)
+    gst_caps_unref (tmpl->src_caps);
+  g_slice_free (EffectTemplate, tmpl);
+}
+
+/* Records the ghost pad @name of @bin in @element and @padname */
+static gboolean
+get_ghost_target (GstElement * bin, const gchar * name, GPtrArray * children,
+    guint * element, gchar ** padname, GstCaps ** caps)
+{
+  GstPad *ghost, *target;
+  GstElement *parent;
+  gint index = -1;
+
+  ghost = gst_element_get_static_pad (bin, name);
+  if (ghost == NULL)
+    return FALSE;
+
+  target = gst_ghost_pad_get_target (GST_GHOST_PAD (ghost));
+  gst_object_unref (ghost);
+  if (target == NULL)
+    return FALSE;
+
+  parent = gst_pad_get_parent_element (target);
+  if (parent) {
+    index = find_element (children, parent);
+    gst_object_unref (parent);
+  }
+
+  if (index >= 0) {
+    *element = index;
+    *padname = gst_pad_get_name (target);
+    *caps = gst_pad_get_pad_template_caps (target);
+  }
+  gst_object_unref (target);
+
+  return index >= 0;
+}
+
+/* Extracts the template of a bin parsed from a description, returns %NULL
+ * if it can not be replayed */
+static EffectTemplate *
+effect_template_new (GstElement * bin)
+{
+  GstIterator *it;
+  GValue item = G_VALUE_INIT;
+  GPtrArray *children;
+  EffectTemplate *tmpl;
+  guint i;
+  gboolean done = FALSE, ok = TRUE;
+
+  children = g_ptr_array_new_with_free_func (gst_object_unref);
+
+  it = gst_bin_iterate_elements (GST_BIN (bin));
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:
+        g_ptr_array_add (children, g_value_dup_object (&item));
+        g_value_reset (&item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        g_ptr_array_set_size (children, 0);
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  for (i = 0; ok && i < children->len; i++) {
+    GstElement *child = g_ptr_array_index (children, i);
+    GstElementFactory *factory = gst_element_get_factory (child);
+
+    ok = !GST_IS_BIN (child) && factory && !has_sometimes_pads (factory);
+  }
+
+  if (!ok || children->len == 0) {
+    g_ptr_array_unref (children);
+    return NULL;
+  }
+
+  tmpl = g_slice_new0 (EffectTemplate);
+  tmpl->elements = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      element_template_free);
+  tmpl->links = g_array_new (FALSE, FALSE, sizeof (LinkTemplate));
+
+  for (i = 0; i < children->len; i++) {
+    GstElement *child = g_ptr_array_index (children, i);
+    GstIterator *pads;
+    gboolean pads_done = FALSE;
+
+    g_ptr_array_add (tmpl->elements, element_template_new (child));
+
+    pads = gst_element_iterate_src_pads (child);
+    while (!pads_done) {
+      switch (gst_iterator_next (pads, &item)) {
+        case GST_ITERATOR_OK:
+        {
+          GstPad *pad = g_value_get_object (&item);
+          GstPad *peer = gst_pad_get_peer (pad);
+          GstElement *peer_parent = peer ? gst_pad_get_parent_element (peer) :
+              NULL;
+          gint sink = peer_parent ? find_element (children, peer_parent) : -1;
+
+          /* The ghost pads targets are linked to proxy pads */
+          if (sink >= 0) {
+            LinkTemplate ltmpl;
+
+            ltmpl.src = i;
+            ltmpl.sink = sink;
+            ltmpl.srcpad = gst_pad_get_name (pad);
+            ltmpl.sinkpad = gst_pad_get_name (peer);
+            g_array_append_val (tmpl->links, ltmpl);
+          }
+
+          if (peer_parent)
+            gst_object_unref (peer_parent);
+          if (peer)
+            gst_object_unref (peer);
+          g_value_reset (&item);
+          break;
+        }
+        case GST_ITERATOR_RESYNC:
+          /* Pads of the elements of a bin we own do not change */
+        default:
+          pads_done = TRUE;
+          break;
+      }
+    }
+    g_value_unset (&item);
+    gst_iterator_free (pads);
+  }
+
+  if (!get_ghost_target (bin, "sink", children, &tmpl->sink_element,
+          &tmpl->sinkpad, &tmpl->sink_caps) ||
+      !get_ghost_target (bin, "src", children, &tmpl->src_element,
+          &tmpl->srcpad, &tmpl->src_caps)) {
+    effect_template_free (tmpl);
+    tmpl = NULL;
+  }
+
+  g_ptr_array_unref (children);
+
+  return tmpl;
+}
+
+static GstPad *
+get_pad (GstElement * element, const gchar * name)
+{
+  GstPad *pad = gst_element_get_static_pad (element, name);
+
+  if (pad == NULL)
+    pad = gst_element_get_request_pad (element, name);
+
+  return pad;
+}
+
+/* Adds the elements of @tmpl to @bin, and returns the pads the effect
+ * should be ghosted from in @sinkpad and @srcpad */
+static gboolean
+effect_template_instantiate (EffectTemplate * tmpl, GstBin * bin,
+    GstPad ** sinkpad, GstPad ** srcpad)
+{
+  guint i, j;
+  GstElement **elements = g_newa (GstElement *, tmpl->elements->len);
+
+  for (i = 0; i < tmpl->elements->len; i++) {
+    ElementTemplate *etmpl = g_ptr_array_index (tmpl->elements, i);
+
+    elements[i] = gst_element_factory_create (etmpl->factory, etmpl->name);
+    if (G_UNLIKELY (elements[i] == NULL)) {
+      GST_ERROR ("Could not create %s", etmpl->name);
+      return FALSE;
+    }
+
+    for (j = 0; j < etmpl->properties->len; j++) {
+      PropertyTemplate *ptmpl = &g_array_index (etmpl->properties,
+          PropertyTemplate, j);
+
+      g_object_set_property (G_OBJECT (elements[i]), ptmpl->name,
+          &ptmpl->value);
+    }
+
+    gst_bin_add (bin, elements[i]);
+  }
+
+  /* Those links were already checked when parsing the description */
+  for (i = 0; i < tmpl->links->len; i++) {
+    LinkTemplate *ltmpl = &g_array_index (tmpl->links, LinkTemplate, i);
+    GstPad *src = get_pad (elements[ltmpl->src], ltmpl->srcpad);
+    GstPad *sink = get_pad (elements[ltmpl->sink], ltmpl->sinkpad);
+
+    if (src && sink)
+      gst_pad_link_full (src, sink, GST_PAD_LINK_CHECK_NOTHING);
+
+    if (src)
+      gst_object_unref (src);
+    if (sink)
+      gst_object_unref (sink);
+  }
+
+  *sinkpad = get_pad (elements[tmpl->sink_element], tmpl->sinkpad);
+  *srcpad = get_pad (elements[tmpl->src_element], tmpl->srcpad);
+
+  if (*sinkpad && *srcpad)
+    return TRUE;
+
+  if (*sinkpad)
+    gst_object_unref (*sinkpad);
+  if (*srcpad)
+    gst_object_unref (*srcpad);
+  *sinkpad = *srcpad = NULL;
+
+  return FALSE;
+}
+
+/* Returns the template of @bin_description, parsing it the first time, or
+ * %NULL if it has to be parsed every time */
+static EffectTemplate *
+get_effect_template (const gchar * bin_description)
+{
+  gpointer tmpl = NULL;
+  GstElement *prototype;
+  GError *error = NULL;
+
+  g_mutex_lock (&effect_templates_lock);
+  if (G_UNLIKELY (effect_templates == NULL))
+    effect_templates = g_hash_table_new (g_str_hash, g_str_equal);
+
+  if (!g_hash_table_lookup_extended (effect_templates, bin_description, NULL,
+          &tmpl)) {
+    prototype = gst_parse_bin_from_description (bin_description, TRUE, &error);
+
+    if (prototype) {
+      gst_object_ref_sink (prototype);
+      tmpl = effect_template_new (prototype);
+      gst_object_unref (prototype);
+
+      if (tmpl == NULL)
+        GST_DEBUG ("'%s' can not be instantiated from a template",
+            bin_description);
+    }
+
+    /* Errors are reported when parsing the full description */
+    if (error)
+      g_clear_error (&error);
+    else
+      g_hash_table_insert (effect_templates, g_strdup (bin_description),
+          tmpl);
+  }
+  g_mutex_unlock (&effect_templates_lock);
+
+  return tmpl;
+}
+
+/* Whether the effect can process all the formats of @track as is */
+static gboolean
+accepts_track_caps (GESTrack * track, GstCaps * caps)
+{
+  const GstCaps *track_caps = ges_track_get_caps (track);
+
+  return track_caps && !gst_caps_is_any (track_caps) &&
+      gst_caps_is_subset (track_caps, caps);
+}
+
+static GstElement *
+create_element_from_template (GESTrack * track, EffectTemplate * tmpl)
+{
+  GstElement *bin, *convert;
+  GstPad *sinkpad, *srcpad, *pad;
+
+  bin = gst_bin_new (NULL);
+
+  if (!effect_template_instantiate (tmpl, GST_BIN (bin), &sinkpad, &srcpad)) {
+    gst_object_unref (bin);
+    return NULL;
+  }
+
+  if (track->type == GES_TRACK_TYPE_VIDEO) {
+    if (!accepts_track_caps (track, tmpl->sink_caps)) {
+      convert = gst_element_factory_make ("videoconvert", "pre_video_convert");
+      gst_bin_add (GST_BIN (bin), convert);
+      pad = gst_element_get_static_pad (convert, "src");
+      gst_pad_link_full (pad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
+      gst_object_unref (pad);
+      gst_object_unref (sinkpad);
+      sinkpad = gst_element_get_static_pad (convert, "sink");
+    }
+
+    if (!accepts_track_caps (track, tmpl->src_caps)) {
+      convert = gst_element_factory_make ("videoconvert", "post_video_convert");
+      gst_bin_add (GST_BIN (bin), convert);
+      pad = gst_element_get_static_pad (convert, "sink");
+      gst_pad_link_full (srcpad, pad, GST_PAD_LINK_CHECK_NOTHING);
+      gst_object_unref (pad);
+      gst_object_unref (srcpad);
+      srcpad = gst_element_get_static_pad (convert, "src");
+    }
+  } else if (!accepts_track_caps (track, tmpl->sink_caps)) {
+    GstElement *resample = gst_element_factory_make ("audioresample", NULL);
+
+    convert = gst_element_factory_make ("audioconvert", NULL);
+    gst_bin_add_many (GST_BIN (bin), convert, resample, NULL);
+    gst_element_link_pads_full (convert, "src", resample, "sink",
+        GST_PAD_LINK_CHECK_NOTHING);
+    pad = gst_element_get_static_pad (resample, "src");
+    gst_pad_link_full (pad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
+    gst_object_unref (pad);
+    gst_object_unref (sinkpad);
+    sinkpad = gst_element_get_static_pad (convert, "sink");
+  }
+
+  gst_element_add_pad (bin, gst_ghost_pad_new ("sink", sinkpad));
+  gst_element_add_pad (bin, gst_ghost_pad_new ("src", srcpad));
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+
+  return bin;
+}
+
 static GstElement *
 ges_track_parse_launch_effect_create_element (GESTrackObject * object)
 {
   GstElement *effect;
   gchar *bin_desc;
+  EffectTemplate *tmpl;
 
   GError *error = NULL;
   GESTrackParseLaunchEffect *self = GES_TRACK_PARSE_LAUNCH_EFFECT (object);
@@ -155,6 +641,25 @@ ges_track_parse_launch_effect_create_element (GESTrackObject * object)
     return NULL;
   }
 
+  if (track->type != GES_TRACK_TYPE_VIDEO &&
+      track->type != GES_TRACK_TYPE_AUDIO) {
+    GST_DEBUG ("Track type not supported");
+    return NULL;
+  }
+
+  tmpl = self->priv->bin_description ?
+      get_effect_template (self->priv->bin_description) : NULL;
+  if (tmpl) {
+    effect = create_element_from_template (track, tmpl);
+    GST_DEBUG ("Created effect %p from template", effect);
+
+    if (effect)
+      return effect;
+
+    GST_WARNING ("Could not instantiate the template of %s, parsing it",
+        self->priv->bin_description);
+  }
+
   if (track->type == GES_TRACK_TYPE_VIDEO) {
     bin_desc = g_strconcat ("videoconvert name=pre_video_convert ! ",
         self->priv->bin_description, " ! videoconvert name=post_video_convert",
@@ -163,9 +668,6 @@ ges_track_parse_launch_effect_create_element (GESTrackObject * object)
     bin_desc =
         g_strconcat ("audioconvert ! audioresample !",
         self->priv->bin_description, NULL);
-  } else {
-    GST_DEBUG ("Track type not supported");
-    return NULL;
   }
 
   effect = gst_parse_bin_from_description (bin_desc, TRUE, &error);
@@ -21,7 +21,19 @@
 /**
  * SECTION:ges-track-title-source
  * @short_description: render stand-alone text titles
- * 
+ *
+ * As long as none of the properties of the rendering elements is controlled
+ * and the background is not animated, every frame of a title is the same.
+ * The text is then rendered on a single frame per configuration (text, font,
+ * alignment, color, position and track caps), which is frozen for the whole
+ * duration of the title. The rendered frames are kept in a cache shared by
+ * all the #GESTrackTitleSource-s of the process, and the titles whose frame
+ * is already cached output it without rendering anything.
+ *
+ * The text is rendered on each frame again as soon as a property of the
+ * rendering elements gets a control binding or an animated background
+ * pattern is chosen. Such changes, like all changes of the text, are picked
+ * up on the next flushing seek.
  */
 
 #include "ges-internal.h"
@@ -32,6 +44,18 @@
 G_DEFINE_TYPE (GESTrackTitleSource, ges_track_title_source,
     GES_TYPE_TRACK_SOURCE);
 
+/* How the output of the source is produced */
+typedef enum
+{
+  /* videotestsrc ! textoverlay, rendering each frame */
+  TITLE_MODE_RENDER,
+  /* videotestsrc num-buffers=1 ! textoverlay ! imagefreeze, storing the
+   * rendered frame in the cache */
+  TITLE_MODE_STORE,
+  /* appsrc ! imagefreeze, with the cached frame */
+  TITLE_MODE_FRAME
+} TitleMode;
+
 struct _GESTrackTitleSourcePrivate
 {
   gchar *text;
@@ -43,8 +67,50 @@ struct _GESTrackTitleSourcePrivate
   gdouble ypos;
   GstElement *text_el;
   GstElement *background_el;
+
+  /* The branches of the bin, only one of render_bin and appsrc is linked to
+   * freeze_bin, and the unused ones are locked in the NULL state */
+  GstElement *render_bin;
+  GstElement *appsrc;
+  GstElement *freeze_bin;
+  GstPad *srcpad;
+
+  /* Serializes the switches of branch */
+  GMutex switch_lock;
+  TitleMode mode;
+
+  /* Protects the fields below, used from the streaming thread */
+  GMutex lock;
+  /* Key of the current configuration in the frame cache, %NULL when it has
+   * to be computed again */
+  gchar *key;
+  /* The rendered frame of the current configuration, if known */
+  GstSample *frame;
+  /* Key of the frame output by the current branch */
+  gchar *branch_key;
+  /* The frame pushed by appsrc */
+  GstSample *sample;
+  /* The thread pushing our output, which can not switch branch */
+  GThread *streaming_thread;
 };
 
+/* Process wide LRU cache of the rendered titles, keyed by the properties of
+ * the rendering elements and the caps of the track */
+#define FRAME_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+GESLruCache *
+ges_track_title_source_get_frame_cache (void)
+{
+  static gsize cache = 0;
+
+  if (g_once_init_enter (&cache))
+    g_once_init_leave (&cache, (gsize) ges_lru_cache_new (FRAME_CACHE_MAX_SIZE,
+            g_str_hash, g_str_equal, g_free, (GBoxedCopyFunc) gst_sample_ref,
+            (GDestroyNotify) gst_sample_unref));
+
+  return (GESLruCache *) cache;
+}
+
 enum
 {
   PROP_0,
@@ -52,6 +118,8 @@ enum
 
 static void ges_track_title_source_dispose (GObject * object);
 
+static void ges_track_title_source_finalize (GObject * object);
+
 static void ges_track_title_source_get_property (GObject * object, guint
     property_id, GValue * value, GParamSpec * pspec);
 
@@ -60,6 +128,7 @@ static void ges_track_title_source_set_property (GObject * object, guint
 
 static GstElement *ges_track_title_source_create_element (GESTrackObject *
     self);
+static void ges_track_title_source_release_element (GESTrackObject * self);
 
 static void
 ges_track_title_source_class_init (GESTrackTitleSourceClass * klass)
@@ -72,8 +141,10 @@ ges_track_title_source_class_init (GESTrackTitleSourceClass * klass)
   object_class->get_property = ges_track_title_source_get_property;
   object_class->set_property = ges_track_title_source_set_property;
   object_class->dispose = ges_track_title_source_dispose;
+  object_class->finalize = ges_track_title_source_finalize;
 
   bg_class->create_element = ges_track_title_source_create_element;
+  bg_class->release_element = ges_track_title_source_release_element;
 }
 
 static void
@@ -91,6 +162,72 @@ ges_track_title_source_init (GESTrackTitleSource * self)
   self->priv->xpos = 0.5;
   self->priv->ypos = 0.5;
   self->priv->background_el = NULL;
+
+  g_mutex_init (&self->priv->switch_lock);
+  g_mutex_init (&self->priv->lock);
+}
+
+/* Must be called with the lock held */
+static void
+invalidate_frame (GESTrackTitleSourcePrivate * priv)
+{
+  g_free (priv->key);
+  priv->key = NULL;
+
+  if (priv->frame) {
+    gst_sample_unref (priv->frame);
+    priv->frame = NULL;
+  }
+}
+
+static void
+release_elements (GESTrackTitleSource * self)
+{
+  GESTrackTitleSourcePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->lock);
+  invalidate_frame (priv);
+  g_free (priv->branch_key);
+  priv->branch_key = NULL;
+  if (priv->sample) {
+    gst_sample_unref (priv->sample);
+    priv->sample = NULL;
+  }
+  priv->streaming_thread = NULL;
+  g_mutex_unlock (&priv->lock);
+
+  if (priv->text_el) {
+    g_signal_handlers_disconnect_by_data (priv->text_el, self);
+    g_object_unref (priv->text_el);
+    priv->text_el = NULL;
+  }
+
+  if (priv->background_el) {
+    g_signal_handlers_disconnect_by_data (priv->background_el, self);
+    g_object_unref (priv->background_el);
+    priv->background_el = NULL;
+  }
+
+  if (priv->appsrc) {
+    g_signal_handlers_disconnect_by_data (priv->appsrc, self);
+    gst_object_unref (priv->appsrc);
+    priv->appsrc = NULL;
+  }
+
+  if (priv->render_bin) {
+    gst_object_unref (priv->render_bin);
+    priv->render_bin = NULL;
+  }
+
+  if (priv->freeze_bin) {
+    gst_object_unref (priv->freeze_bin);
+    priv->freeze_bin = NULL;
+  }
+
+  if (priv->srcpad) {
+    gst_object_unref (priv->srcpad);
+    priv->srcpad = NULL;
+  }
 }
 
 static void
@@ -99,23 +236,373 @@ ges_track_title_source_dispose (GObject * object)
   GESTrackTitleSource *self = GES_TRACK_TITLE_SOURCE (object);
   if (self->priv->text) {
     g_free (self->priv->text);
+    self->priv->text = NULL;
   }
 
   if (self->priv->font_desc) {
     g_free (self->priv->font_desc);
+    self->priv->font_desc = NULL;
   }
 
-  if (self->priv->text_el) {
-    g_object_unref (self->priv->text_el);
-    self->priv->text_el = NULL;
+  release_elements (self);
+
+  G_OBJECT_CLASS (ges_track_title_source_parent_class)->dispose (object);
+}
+
+static void
+ges_track_title_source_finalize (GObject * object)
+{
+  GESTrackTitleSourcePrivate *priv = GES_TRACK_TITLE_SOURCE (object)->priv;
+
+  g_mutex_clear (&priv->switch_lock);
+  g_mutex_clear (&priv->lock);
+
+  G_OBJECT_CLASS (ges_track_title_source_parent_class)->finalize (object);
+}
+
+static void
+append_element_properties (GString * key, GstElement * element)
+{
+  GParamSpec **pspecs;
+  guint i, n_pspecs;
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (element),
+      &n_pspecs);
+  for (i = 0; i < n_pspecs; i++) {
+    GValue v = { 0 };
+    gchar *serialized;
+    GParamSpec *pspec = pspecs[i];
+
+    /* "num-buffers" is ours to toggle, see switch_branch() */
+    if (!(pspec->flags & G_PARAM_READABLE) ||
+        G_TYPE_FUNDAMENTAL (pspec->value_type) == G_TYPE_OBJECT ||
+        !g_strcmp0 (pspec->name, "name") ||
+        !g_strcmp0 (pspec->name, "num-buffers"))
+      continue;
+
+    g_value_init (&v, pspec->value_type);
+    g_object_get_property (G_OBJECT (element), pspec->name, &v);
+    if ((serialized = gst_value_serialize (&v))) {
+      g_string_append_printf (key, "%s=%s;", pspec->name, serialized);
+      g_free (serialized);
+    }
+    g_value_unset (&v);
   }
+  g_free (pspecs);
+}
 
-  if (self->priv->background_el) {
-    g_object_unref (self->priv->background_el);
-    self->priv->background_el = NULL;
+/* Everything the rendered frame depends on */
+static gchar *
+make_frame_key (GESTrackTitleSource * self)
+{
+  GESTrack *track = ges_track_object_get_track (GES_TRACK_OBJECT (self));
+  const GstCaps *caps = track ? ges_track_get_caps (track) : NULL;
+  GString *key = g_string_new (NULL);
+  gchar *caps_str;
+
+  append_element_properties (key, self->priv->background_el);
+  append_element_properties (key, self->priv->text_el);
+  caps_str = caps ? gst_caps_to_string (caps) : g_strdup ("ANY");
+  g_string_append (key, caps_str);
+  g_free (caps_str);
+
+  return g_string_free (key, FALSE);
+}
+
+/* Background patterns changing from one frame to the next */
+static const gchar *animated_patterns[] = {
+  "snow", "blink", "ball", "zone-plate", "chroma-zone-plate", NULL
+};
+
+static gboolean
+background_is_static (GstElement * background)
+{
+  GParamSpec *pspec;
+  GEnumValue *pattern;
+  gint value, speed = 0;
+  guint i;
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (background),
+      "horizontal-speed");
+  if (pspec)
+    g_object_get (background, "horizontal-speed", &speed, NULL);
+  if (speed != 0)
+    return FALSE;
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (background),
+      "pattern");
+  g_object_get (background, "pattern", &value, NULL);
+  pattern = g_enum_get_value (G_PARAM_SPEC_ENUM (pspec)->enum_class, value);
+  if (pattern == NULL)
+    return FALSE;
+
+  for (i = 0; animated_patterns[i]; i++) {
+    if (!g_strcmp0 (pattern->value_nick, animated_patterns[i]))
+      return FALSE;
   }
 
-  G_OBJECT_CLASS (ges_track_title_source_parent_class)->dispose (object);
+  return TRUE;
+}
+
+static gboolean
+is_static (GESTrackTitleSourcePrivate * priv)
+{
+  return !gst_object_has_active_control_bindings (GST_OBJECT (priv->text_el))
+      && !gst_object_has_active_control_bindings (GST_OBJECT
+      (priv->background_el)) && background_is_static (priv->background_el);
+}
+
+/* Pushes the cached frame once, imagefreeze repeats it */
+static void
+need_data_cb (GstElement * appsrc, guint length, GESTrackTitleSource * self)
+{
+  GstFlowReturn ret;
+
+  g_mutex_lock (&self->priv->lock);
+  if (self->priv->sample)
+    g_signal_emit_by_name (appsrc, "push-buffer",
+        gst_sample_get_buffer (self->priv->sample), &ret);
+  g_mutex_unlock (&self->priv->lock);
+
+  g_signal_emit_by_name (appsrc, "end-of-stream", &ret);
+}
+
+/* Keeps the frame rendered in TITLE_MODE_STORE, before imagefreeze */
+static GstPadProbeReturn
+store_frame_probe (GstPad * pad, GstPadProbeInfo * info,
+    GESTrackTitleSource * self)
+{
+  GESTrackTitleSourcePrivate *priv = self->priv;
+  GstSample *sample;
+  GstCaps *caps;
+
+  caps = gst_pad_get_current_caps (pad);
+  if (caps == NULL)
+    return GST_PAD_PROBE_OK;
+
+  /* In system memory, so that the pool of textoverlay can be freed */
+  sample = ges_video_sample_new_copy (GST_PAD_PROBE_INFO_BUFFER (info), caps);
+  gst_caps_unref (caps);
+  if (sample == NULL)
+    return GST_PAD_PROBE_OK;
+
+  g_mutex_lock (&priv->lock);
+  if (priv->mode == TITLE_MODE_STORE && priv->branch_key) {
+    ges_lru_cache_insert (ges_track_title_source_get_frame_cache (),
+        g_strdup (priv->branch_key), gst_sample_ref (sample),
+        gst_buffer_get_size (gst_sample_get_buffer (sample)));
+
+    if (!g_strcmp0 (priv->key, priv->branch_key) && priv->frame == NULL)
+      priv->frame = gst_sample_ref (sample);
+  }
+  g_mutex_unlock (&priv->lock);
+
+  gst_sample_unref (sample);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+set_branch_active (GstElement * branch, gboolean active)
+{
+  if (active) {
+    gst_element_set_locked_state (branch, FALSE);
+    gst_element_sync_state_with_parent (branch);
+  } else {
+    gst_element_set_locked_state (branch, TRUE);
+    gst_element_set_state (branch, GST_STATE_NULL);
+  }
+}
+
+static void
+unlink_src_pad (GstPad * pad)
+{
+  GstPad *peer = gst_pad_get_peer (pad);
+
+  if (peer) {
+    gst_pad_unlink (pad, peer);
+    gst_object_unref (peer);
+  }
+}
+
+/* Shuts the current branch down and outputs the frames of @mode instead,
+ * @sample being the frame to push in TITLE_MODE_FRAME and @key the one of
+ * the frame to output in the TITLE_MODE_STORE and TITLE_MODE_FRAME modes.
+ * Must be called with the switch lock held, takes ownership of @sample and
+ * @key */
+static void
+switch_branch (GESTrackTitleSource * self, TitleMode mode, GstSample * sample,
+    gchar * key)
+{
+  GESTrackTitleSourcePrivate *priv = self->priv;
+  GstPad *render_src, *appsrc_src, *freeze_sink, *freeze_src;
+  gboolean running = GST_PAD_IS_ACTIVE (priv->srcpad);
+
+  GST_DEBUG_OBJECT (self, "Switching from mode %d to %d", priv->mode, mode);
+
+  /* Unblocks the streaming thread of the current branch, so that it can be
+   * shut down */
+  if (running)
+    gst_pad_push_event (priv->srcpad, gst_event_new_flush_start ());
+
+  set_branch_active (priv->render_bin, FALSE);
+  set_branch_active (priv->appsrc, FALSE);
+  set_branch_active (priv->freeze_bin, FALSE);
+
+  render_src = gst_element_get_static_pad (priv->render_bin, "src");
+  appsrc_src = gst_element_get_static_pad (priv->appsrc, "src");
+  freeze_sink = gst_element_get_static_pad (priv->freeze_bin, "sink");
+  freeze_src = gst_element_get_static_pad (priv->freeze_bin, "src");
+
+  gst_ghost_pad_set_target (GST_GHOST_PAD (priv->srcpad), NULL);
+  unlink_src_pad (render_src);
+  unlink_src_pad (appsrc_src);
+
+  g_mutex_lock (&priv->lock);
+  if (priv->sample)
+    gst_sample_unref (priv->sample);
+  priv->sample = sample;
+  g_free (priv->branch_key);
+  priv->branch_key = key;
+  priv->mode = mode;
+  priv->streaming_thread = NULL;
+  g_mutex_unlock (&priv->lock);
+
+  switch (mode) {
+    case TITLE_MODE_RENDER:
+      g_object_set (priv->background_el, "num-buffers", -1, NULL);
+      gst_ghost_pad_set_target (GST_GHOST_PAD (priv->srcpad), render_src);
+      set_branch_active (priv->render_bin, TRUE);
+      break;
+    case TITLE_MODE_STORE:
+      g_object_set (priv->background_el, "num-buffers", 1, NULL);
+      gst_pad_link_full (render_src, freeze_sink, GST_PAD_LINK_CHECK_NOTHING);
+      gst_ghost_pad_set_target (GST_GHOST_PAD (priv->srcpad), freeze_src);
+      set_branch_active (priv->freeze_bin, TRUE);
+      set_branch_active (priv->render_bin, TRUE);
+      break;
+    case TITLE_MODE_FRAME:
+      g_object_set (priv->appsrc, "caps", gst_sample_get_caps (sample), NULL);
+      gst_pad_link_full (appsrc_src, freeze_sink, GST_PAD_LINK_CHECK_NOTHING);
+      gst_ghost_pad_set_target (GST_GHOST_PAD (priv->srcpad), freeze_src);
+      set_branch_active (priv->freeze_bin, TRUE);
+      set_branch_active (priv->appsrc, TRUE);
+      break;
+  }
+
+  /* The seek which triggered the switch flushes the new branch */
+  if (running)
+    gst_pad_push_event (priv->srcpad, gst_event_new_flush_stop (TRUE));
+
+  gst_object_unref (render_src);
+  gst_object_unref (appsrc_src);
+  gst_object_unref (freeze_sink);
+  gst_object_unref (freeze_src);
+}
+
+/* Picks the branch matching the current configuration */
+static void
+update_mode (GESTrackTitleSource * self)
+{
+  GESTrackTitleSourcePrivate *priv = self->priv;
+  GstSample *sample = NULL;
+  gchar *key = NULL;
+  TitleMode mode;
+  gboolean needs_switch;
+
+  g_mutex_lock (&priv->switch_lock);
+
+  g_mutex_lock (&priv->lock);
+  if (!is_static (priv)) {
+    mode = TITLE_MODE_RENDER;
+    needs_switch = priv->mode != TITLE_MODE_RENDER;
+  } else {
+    if (priv->key == NULL) {
+      priv->key = make_frame_key (self);
+      priv->frame =
+          ges_lru_cache_lookup (ges_track_title_source_get_frame_cache (),
+          priv->key);
+
+      GST_DEBUG_OBJECT (self, "Rendered frame cache %s",
+          priv->frame ? "hit" : "miss");
+    }
+
+    if (priv->frame) {
+      mode = TITLE_MODE_FRAME;
+      needs_switch = priv->mode != TITLE_MODE_FRAME ||
+          priv->sample != priv->frame;
+      sample = gst_sample_ref (priv->frame);
+    } else {
+      mode = TITLE_MODE_STORE;
+      needs_switch = priv->mode != TITLE_MODE_STORE ||
+          g_strcmp0 (priv->key, priv->branch_key);
+    }
+    key = g_strdup (priv->key);
+  }
+  g_mutex_unlock (&priv->lock);
+
+  if (needs_switch) {
+    switch_branch (self, mode, sample, key);
+  } else {
+    if (sample)
+      gst_sample_unref (sample);
+    g_free (key);
+  }
+
+  g_mutex_unlock (&priv->switch_lock);
+}
+
+/* Records the streaming thread, and switches branch before the flushing
+ * seeks reach it */
+static GstPadProbeReturn
+src_probe (GstPad * pad, GstPadProbeInfo * info, GESTrackTitleSource * self)
+{
+  GESTrackTitleSourcePrivate *priv = self->priv;
+  GstEvent *event;
+  GstSeekFlags flags;
+  gboolean from_streaming_thread;
+
+  if (!(info->type & GST_PAD_PROBE_TYPE_EVENT_UPSTREAM)) {
+    g_mutex_lock (&priv->lock);
+    priv->streaming_thread = g_thread_self ();
+    g_mutex_unlock (&priv->lock);
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  event = GST_PAD_PROBE_INFO_EVENT (info);
+  if (GST_EVENT_TYPE (event) != GST_EVENT_SEEK)
+    return GST_PAD_PROBE_OK;
+
+  gst_event_parse_seek (event, NULL, NULL, &flags, NULL, NULL, NULL, NULL);
+  if (!(flags & GST_SEEK_FLAG_FLUSH))
+    return GST_PAD_PROBE_OK;
+
+  /* Shutting the branch down from its own thread would deadlock */
+  g_mutex_lock (&priv->lock);
+  from_streaming_thread = priv->streaming_thread == g_thread_self ();
+  g_mutex_unlock (&priv->lock);
+
+  if (from_streaming_thread)
+    GST_DEBUG_OBJECT (self, "Seeked from the streaming thread, keeping mode");
+  else
+    update_mode (self);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Any change of the rendering elements, made through our setters or as
+ * child properties, needs a new rendering */
+static void
+element_notify_cb (GstElement * element, GParamSpec * pspec,
+    GESTrackTitleSource * self)
+{
+  if (!g_strcmp0 (pspec->name, "num-buffers"))
+    return;
+
+  g_mutex_lock (&self->priv->lock);
+  invalidate_frame (self->priv);
+  g_mutex_unlock (&self->priv->lock);
 }
 
 static void
@@ -143,10 +630,19 @@ ges_track_title_source_create_element (GESTrackObject * object)
 {
   GESTrackTitleSource *self = GES_TRACK_TITLE_SOURCE (object);
   GESTrackTitleSourcePrivate *priv = self->priv;
-  GstElement *topbin, *background, *text;
-  GstPad *src;
+  GstElement *topbin, *render_bin, *freeze_bin, *background, *text, *appsrc;
+  GstElement *scale, *iconv, *freeze;
+  GstPad *src, *pad;
+  GstSample *sample;
+  TitleMode mode;
+  gchar *key;
+
+  release_elements (self);
 
   topbin = gst_bin_new ("titlesrc-bin");
+
+  /* The rendering branch */
+  render_bin = gst_bin_new ("titlesrc-render");
   background = gst_element_factory_make ("videotestsrc", "titlesrc-bg");
 
   text = gst_element_factory_make ("textoverlay", "titlsrc-text");
@@ -165,23 +661,91 @@ ges_track_title_source_create_element (GESTrackObject * object)
   g_object_set (text, "xpos", (gdouble) self->priv->xpos, NULL);
   g_object_set (text, "ypos", (gdouble) self->priv->ypos, NULL);
 
-  gst_bin_add_many (GST_BIN (topbin), background, text, NULL);
+  gst_bin_add_many (GST_BIN (render_bin), background, text, NULL);
 
   gst_element_link_pads_full (background, "src", text, "video_sink",
       GST_PAD_LINK_CHECK_NOTHING);
 
-  src = gst_ghost_pad_new ("src", gst_element_get_static_pad (text, "src"));
-  gst_element_add_pad (topbin, src);
+  pad = gst_element_get_static_pad (text, "src");
+  gst_element_add_pad (render_bin, gst_ghost_pad_new ("src", pad));
+  gst_object_unref (pad);
+
+  /* The cached frame, the frame is already scaled and converted, videoscale
+   * and videoconvert are passthrough unless downstream negotiates other
+   * caps */
+  appsrc = gst_element_factory_make ("appsrc", "titlesrc-frame");
+  g_object_set (appsrc, "format", GST_FORMAT_TIME, "emit-signals", TRUE,
+      NULL);
+
+  freeze_bin = gst_bin_new ("titlesrc-freeze");
+  scale = gst_element_factory_make ("videoscale", NULL);
+  iconv = gst_element_factory_make ("videoconvert", NULL);
+  freeze = gst_element_factory_make ("imagefreeze", NULL);
+  gst_bin_add_many (GST_BIN (freeze_bin), scale, iconv, freeze, NULL);
+
+  gst_element_link_pads_full (scale, "src", iconv, "sink",
+      GST_PAD_LINK_CHECK_NOTHING);
+  gst_element_link_pads_full (iconv, "src", freeze, "sink",
+      GST_PAD_LINK_CHECK_NOTHING);
+
+  pad = gst_element_get_static_pad (scale, "sink");
+  gst_element_add_pad (freeze_bin, gst_ghost_pad_new ("sink", pad));
+  gst_object_unref (pad);
 
-  g_object_ref (text);
-  g_object_ref (background);
+  pad = gst_element_get_static_pad (freeze, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) store_frame_probe, self, NULL);
+  gst_object_unref (pad);
 
-  priv->text_el = text;
-  priv->background_el = background;
+  pad = gst_element_get_static_pad (freeze, "src");
+  gst_element_add_pad (freeze_bin, gst_ghost_pad_new ("src", pad));
+  gst_object_unref (pad);
+
+  gst_bin_add_many (GST_BIN (topbin), render_bin, appsrc, freeze_bin, NULL);
+
+  src = gst_ghost_pad_new_no_target ("src", GST_PAD_SRC);
+  gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      (GstPadProbeCallback) src_probe, self, NULL);
+  gst_element_add_pad (topbin, src);
+
+  priv->text_el = gst_object_ref (text);
+  priv->background_el = gst_object_ref (background);
+  priv->render_bin = gst_object_ref (render_bin);
+  priv->appsrc = gst_object_ref (appsrc);
+  priv->freeze_bin = gst_object_ref (freeze_bin);
+  priv->srcpad = gst_object_ref (src);
+
+  g_signal_connect (text, "notify", G_CALLBACK (element_notify_cb), self);
+  g_signal_connect (background, "notify", G_CALLBACK (element_notify_cb),
+      self);
+  g_signal_connect (appsrc, "need-data", G_CALLBACK (need_data_cb), self);
+
+  /* Nothing is controlled nor animated yet */
+  g_mutex_lock (&priv->switch_lock);
+  g_mutex_lock (&priv->lock);
+  priv->key = make_frame_key (self);
+  priv->frame = ges_lru_cache_lookup (ges_track_title_source_get_frame_cache
+      (), priv->key);
+  GST_DEBUG_OBJECT (self, "Rendered frame cache %s",
+      priv->frame ? "hit" : "miss");
+  mode = priv->frame ? TITLE_MODE_FRAME : TITLE_MODE_STORE;
+  sample = priv->frame ? gst_sample_ref (priv->frame) : NULL;
+  key = g_strdup (priv->key);
+  g_mutex_unlock (&priv->lock);
+
+  switch_branch (self, mode, sample, key);
+  g_mutex_unlock (&priv->switch_lock);
 
   return topbin;
 }
 
+static void
+ges_track_title_source_release_element (GESTrackObject * object)
+{
+  release_elements (GES_TRACK_TITLE_SOURCE (object));
+}
+
 /**
  * ges_track_title_source_set_text:
  * @self: the #GESTrackTitleSource* to set text on
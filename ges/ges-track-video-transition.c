@@ -43,29 +43,15 @@ ges_track_video_transition_set_transition_type_internal (GESTrackVideoTransition
 struct _GESTrackVideoTransitionPrivate
 {
   GESVideoStandardTransitionType type;
-
-  /* prevents cases where the transition has not been changed yet */
-  GESVideoStandardTransitionType pending_type;
+  guint border;
+  gboolean inverted;
 
   /* these enable video interpolation */
   GstControlSource *control_source;
 
-  /* so we can support changing between wipes */
-  GstElement *topbin;
-  GstElement *smpte;
-  GstElement *mixer;
-  GstPad *sinka;
-  GstPad *sinkb;
-
-  /* these will be different depending on whether smptealpha or alpha element
-   * is used */
-  gdouble start_value;
-  gdouble end_value;
+  /* blends both inputs, crossfade or wipe */
+  GstElement *blend;
   guint64 dur;
-
-  /* This is in case the smpte doesn't exist yet */
-  gint pending_border_value;
-  gboolean pending_inverted;
 };
 
 enum
@@ -81,13 +67,6 @@ static GParamSpec *properties[PROP_LAST];
 
 #define fast_element_link(a,b) gst_element_link_pads_full((a),"src",(b),"sink",GST_PAD_LINK_CHECK_NOTHING)
 
-static GObject *link_element_to_mixer (GstElement * element,
-    GstElement * mixer);
-
-static GObject *link_element_to_mixer_with_smpte (GstBin * bin,
-    GstElement * element, GstElement * mixer, gint type,
-    GstElement ** smpteref);
-
 static void
 ges_track_video_transition_duration_changed (GESTrackObject * self,
     guint64 duration);
@@ -169,18 +148,11 @@ ges_track_video_transition_init (GESTrackVideoTransition * self)
       GES_TYPE_TRACK_VIDEO_TRANSITION, GESTrackVideoTransitionPrivate);
 
   self->priv->control_source = NULL;
-  self->priv->smpte = NULL;
-  self->priv->mixer = NULL;
-  self->priv->sinka = NULL;
-  self->priv->sinkb = NULL;
-  self->priv->topbin = NULL;
+  self->priv->blend = NULL;
   self->priv->type = GES_VIDEO_STANDARD_TRANSITION_TYPE_NONE;
-  self->priv->pending_type = GES_VIDEO_STANDARD_TRANSITION_TYPE_NONE;
-  self->priv->start_value = 0.0;
-  self->priv->end_value = 0.0;
+  self->priv->border = 0;
+  self->priv->inverted = FALSE;
   self->priv->dur = 42;
-  self->priv->pending_border_value = -1;
-  self->priv->pending_inverted = FALSE;
 }
 
 static void
@@ -190,29 +162,16 @@ ges_track_video_transition_dispose (GObject * object)
   GESTrackVideoTransitionPrivate *priv = self->priv;
 
   GST_DEBUG ("disposing");
-  GST_LOG ("mixer: %p smpte: %p sinka: %p sinkb: %p",
-      priv->mixer, priv->smpte, priv->sinka, priv->sinkb);
 
   if (priv->control_source) {
-    if (priv->control_source)
-      gst_object_unref (priv->control_source);
+    gst_object_unref (priv->control_source);
     priv->control_source = NULL;
   }
 
-  if (priv->sinka && priv->sinkb) {
-    GST_DEBUG ("releasing request pads for mixer");
-    gst_element_release_request_pad (priv->mixer, priv->sinka);
-    gst_element_release_request_pad (priv->mixer, priv->sinkb);
-    gst_object_unref (priv->sinka);
-    gst_object_unref (priv->sinkb);
-    priv->sinka = NULL;
-    priv->sinkb = NULL;
-  }
-
-  if (priv->mixer) {
-    GST_LOG ("unrefing mixer");
-    gst_object_unref (priv->mixer);
-    priv->mixer = NULL;
+  if (priv->blend) {
+    GST_LOG ("unrefing blend");
+    gst_object_unref (priv->blend);
+    priv->blend = NULL;
   }
 
   G_OBJECT_CLASS (ges_track_video_transition_parent_class)->dispose (object);
@@ -270,43 +229,6 @@ ges_track_video_transition_set_property (GObject * object,
   }
 }
 
-static void
-on_caps_set (GstPad * srca_pad, GParamSpec * pspec, GstElement * capsfilt)
-{
-  GstCaps *orig_caps;
-
-  orig_caps = gst_pad_query_caps (srca_pad, NULL);
-
-  if (orig_caps) {
-    gint width, height;
-    const GstStructure *str;
-    GstCaps *size_caps;
-
-    /* Get width and height of first video */
-    str = gst_caps_get_structure (orig_caps, 0);
-    gst_structure_get_int (str, "width", &width);
-    gst_structure_get_int (str, "height", &height);
-
-    /* Set capsfilter to the size of the first video */
-    size_caps =
-        gst_caps_new_simple ("video/x-raw", "width", G_TYPE_INT, width,
-        "height", G_TYPE_INT, height, NULL);
-    g_object_set (capsfilt, "caps", size_caps, NULL);
-  }
-}
-
-static GstElement *
-create_mixer (GstElement * topbin)
-{
-  GstElement *mixer = NULL;
-
-  mixer = gst_element_factory_make ("videomixer", NULL);
-  g_object_set (G_OBJECT (mixer), "background", 1, NULL);
-  gst_bin_add (GST_BIN (topbin), mixer);
-
-  return (mixer);
-}
-
 static void
 set_interpolation (GstObject * element, GESTrackVideoTransitionPrivate * priv,
     const gchar * propname)
@@ -320,7 +242,7 @@ set_interpolation (GstObject * element, GESTrackVideoTransitionPrivate * priv,
     gst_object_unref (priv->control_source);
   }
 
-  g_object_set (element, propname, (gfloat) 0.0, NULL);
+  g_object_set (element, propname, (gdouble) 0.0, NULL);
 
   priv->control_source = gst_interpolation_control_source_new ();
   gst_object_add_control_binding (GST_OBJECT (element),
@@ -328,19 +250,17 @@ set_interpolation (GstObject * element, GESTrackVideoTransitionPrivate * priv,
           priv->control_source));
   g_object_set (priv->control_source, "mode", GST_INTERPOLATION_MODE_LINEAR,
       NULL);
-
-
 }
 
+/* Each input goes through a converter and a scaler, both of them are
+ * passthrough when the input already has the format and size the blend
+ * negotiated with the track. The blend handles crossfades and wipes alike,
+ * so changing the transition type does not touch the graph. */
 static GstElement *
 ges_track_video_transition_create_element (GESTrackObject * object)
 {
-  GstElement *topbin, *iconva, *iconvb, *scalea, *scaleb, *capsfilt, *oconv;
-  GstObject *target = NULL;
-  const gchar *propname = NULL;
-  GstElement *mixer = NULL;
-  GstPad *sinka_target, *sinkb_target, *src_target, *sinka, *sinkb, *src,
-      *srca_pad;
+  GstElement *topbin, *iconva, *iconvb, *scalea, *scaleb, *blend;
+  GstPad *sinka_target, *sinkb_target, *src_target, *sinka, *sinkb, *src;
   GESTrackVideoTransition *self;
   GESTrackVideoTransitionPrivate *priv;
 
@@ -354,51 +274,25 @@ ges_track_video_transition_create_element (GESTrackObject * object)
   iconvb = gst_element_factory_make ("videoconvert", "tr-csp-b");
   scalea = gst_element_factory_make ("videoscale", "vs-a");
   scaleb = gst_element_factory_make ("videoscale", "vs-b");
-  capsfilt = gst_element_factory_make ("capsfilter", "capsfilt");
-  oconv = gst_element_factory_make ("videoconvert", "tr-csp-output");
-
-  gst_bin_add_many (GST_BIN (topbin), iconva, iconvb, scalea, scaleb, capsfilt,
-      oconv, NULL);
-
-  mixer = gst_element_factory_make ("videomixer", NULL);
-  g_assert (mixer);
-  g_object_set (G_OBJECT (mixer), "background", 1, NULL);
-  gst_bin_add (GST_BIN (topbin), mixer);
-
-  if (priv->pending_type != GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE) {
-    priv->sinka =
-        (GstPad *) link_element_to_mixer_with_smpte (GST_BIN (topbin), iconva,
-        mixer, priv->pending_type, NULL);
-    priv->sinkb =
-        (GstPad *) link_element_to_mixer_with_smpte (GST_BIN (topbin), iconvb,
-        mixer, priv->pending_type, &priv->smpte);
-    target = GST_OBJECT (priv->smpte);
-    propname = "position";
-    priv->start_value = 1.0;
-    priv->end_value = 0.0;
-  } else {
-    gst_element_link_pads_full (iconva, "src", scalea, "sink",
-        GST_PAD_LINK_CHECK_NOTHING);
-    gst_element_link_pads_full (iconvb, "src", scaleb, "sink",
-        GST_PAD_LINK_CHECK_NOTHING);
-    gst_element_link_pads_full (scaleb, "src", capsfilt, "sink",
-        GST_PAD_LINK_CHECK_NOTHING);
-
-    priv->sinka = (GstPad *) link_element_to_mixer (scalea, mixer);
-    priv->sinkb = (GstPad *) link_element_to_mixer (capsfilt, mixer);
-    target = GST_OBJECT (priv->sinkb);
-    propname = "alpha";
-    priv->start_value = 0.0;
-    priv->end_value = 1.0;
-  }
+  blend = gst_element_factory_make ("gesvideoblend", "tr-blend");
+  g_assert (blend);
 
-  priv->mixer = gst_object_ref (mixer);
+  g_object_set (blend, "transition-type", priv->type, "border", priv->border,
+      "invert", priv->inverted, NULL);
+
+  gst_bin_add_many (GST_BIN (topbin), iconva, iconvb, scalea, scaleb, blend,
+      NULL);
 
-  fast_element_link (mixer, oconv);
+  fast_element_link (iconva, scalea);
+  fast_element_link (iconvb, scaleb);
+  gst_element_link_pads_full (scalea, "src", blend, "sink_a",
+      GST_PAD_LINK_CHECK_NOTHING);
+  gst_element_link_pads_full (scaleb, "src", blend, "sink_b",
+      GST_PAD_LINK_CHECK_NOTHING);
 
   sinka_target = gst_element_get_static_pad (iconva, "sink");
   sinkb_target = gst_element_get_static_pad (iconvb, "sink");
-  src_target = gst_element_get_static_pad (oconv, "src");
+  src_target = gst_element_get_static_pad (blend, "src");
 
   sinka = gst_ghost_pad_new ("sinka", sinka_target);
   sinkb = gst_ghost_pad_new ("sinkb", sinkb_target);
@@ -408,239 +302,18 @@ ges_track_video_transition_create_element (GESTrackObject * object)
   gst_element_add_pad (topbin, sinka);
   gst_element_add_pad (topbin, sinkb);
 
-  srca_pad = gst_element_get_static_pad (scalea, "src");
-  g_signal_connect (srca_pad, "notify::caps", G_CALLBACK (on_caps_set),
-      (GstElement *) capsfilt);
-
   gst_object_unref (sinka_target);
   gst_object_unref (sinkb_target);
   gst_object_unref (src_target);
-  gst_object_unref (srca_pad);
 
   /* set up interpolation */
+  set_interpolation (GST_OBJECT (blend), priv, "position");
 
-  set_interpolation (target, priv, propname);
-
-  priv->topbin = topbin;
-  priv->type = priv->pending_type;
+  priv->blend = gst_object_ref (blend);
 
   return topbin;
 }
 
-static void
-add_smpte_to_bin (GstPad * sink, GstElement * smptealpha,
-    GESTrackVideoTransitionPrivate * priv)
-{
-  GstPad *peer, *sinkpad;
-
-  g_object_set (smptealpha,
-      "type", (gint) priv->pending_type, "invert", (gboolean) TRUE, NULL);
-  gst_bin_add (GST_BIN (priv->topbin), smptealpha);
-  gst_element_sync_state_with_parent (smptealpha);
-
-  sinkpad = gst_element_get_static_pad (smptealpha, "sink");
-  peer = gst_pad_get_peer (sink);
-  gst_pad_unlink (peer, sink);
-
-  gst_pad_link_full (peer, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
-
-  gst_object_unref (sinkpad);
-  gst_object_unref (peer);
-}
-
-static void
-replace_mixer (GESTrackVideoTransitionPrivate * priv)
-{
-  GstPad *mixer_src_pad, *color_sink_pad;
-
-  mixer_src_pad = gst_element_get_static_pad (priv->mixer, "src");
-  color_sink_pad = gst_pad_get_peer (mixer_src_pad);
-
-  gst_element_set_state (priv->mixer, GST_STATE_NULL);
-  gst_bin_remove (GST_BIN (priv->topbin), priv->mixer);
-
-  gst_object_unref (priv->mixer);
-
-  priv->mixer = gst_object_ref (create_mixer (priv->topbin));
-
-  gst_element_sync_state_with_parent (priv->mixer);
-
-  gst_object_unref (mixer_src_pad);
-
-  mixer_src_pad = gst_element_get_static_pad (priv->mixer, "src");
-  gst_pad_link (mixer_src_pad, color_sink_pad);
-
-  gst_object_unref (mixer_src_pad);
-  gst_object_unref (color_sink_pad);
-
-}
-
-static GstPadProbeReturn
-switch_to_smpte_cb (GstPad * sink, gboolean blocked,
-    GESTrackVideoTransition * transition)
-{
-  GstElement *smptealpha = gst_element_factory_make ("smptealpha", NULL);
-  GstElement *smptealphab = gst_element_factory_make ("smptealpha", NULL);
-  GESTrackVideoTransitionPrivate *priv = transition->priv;
-
-  if (priv->pending_type == GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE)
-    goto beach;
-
-  GST_INFO ("Bin %p switching from crossfade to smpte", priv->topbin);
-
-  add_smpte_to_bin (priv->sinka, smptealpha, priv);
-  add_smpte_to_bin (priv->sinkb, smptealphab, priv);
-
-  if (priv->pending_border_value != -1) {
-    g_object_set (smptealphab, "border", priv->pending_border_value, NULL);
-    priv->pending_border_value = -1;
-  }
-
-  if (priv->pending_inverted) {
-    g_object_set (smptealphab, "invert", priv->pending_inverted, NULL);
-    priv->pending_inverted = FALSE;
-  }
-
-  replace_mixer (priv);
-
-  priv->start_value = 1.0;
-  priv->end_value = 0.0;
-
-  set_interpolation (GST_OBJECT (smptealphab), priv, (gchar *) "position");
-  ges_track_video_transition_duration_changed (GES_TRACK_OBJECT (transition),
-      priv->dur);
-
-
-  priv->sinka = (GstPad *) link_element_to_mixer (smptealpha, priv->mixer);
-  priv->sinkb = (GstPad *) link_element_to_mixer (smptealphab, priv->mixer);
-
-  priv->smpte = smptealphab;
-
-  priv->type = priv->pending_type;
-
-  GST_INFO ("Bin %p switched from crossfade to smpte", priv->topbin);
-
-beach:
-  priv->pending_type = GES_VIDEO_STANDARD_TRANSITION_TYPE_NONE;
-
-  return GST_PAD_PROBE_REMOVE;
-}
-
-static GstElement *
-remove_smpte_from_bin (GESTrackVideoTransitionPrivate * priv, GstPad * sink)
-{
-  GstPad *smpte_src, *peer_src, *smpte_sink;
-  GstElement *smpte, *peer;
-
-  smpte_src = gst_pad_get_peer (sink);
-  smpte = gst_pad_get_parent_element (smpte_src);
-
-  if (smpte == NULL) {
-    gst_object_unref (smpte_src);
-    GST_ERROR ("The pad %" GST_PTR_FORMAT " has no parent element. "
-        "This should not happen", smpte_src);
-    return (NULL);
-  }
-
-  smpte_sink = gst_element_get_static_pad (smpte, "sink");
-  peer_src = gst_pad_get_peer (smpte_sink);
-  peer = gst_pad_get_parent_element (peer_src);
-
-  gst_pad_unlink (peer_src, smpte_sink);
-  gst_pad_unlink (smpte_src, sink);
-
-  gst_element_set_state (smpte, GST_STATE_NULL);
-  gst_bin_remove (GST_BIN (priv->topbin), smpte);
-
-  gst_object_unref (smpte);
-  gst_object_unref (smpte_sink);
-  gst_object_unref (smpte_src);
-  gst_object_unref (peer_src);
-  return (peer);
-}
-
-static GstPadProbeReturn
-switch_to_crossfade_cb (GstPad * sink, gboolean blocked,
-    GESTrackVideoTransition * transition)
-{
-  GstElement *peera;
-  GstElement *peerb;
-  GESTrackVideoTransitionPrivate *priv = transition->priv;
-
-  GST_INFO ("Bin %p switching from smpte to crossfade", priv->topbin);
-
-  if (priv->pending_type != GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE)
-    goto beach;
-
-  peera = remove_smpte_from_bin (priv, priv->sinka);
-  peerb = remove_smpte_from_bin (priv, priv->sinkb);
-  if (!peera || !peerb)
-    goto beach;
-
-  replace_mixer (priv);
-
-  priv->sinka = (GstPad *) link_element_to_mixer (peera, priv->mixer);
-  priv->sinkb = (GstPad *) link_element_to_mixer (peerb, priv->mixer);
-
-  priv->start_value = 0.0;
-  priv->end_value = 1.0;
-  set_interpolation (GST_OBJECT (priv->sinkb), priv, (gchar *) "alpha");
-  ges_track_video_transition_duration_changed (GES_TRACK_OBJECT (transition),
-      priv->dur);
-
-  priv->smpte = NULL;
-
-  gst_object_unref (peera);
-  gst_object_unref (peerb);
-
-  priv->type = priv->pending_type;
-
-  GST_INFO ("Bin %p switched from smpte to crossfade", priv->topbin);
-
-beach:
-  priv->pending_type = GES_VIDEO_STANDARD_TRANSITION_TYPE_NONE;
-
-  return GST_PAD_PROBE_REMOVE;
-}
-
-static GObject *
-link_element_to_mixer (GstElement * element, GstElement * mixer)
-{
-  GstPad *sinkpad = gst_element_get_request_pad (mixer, "sink_%u");
-  GstPad *srcpad = gst_element_get_static_pad (element, "src");
-
-  gst_pad_link_full (srcpad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
-  gst_object_unref (srcpad);
-
-  return G_OBJECT (sinkpad);
-}
-
-static GObject *
-link_element_to_mixer_with_smpte (GstBin * bin, GstElement * element,
-    GstElement * mixer, gint type, GstElement ** smpteref)
-{
-  GstPad *srcpad, *sinkpad;
-  GstElement *smptealpha = gst_element_factory_make ("smptealpha", NULL);
-
-  g_object_set (G_OBJECT (smptealpha),
-      "type", (gint) type, "invert", (gboolean) TRUE, NULL);
-  gst_bin_add (bin, smptealpha);
-
-  fast_element_link (element, smptealpha);
-
-  /* crack */
-  if (smpteref) {
-    *smpteref = smptealpha;
-  }
-
-  srcpad = gst_element_get_static_pad (smptealpha, "src");
-  sinkpad = gst_element_get_request_pad (mixer, "sink_%u");
-  gst_pad_link_full (srcpad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
-  gst_object_unref (srcpad);
-
-  return G_OBJECT (sinkpad);
-}
-
 static void
 ges_track_video_transition_duration_changed (GESTrackObject * object,
     guint64 duration)
@@ -661,8 +334,8 @@ ges_track_video_transition_duration_changed (GESTrackObject * object,
   GST_LOG ("setting values on controller");
 
   gst_timed_value_control_source_unset_all (ts);
-  gst_timed_value_control_source_set (ts, 0, priv->start_value);
-  gst_timed_value_control_source_set (ts, duration, priv->end_value);
+  gst_timed_value_control_source_set (ts, 0, 0.0);
+  gst_timed_value_control_source_set (ts, duration, 1.0);
 
   priv->dur = duration;
   GST_LOG ("done updating controller");
@@ -674,11 +347,9 @@ ges_track_video_transition_set_border_internal (GESTrackVideoTransition * self,
 {
   GESTrackVideoTransitionPrivate *priv = self->priv;
 
-  if (!priv->smpte) {
-    priv->pending_border_value = value;
-    return;
-  }
-  g_object_set (priv->smpte, "border", value, NULL);
+  priv->border = value;
+  if (priv->blend)
+    g_object_set (priv->blend, "border", value, NULL);
 }
 
 static inline void
@@ -687,11 +358,9 @@ ges_track_video_transition_set_inverted_internal (GESTrackVideoTransition *
 {
   GESTrackVideoTransitionPrivate *priv = self->priv;
 
-  if (!priv->smpte) {
-    priv->pending_inverted = !inverted;
-    return;
-  }
-  g_object_set (priv->smpte, "invert", !inverted, NULL);
+  priv->inverted = inverted;
+  if (priv->blend)
+    g_object_set (priv->blend, "invert", inverted, NULL);
 }
 
 
@@ -703,43 +372,16 @@ ges_track_video_transition_set_transition_type_internal (GESTrackVideoTransition
 
   GST_DEBUG ("%p %d => %d", self, priv->type, type);
 
-  if (type == priv->type && !priv->pending_type) {
+  if (type == priv->type) {
     GST_INFO ("This type is already set on this transition\n");
     return TRUE;
   }
 
-  if (type == priv->pending_type) {
-    GST_INFO ("This type is already pending for this transition\n");
-    return TRUE;
-  }
+  /* The blend picks the new type up on its next frame */
+  priv->type = type;
+  if (priv->blend)
+    g_object_set (priv->blend, "transition-type", type, NULL);
 
-  if (priv->type &&
-      ((priv->type != type) || (priv->type != priv->pending_type)) &&
-      ((type == GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE) ||
-          (priv->type == GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE))) {
-    GstPad *pad = gst_element_get_static_pad (priv->topbin, "sinka");
-
-    priv->pending_type = type;
-    if (type != GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE) {
-      if (!priv->topbin)
-        return FALSE;
-      priv->smpte = NULL;
-      gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_IDLE,
-          (GstPadProbeCallback) switch_to_smpte_cb, self, NULL);
-    } else {
-      if (!priv->topbin)
-        return FALSE;
-      priv->start_value = 1.0;
-      priv->end_value = 0.0;
-      gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_IDLE,
-          (GstPadProbeCallback) switch_to_crossfade_cb, self, NULL);
-    }
-    return TRUE;
-  }
-  priv->pending_type = type;
-  if (priv->smpte && (type != GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE)) {
-    g_object_set (priv->smpte, "type", (gint) type, NULL);
-  }
   return TRUE;
 }
 
@@ -775,15 +417,10 @@ ges_track_video_transition_set_border (GESTrackVideoTransition * self,
 gint
 ges_track_video_transition_get_border (GESTrackVideoTransition * self)
 {
-  gint value;
-
-  if (!self->priv->smpte) {
+  if (self->priv->type == GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE)
     return -1;
-  }
 
-  g_object_get (self->priv->smpte, "border", &value, NULL);
-
-  return value;
+  return self->priv->border;
 }
 
 /**
@@ -817,15 +454,7 @@ ges_track_video_transition_set_inverted (GESTrackVideoTransition * self,
 gboolean
 ges_track_video_transition_is_inverted (GESTrackVideoTransition * self)
 {
-  gboolean inverted;
-
-  if (!self->priv->smpte) {
-    return FALSE;
-  }
-
-  g_object_get (self->priv->smpte, "invert", &inverted, NULL);
-
-  return !inverted;
+  return self->priv->inverted;
 }
 
 /**
@@ -860,8 +489,6 @@ ges_track_video_transition_set_transition_type (GESTrackVideoTransition * self,
 GESVideoStandardTransitionType
 ges_track_video_transition_get_transition_type (GESTrackVideoTransition * trans)
 {
-  if (trans->priv->pending_type)
-    return trans->priv->pending_type;
   return trans->priv->type;
 }
 
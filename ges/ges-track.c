@@ -32,6 +32,7 @@
 #include "ges-internal.h"
 #include "ges-track.h"
 #include "ges-track-object.h"
+#include "ges-track-filesource.h"
 
 G_DEFINE_TYPE (GESTrack, ges_track, GST_TYPE_BIN);
 
@@ -51,27 +52,59 @@ struct _GESTrackPrivate
   /*< private > */
   GESTimeline *timeline;
   GSequence *tckobjs_by_start;
-  GList *gaps;
+  GList *gaps;                  /* Gap-s sorted by start */
 
   guint64 duration;
 
   GstCaps *caps;
+  /* The raw part of @caps, if @caps also contains compressed formats
+   * (smart rendering), otherwise %NULL */
+  GstCaps *raw_caps;
 
   GstElement *composition;      /* The composition associated with this track */
   GstPad *srcpad;               /* The source GhostPad */
 
   gboolean updating;
+  /* %TRUE if objects moved while we were not updating and
+   * tckobjs_by_start has not been resorted yet */
+  gboolean needs_sort;
 
   /* Virtual method to create GstElement that fill gaps */
   GESCreateElementForGapFunc create_element_for_gaps;
+
+  /* Gap gnlsources not currently used in the composition, ready
+   * to be reused by gap_new */
+  GList *gap_pool;
+  guint gap_pool_size;
+  guint gap_pool_max_size;
+  guint gap_pool_hits;
+  guint gap_pool_misses;
+
+  /* Lazy element creation, see ges_track_set_materialization_window() */
+  gboolean lazy_elements;
+  GstClockTime window_start;
+  GstClockTime window_stop;
+  /* The objects that were in the window when it was last updated, or whose
+   * element could not be released yet */
+  GHashTable *materialized;
+  /* Longest duration an object of the track ever had, bounds how far before
+   * the window an object intersecting it can start */
+  guint64 max_duration;
 };
 
+#define DEFAULT_GAP_POOL_MAX_SIZE 8
+
 enum
 {
   ARG_0,
   ARG_CAPS,
   ARG_TYPE,
   ARG_DURATION,
+  ARG_GAP_POOL_MAX_SIZE,
+  ARG_GAP_POOL_SIZE,
+  ARG_GAP_POOL_HITS,
+  ARG_GAP_POOL_MISSES,
+  ARG_LAZY_ELEMENTS,
   ARG_LAST,
   TRACK_OBJECT_ADDED,
   TRACK_OBJECT_REMOVED,
@@ -117,36 +150,101 @@ add_trackobj_to_list_foreach (GESTrackObject * trackobj, GList ** list)
   *list = g_list_prepend (*list, trackobj);
 }
 
-static Gap *
-gap_new (GESTrack * track, GstClockTime start, GstClockTime duration)
+/* Gap pool handling */
+static GstElement *
+gap_pool_acquire (GESTrack * track)
 {
   GstElement *gnlsrc, *elem;
+  GESTrackPrivate *priv = track->priv;
 
-  Gap *new_gap;
+  if (priv->gap_pool) {
+    gnlsrc = GST_ELEMENT (priv->gap_pool->data);
+    priv->gap_pool = g_list_delete_link (priv->gap_pool, priv->gap_pool);
+    priv->gap_pool_size--;
+    priv->gap_pool_hits++;
+
+    return gnlsrc;
+  }
+
+  priv->gap_pool_misses++;
 
   gnlsrc = gst_element_factory_make ("gnlsource", NULL);
-  elem = track->priv->create_element_for_gaps (track);
-  if (G_UNLIKELY (gst_bin_add (GST_BIN (gnlsrc), elem) == FALSE)) {
-    GST_WARNING_OBJECT (track, "Could not create gap filler");
+  if (G_UNLIKELY (gnlsrc == NULL)) {
+    GST_WARNING_OBJECT (track, "Could not create gnlsource for gap");
+
+    return NULL;
+  }
+  gst_object_ref_sink (gnlsrc);
 
-    if (gnlsrc)
-      gst_object_unref (gnlsrc);
+  elem = priv->create_element_for_gaps (track);
+  if (G_UNLIKELY (elem == NULL ||
+          gst_bin_add (GST_BIN (gnlsrc), elem) == FALSE)) {
+    GST_WARNING_OBJECT (track, "Could not create gap filler");
 
     if (elem)
       gst_object_unref (elem);
+    gst_object_unref (gnlsrc);
 
     return NULL;
   }
 
+  return gnlsrc;
+}
+
+static void
+gap_pool_release (GESTrack * track, GstElement * gnlsrc)
+{
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->gap_pool_size < priv->gap_pool_max_size) {
+    gst_element_set_state (gnlsrc, GST_STATE_READY);
+    priv->gap_pool = g_list_prepend (priv->gap_pool, gnlsrc);
+    priv->gap_pool_size++;
+
+    return;
+  }
+
+  gst_element_set_state (gnlsrc, GST_STATE_NULL);
+  gst_object_unref (gnlsrc);
+}
+
+static void
+gap_pool_trim (GESTrack * track, guint max_size)
+{
+  GstElement *gnlsrc;
+  GESTrackPrivate *priv = track->priv;
+
+  while (priv->gap_pool_size > max_size) {
+    gnlsrc = GST_ELEMENT (priv->gap_pool->data);
+    priv->gap_pool = g_list_delete_link (priv->gap_pool, priv->gap_pool);
+    priv->gap_pool_size--;
+
+    gst_element_set_state (gnlsrc, GST_STATE_NULL);
+    gst_object_unref (gnlsrc);
+  }
+}
+
+static Gap *
+gap_new (GESTrack * track, GstClockTime start, GstClockTime duration)
+{
+  GstElement *gnlsrc;
+
+  Gap *new_gap;
+
+  gnlsrc = gap_pool_acquire (track);
+  if (G_UNLIKELY (gnlsrc == NULL))
+    return NULL;
+
+  /* Position the gap before adding it so the composition does not see
+   * it at the place it previously was */
+  g_object_set (gnlsrc, "start", start, "duration", duration,
+      "priority", 0, NULL);
+
   if (G_UNLIKELY (gst_bin_add (GST_BIN (track->priv->composition),
               gnlsrc) == FALSE)) {
     GST_WARNING_OBJECT (track, "Could not add gap to the composition");
 
-    if (gnlsrc)
-      gst_object_unref (gnlsrc);
-
-    if (elem)
-      gst_object_unref (elem);
+    gap_pool_release (track, gnlsrc);
 
     return NULL;
   }
@@ -155,11 +253,7 @@ gap_new (GESTrack * track, GstClockTime start, GstClockTime duration)
   new_gap->start = start;
   new_gap->duration = duration;
   new_gap->track = track;
-  new_gap->gnlobj = gst_object_ref (gnlsrc);
-
-
-  g_object_set (gnlsrc, "start", new_gap->start, "duration", new_gap->duration,
-      "priority", 0, NULL);
+  new_gap->gnlobj = gnlsrc;
 
   GST_DEBUG_OBJECT (track,
       "Created gap with start %" GST_TIME_FORMAT " duration %" GST_TIME_FORMAT,
@@ -178,17 +272,71 @@ free_gap (Gap * gap)
       " duration %" GST_TIME_FORMAT, GST_TIME_ARGS (gap->start),
       GST_TIME_ARGS (gap->duration));
   gst_bin_remove (GST_BIN (track->priv->composition), gap->gnlobj);
-  gst_element_set_state (gap->gnlobj, GST_STATE_NULL);
-  gst_object_unref (gap->gnlobj);
+  gap_pool_release (track, gap->gnlobj);
 
   g_slice_free (Gap, gap);
 }
 
+/* Move @gap to @start/@duration, only touching the gnlobject properties
+ * that actually changed */
+static void
+gap_set_position (Gap * gap, GstClockTime start, GstClockTime duration)
+{
+  if (gap->start == start && gap->duration == duration)
+    return;
+
+  GST_DEBUG_OBJECT (gap->track, "Moving gap from %" GST_TIME_FORMAT
+      " (duration %" GST_TIME_FORMAT ") to %" GST_TIME_FORMAT " (duration %"
+      GST_TIME_FORMAT ")", GST_TIME_ARGS (gap->start),
+      GST_TIME_ARGS (gap->duration), GST_TIME_ARGS (start),
+      GST_TIME_ARGS (duration));
+
+  if (gap->start != start && gap->duration != duration)
+    g_object_set (gap->gnlobj, "start", start, "duration", duration, NULL);
+  else if (gap->start != start)
+    g_object_set (gap->gnlobj, "start", start, NULL);
+  else
+    g_object_set (gap->gnlobj, "duration", duration, NULL);
+
+  gap->start = start;
+  gap->duration = duration;
+}
+
+/* Make @cur (or a new gap appended after @last if @cur is NULL) cover
+ * @start/@duration and return the next gap to reuse. Existing gaps are
+ * reused so that elements are only created when the number of gaps grows */
+static inline GList *
+place_gap (GESTrack * track, GList ** last, GList * cur, GstClockTime start,
+    GstClockTime duration)
+{
+  Gap *gap;
+  GESTrackPrivate *priv = track->priv;
+
+  if (cur) {
+    gap_set_position (cur->data, start, duration);
+    *last = cur;
+
+    return cur->next;
+  }
+
+  gap = gap_new (track, start, duration);
+  if (G_LIKELY (gap != NULL)) {
+    if (*last == NULL) {
+      priv->gaps = g_list_append (priv->gaps, gap);
+      *last = priv->gaps;
+    } else {
+      *last = g_list_append (*last, gap)->next;
+    }
+  }
+
+  return NULL;
+}
+
 static inline void
 update_gaps (GESTrack * track)
 {
-  Gap *gap;
   GSequenceIter *it;
+  GList *cur, *next, *last = NULL;
 
   GESTrackObject *tckobj;
   GstClockTime start, end, duration = 0, timeline_duration;
@@ -201,11 +349,9 @@ update_gaps (GESTrack * track)
     return;
   }
 
-  /* 1- Remove all gaps */
-  g_list_free_full (priv->gaps, (GDestroyNotify) free_gap);
-  priv->gaps = NULL;
-
-  /* 2- And recalculate gaps */
+  /* 1- Calculate the gaps, reusing the existing ones (which are sorted by
+   * start) in order */
+  cur = priv->gaps;
   for (it = g_sequence_get_begin_iter (priv->tckobjs_by_start);
       g_sequence_iter_is_end (it) == FALSE; it = g_sequence_iter_next (it)) {
     tckobj = g_sequence_get (it);
@@ -214,30 +360,70 @@ update_gaps (GESTrack * track)
     end = start + GES_TRACK_OBJECT_DURATION (tckobj);
 
     if (start > duration) {
-      /* 3- Fill gap */
-      gap = gap_new (track, duration, start - duration);
-
-      if (G_LIKELY (gap != NULL))
-        priv->gaps = g_list_prepend (priv->gaps, gap);
+      /* 2- Fill gap */
+      cur = place_gap (track, &last, cur, duration, start - duration);
     }
 
     duration = MAX (duration, end);
   }
 
-  /* 4- Add a gap at the end of the timeline if needed */
+  /* 3- Add a gap at the end of the timeline if needed */
   if (priv->timeline) {
     g_object_get (priv->timeline, "duration", &timeline_duration, NULL);
 
     if (duration < timeline_duration) {
-      gap = gap_new (track, duration, timeline_duration - duration);
-
-      if (G_LIKELY (gap != NULL)) {
-        priv->gaps = g_list_prepend (priv->gaps, gap);
-      }
+      cur = place_gap (track, &last, cur, duration,
+          timeline_duration - duration);
 
       priv->duration = timeline_duration;
     }
+  }
 
+  /* 4- Remove the gaps that are not needed anymore */
+  while (cur) {
+    next = cur->next;
+
+    free_gap (cur->data);
+    priv->gaps = g_list_delete_link (priv->gaps, cur);
+
+    cur = next;
+  }
+}
+
+/* When smart rendering, only the file sources playing alone can output
+ * compressed data, anything overlapping (other sources, transitions,
+ * effects, overlays) needs to be decoded to be processed. */
+static void
+update_passthrough (GESTrack * track)
+{
+  GSequenceIter *it, *next;
+  GESTrackObject *tckobj;
+  GstElement *gnlobject;
+  GstClockTime start, end, max_end = 0;
+  gboolean passthrough;
+
+  GESTrackPrivate *priv = track->priv;
+
+  for (it = g_sequence_get_begin_iter (priv->tckobjs_by_start);
+      g_sequence_iter_is_end (it) == FALSE; it = next) {
+    tckobj = g_sequence_get (it);
+    next = g_sequence_iter_next (it);
+
+    start = GES_TRACK_OBJECT_START (tckobj);
+    end = start + GES_TRACK_OBJECT_DURATION (tckobj);
+
+    /* Objects are sorted by start, only the previous ones can still be
+     * playing at @start and only the next one can start before @end */
+    passthrough = priv->raw_caps && GES_IS_TRACK_FILESOURCE (tckobj) &&
+        max_end <= start && (g_sequence_iter_is_end (next) ||
+        GES_TRACK_OBJECT_START (g_sequence_get (next)) >= end);
+
+    max_end = MAX (max_end, end);
+
+    gnlobject = ges_track_object_get_gnlobject (tckobj);
+    if (gnlobject)
+      g_object_set (gnlobject, "caps",
+          passthrough || !priv->raw_caps ? priv->caps : priv->raw_caps, NULL);
   }
 }
 
@@ -246,9 +432,24 @@ resort_and_fill_gaps (GESTrack * track)
 {
   g_sequence_sort (track->priv->tckobjs_by_start,
       (GCompareDataFunc) objects_start_compare, NULL);
+  track->priv->needs_sort = FALSE;
 
   if (track->priv->updating == TRUE) {
     update_gaps (track);
+
+    if (track->priv->raw_caps)
+      update_passthrough (track);
+  }
+}
+
+/* Resort the objects if they moved while we were not updating */
+static inline void
+ensure_sorted (GESTrack * track)
+{
+  if (G_UNLIKELY (track->priv->needs_sort)) {
+    g_sequence_sort (track->priv->tckobjs_by_start,
+        (GCompareDataFunc) objects_start_compare, NULL);
+    track->priv->needs_sort = FALSE;
   }
 }
 
@@ -261,21 +462,70 @@ timeline_duration_changed_cb (GESTimeline * timeline,
 
   /* Remove the last gap on the timeline if not needed anymore */
   if (priv->updating == TRUE && priv->gaps) {
-    Gap *gap = (Gap *) priv->gaps->data;
+    GList *last = g_list_last (priv->gaps);
+    Gap *gap = (Gap *) last->data;
     GstClockTime tl_duration = ges_timeline_get_duration (timeline);
 
     if (gap->start + gap->duration > tl_duration) {
       free_gap (gap);
-      priv->gaps = g_list_remove (priv->gaps, gap);
+      priv->gaps = g_list_delete_link (priv->gaps, last);
     }
   }
 }
 
+/* Creates or releases the element of @tckobj depending on whether it is in
+ * the materialization window or not */
+static void
+update_materialization (GESTrack * track, GESTrackObject * tckobj)
+{
+  GESTrackPrivate *priv = track->priv;
+  guint64 start = GES_TRACK_OBJECT_START (tckobj);
+  guint64 end = start + GES_TRACK_OBJECT_DURATION (tckobj);
+
+  if (start < priv->window_stop && end > priv->window_start) {
+    ges_track_object_materialize (tckobj);
+    g_hash_table_insert (priv->materialized, tckobj, tckobj);
+  } else if (ges_track_object_dematerialize (tckobj)) {
+    g_hash_table_remove (priv->materialized, tckobj);
+  }
+}
+
+/* Returns the first iter of tckobjs_by_start whose object starts at or
+ * after @start, tckobjs_by_start has to be sorted */
+static GSequenceIter *
+get_iter_at_start (GESTrack * track, guint64 start)
+{
+  GSequence *seq = track->priv->tckobjs_by_start;
+  gint low = 0, high = g_sequence_get_length (seq), mid;
+
+  while (low < high) {
+    mid = low + (high - low) / 2;
+
+    if (GES_TRACK_OBJECT_START (g_sequence_get (g_sequence_get_iter_at_pos (seq,
+                    mid))) < start)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  return g_sequence_get_iter_at_pos (seq, low);
+}
+
 static void
 sort_track_objects_cb (GESTrackObject * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTrack * track)
 {
-  resort_and_fill_gaps (track);
+  track->priv->max_duration = MAX (track->priv->max_duration,
+      GES_TRACK_OBJECT_DURATION (child));
+
+  if (track->priv->lazy_elements)
+    update_materialization (track, child);
+
+  /* When not updating, everything is resorted once updates are reenabled */
+  if (track->priv->updating == FALSE)
+    track->priv->needs_sort = TRUE;
+  else
+    resort_and_fill_gaps (track);
 }
 
 static void
@@ -469,6 +719,21 @@ ges_track_get_property (GObject * object, guint property_id,
     case ARG_DURATION:
       g_value_set_uint64 (value, track->priv->duration);
       break;
+    case ARG_GAP_POOL_MAX_SIZE:
+      g_value_set_uint (value, track->priv->gap_pool_max_size);
+      break;
+    case ARG_GAP_POOL_SIZE:
+      g_value_set_uint (value, track->priv->gap_pool_size);
+      break;
+    case ARG_GAP_POOL_HITS:
+      g_value_set_uint (value, track->priv->gap_pool_hits);
+      break;
+    case ARG_GAP_POOL_MISSES:
+      g_value_set_uint (value, track->priv->gap_pool_misses);
+      break;
+    case ARG_LAZY_ELEMENTS:
+      g_value_set_boolean (value, track->priv->lazy_elements);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -487,6 +752,13 @@ ges_track_set_property (GObject * object, guint property_id,
     case ARG_TYPE:
       track->type = g_value_get_flags (value);
       break;
+    case ARG_GAP_POOL_MAX_SIZE:
+      track->priv->gap_pool_max_size = g_value_get_uint (value);
+      gap_pool_trim (track, track->priv->gap_pool_max_size);
+      break;
+    case ARG_LAZY_ELEMENTS:
+      track->priv->lazy_elements = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -503,6 +775,8 @@ ges_track_dispose (GObject * object)
       (GFunc) dispose_tckobjs_foreach, track);
   g_sequence_free (priv->tckobjs_by_start);
   g_list_free_full (priv->gaps, (GDestroyNotify) free_gap);
+  priv->gaps = NULL;
+  gap_pool_trim (track, 0);
 
   if (priv->composition) {
     gst_bin_remove (GST_BIN (object), priv->composition);
@@ -514,12 +788,21 @@ ges_track_dispose (GObject * object)
     priv->caps = NULL;
   }
 
+  if (priv->raw_caps) {
+    gst_caps_unref (priv->raw_caps);
+    priv->raw_caps = NULL;
+  }
+
   G_OBJECT_CLASS (ges_track_parent_class)->dispose (object);
 }
 
 static void
 ges_track_finalize (GObject * object)
 {
+  GESTrack *track = (GESTrack *) object;
+
+  g_hash_table_unref (track->priv->materialized);
+
   G_OBJECT_CLASS (ges_track_parent_class)->finalize (object);
 }
 
@@ -579,6 +862,75 @@ ges_track_class_init (GESTrackClass * klass)
   g_object_class_install_property (object_class, ARG_TYPE,
       properties[ARG_TYPE]);
 
+  /**
+   * GESTrack:gap-pool-max-size:
+   *
+   * Maximum number of unused gap filling elements the track keeps around to
+   * reuse them when new gaps appear, instead of creating new elements.
+   *
+   * Default value: 8
+   */
+  properties[ARG_GAP_POOL_MAX_SIZE] =
+      g_param_spec_uint ("gap-pool-max-size", "Gap pool max size",
+      "Maximum number of unused gap filling elements kept for reuse", 0,
+      G_MAXUINT, DEFAULT_GAP_POOL_MAX_SIZE, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_GAP_POOL_MAX_SIZE,
+      properties[ARG_GAP_POOL_MAX_SIZE]);
+
+  /**
+   * GESTrack:gap-pool-size:
+   *
+   * Number of unused gap filling elements currently kept for reuse
+   */
+  properties[ARG_GAP_POOL_SIZE] =
+      g_param_spec_uint ("gap-pool-size", "Gap pool size",
+      "Number of unused gap filling elements currently kept for reuse", 0,
+      G_MAXUINT, 0, G_PARAM_READABLE);
+  g_object_class_install_property (object_class, ARG_GAP_POOL_SIZE,
+      properties[ARG_GAP_POOL_SIZE]);
+
+  /**
+   * GESTrack:gap-pool-hits:
+   *
+   * Number of gaps that were filled reusing a pooled element
+   */
+  properties[ARG_GAP_POOL_HITS] =
+      g_param_spec_uint ("gap-pool-hits", "Gap pool hits",
+      "Number of gaps filled with a reused element", 0, G_MAXUINT, 0,
+      G_PARAM_READABLE);
+  g_object_class_install_property (object_class, ARG_GAP_POOL_HITS,
+      properties[ARG_GAP_POOL_HITS]);
+
+  /**
+   * GESTrack:gap-pool-misses:
+   *
+   * Number of gaps for which a new filling element had to be created
+   */
+  properties[ARG_GAP_POOL_MISSES] =
+      g_param_spec_uint ("gap-pool-misses", "Gap pool misses",
+      "Number of gaps for which a new element had to be created", 0,
+      G_MAXUINT, 0, G_PARAM_READABLE);
+  g_object_class_install_property (object_class, ARG_GAP_POOL_MISSES,
+      properties[ARG_GAP_POOL_MISSES]);
+
+  /**
+   * GESTrack:lazy-elements:
+   *
+   * If %TRUE, the sources added to the track afterwards only create their
+   * GStreamer elements when they are within the window set with
+   * ges_track_set_materialization_window(), and release them when they
+   * leave it. Until a window is set, it covers the whole track. This keeps
+   * the memory usage and the loading time of long timelines low.
+   * #GESTimelinePipeline moves the window along with its playback (or
+   * rendering) position.
+   */
+  properties[ARG_LAZY_ELEMENTS] =
+      g_param_spec_boolean ("lazy-elements", "Lazy elements",
+      "Only create the elements of the sources in the materialization window",
+      FALSE, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_LAZY_ELEMENTS,
+      properties[ARG_LAZY_ELEMENTS]);
+
   /**
    * GESTrack::track-object-added:
    * @object: the #GESTrack
@@ -616,9 +968,20 @@ ges_track_init (GESTrack * self)
 
   self->priv->composition = gst_element_factory_make ("gnlcomposition", NULL);
   self->priv->updating = TRUE;
+  self->priv->needs_sort = FALSE;
   self->priv->tckobjs_by_start = g_sequence_new (NULL);
   self->priv->create_element_for_gaps = NULL;
   self->priv->gaps = NULL;
+  self->priv->gap_pool = NULL;
+  self->priv->gap_pool_size = 0;
+  self->priv->gap_pool_max_size = DEFAULT_GAP_POOL_MAX_SIZE;
+  self->priv->gap_pool_hits = 0;
+  self->priv->gap_pool_misses = 0;
+  self->priv->lazy_elements = FALSE;
+  self->priv->window_start = 0;
+  self->priv->window_stop = GST_CLOCK_TIME_NONE;
+  self->priv->materialized = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->max_duration = 0;
 
   g_signal_connect (G_OBJECT (self->priv->composition), "notify::duration",
       G_CALLBACK (composition_duration_cb), self);
@@ -723,16 +1086,46 @@ ges_track_set_timeline (GESTrack * track, GESTimeline * timeline)
   track->priv->timeline = timeline;
 }
 
+/* Returns the raw structures of @caps if it also contains compressed
+ * formats, else %NULL */
+static GstCaps *
+get_raw_caps (const GstCaps * caps)
+{
+  guint i;
+  GstCaps *raw_caps = gst_caps_new_empty ();
+
+  for (i = 0; i < gst_caps_get_size (caps); i++) {
+    GstStructure *structure = gst_caps_get_structure (caps, i);
+
+    if (g_str_has_suffix (gst_structure_get_name (structure), "/x-raw"))
+      gst_caps_append_structure (raw_caps, gst_structure_copy (structure));
+  }
+
+  if (gst_caps_is_empty (raw_caps) ||
+      gst_caps_get_size (raw_caps) == gst_caps_get_size (caps)) {
+    gst_caps_unref (raw_caps);
+    return NULL;
+  }
+
+  return raw_caps;
+}
+
 /**
  * ges_track_set_caps:
  * @track: a #GESTrack
  * @caps: the #GstCaps to set
  *
  * Sets the given @caps on the track.
+ *
+ * If @caps contain both raw and compressed formats, only the
+ * #GESTrackFileSource-s that do not overlap with any other object will
+ * be allowed to output compressed data, which is what smart rendering
+ * relies on.
  */
 void
 ges_track_set_caps (GESTrack * track, const GstCaps * caps)
 {
+  GSequenceIter *it;
   GESTrackPrivate *priv;
 
   g_return_if_fail (GES_IS_TRACK (track));
@@ -746,8 +1139,26 @@ ges_track_set_caps (GESTrack * track, const GstCaps * caps)
     gst_caps_unref (priv->caps);
   priv->caps = gst_caps_copy (caps);
 
+  if (priv->raw_caps)
+    gst_caps_unref (priv->raw_caps);
+  priv->raw_caps = get_raw_caps (caps);
+
   g_object_set (priv->composition, "caps", caps, NULL);
-  /* FIXME : update all trackobjects ? */
+
+  /* Update the objects we already contain */
+  ensure_sorted (track);
+  if (priv->raw_caps) {
+    update_passthrough (track);
+  } else {
+    for (it = g_sequence_get_begin_iter (priv->tckobjs_by_start);
+        g_sequence_iter_is_end (it) == FALSE; it = g_sequence_iter_next (it)) {
+      GstElement *gnlobject =
+          ges_track_object_get_gnlobject (g_sequence_get (it));
+
+      if (gnlobject)
+        g_object_set (gnlobject, "caps", caps, NULL);
+    }
+  }
 }
 
 /**
@@ -807,7 +1218,14 @@ ges_track_add_object (GESTrack * track, GESTrackObject * object)
   g_signal_connect (GES_TRACK_OBJECT (object), "notify::priority",
       G_CALLBACK (sort_track_objects_cb), track);
 
-  resort_and_fill_gaps (track);
+  track->priv->max_duration = MAX (track->priv->max_duration,
+      GES_TRACK_OBJECT_DURATION (object));
+  if (track->priv->lazy_elements)
+    update_materialization (track, object);
+
+  /* Gaps will be filled when updates are reenabled */
+  if (track->priv->updating == TRUE)
+    resort_and_fill_gaps (track);
 
   return TRUE;
 }
@@ -828,6 +1246,7 @@ ges_track_get_objects (GESTrack * track)
 
   g_return_val_if_fail (GES_IS_TRACK (track), NULL);
 
+  ensure_sorted (track);
   g_sequence_foreach (track->priv->tckobjs_by_start,
       (GFunc) add_trackobj_to_list_foreach, &ret);
 
@@ -860,10 +1279,13 @@ ges_track_remove_object (GESTrack * track, GESTrackObject * object)
   priv = track->priv;
 
   if (remove_object_internal (track, object) == TRUE) {
+    g_hash_table_remove (priv->materialized, object);
+    ensure_sorted (track);
     it = lookup_trackobj_it (priv->tckobjs_by_start, object);
     g_sequence_remove (it);
 
-    resort_and_fill_gaps (track);
+    if (priv->updating == TRUE)
+      resort_and_fill_gaps (track);
 
     return TRUE;
   }
@@ -922,14 +1344,18 @@ ges_track_enable_update (GESTrack * track, gboolean enabled)
 
   g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
 
+  /* Resort and fill the gaps before letting the composition update so that
+   * it only has to do it once */
+  if (enabled == TRUE) {
+    track->priv->updating = TRUE;
+    resort_and_fill_gaps (track);
+  }
+
   g_object_set (track->priv->composition, "update", enabled, NULL);
   g_object_get (track->priv->composition, "update", &update, NULL);
 
   track->priv->updating = update;
 
-  if (update == TRUE)
-    resort_and_fill_gaps (track);
-
   return update == enabled;
 }
 
@@ -966,5 +1392,75 @@ ges_track_set_create_element_for_gap_func (GESTrack * track,
 {
   g_return_if_fail (GES_IS_TRACK (track));
 
+  /* Pooled elements were created by the previous function */
+  if (track->priv->create_element_for_gaps != func)
+    gap_pool_trim (track, 0);
+
   track->priv->create_element_for_gaps = func;
 }
+
+/* INTERNAL USAGE */
+gboolean
+ges_track_get_lazy_elements (GESTrack * track)
+{
+  return track->priv->lazy_elements;
+}
+
+/**
+ * ges_track_set_materialization_window:
+ * @track: a #GESTrack
+ * @start: The start of the window
+ * @stop: The stop of the window
+ *
+ * Sets the part of @track for which the sources must have their GStreamer
+ * elements created, when #GESTrack:lazy-elements is %TRUE. Sources
+ * intersecting [@start, @stop[ get their elements created, the elements of
+ * the other sources are released if they are not in use. The default
+ * window covers the whole track, use %GST_CLOCK_TIME_NONE as @stop to go
+ * back to it.
+ *
+ * #GESTimelinePipeline keeps the window around its current position,
+ * applications driving @track through other means should do the same,
+ * for example from the current position to a few seconds ahead of it.
+ *
+ * Only the objects entering or leaving the window are updated, so this can
+ * be called often, even on long tracks.
+ */
+void
+ges_track_set_materialization_window (GESTrack * track, GstClockTime start,
+    GstClockTime stop)
+{
+  GSequenceIter *it;
+  GESTrackPrivate *priv;
+  GList *objects, *tmp;
+  guint64 first_start;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+  g_return_if_fail (start <= stop);
+
+  priv = track->priv;
+  priv->window_start = start;
+  priv->window_stop = stop;
+
+  if (priv->lazy_elements == FALSE)
+    return;
+
+  GST_DEBUG_OBJECT (track, "Materializing %" GST_TIME_FORMAT " -- %"
+      GST_TIME_FORMAT, GST_TIME_ARGS (start), GST_TIME_ARGS (stop));
+
+  /* Objects leaving the window */
+  objects = g_hash_table_get_keys (priv->materialized);
+  for (tmp = objects; tmp; tmp = tmp->next)
+    update_materialization (track, tmp->data);
+  g_list_free (objects);
+
+  /* Objects entering it, no object starting before @start - max_duration
+   * can intersect it */
+  ensure_sorted (track);
+  first_start = start > priv->max_duration ? start - priv->max_duration : 0;
+  for (it = get_iter_at_start (track, first_start);
+      g_sequence_iter_is_end (it) == FALSE &&
+      GES_TRACK_OBJECT_START (g_sequence_get (it)) < stop;
+      it = g_sequence_iter_next (it))
+    update_materialization (track, g_sequence_get (it));
+}
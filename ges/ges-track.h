@@ -123,6 +123,11 @@ void
 ges_track_set_create_element_for_gap_func (GESTrack *track,
                                            GESCreateElementForGapFunc func);
 
+void
+ges_track_set_materialization_window      (GESTrack *track,
+                                           GstClockTime start,
+                                           GstClockTime stop);
+
 G_END_DECLS
 
 #endif /* _GES_TRACK */
@@ -134,6 +134,9 @@ typedef struct _GESFormatterClass GESFormatterClass;
 typedef struct _GESKeyfileFormatter GESKeyfileFormatter;
 typedef struct _GESKeyfileFormatterClass GESKeyfileFormatterClass;
 
+typedef struct _GESBinaryFormatter GESBinaryFormatter;
+typedef struct _GESBinaryFormatterClass GESBinaryFormatterClass;
+
 typedef struct _GESPitiviFormatter GESPitiviFormatter;
 typedef struct _GESPitiviFormatterClass GESPitiviFormatterClass;
 
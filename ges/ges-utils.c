@@ -23,6 +23,8 @@
  *
  */
 
+#include <gst/video/video.h>
+
 #include "ges-internal.h"
 #include "ges-timeline.h"
 #include "ges-track.h"
@@ -58,3 +60,41 @@ ges_timeline_new_audio_video (void)
 
   return timeline;
 }
+
+/* INTERNAL USAGE */
+/* Returns a sample holding a copy of the video frame in @buffer, in system
+ * memory and with the default strides, so that caching it does not keep the
+ * buffer pool of its producer alive. Returns %NULL if @buffer is not a
+ * frame of @caps. */
+GstSample *
+ges_video_sample_new_copy (GstBuffer * buffer, GstCaps * caps)
+{
+  GstVideoInfo info;
+  GstVideoFrame src, dest;
+  GstBuffer *copy;
+  GstSample *sample;
+
+  if (!gst_video_info_from_caps (&info, caps) ||
+      !gst_video_frame_map (&src, &info, buffer, GST_MAP_READ))
+    return NULL;
+
+  copy = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  if (!gst_video_frame_map (&dest, &info, copy, GST_MAP_WRITE)) {
+    gst_video_frame_unmap (&src);
+    gst_buffer_unref (copy);
+
+    return NULL;
+  }
+
+  gst_video_frame_copy (&dest, &src);
+  gst_video_frame_unmap (&dest);
+  gst_video_frame_unmap (&src);
+
+  gst_buffer_copy_into (copy, buffer,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  sample = gst_sample_new (copy, caps, NULL, NULL);
+  gst_buffer_unref (copy);
+
+  return sample;
+}
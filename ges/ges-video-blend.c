@@ -0,0 +1,905 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Blends the two inputs of a video transition in a single pass.
+ *
+ * Both inputs have to share the format and size of the output, which is the
+ * format the first input negotiated. The caps query of the sink pads answers
+ * with that format, so that converters placed upstream are passthrough as
+ * soon as the sources already produce it.
+ *
+ * The output follows the frames of the first input. The second input keeps
+ * its own framerate: its frames are paired with the first input ones by
+ * running time, repeating or dropping them like videomixer does.
+ *
+ * Each output byte is `a + (b - a) * weight / 256`, where the weight of the
+ * second input is the same for the whole frame for crossfades and comes from
+ * a #GESSmpteMask for the other transition types. The loops work on plain
+ * byte rows without branches so that the compiler can vectorize them. */
+
+#include <gst/base/gstcollectpads.h>
+#include <gst/video/video.h>
+
+#include "ges-internal.h"
+
+#define GES_VIDEO_BLEND(obj) ((GESVideoBlend *) (obj))
+
+typedef struct _GESVideoBlend GESVideoBlend;
+typedef struct _GESVideoBlendClass GESVideoBlendClass;
+
+typedef struct
+{
+  GstCollectData data;
+
+  /* The caps of this input are not the output ones yet */
+  gboolean mismatch;
+} GESVideoBlendData;
+
+struct _GESVideoBlend
+{
+  GstElement parent;
+
+  GstPad *srcpad;
+  GstPad *sinka;
+  GstPad *sinkb;
+
+  GstCollectPads *collect;
+  GESVideoBlendData *dataa;
+  GESVideoBlendData *datab;
+
+  /* Protected by the object lock */
+  GstCaps *caps;
+  GstVideoInfo info;
+  gboolean send_caps;
+  gdouble position;
+  GESVideoStandardTransitionType type;
+  guint border;
+  gboolean invert;
+
+  /* Only accessed from the streaming thread */
+  gboolean send_segment;
+  /* The frame of the second input shown at the current running time, and
+   * the running time it ends at */
+  GstBuffer *current_b;
+  GstClockTime current_b_end;
+  GESSmpteMask *mask;
+  guint *columns[GST_VIDEO_MAX_PLANES];
+};
+
+struct _GESVideoBlendClass
+{
+  GstElementClass parent_class;
+};
+
+G_DEFINE_TYPE (GESVideoBlend, ges_video_blend, GST_TYPE_ELEMENT);
+
+enum
+{
+  PROP_0,
+  PROP_POSITION,
+  PROP_TRANSITION_TYPE,
+  PROP_BORDER,
+  PROP_INVERT
+};
+
+#define BLEND_FORMATS "{ I420, YV12, Y42B, Y444, Y41B, NV12, NV21, AYUV, " \
+    "YUY2, UYVY, YVYU, ARGB, BGRA, RGBA, ABGR, xRGB, BGRx, RGBx, xBGR, " \
+    "RGB, BGR, GRAY8 }"
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (BLEND_FORMATS)));
+
+static GstStaticPadTemplate sink_a_template =
+GST_STATIC_PAD_TEMPLATE ("sink_a",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (BLEND_FORMATS)));
+
+static GstStaticPadTemplate sink_b_template =
+GST_STATIC_PAD_TEMPLATE ("sink_b",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (BLEND_FORMATS)));
+
+static void
+free_columns (GESVideoBlend * blend)
+{
+  guint i;
+
+  for (i = 0; i < GST_VIDEO_MAX_PLANES; i++) {
+    g_free (blend->columns[i]);
+    blend->columns[i] = NULL;
+  }
+}
+
+static void
+clear_current_b (GESVideoBlend * blend)
+{
+  if (blend->current_b) {
+    gst_buffer_unref (blend->current_b);
+    blend->current_b = NULL;
+  }
+  blend->current_b_end = GST_CLOCK_TIME_NONE;
+}
+
+static void
+reset (GESVideoBlend * blend)
+{
+  GST_OBJECT_LOCK (blend);
+  gst_caps_replace (&blend->caps, NULL);
+  gst_video_info_init (&blend->info);
+  blend->send_caps = FALSE;
+  GST_OBJECT_UNLOCK (blend);
+
+  blend->send_segment = TRUE;
+  blend->dataa->mismatch = FALSE;
+  blend->datab->mismatch = FALSE;
+  clear_current_b (blend);
+
+  if (blend->mask) {
+    ges_smpte_mask_unref (blend->mask);
+    blend->mask = NULL;
+  }
+  free_columns (blend);
+}
+
+/* Only the format and the size of the inputs have to match */
+static gboolean
+info_matches (const GstVideoInfo * info, const GstVideoInfo * other)
+{
+  return GST_VIDEO_INFO_FORMAT (info) == GST_VIDEO_INFO_FORMAT (other) &&
+      GST_VIDEO_INFO_WIDTH (info) == GST_VIDEO_INFO_WIDTH (other) &&
+      GST_VIDEO_INFO_HEIGHT (info) == GST_VIDEO_INFO_HEIGHT (other);
+}
+
+static GstCaps *
+get_input_caps (GESVideoBlend * blend, GstPad * pad, GstCaps * filter)
+{
+  GstCaps *caps, *template, *tmp;
+
+  template = gst_pad_get_pad_template_caps (pad);
+
+  GST_OBJECT_LOCK (blend);
+  if (blend->caps) {
+    GstStructure *structure;
+
+    /* Let the second input keep its own framerate, its frames are paired
+     * with the first input ones by running time, and its pixel aspect
+     * ratio */
+    caps = gst_caps_copy (blend->caps);
+    structure = gst_caps_get_structure (caps, 0);
+    gst_structure_remove_fields (structure, "framerate", "pixel-aspect-ratio",
+        NULL);
+    GST_OBJECT_UNLOCK (blend);
+  } else {
+    GST_OBJECT_UNLOCK (blend);
+
+    caps = gst_pad_peer_query_caps (blend->srcpad, template);
+  }
+
+  tmp = gst_caps_intersect (caps, template);
+  gst_caps_unref (caps);
+  gst_caps_unref (template);
+  caps = tmp;
+
+  if (filter) {
+    tmp = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+    caps = tmp;
+  }
+
+  return caps;
+}
+
+static gboolean
+set_input_caps (GESVideoBlend * blend, GESVideoBlendData * data,
+    GstCaps * caps)
+{
+  GstVideoInfo info;
+
+  if (!gst_video_info_from_caps (&info, caps)) {
+    GST_WARNING_OBJECT (data->data.pad, "Invalid caps %" GST_PTR_FORMAT, caps);
+    return FALSE;
+  }
+
+  GST_OBJECT_LOCK (blend);
+  if (blend->caps == NULL) {
+    GST_DEBUG_OBJECT (data->data.pad, "Output caps %" GST_PTR_FORMAT, caps);
+
+    blend->caps = gst_caps_ref (caps);
+    blend->info = info;
+    blend->send_caps = TRUE;
+    data->mismatch = FALSE;
+  } else if (info_matches (&info, &blend->info)) {
+    /* The output follows the framerate of the first input */
+    if (data == blend->dataa && !gst_caps_is_equal (caps, blend->caps)) {
+      gst_caps_replace (&blend->caps, caps);
+      blend->info = info;
+      blend->send_caps = TRUE;
+    }
+    data->mismatch = FALSE;
+  } else {
+    GST_DEBUG_OBJECT (data->data.pad, "%" GST_PTR_FORMAT " does not match "
+        "the output caps, renegotiating", caps);
+    data->mismatch = TRUE;
+  }
+  GST_OBJECT_UNLOCK (blend);
+
+  if (data->mismatch)
+    gst_pad_push_event (data->data.pad, gst_event_new_reconfigure ());
+
+  return TRUE;
+}
+
+static gboolean
+ges_video_blend_sink_event (GstCollectPads * pads, GstCollectData * data,
+    GstEvent * event, GESVideoBlend * blend)
+{
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      gboolean ret;
+
+      gst_event_parse_caps (event, &caps);
+      ret = set_input_caps (blend, (GESVideoBlendData *) data, caps);
+      gst_event_unref (event);
+
+      return ret;
+    }
+    case GST_EVENT_FLUSH_STOP:
+      GST_COLLECT_PADS_STREAM_LOCK (pads);
+      clear_current_b (blend);
+      GST_COLLECT_PADS_STREAM_UNLOCK (pads);
+      /* fall through */
+    case GST_EVENT_SEGMENT:
+      blend->send_segment = TRUE;
+      break;
+    default:
+      break;
+  }
+
+  return gst_collect_pads_event_default (pads, data, event, FALSE);
+}
+
+static gboolean
+ges_video_blend_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GESVideoBlend *blend = GES_VIDEO_BLEND (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps;
+
+      gst_query_parse_caps (query, &filter);
+      caps = get_input_caps (blend, pad, filter);
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+
+      return TRUE;
+    }
+    case GST_QUERY_ACCEPT_CAPS:
+    {
+      GstCaps *caps, *allowed;
+
+      gst_query_parse_accept_caps (query, &caps);
+      allowed = get_input_caps (blend, pad, NULL);
+      gst_query_set_accept_caps_result (query,
+          gst_caps_can_intersect (caps, allowed));
+      gst_caps_unref (allowed);
+
+      return TRUE;
+    }
+    default:
+      break;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+static gboolean
+ges_video_blend_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GESVideoBlend *blend = GES_VIDEO_BLEND (parent);
+  gboolean ret;
+
+  /* Both inputs are driven by the same composition */
+  gst_event_ref (event);
+  ret = gst_pad_push_event (blend->sinka, event);
+  ret &= gst_pad_push_event (blend->sinkb, event);
+
+  return ret;
+}
+
+static gboolean
+ges_video_blend_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GESVideoBlend *blend = GES_VIDEO_BLEND (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps;
+
+      gst_query_parse_caps (query, &filter);
+
+      GST_OBJECT_LOCK (blend);
+      if (blend->caps)
+        caps = gst_caps_ref (blend->caps);
+      else
+        caps = gst_pad_get_pad_template_caps (pad);
+      GST_OBJECT_UNLOCK (blend);
+
+      if (filter) {
+        GstCaps *tmp =
+            gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+
+        gst_caps_unref (caps);
+        caps = tmp;
+      }
+
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+
+      return TRUE;
+    }
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+/* For each byte of a row of every plane, the column of the pixel it belongs
+ * to in the mask */
+static void
+compute_columns (GESVideoBlend * blend, GstVideoFrame * frame)
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  guint plane, comp;
+
+  for (plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (frame); plane++) {
+    gint i, bytes, pstride, wsub;
+
+    for (comp = 0; GST_VIDEO_FORMAT_INFO_PLANE (finfo, comp) != plane; comp++);
+
+    pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, comp);
+    wsub = GST_VIDEO_FORMAT_INFO_W_SUB (finfo, comp);
+    bytes = GST_VIDEO_FRAME_COMP_WIDTH (frame, comp) * pstride;
+
+    blend->columns[plane] = g_new (guint, bytes);
+    for (i = 0; i < bytes; i++)
+      blend->columns[plane][i] = MIN ((i / pstride) << wsub,
+          GST_VIDEO_FRAME_WIDTH (frame) - 1);
+  }
+}
+
+static void
+blend_row (guint8 * out, const guint8 * a, const guint8 * b, gint n,
+    gint weight)
+{
+  gint i;
+
+  for (i = 0; i < n; i++)
+    out[i] = a[i] + (((b[i] - a[i]) * weight + 128) >> 8);
+}
+
+static void
+blend_row_masked (guint8 * out, const guint8 * a, const guint8 * b, gint n,
+    const guint32 * ramp, const guint * columns, gint32 threshold)
+{
+  gint i;
+
+  for (i = 0; i < n; i++) {
+    gint32 weight = CLAMP (threshold - (gint32) ramp[columns[i]], 0, 256);
+
+    out[i] = a[i] + (((b[i] - a[i]) * weight + 128) >> 8);
+  }
+}
+
+static void
+blend_frames (GESVideoBlend * blend, GstVideoFrame * out, GstVideoFrame * fa,
+    GstVideoFrame * fb, gint weight, gint32 threshold)
+{
+  const GstVideoFormatInfo *finfo = out->info.finfo;
+  guint plane, comp;
+
+  for (plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (out); plane++) {
+    guint8 *dout = GST_VIDEO_FRAME_PLANE_DATA (out, plane);
+    const guint8 *da = GST_VIDEO_FRAME_PLANE_DATA (fa, plane);
+    const guint8 *db = GST_VIDEO_FRAME_PLANE_DATA (fb, plane);
+    gint sout = GST_VIDEO_FRAME_PLANE_STRIDE (out, plane);
+    gint sa = GST_VIDEO_FRAME_PLANE_STRIDE (fa, plane);
+    gint sb = GST_VIDEO_FRAME_PLANE_STRIDE (fb, plane);
+    gint y, rows, bytes, hsub;
+
+    for (comp = 0; GST_VIDEO_FORMAT_INFO_PLANE (finfo, comp) != plane; comp++);
+
+    rows = GST_VIDEO_FRAME_COMP_HEIGHT (out, comp);
+    bytes = GST_VIDEO_FRAME_COMP_WIDTH (out, comp) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (out, comp);
+    hsub = GST_VIDEO_FORMAT_INFO_H_SUB (finfo, comp);
+
+    for (y = 0; y < rows; y++) {
+      if (blend->mask) {
+        gint mrow = MIN (y << hsub, blend->mask->height - 1);
+
+        blend_row_masked (dout, da, db, bytes,
+            blend->mask->ramp + mrow * blend->mask->width,
+            blend->columns[plane], threshold);
+      } else {
+        blend_row (dout, da, db, bytes, weight);
+      }
+
+      dout += sout;
+      da += sa;
+      db += sb;
+    }
+  }
+}
+
+/* Makes sure the mask matches the current properties, returns %FALSE for
+ * crossfades */
+static gboolean
+update_mask (GESVideoBlend * blend, GstVideoInfo * info)
+{
+  GESVideoStandardTransitionType type;
+  guint border;
+  gboolean invert;
+
+  GST_OBJECT_LOCK (blend);
+  type = blend->type;
+  border = blend->border;
+  invert = blend->invert;
+  GST_OBJECT_UNLOCK (blend);
+
+  if (type == GES_VIDEO_STANDARD_TRANSITION_TYPE_NONE ||
+      type == GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE) {
+    if (blend->mask) {
+      ges_smpte_mask_unref (blend->mask);
+      blend->mask = NULL;
+    }
+
+    return FALSE;
+  }
+
+  if (blend->mask && blend->mask->type == type &&
+      blend->mask->border == border && blend->mask->invert == invert &&
+      blend->mask->width == GST_VIDEO_INFO_WIDTH (info) &&
+      blend->mask->height == GST_VIDEO_INFO_HEIGHT (info))
+    return TRUE;
+
+  if (blend->mask)
+    ges_smpte_mask_unref (blend->mask);
+
+  blend->mask = ges_smpte_mask_get (type, GST_VIDEO_INFO_WIDTH (info),
+      GST_VIDEO_INFO_HEIGHT (info), border, invert);
+
+  return TRUE;
+}
+
+static GstBuffer *
+blend_buffers (GESVideoBlend * blend, GstBuffer * bufa, GstBuffer * bufb,
+    gdouble position)
+{
+  GstVideoFrame out, fa, fb;
+  GstVideoInfo info;
+  GstBuffer *outbuf;
+  gint weight = 0;
+  gint32 threshold = 0;
+
+  GST_OBJECT_LOCK (blend);
+  info = blend->info;
+  GST_OBJECT_UNLOCK (blend);
+
+  if (update_mask (blend, &info)) {
+    threshold = ges_smpte_mask_get_threshold (blend->mask, position);
+  } else {
+    weight = (gint) (CLAMP (position, 0.0, 1.0) * 256 + 0.5);
+
+    /* Nothing to blend */
+    if (weight == 0) {
+      gst_buffer_unref (bufb);
+
+      return bufa;
+    } else if (weight == 256) {
+      /* Keeps the metas of bufb, describing its own memory */
+      outbuf = gst_buffer_make_writable (bufb);
+      gst_buffer_copy_into (outbuf, bufa,
+          GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+      gst_buffer_unref (bufa);
+
+      return outbuf;
+    }
+  }
+
+  outbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  /* The metas of bufa, like its GstVideoMeta, do not apply to outbuf */
+  gst_buffer_copy_into (outbuf, bufa,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  if (!gst_video_frame_map (&out, &info, outbuf, GST_MAP_WRITE))
+    goto map_failed;
+
+  if (!gst_video_frame_map (&fa, &info, bufa, GST_MAP_READ)) {
+    gst_video_frame_unmap (&out);
+    goto map_failed;
+  }
+
+  if (!gst_video_frame_map (&fb, &info, bufb, GST_MAP_READ)) {
+    gst_video_frame_unmap (&fa);
+    gst_video_frame_unmap (&out);
+    goto map_failed;
+  }
+
+  if (blend->mask && blend->columns[0] == NULL)
+    compute_columns (blend, &out);
+
+  blend_frames (blend, &out, &fa, &fb, weight, threshold);
+
+  gst_video_frame_unmap (&fb);
+  gst_video_frame_unmap (&fa);
+  gst_video_frame_unmap (&out);
+
+  gst_buffer_unref (bufa);
+  gst_buffer_unref (bufb);
+
+  return outbuf;
+
+map_failed:
+  GST_WARNING_OBJECT (blend, "Could not map buffers, outputting first input");
+  gst_buffer_unref (outbuf);
+  gst_buffer_unref (bufb);
+
+  return bufa;
+}
+
+static GstClockTime
+get_running_time (GstCollectData * data, GstBuffer * buffer)
+{
+  if (!GST_BUFFER_TIMESTAMP_IS_VALID (buffer))
+    return GST_CLOCK_TIME_NONE;
+
+  return gst_segment_to_running_time (&data->segment, GST_FORMAT_TIME,
+      GST_BUFFER_TIMESTAMP (buffer));
+}
+
+/* Makes current_b the last frame of the second input starting at or before
+ * @running_time, dropping the ones before it. Frames without timestamps
+ * are paired in order. Returns %FALSE if the second input has to provide
+ * its next frame first */
+static gboolean
+update_current_b (GESVideoBlend * blend, GstCollectPads * pads,
+    GstClockTime running_time)
+{
+  GstCollectData *data = (GstCollectData *) blend->datab;
+  GstBuffer *buffer;
+
+  while ((buffer = gst_collect_pads_peek (pads, data))) {
+    GstClockTime start = get_running_time (data, buffer);
+
+    gst_buffer_unref (buffer);
+
+    /* The next frame is for later, keep showing the current one */
+    if (GST_CLOCK_TIME_IS_VALID (start) &&
+        GST_CLOCK_TIME_IS_VALID (running_time) && start > running_time)
+      return TRUE;
+
+    buffer = gst_collect_pads_pop (pads, data);
+
+    /* Inputs are dropped until they renegotiated to the output caps */
+    if (blend->datab->mismatch) {
+      gst_buffer_unref (buffer);
+      continue;
+    }
+
+    clear_current_b (blend);
+    blend->current_b = buffer;
+    if (GST_CLOCK_TIME_IS_VALID (start) &&
+        GST_BUFFER_DURATION_IS_VALID (buffer))
+      blend->current_b_end = start + GST_BUFFER_DURATION (buffer);
+
+    if (!GST_CLOCK_TIME_IS_VALID (start) ||
+        !GST_CLOCK_TIME_IS_VALID (running_time))
+      return TRUE;
+  }
+
+  if (GST_COLLECT_PADS_STATE_IS_SET (data, GST_COLLECT_PADS_STATE_EOS))
+    return TRUE;
+
+  /* Wait for the next frame unless the current one covers @running_time */
+  return blend->current_b && GST_CLOCK_TIME_IS_VALID (blend->current_b_end) &&
+      blend->current_b_end > running_time;
+}
+
+static GstFlowReturn
+ges_video_blend_collected (GstCollectPads * pads, GESVideoBlend * blend)
+{
+  GstBuffer *bufa, *bufb = NULL, *outbuf;
+  GstCollectData *data;
+  GstClockTime stream_time, running_time;
+  GstCaps *caps = NULL;
+  gdouble position;
+
+  bufa = gst_collect_pads_peek (pads, (GstCollectData *) blend->dataa);
+
+  if (bufa == NULL) {
+    /* Output what is left of the second input */
+    clear_current_b (blend);
+    bufb = gst_collect_pads_pop (pads, (GstCollectData *) blend->datab);
+
+    if (bufb == NULL) {
+      GST_DEBUG_OBJECT (blend, "All inputs are EOS");
+      gst_pad_push_event (blend->srcpad, gst_event_new_eos ());
+
+      return GST_FLOW_EOS;
+    }
+
+    if (blend->datab->mismatch) {
+      gst_buffer_unref (bufb);
+
+      return GST_FLOW_OK;
+    }
+
+    data = (GstCollectData *) blend->datab;
+  } else {
+    running_time = get_running_time ((GstCollectData *) blend->dataa, bufa);
+    gst_buffer_unref (bufa);
+
+    if (!blend->dataa->mismatch &&
+        !update_current_b (blend, pads, running_time)) {
+      GST_LOG_OBJECT (blend, "Waiting for the second input to reach %"
+          GST_TIME_FORMAT, GST_TIME_ARGS (running_time));
+
+      return GST_FLOW_OK;
+    }
+
+    bufa = gst_collect_pads_pop (pads, (GstCollectData *) blend->dataa);
+
+    /* Inputs are dropped until they renegotiated to the output caps */
+    if (blend->dataa->mismatch) {
+      gst_buffer_unref (bufa);
+
+      return GST_FLOW_OK;
+    }
+
+    /* Blend with the current frame of the second input unless it ended */
+    if (blend->current_b && (!GST_CLOCK_TIME_IS_VALID (running_time) ||
+            !GST_CLOCK_TIME_IS_VALID (blend->current_b_end) ||
+            blend->current_b_end > running_time))
+      bufb = gst_buffer_ref (blend->current_b);
+
+    data = (GstCollectData *) blend->dataa;
+  }
+
+  GST_OBJECT_LOCK (blend);
+  if (blend->send_caps) {
+    caps = gst_caps_ref (blend->caps);
+    blend->send_caps = FALSE;
+  }
+  GST_OBJECT_UNLOCK (blend);
+
+  if (caps) {
+    free_columns (blend);
+    gst_pad_push_event (blend->srcpad, gst_event_new_caps (caps));
+    gst_caps_unref (caps);
+  }
+
+  if (blend->send_segment) {
+    gst_pad_push_event (blend->srcpad, gst_event_new_segment (&data->segment));
+    blend->send_segment = FALSE;
+  }
+
+  stream_time = gst_segment_to_stream_time (&data->segment, GST_FORMAT_TIME,
+      GST_BUFFER_TIMESTAMP (bufa ? bufa : bufb));
+  if (GST_CLOCK_TIME_IS_VALID (stream_time))
+    gst_object_sync_values (GST_OBJECT (blend), stream_time);
+
+  GST_OBJECT_LOCK (blend);
+  position = blend->position;
+  GST_OBJECT_UNLOCK (blend);
+
+  if (bufa == NULL)
+    outbuf = bufb;
+  else if (bufb == NULL)
+    outbuf = bufa;
+  else
+    outbuf = blend_buffers (blend, bufa, bufb, position);
+
+  return gst_pad_push (blend->srcpad, outbuf);
+}
+
+static GstStateChangeReturn
+ges_video_blend_change_state (GstElement * element, GstStateChange transition)
+{
+  GESVideoBlend *blend = GES_VIDEO_BLEND (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      reset (blend);
+      gst_collect_pads_start (blend->collect);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* Unblock the streaming threads before chaining up */
+      gst_collect_pads_stop (blend->collect);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (ges_video_blend_parent_class)->change_state (element,
+      transition);
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+    reset (blend);
+
+  return ret;
+}
+
+static void
+ges_video_blend_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GESVideoBlend *blend = GES_VIDEO_BLEND (object);
+
+  GST_OBJECT_LOCK (blend);
+  switch (property_id) {
+    case PROP_POSITION:
+      g_value_set_double (value, blend->position);
+      break;
+    case PROP_TRANSITION_TYPE:
+      g_value_set_enum (value, blend->type);
+      break;
+    case PROP_BORDER:
+      g_value_set_uint (value, blend->border);
+      break;
+    case PROP_INVERT:
+      g_value_set_boolean (value, blend->invert);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+  GST_OBJECT_UNLOCK (blend);
+}
+
+static void
+ges_video_blend_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GESVideoBlend *blend = GES_VIDEO_BLEND (object);
+
+  GST_OBJECT_LOCK (blend);
+  switch (property_id) {
+    case PROP_POSITION:
+      blend->position = g_value_get_double (value);
+      break;
+    case PROP_TRANSITION_TYPE:
+      blend->type = g_value_get_enum (value);
+      break;
+    case PROP_BORDER:
+      blend->border = g_value_get_uint (value);
+      break;
+    case PROP_INVERT:
+      blend->invert = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+  GST_OBJECT_UNLOCK (blend);
+}
+
+static void
+ges_video_blend_finalize (GObject * object)
+{
+  GESVideoBlend *blend = GES_VIDEO_BLEND (object);
+
+  gst_caps_replace (&blend->caps, NULL);
+  if (blend->mask)
+    ges_smpte_mask_unref (blend->mask);
+  free_columns (blend);
+  clear_current_b (blend);
+  gst_object_unref (blend->collect);
+
+  G_OBJECT_CLASS (ges_video_blend_parent_class)->finalize (object);
+}
+
+static void
+ges_video_blend_class_init (GESVideoBlendClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  object_class->get_property = ges_video_blend_get_property;
+  object_class->set_property = ges_video_blend_set_property;
+  object_class->finalize = ges_video_blend_finalize;
+
+  g_object_class_install_property (object_class, PROP_POSITION,
+      g_param_spec_double ("position", "Position",
+          "Position of the transition, from the first input (0) to the "
+          "second one (1)", 0.0, 1.0, 0.0,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE |
+          G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (object_class, PROP_TRANSITION_TYPE,
+      g_param_spec_enum ("transition-type", "Transition type",
+          "The type of the transition", GES_VIDEO_STANDARD_TRANSITION_TYPE_TYPE,
+          GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (object_class, PROP_BORDER,
+      g_param_spec_uint ("border", "Border",
+          "Width of the soft border of wipes", 0, G_MAXUINT, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (object_class, PROP_INVERT,
+      g_param_spec_boolean ("invert", "Invert",
+          "Whether wipes are played backwards", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  element_class->change_state = ges_video_blend_change_state;
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&src_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_a_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_b_template));
+
+  gst_element_class_set_metadata (element_class,
+      "GES video transition blender", "Filter/Editor/Video",
+      "Blends two video streams in a single pass",
+      "GStreamer Editing Services");
+}
+
+static void
+ges_video_blend_init (GESVideoBlend * blend)
+{
+  blend->position = 0.0;
+  blend->type = GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE;
+  blend->border = 0;
+  blend->invert = FALSE;
+  gst_video_info_init (&blend->info);
+  blend->current_b_end = GST_CLOCK_TIME_NONE;
+
+  blend->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_set_event_function (blend->srcpad, ges_video_blend_src_event);
+  gst_pad_set_query_function (blend->srcpad, ges_video_blend_src_query);
+  gst_element_add_pad (GST_ELEMENT (blend), blend->srcpad);
+
+  blend->sinka = gst_pad_new_from_static_template (&sink_a_template, "sink_a");
+  blend->sinkb = gst_pad_new_from_static_template (&sink_b_template, "sink_b");
+
+  blend->collect = gst_collect_pads_new ();
+  gst_collect_pads_set_function (blend->collect,
+      (GstCollectPadsFunction) ges_video_blend_collected, blend);
+  gst_collect_pads_set_event_function (blend->collect,
+      (GstCollectPadsEventFunction) ges_video_blend_sink_event, blend);
+
+  blend->dataa = (GESVideoBlendData *) gst_collect_pads_add_pad (blend->collect,
+      blend->sinka, sizeof (GESVideoBlendData), NULL, TRUE);
+  blend->datab = (GESVideoBlendData *) gst_collect_pads_add_pad (blend->collect,
+      blend->sinkb, sizeof (GESVideoBlendData), NULL, TRUE);
+
+  gst_pad_set_query_function (blend->sinka, ges_video_blend_sink_query);
+  gst_pad_set_query_function (blend->sinkb, ges_video_blend_sink_query);
+
+  gst_element_add_pad (GST_ELEMENT (blend), blend->sinka);
+  gst_element_add_pad (GST_ELEMENT (blend), blend->sinkb);
+}
@@ -70,6 +70,12 @@ ges_init (void)
   GES_TYPE_TIMELINE_STANDARD_TRANSITION;
   GES_TYPE_TIMELINE_OVERLAY;
 
+  /* internal elements */
+  gst_element_register (NULL, "gesvideoblend", GST_RANK_NONE,
+      GES_TYPE_VIDEO_BLEND);
+  gst_element_register (NULL, "gesaudiocrossfade", GST_RANK_NONE,
+      GES_TYPE_AUDIO_CROSSFADE);
+
   /* check the gnonlin elements are available */
   if (!ges_check_gnonlin_availability ())
     return FALSE;
@@ -31,6 +31,7 @@
 #include <ges/ges-simple-timeline-layer.h>
 #include <ges/ges-timeline-object.h>
 #include <ges/ges-timeline-pipeline.h>
+#include <ges/ges-parallel-render.h>
 #include <ges/ges-timeline-source.h>
 #include <ges/ges-timeline-test-source.h>
 #include <ges/ges-timeline-title-source.h>
@@ -64,6 +65,7 @@
 #include <ges/ges-track-parse-launch-effect.h>
 #include <ges/ges-formatter.h>
 #include <ges/ges-keyfile-formatter.h>
+#include <ges/ges-binary-formatter.h>
 #include <ges/ges-pitivi-formatter.h>
 #include <ges/ges-utils.h>
 #include <ges/ges-metadata-container.h>
@@ -0,0 +1,108 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the cost of moving an object around a big timeline with
+ * snapping enabled */
+
+#include <stdlib.h>
+#include <ges/ges.h>
+
+static gboolean
+fill_track_func (GESTimelineObject * object,
+    GESTrackObject * trobject, GstElement * gnlobj, gpointer user_data)
+{
+  return gst_bin_add (GST_BIN (gnlobj),
+      gst_element_factory_make ("fakesrc", NULL));
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GError *err = NULL;
+  GOptionContext *ctx;
+  GESTimeline *timeline;
+  GESTrack *track;
+  GESTimelineLayer *layer;
+  GESTimelineObject *obj, *moving = NULL;
+  GList *objects = NULL;
+  GstClockTime start, end, position;
+  guint i;
+
+  gint nb_objects = 20000, nb_moves = 1000;
+  GOptionEntry options[] = {
+    {"objects", 'n', 0, G_OPTION_ARG_INT, &nb_objects,
+        "Number of objects in the timeline (default:20000)", "N"},
+    {"moves", 'm', 0, G_OPTION_ARG_INT, &nb_moves,
+        "Number of moves to do (default:1000)", "N"},
+    {NULL}
+  };
+
+  ctx = g_option_context_new ("- Benchmark snapping while moving objects");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_print ("Error initializing %s\n", err->message);
+    exit (1);
+  }
+  g_option_context_free (ctx);
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, gst_caps_new_any ());
+  ges_timeline_add_track (timeline, track);
+  layer = ges_timeline_append_layer (timeline);
+
+  /* Objects are 10 units long and separated by 5 units gaps, so that there is
+   * always an edge close to where we move */
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < nb_objects; i++) {
+    obj = GES_TIMELINE_OBJECT (ges_custom_timeline_source_new (fill_track_func,
+            NULL));
+    g_object_set (obj, "start", (guint64) i * 15, "duration", (guint64) 10,
+        NULL);
+    objects = g_list_prepend (objects, obj);
+
+    if (i == nb_objects / 2)
+      moving = obj;
+  }
+  ges_timeline_layer_add_objects (layer, objects);
+  end = gst_util_get_timestamp ();
+  g_print ("%d objects added in %" GST_TIME_FORMAT "\n", nb_objects,
+      GST_TIME_ARGS (end - start));
+
+  g_object_set (timeline, "snapping-distance", (guint64) 3, NULL);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < nb_moves; i++) {
+    position = g_random_int_range (0, nb_objects * 15);
+
+    ges_timeline_object_edit (moving, NULL, -1, GES_EDIT_MODE_NORMAL,
+        GES_EDGE_NONE, position);
+  }
+  end = gst_util_get_timestamp ();
+
+  g_print ("%d moves in %" GST_TIME_FORMAT " (%" GST_TIME_FORMAT
+      " per move)\n", nb_moves, GST_TIME_ARGS (end - start),
+      GST_TIME_ARGS ((end - start) / MAX (nb_moves, 1)));
+
+  gst_object_unref (timeline);
+
+  return 0;
+}
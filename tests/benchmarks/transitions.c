@@ -0,0 +1,137 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the frame rate of video transitions, comparing the videomixer
+ * based graph GESTrackVideoTransition used to build with the current one */
+
+#include <stdlib.h>
+#include <ges/ges.h>
+
+#define SOURCE "videotestsrc num-buffers=%d pattern=%s ! " \
+    "video/x-raw,format=I420,width=%d,height=%d,framerate=25/1 ! "
+
+static gdouble
+run (const gchar * description, gint nb_frames)
+{
+  GError *err = NULL;
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *message;
+  GstClockTime start, end;
+
+  pipeline = gst_parse_launch (description, &err);
+  if (pipeline == NULL) {
+    g_print ("Could not create pipeline: %s\n", err->message);
+    exit (1);
+  }
+
+  bus = gst_element_get_bus (pipeline);
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = gst_util_get_timestamp ();
+
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR) {
+    g_print ("Error while running %s\n", description);
+    exit (1);
+  }
+
+  gst_message_unref (message);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return (gdouble) nb_frames * GST_SECOND / (end - start);
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GError *err = NULL;
+  GOptionContext *ctx;
+  gchar *source_a, *source_b, *description;
+  gdouble before, after;
+
+  gint nb_frames = 250, width = 1920, height = 1080, type =
+      GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE;
+  GOptionEntry options[] = {
+    {"frames", 'n', 0, G_OPTION_ARG_INT, &nb_frames,
+        "Number of frames to blend (default:250)", "N"},
+    {"width", 'w', 0, G_OPTION_ARG_INT, &width,
+        "Width of the frames (default:1920)", "W"},
+    {"height", 'h', 0, G_OPTION_ARG_INT, &height,
+        "Height of the frames (default:1080)", "H"},
+    {"type", 't', 0, G_OPTION_ARG_INT, &type,
+        "The GESVideoStandardTransitionType to use (default:512, crossfade)",
+        "T"},
+    {NULL}
+  };
+
+  ctx = g_option_context_new ("- Benchmark video transitions");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_print ("Error initializing %s\n", err->message);
+    exit (1);
+  }
+  g_option_context_free (ctx);
+
+  ges_init ();
+
+  source_a = g_strdup_printf (SOURCE, nb_frames, "black", width, height);
+  source_b = g_strdup_printf (SOURCE, nb_frames, "white", width, height);
+
+  /* The graph from before: converters on each input, a capsfilter, a
+   * videomixer painting a background and an output converter */
+  if (type == GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE) {
+    description = g_strdup_printf ("%s videoconvert ! videoscale ! "
+        "videomixer name=mixer background=black sink_1::alpha=0.5 ! "
+        "videoconvert ! fakesink sync=false "
+        "%s videoconvert ! videoscale ! "
+        "capsfilter caps=video/x-raw,width=%d,height=%d ! mixer.",
+        source_a, source_b, width, height);
+  } else {
+    description = g_strdup_printf ("%s videoconvert ! "
+        "smptealpha type=%d invert=true position=0.5 ! "
+        "videomixer name=mixer background=black ! "
+        "videoconvert ! fakesink sync=false "
+        "%s videoconvert ! smptealpha type=%d invert=true position=0.5 ! "
+        "mixer.", source_a, type, source_b, type);
+  }
+  before = run (description, nb_frames);
+  g_free (description);
+
+  description = g_strdup_printf ("%s videoconvert ! videoscale ! "
+      "gesvideoblend name=blend transition-type=%d position=0.5 ! "
+      "fakesink sync=false "
+      "%s videoconvert ! videoscale ! blend.sink_b",
+      source_a, type, source_b);
+  after = run (description, nb_frames);
+  g_free (description);
+
+  g_print ("%dx%d, type %d: videomixer %.1f fps, gesvideoblend %.1f fps\n",
+      width, height, type, before, after);
+
+  g_free (source_a);
+  g_free (source_b);
+
+  return 0;
+}
@@ -332,6 +332,203 @@ GST_START_TEST (test_gap_filling_basic)
 
 GST_END_TEST;
 
+GST_START_TEST (test_gap_filling_reuse)
+{
+  GESTrack *track;
+  GESTrackObject *trackobject, *trackobject1;
+  GESTimelineObject *object, *object1;
+  GstElement *gnlsrc, *gnlsrc1, *gap = NULL;
+  GstElement *composition;
+  guint pool_size, hits, misses;
+  GList *tmp;
+
+  ges_init ();
+
+  track = ges_track_audio_raw_new ();
+  fail_unless (track != NULL);
+
+  composition = find_composition (track);
+  fail_unless (composition != NULL);
+
+  object = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object, "start", (guint64) 0, "duration", (guint64) 5, NULL);
+  trackobject = ges_timeline_object_create_track_object (object, track);
+  ges_timeline_object_add_track_object (object, trackobject);
+  fail_unless (ges_track_add_object (track, trackobject));
+  gnlsrc = ges_track_object_get_gnlobject (trackobject);
+
+  object1 = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object1, "start", (guint64) 15, "duration", (guint64) 5, NULL);
+  trackobject1 = ges_timeline_object_create_track_object (object1, track);
+  ges_timeline_object_add_track_object (object1, trackobject1);
+  fail_unless (ges_track_add_object (track, trackobject1));
+  gnlsrc1 = ges_track_object_get_gnlobject (trackobject1);
+
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  for (tmp = GST_BIN_CHILDREN (composition); tmp; tmp = tmp->next) {
+    if (tmp->data != gnlsrc && tmp->data != gnlsrc1)
+      gap = GST_ELEMENT (tmp->data);
+  }
+  fail_unless (gap != NULL);
+  gap_object_check (gap, 5, 10, 0);
+
+  /* Moving an object only re-times the existing gap */
+  ges_timeline_object_set_start (object1, 25);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  fail_unless (g_list_find (GST_BIN_CHILDREN (composition), gap) != NULL);
+  gap_object_check (gap, 5, 20, 0);
+
+  ges_timeline_object_set_start (object, 10);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 4);
+  fail_unless (g_list_find (GST_BIN_CHILDREN (composition), gap) != NULL);
+  gap_object_check (gap, 0, 10, 0);
+
+  /* Closing the gaps removes the elements */
+  ges_timeline_object_set_start (object, 0);
+  ges_timeline_object_set_start (object1, 5);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 2);
+
+  /* The removed gap elements are pooled and reused */
+  g_object_get (track, "gap-pool-size", &pool_size, "gap-pool-hits", &hits,
+      "gap-pool-misses", &misses, NULL);
+  assert_equals_int (pool_size, 2);
+  assert_equals_int (hits, 0);
+  assert_equals_int (misses, 2);
+
+  ges_timeline_object_set_start (object1, 15);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  g_object_get (track, "gap-pool-size", &pool_size, "gap-pool-hits", &hits,
+      "gap-pool-misses", &misses, NULL);
+  assert_equals_int (pool_size, 1);
+  assert_equals_int (hits, 1);
+  assert_equals_int (misses, 2);
+
+  g_object_set (track, "gap-pool-max-size", 0, NULL);
+  g_object_get (track, "gap-pool-size", &pool_size, NULL);
+  assert_equals_int (pool_size, 0);
+
+  gst_object_unref (track);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_lazy_elements)
+{
+  GESTrack *track;
+  GESTrackObject *trackobject, *trackobject1;
+  GESTimelineObject *object, *object1;
+
+  ges_init ();
+
+  track = ges_track_audio_raw_new ();
+  fail_unless (track != NULL);
+  g_object_set (track, "lazy-elements", TRUE, NULL);
+
+  object = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object, "start", (guint64) 0, "duration", (guint64) 5, NULL);
+  trackobject = ges_timeline_object_create_track_object (object, track);
+  ges_timeline_object_add_track_object (object, trackobject);
+  fail_unless (ges_track_add_object (track, trackobject));
+
+  object1 = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object1, "start", (guint64) 15, "duration", (guint64) 5, NULL);
+  trackobject1 = ges_timeline_object_create_track_object (object1, track);
+  ges_timeline_object_add_track_object (object1, trackobject1);
+  fail_unless (ges_track_add_object (track, trackobject1));
+
+  /* Everything is created until a window is set */
+  fail_unless (ges_track_object_get_gnlobject (trackobject) != NULL);
+  fail_unless (ges_track_object_get_element (trackobject) != NULL);
+  fail_unless (ges_track_object_get_element (trackobject1) != NULL);
+
+  ges_track_set_materialization_window (track, 0, 10);
+  fail_unless (ges_track_object_get_element (trackobject) != NULL);
+  fail_unless (ges_track_object_get_element (trackobject1) == NULL);
+
+  ges_track_set_materialization_window (track, 12, 20);
+  fail_unless (ges_track_object_get_element (trackobject) == NULL);
+  fail_unless (ges_track_object_get_element (trackobject1) != NULL);
+
+  /* Moving an object into the window creates its element */
+  ges_timeline_object_set_start (object, 10);
+  fail_unless (ges_track_object_get_element (trackobject) != NULL);
+
+  /* Going back to the default window materializes everything again */
+  ges_track_set_materialization_window (track, 0, GST_CLOCK_TIME_NONE);
+  fail_unless (ges_track_object_get_element (trackobject) != NULL);
+  fail_unless (ges_track_object_get_element (trackobject1) != NULL);
+
+  /* An object starting long before the window still intersects it */
+  g_object_set (object, "start", (guint64) 0, "duration", (guint64) 100, NULL);
+  ges_track_set_materialization_window (track, 90, 95);
+  fail_unless (ges_track_object_get_element (trackobject) != NULL);
+  fail_unless (ges_track_object_get_element (trackobject1) == NULL);
+
+  ges_track_set_materialization_window (track, 100, 110);
+  fail_unless (ges_track_object_get_element (trackobject) == NULL);
+  fail_unless (ges_track_object_get_element (trackobject1) == NULL);
+
+  gst_object_unref (track);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_lazy_elements_pipeline)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelinePipeline *pipeline;
+  GESTrack *track;
+  GESTimelineObject *object, *object1;
+  GESTrackObject *trackobject, *trackobject1;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  track = ges_track_audio_raw_new ();
+  g_object_set (track, "lazy-elements", TRUE, NULL);
+  fail_unless (ges_timeline_add_track (timeline, track));
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  object = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object, "start", (guint64) 0, "duration", GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+  object1 = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object1, "start", 60 * GST_SECOND, "duration", GST_SECOND,
+      NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object1));
+
+  trackobject = ges_timeline_object_find_track_object (object, track,
+      GES_TYPE_TRACK_AUDIO_TEST_SOURCE);
+  trackobject1 = ges_timeline_object_find_track_object (object1, track,
+      GES_TYPE_TRACK_AUDIO_TEST_SOURCE);
+  fail_unless (trackobject != NULL);
+  fail_unless (trackobject1 != NULL);
+
+  pipeline = ges_timeline_pipeline_new ();
+  fail_unless (ges_timeline_pipeline_add_timeline (pipeline, timeline));
+
+  /* Seeking moves the window to the seek target */
+  gst_element_send_event (GST_ELEMENT (pipeline),
+      gst_event_new_seek (1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH,
+          GST_SEEK_TYPE_SET, 60 * GST_SECOND, GST_SEEK_TYPE_NONE, -1));
+  fail_unless (ges_track_object_get_element (trackobject) == NULL);
+  fail_unless (ges_track_object_get_element (trackobject1) != NULL);
+
+  gst_element_send_event (GST_ELEMENT (pipeline),
+      gst_event_new_seek (1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH,
+          GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_NONE, -1));
+  fail_unless (ges_track_object_get_element (trackobject) != NULL);
+  fail_unless (ges_track_object_get_element (trackobject1) == NULL);
+
+  g_object_unref (trackobject);
+  g_object_unref (trackobject1);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -344,6 +541,9 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_test_source_properties);
   tcase_add_test (tc_chain, test_test_source_in_layer);
   tcase_add_test (tc_chain, test_gap_filling_basic);
+  tcase_add_test (tc_chain, test_gap_filling_reuse);
+  tcase_add_test (tc_chain, test_lazy_elements);
+  tcase_add_test (tc_chain, test_lazy_elements_pipeline);
 
   return s;
 }
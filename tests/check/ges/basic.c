@@ -19,6 +19,7 @@
 
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
+#include <gst/pbutils/pbutils.h>
 
 GST_START_TEST (test_ges_init)
 {
@@ -568,6 +569,379 @@ GST_START_TEST (test_ges_timeline_remove_track)
 
 GST_END_TEST;
 
+GST_START_TEST (test_ges_parallel_render_split)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer, *layer1;
+  GESTimelineTestSource *a, *b, *c, *d;
+  GstClockTime *boundaries;
+  guint n;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  layer1 = ges_timeline_layer_new ();
+  ges_timeline_layer_set_priority (layer1, 1);
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  fail_unless (ges_timeline_add_layer (timeline, layer1));
+
+  a = ges_timeline_test_source_new ();
+  b = ges_timeline_test_source_new ();
+  c = ges_timeline_test_source_new ();
+  d = ges_timeline_test_source_new ();
+  g_object_set (a, "start", (guint64) 0, "duration", (guint64) 10, NULL);
+  g_object_set (b, "start", (guint64) 10, "duration", (guint64) 10, NULL);
+  g_object_set (c, "start", (guint64) 15, "duration", (guint64) 15, NULL);
+  g_object_set (d, "start", (guint64) 30, "duration", (guint64) 10, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (a)));
+  fail_unless (ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (b)));
+  fail_unless (ges_timeline_layer_add_object (layer1,
+          GES_TIMELINE_OBJECT (c)));
+  fail_unless (ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (d)));
+
+  /* c is playing across 20, the closest cut is 30 */
+  n = ges_parallel_render_split (timeline, 4, &boundaries);
+  assert_equals_int (n, 3);
+  assert_equals_uint64 (boundaries[0], 0);
+  assert_equals_uint64 (boundaries[1], 10);
+  assert_equals_uint64 (boundaries[2], 30);
+  assert_equals_uint64 (boundaries[3], 40);
+  g_free (boundaries);
+
+  n = ges_parallel_render_split (timeline, 1, &boundaries);
+  assert_equals_int (n, 1);
+  assert_equals_uint64 (boundaries[0], 0);
+  assert_equals_uint64 (boundaries[1], 40);
+  g_free (boundaries);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+/* Theora and Vorbis in the @format container */
+static GstEncodingProfile *
+create_profile (const gchar * format)
+{
+  GstEncodingContainerProfile *profile;
+  GstCaps *caps;
+
+  caps = gst_caps_from_string (format);
+  profile = gst_encoding_container_profile_new (NULL, NULL, caps, NULL);
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("video/x-theora");
+  gst_encoding_container_profile_add_profile (profile,
+      (GstEncodingProfile *) gst_encoding_video_profile_new (caps, NULL,
+          NULL, 0));
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("audio/x-vorbis");
+  gst_encoding_container_profile_add_profile (profile,
+      (GstEncodingProfile *) gst_encoding_audio_profile_new (caps, NULL,
+          NULL, 0));
+  gst_caps_unref (caps);
+
+  return (GstEncodingProfile *) profile;
+}
+
+/* Renders a timeline ending its first range with a gap in 2 jobs to a
+ * @format file */
+static void
+parallel_render_gap (const gchar * format, const gchar * filename)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineTestSource *a, *b;
+  GstEncodingProfile *profile;
+  GstDiscoverer *discoverer;
+  GstDiscovererInfo *info;
+  GstClockTime *boundaries, duration;
+  gchar *path, *project_uri, *output_uri;
+  guint n;
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+
+  /* The first range ends with the gap between a and b */
+  a = ges_timeline_test_source_new ();
+  b = ges_timeline_test_source_new ();
+  g_object_set (a, "start", (guint64) 0, "duration", GST_SECOND, NULL);
+  g_object_set (b, "start", 2 * GST_SECOND, "duration", GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (a)));
+  fail_unless (ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (b)));
+
+  n = ges_parallel_render_split (timeline, 2, &boundaries);
+  assert_equals_int (n, 2);
+  assert_equals_uint64 (boundaries[1], 2 * GST_SECOND);
+  g_free (boundaries);
+
+  path = g_build_filename (g_get_tmp_dir (), "test-parallel-render.xptv",
+      NULL);
+  project_uri = gst_filename_to_uri (path, NULL);
+  g_free (path);
+  path = g_build_filename (g_get_tmp_dir (), filename, NULL);
+  output_uri = gst_filename_to_uri (path, NULL);
+  g_free (path);
+
+  fail_unless (ges_timeline_save_to_uri (timeline, project_uri));
+  g_object_unref (timeline);
+
+  profile = create_profile (format);
+  fail_unless (ges_parallel_render (project_uri, output_uri, profile, 2));
+  gst_encoding_profile_unref (profile);
+
+  /* Both chunks last as long as their range, gap included, and the second
+   * one follows the first one in the remuxed streams */
+  discoverer = gst_discoverer_new (10 * GST_SECOND, NULL);
+  info = gst_discoverer_discover_uri (discoverer, output_uri, NULL);
+  fail_unless (info != NULL);
+  duration = gst_discoverer_info_get_duration (info);
+  fail_unless (duration > 3 * GST_SECOND - GST_SECOND / 4 &&
+      duration < 3 * GST_SECOND + GST_SECOND / 4,
+      "Rendered %" GST_TIME_FORMAT " instead of 3 seconds",
+      GST_TIME_ARGS (duration));
+  gst_discoverer_info_unref (info);
+  g_object_unref (discoverer);
+
+  /* The chunks of other containers can not be joined, several jobs are
+   * refused instead of silently rendering in one */
+  profile = create_profile ("video/x-msvideo");
+  fail_if (ges_parallel_render (project_uri, output_uri, profile, 2));
+  gst_encoding_profile_unref (profile);
+
+  g_free (project_uri);
+  g_free (output_uri);
+}
+
+static gboolean
+have_features (const gchar * first, ...)
+{
+  va_list args;
+  const gchar *name;
+  gboolean ret = TRUE;
+
+  va_start (args, first);
+  for (name = first; name && ret; name = va_arg (args, const gchar *))
+    ret = gst_registry_check_feature_version (gst_registry_get (), name,
+        GST_VERSION_MAJOR, GST_VERSION_MINOR, 0);
+  va_end (args);
+
+  return ret;
+}
+
+GST_START_TEST (test_ges_parallel_render_gap)
+{
+  ges_init ();
+
+  if (!have_features ("theoraenc", "vorbisenc", NULL)) {
+    GST_WARNING ("Missing encoders, skipping");
+    return;
+  }
+
+  parallel_render_gap ("application/ogg", "test-parallel-render.ogg");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_parallel_render_matroska)
+{
+  ges_init ();
+
+  if (!have_features ("theoraenc", "vorbisenc", "matroskamux",
+          "matroskademux", NULL)) {
+    GST_WARNING ("Missing elements, skipping");
+    return;
+  }
+
+  parallel_render_gap ("video/x-matroska", "test-parallel-render.mkv");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_pipeline_mode_switch)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineTestSource *source;
+  GESTimelinePipeline *pipeline;
+  GstElement *sink;
+  GstEncodingProfile *profile;
+  GstDiscoverer *discoverer;
+  GstDiscovererInfo *info;
+  GstClockTime duration;
+  GstBus *bus;
+  GstMessage *message;
+  gchar *path, *output_uri;
+
+  ges_init ();
+
+  if (!gst_registry_check_feature_version (gst_registry_get (), "theoraenc",
+          GST_VERSION_MAJOR, GST_VERSION_MINOR, 0) ||
+      !gst_registry_check_feature_version (gst_registry_get (), "vorbisenc",
+          GST_VERSION_MAJOR, GST_VERSION_MINOR, 0)) {
+    GST_WARNING ("Missing encoders, skipping");
+    return;
+  }
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  source = ges_timeline_test_source_new ();
+  g_object_set (source, "duration", 2 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (source)));
+
+  path = g_build_filename (g_get_tmp_dir (), "test-mode-switch.ogg", NULL);
+  output_uri = gst_filename_to_uri (path, NULL);
+  g_free (path);
+
+  pipeline = ges_timeline_pipeline_new ();
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+  ges_timeline_pipeline_preview_set_video_sink (pipeline, sink);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+  ges_timeline_pipeline_preview_set_audio_sink (pipeline, sink);
+  fail_unless (ges_timeline_pipeline_add_timeline (pipeline, timeline));
+
+  profile = create_profile ("application/ogg");
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline,
+          output_uri, profile));
+  gst_encoding_profile_unref (profile);
+
+  /* Preroll the preview in the middle of the timeline */
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+  fail_if (gst_element_get_state (GST_ELEMENT (pipeline), NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE);
+  fail_unless (gst_element_seek_simple (GST_ELEMENT (pipeline),
+          GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH, GST_SECOND));
+  fail_if (gst_element_get_state (GST_ELEMENT (pipeline), NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE);
+
+  /* The prerolled preview sinks are removed while paused, and the render
+   * starts from the beginning of the timeline */
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline, TIMELINE_MODE_RENDER));
+  fail_if (gst_element_get_state (GST_ELEMENT (pipeline), NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  discoverer = gst_discoverer_new (10 * GST_SECOND, NULL);
+  info = gst_discoverer_discover_uri (discoverer, output_uri, NULL);
+  fail_unless (info != NULL);
+  duration = gst_discoverer_info_get_duration (info);
+  fail_unless (duration > 2 * GST_SECOND - GST_SECOND / 4 &&
+      duration < 2 * GST_SECOND + GST_SECOND / 4,
+      "Rendered %" GST_TIME_FORMAT " instead of 2 seconds",
+      GST_TIME_ARGS (duration));
+  gst_discoverer_info_unref (info);
+  g_object_unref (discoverer);
+
+  g_free (output_uri);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GArray *timestamps;
+  guint max;
+} Thumbnails;
+
+static gboolean
+thumbnail_cb (GESTimelinePipeline * pipeline, GstClockTime timestamp,
+    GstSample * sample, Thumbnails * thumbnails)
+{
+  GstStructure *structure;
+  gint width = 0;
+
+  structure = gst_caps_get_structure (gst_sample_get_caps (sample), 0);
+  fail_unless (gst_structure_get_int (structure, "width", &width));
+  assert_equals_int (width, 32);
+  fail_unless (gst_sample_get_buffer (sample) != NULL);
+
+  g_array_append_val (thumbnails->timestamps, timestamp);
+
+  return thumbnails->timestamps->len < thumbnails->max;
+}
+
+GST_START_TEST (test_ges_pipeline_thumbnails)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineTestSource *source;
+  GESTimelinePipeline *pipeline;
+  GstCaps *caps;
+  Thumbnails thumbnails;
+  GstClockTime timestamps[] = { 3 * GST_SECOND / 2, GST_SECOND / 2,
+    GST_SECOND
+  };
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  source = ges_timeline_test_source_new ();
+  g_object_set (source, "duration", 2 * GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (source)));
+
+  pipeline = ges_timeline_pipeline_new ();
+  fail_unless (ges_timeline_pipeline_add_timeline (pipeline, timeline));
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_THUMBNAIL));
+
+  caps = gst_caps_from_string ("video/x-raw,format=RGB,width=32,height=24");
+  thumbnails.timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  /* Generated in increasing timestamp order */
+  thumbnails.max = G_MAXUINT;
+  fail_unless (ges_timeline_pipeline_generate_thumbnails (pipeline, caps,
+          timestamps, G_N_ELEMENTS (timestamps), TRUE,
+          (GESTimelinePipelineThumbnailFunc) thumbnail_cb, &thumbnails));
+  assert_equals_int (thumbnails.timestamps->len, 3);
+  assert_equals_uint64 (g_array_index (thumbnails.timestamps, GstClockTime,
+          0), GST_SECOND / 2);
+  assert_equals_uint64 (g_array_index (thumbnails.timestamps, GstClockTime,
+          1), GST_SECOND);
+  assert_equals_uint64 (g_array_index (thumbnails.timestamps, GstClockTime,
+          2), 3 * GST_SECOND / 2);
+
+  /* Stopped by the callback */
+  g_array_set_size (thumbnails.timestamps, 0);
+  thumbnails.max = 1;
+  fail_if (ges_timeline_pipeline_generate_thumbnails (pipeline, caps,
+          timestamps, G_N_ELEMENTS (timestamps), FALSE,
+          (GESTimelinePipelineThumbnailFunc) thumbnail_cb, &thumbnails));
+  assert_equals_int (thumbnails.timestamps->len, 1);
+
+  /* Nothing to generate */
+  g_array_set_size (thumbnails.timestamps, 0);
+  fail_unless (ges_timeline_pipeline_generate_thumbnails (pipeline, caps,
+          NULL, 0, TRUE, (GESTimelinePipelineThumbnailFunc) thumbnail_cb,
+          &thumbnails));
+  assert_equals_int (thumbnails.timestamps->len, 0);
+
+  g_array_free (thumbnails.timestamps, TRUE);
+  gst_caps_unref (caps);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -581,6 +955,11 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_ges_timeline_add_layer);
   tcase_add_test (tc_chain, test_ges_timeline_add_layer_first);
   tcase_add_test (tc_chain, test_ges_timeline_remove_track);
+  tcase_add_test (tc_chain, test_ges_parallel_render_split);
+  tcase_add_test (tc_chain, test_ges_parallel_render_gap);
+  tcase_add_test (tc_chain, test_ges_parallel_render_matroska);
+  tcase_add_test (tc_chain, test_ges_pipeline_mode_switch);
+  tcase_add_test (tc_chain, test_ges_pipeline_thumbnails);
 
   return s;
 }
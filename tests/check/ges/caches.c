@@ -0,0 +1,229 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Tests of the internal caches of the library */
+
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+
+/* ges-internal.h sets its own default debug category */
+#undef GST_CAT_DEFAULT
+#include <ges/ges-internal.h>
+
+static void
+lru_insert (GESLruCache * cache, const gchar * key, gsize size)
+{
+  ges_lru_cache_insert (cache, g_strdup (key), g_bytes_new (NULL, size),
+      size);
+}
+
+static gboolean
+lru_contains (GESLruCache * cache, const gchar * key)
+{
+  GBytes *value = ges_lru_cache_lookup (cache, key);
+
+  if (value == NULL)
+    return FALSE;
+
+  g_bytes_unref (value);
+
+  return TRUE;
+}
+
+GST_START_TEST (test_lru_cache)
+{
+  GESLruCache *cache;
+  GBytes *held, *value, *other;
+
+  cache = ges_lru_cache_new (100, g_str_hash, g_str_equal, g_free,
+      (GBoxedCopyFunc) g_bytes_ref, (GDestroyNotify) g_bytes_unref);
+
+  lru_insert (cache, "a", 40);
+  lru_insert (cache, "b", 40);
+  assert_equals_int (ges_lru_cache_get_size (cache), 80);
+
+  /* Using a makes b the least recently used */
+  held = ges_lru_cache_lookup (cache, "a");
+  fail_unless (held != NULL);
+  assert_equals_int (g_bytes_get_size (held), 40);
+
+  lru_insert (cache, "c", 40);
+  fail_if (lru_contains (cache, "b"));
+  fail_unless (lru_contains (cache, "a"));
+  fail_unless (lru_contains (cache, "c"));
+  assert_equals_int (ges_lru_cache_get_size (cache), 80);
+
+  /* A value bigger than the cache evicts everything else but is kept */
+  lru_insert (cache, "d", 200);
+  fail_if (lru_contains (cache, "a"));
+  fail_if (lru_contains (cache, "c"));
+  fail_unless (lru_contains (cache, "d"));
+  assert_equals_int (ges_lru_cache_get_size (cache), 200);
+
+  /* Evicted values stay valid for the ones holding them */
+  assert_equals_int (g_bytes_get_size (held), 40);
+  g_bytes_unref (held);
+
+  /* Inserting replaces the previous value of the key */
+  lru_insert (cache, "d", 10);
+  assert_equals_int (ges_lru_cache_get_size (cache), 10);
+
+  /* ... unless asked to keep it */
+  other = g_bytes_new (NULL, 20);
+  value = ges_lru_cache_insert_or_lookup (cache, g_strdup ("d"), other, 20);
+  assert_equals_int (g_bytes_get_size (value), 10);
+  g_bytes_unref (value);
+
+  other = g_bytes_new (NULL, 20);
+  value = ges_lru_cache_insert_or_lookup (cache, g_strdup ("e"),
+      g_bytes_ref (other), 20);
+  fail_unless (value == other);
+  g_bytes_unref (value);
+  g_bytes_unref (other);
+  assert_equals_int (ges_lru_cache_get_size (cache), 30);
+
+  ges_lru_cache_free (cache);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_smpte_mask_cache)
+{
+  GESLruCache *cache;
+  GESSmpteMask *mask, *other, *first;
+  guint border;
+
+  ges_init ();
+
+  cache = ges_smpte_mask_get_cache ();
+  assert_equals_int (ges_lru_cache_get_size (cache), 0);
+
+  /* Two transitions with the same parameters share one mask */
+  mask = ges_smpte_mask_get (GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR,
+      320, 240, 0, FALSE);
+  other = ges_smpte_mask_get (GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR,
+      320, 240, 0, FALSE);
+  fail_unless (mask == other);
+  assert_equals_int (ges_lru_cache_get_size (cache), 320 * 240 * 4);
+  ges_smpte_mask_unref (other);
+
+  other = ges_smpte_mask_get (GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR,
+      320, 240, 0, TRUE);
+  fail_unless (mask != other);
+  ges_smpte_mask_unref (other);
+  ges_smpte_mask_unref (mask);
+
+  /* About 8MiB each, the cache holds 64MiB */
+  first = ges_smpte_mask_get (GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR,
+      1920, 1080, 0, FALSE);
+  for (border = 1; border <= 8; border++) {
+    mask = ges_smpte_mask_get (GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR,
+        1920, 1080, border, FALSE);
+    ges_smpte_mask_unref (mask);
+  }
+  fail_unless (ges_lru_cache_get_size (cache) <= 64 * 1024 * 1024);
+
+  /* The first mask was evicted, but is still usable by its users */
+  mask = ges_smpte_mask_get (GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR,
+      1920, 1080, 0, FALSE);
+  fail_unless (mask != first);
+  assert_equals_int (first->width, 1920);
+  assert_equals_int (first->ramp[1919], mask->ramp[1919]);
+  ges_smpte_mask_unref (mask);
+  ges_smpte_mask_unref (first);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_discovery_cache)
+{
+  GESDiscoveryCache *cache;
+  GESTrackType formats;
+  GstClockTime duration;
+  gboolean is_image;
+  gchar *filename, *uri;
+
+  filename = g_build_filename (g_get_tmp_dir (), "test-discovery-cache",
+      NULL);
+  fail_unless (g_file_set_contents (filename, "data", -1, NULL));
+  uri = gst_filename_to_uri (filename, NULL);
+
+  cache = ges_discovery_cache_new (FALSE);
+  fail_if (ges_discovery_cache_lookup (cache, uri, &formats, &duration,
+          &is_image));
+
+  ges_discovery_cache_store (cache, uri, GES_TRACK_TYPE_VIDEO, 5 * GST_SECOND,
+      TRUE);
+  fail_unless (ges_discovery_cache_lookup (cache, uri, &formats, &duration,
+          &is_image));
+  assert_equals_int (formats, GES_TRACK_TYPE_VIDEO);
+  assert_equals_uint64 (duration, 5 * GST_SECOND);
+  fail_unless (is_image);
+
+  /* Changing the file invalidates its entry */
+  fail_unless (g_file_set_contents (filename, "other data", -1, NULL));
+  fail_if (ges_discovery_cache_lookup (cache, uri, &formats, &duration,
+          &is_image));
+
+  /* Only local files are cached */
+  ges_discovery_cache_store (cache, "http://localhost/test.ogg",
+      GES_TRACK_TYPE_AUDIO, GST_SECOND, FALSE);
+  fail_if (ges_discovery_cache_lookup (cache, "http://localhost/test.ogg",
+          &formats, &duration, &is_image));
+
+  ges_discovery_cache_free (cache);
+
+  g_unlink (filename);
+  g_free (filename);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-caches");
+  TCase *tc_chain = tcase_create ("caches");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_lru_cache);
+  tcase_add_test (tc_chain, test_smpte_mask_cache);
+  tcase_add_test (tc_chain, test_discovery_cache);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = ges_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
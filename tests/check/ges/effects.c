@@ -331,6 +331,7 @@ GST_START_TEST (test_track_effect_set_properties)
   guint scratch_line, n_props, i;
   gboolean color_aging;
   GParamSpec **pspecs, *spec;
+  GstStructure *structure;
   GValue val = { 0 };
   GValue nval = { 0 };
 
@@ -364,6 +365,16 @@ GST_START_TEST (test_track_effect_set_properties)
   fail_unless (scratch_line == 17);
   fail_unless (color_aging == FALSE);
 
+  structure = gst_structure_new ("properties",
+      "GstAgingTV::scratch-lines", G_TYPE_UINT, 12,
+      "color-aging", G_TYPE_BOOLEAN, TRUE, NULL);
+  ges_track_object_set_child_properties (tck_effect, structure);
+  gst_structure_free (structure);
+  ges_track_object_get_child_property (tck_effect,
+      "scratch-lines", &scratch_line, "color-aging", &color_aging, NULL);
+  fail_unless (scratch_line == 12);
+  fail_unless (color_aging == TRUE);
+
   pspecs = ges_track_object_list_children_properties (tck_effect, &n_props);
   fail_unless (n_props == 7);
 
@@ -458,6 +469,76 @@ GST_START_TEST (test_tl_obj_signals)
 }
 
 GST_END_TEST;
+
+GST_START_TEST (test_parse_launch_effect_template)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track_video;
+  GESTimelineTestSource *source;
+  GESTrackObject *effects[2], *identity;
+  GstElement *balance[2], *element;
+  gdouble saturation;
+  guint i;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = (GESTimelineLayer *) ges_simple_timeline_layer_new ();
+  track_video = ges_track_video_raw_new ();
+
+  ges_timeline_add_track (timeline, track_video);
+  ges_timeline_add_layer (timeline, layer);
+
+  source = ges_timeline_test_source_new ();
+  g_object_set (source, "duration", 10 * GST_SECOND, NULL);
+  ges_simple_timeline_layer_add_object ((GESSimpleTimelineLayer *) (layer),
+      (GESTimelineObject *) source, 0);
+
+  /* The second effect is instantiated from the first one */
+  for (i = 0; i < 2; i++) {
+    effects[i] = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new
+        ("videobalance name=balance saturation=0.5"));
+    fail_unless (ges_timeline_object_add_track_object (GES_TIMELINE_OBJECT
+            (source), effects[i]));
+    fail_unless (ges_track_add_object (track_video, effects[i]));
+
+    element = ges_track_object_get_element (effects[i]);
+    fail_unless (element != NULL);
+    balance[i] = gst_bin_get_by_name (GST_BIN (element), "balance");
+    fail_unless (balance[i] != NULL);
+
+    g_object_get (balance[i], "saturation", &saturation, NULL);
+    fail_unless (saturation == 0.5);
+
+    /* videobalance does not handle all the raw formats */
+    element = gst_bin_get_by_name (GST_BIN (element), "pre_video_convert");
+    fail_unless (element != NULL);
+    gst_object_unref (element);
+  }
+  fail_if (balance[0] == balance[1]);
+  gst_object_unref (balance[0]);
+  gst_object_unref (balance[1]);
+
+  /* No converters are needed around an effect accepting anything */
+  identity = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new ("identity"));
+  fail_unless (ges_timeline_object_add_track_object (GES_TIMELINE_OBJECT
+          (source), identity));
+  fail_unless (ges_track_add_object (track_video, identity));
+  element = ges_track_object_get_element (identity);
+  fail_unless (element != NULL);
+  balance[0] = gst_bin_get_by_name (GST_BIN (element), "pre_video_convert");
+  balance[1] = gst_bin_get_by_name (GST_BIN (element), "post_video_convert");
+  fail_unless (balance[0] == NULL);
+  fail_unless (balance[1] == NULL);
+
+  ges_timeline_layer_remove_object (layer, (GESTimelineObject *) source);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -473,6 +554,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_priorities_tl_object);
   tcase_add_test (tc_chain, test_track_effect_set_properties);
   tcase_add_test (tc_chain, test_tl_obj_signals);
+  tcase_add_test (tc_chain, test_parse_launch_effect_template);
 
   return s;
 }
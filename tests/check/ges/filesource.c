@@ -19,6 +19,12 @@
 
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
+#include <gst/pbutils/pbutils.h>
+#include <glib/gstdio.h>
+
+/* ges-internal.h sets its own default debug category */
+#undef GST_CAT_DEFAULT
+#include <ges/ges-internal.h>
 
 /* This test uri will eventually have to be fixed */
 #define TEST_URI "http://nowhere/blahblahblah"
@@ -198,6 +204,581 @@ GST_START_TEST (test_filesource_images)
 
 GST_END_TEST;
 
+GST_START_TEST (test_filesource_smart_render_caps)
+{
+  GESTrack *track;
+  GESTimelineObject *tlobj;
+  GESTrackObject *trobj[3];
+  GstCaps *caps, *raw_caps, *ocaps;
+  guint i;
+
+  ges_init ();
+
+  track = ges_track_new (GES_TRACK_TYPE_VIDEO,
+      gst_caps_new_empty_simple ("video/x-raw"));
+  fail_unless (track != NULL);
+
+  /* 0 -- 10, 20 -- 30 and 25 -- 35 */
+  for (i = 0; i < 3; i++) {
+    tlobj = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+        TEST_URI);
+    g_object_set (tlobj, "supported-formats", GES_TRACK_TYPE_VIDEO,
+        "start", (guint64) (i ? 15 + i * 5 : 0), "duration", (guint64) 10,
+        NULL);
+
+    trobj[i] = ges_timeline_object_create_track_object (tlobj, track);
+    fail_unless (trobj[i] != NULL);
+    fail_unless (ges_timeline_object_add_track_object (tlobj, trobj[i]));
+    fail_unless (ges_track_add_object (track, trobj[i]));
+  }
+
+  caps = gst_caps_from_string ("video/x-h264; video/x-raw");
+  raw_caps = gst_caps_new_empty_simple ("video/x-raw");
+  ges_track_set_caps (track, caps);
+
+  /* Only the source playing alone can output compressed data */
+  g_object_get (ges_track_object_get_gnlobject (trobj[0]), "caps", &ocaps,
+      NULL);
+  fail_unless (gst_caps_is_equal (ocaps, caps));
+  gst_caps_unref (ocaps);
+  for (i = 1; i < 3; i++) {
+    g_object_get (ges_track_object_get_gnlobject (trobj[i]), "caps", &ocaps,
+        NULL);
+    fail_unless (gst_caps_is_equal (ocaps, raw_caps));
+    gst_caps_unref (ocaps);
+  }
+
+  /* Once they don't overlap anymore, all of them can */
+  g_object_set (trobj[2], "start", (guint64) 30, NULL);
+  for (i = 0; i < 3; i++) {
+    g_object_get (ges_track_object_get_gnlobject (trobj[i]), "caps", &ocaps,
+        NULL);
+    fail_unless (gst_caps_is_equal (ocaps, caps));
+    gst_caps_unref (ocaps);
+  }
+
+  gst_caps_unref (raw_caps);
+  gst_caps_unref (caps);
+  g_object_unref (track);
+}
+
+GST_END_TEST;
+
+
+/* Writes a one second video, black for its first half and white for the
+ * second one */
+/* Encodes a one second video in the temporary directory, returns its uri */
+static gchar *
+make_test_video_named (const gchar * name)
+{
+  GstElement *pipeline, *src;
+  GstBus *bus;
+  GstMessage *message;
+  GstFlowReturn ret;
+  gchar *location, *description, *uri;
+  guint i;
+
+  location = g_build_filename (g_get_tmp_dir (), name, NULL);
+  description = g_strdup_printf ("appsrc name=src format=time "
+      "caps=video/x-raw,format=GRAY8,width=64,height=48,framerate=25/1 ! "
+      "videoconvert ! theoraenc ! oggmux ! filesink location=%s", location);
+  pipeline = gst_parse_launch (description, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (description);
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  for (i = 0; i < 25; i++) {
+    GstBuffer *buffer = gst_buffer_new_allocate (NULL, 64 * 48, NULL);
+
+    gst_buffer_memset (buffer, 0, i < 13 ? 0 : 255, 64 * 48);
+    GST_BUFFER_TIMESTAMP (buffer) = i * GST_SECOND / 25;
+    GST_BUFFER_DURATION (buffer) = GST_SECOND / 25;
+    g_signal_emit_by_name (src, "push-buffer", buffer, &ret);
+    gst_buffer_unref (buffer);
+  }
+  g_signal_emit_by_name (src, "end-of-stream", &ret);
+  gst_object_unref (src);
+
+  bus = gst_element_get_bus (pipeline);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  uri = gst_filename_to_uri (location, NULL);
+  g_free (location);
+
+  return uri;
+}
+
+static gchar *
+make_test_video (void)
+{
+  return make_test_video_named ("test-image-cache.ogg");
+}
+
+typedef struct
+{
+  guint8 luma;
+  gint width;
+} StillFrame;
+
+static void
+still_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    StillFrame * frame)
+{
+  GstMapInfo map;
+  GstCaps *caps = gst_pad_get_current_caps (pad);
+
+  fail_unless (gst_structure_get_int (gst_caps_get_structure (caps, 0),
+          "width", &frame->width));
+  gst_caps_unref (caps);
+
+  /* The first byte of I420 frames is the luma of the top left pixel */
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  frame->luma = map.data[0];
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* Plays @uri as an image taken at @inpoint in a @width wide track */
+static void
+play_still (const gchar * uri, GstClockTime inpoint, gint width,
+    StillFrame * frame)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineFileSource *tfs;
+  GESTimelinePipeline *pipeline;
+  GESTrack *track;
+  GstElement *sink, *fakesink;
+  GstBus *bus;
+  GstMessage *message;
+  gchar *caps;
+
+  timeline = ges_timeline_new ();
+  caps = g_strdup_printf ("video/x-raw,format=I420,width=%d,height=%d",
+      width, width * 3 / 4);
+  track = ges_track_new (GES_TRACK_TYPE_VIDEO, gst_caps_from_string (caps));
+  g_free (caps);
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  tfs = ges_timeline_filesource_new ((gchar *) uri);
+  g_object_set (tfs, "is-image", TRUE, "supported-formats",
+      GES_TRACK_TYPE_VIDEO, "max-duration", GST_SECOND, "in-point", inpoint,
+      "duration", GST_SECOND / 5, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (tfs)));
+
+  sink = gst_parse_bin_from_description ("videoconvert ! "
+      "video/x-raw,format=I420 ! "
+      "fakesink name=sink signal-handoffs=true sync=false", TRUE, NULL);
+  fail_unless (sink != NULL);
+  fakesink = gst_bin_get_by_name (GST_BIN (sink), "sink");
+  g_signal_connect (fakesink, "handoff", G_CALLBACK (still_handoff_cb), frame);
+  gst_object_unref (fakesink);
+
+  pipeline = ges_timeline_pipeline_new ();
+  ges_timeline_pipeline_preview_set_video_sink (pipeline, sink);
+  fail_unless (ges_timeline_pipeline_add_timeline (pipeline, timeline));
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_PREVIEW_VIDEO));
+
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_START_TEST (test_image_source_cache)
+{
+  GESLruCache *cache;
+  StillFrame frame;
+  gsize size;
+  gchar *uri;
+
+  ges_init ();
+
+  if (!gst_registry_check_feature_version (gst_registry_get (), "theoraenc",
+          GST_VERSION_MAJOR, GST_VERSION_MINOR, 0)) {
+    GST_WARNING ("Missing theoraenc, skipping");
+    return;
+  }
+
+  uri = make_test_video ();
+  cache = ges_track_image_source_get_cache ();
+
+  /* The frame is cached as output, an I420 frame of the track size */
+  size = ges_lru_cache_get_size (cache);
+  play_still (uri, 0, 64, &frame);
+  fail_unless (frame.luma < 64);
+  assert_equals_int (frame.width, 64);
+  assert_equals_int (ges_lru_cache_get_size (cache), size + 64 * 48 * 3 / 2);
+
+  /* Served from the cache */
+  size = ges_lru_cache_get_size (cache);
+  play_still (uri, 0, 64, &frame);
+  fail_unless (frame.luma < 64);
+  assert_equals_int (frame.width, 64);
+  assert_equals_int (ges_lru_cache_get_size (cache), size);
+
+  /* Other caps are another entry */
+  play_still (uri, 0, 32, &frame);
+  fail_unless (frame.luma < 64);
+  assert_equals_int (frame.width, 32);
+  assert_equals_int (ges_lru_cache_get_size (cache), size + 32 * 24 * 3 / 2);
+
+  /* Another in-point is another frame, the one after the in-point seek */
+  size = ges_lru_cache_get_size (cache);
+  play_still (uri, GST_SECOND * 4 / 5, 32, &frame);
+  fail_unless (frame.luma > 192);
+  assert_equals_int (frame.width, 32);
+  assert_equals_int (ges_lru_cache_get_size (cache), size + 32 * 24 * 3 / 2);
+
+  size = ges_lru_cache_get_size (cache);
+  play_still (uri, GST_SECOND * 4 / 5, 32, &frame);
+  fail_unless (frame.luma > 192);
+  assert_equals_int (frame.width, 32);
+  assert_equals_int (ges_lru_cache_get_size (cache), size);
+
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GMainLoop *loop;
+  gchar *proxy_uri;
+  guint n_calls;
+} ProxyReady;
+
+static void
+proxy_ready_cb (const gchar * uri, const gchar * proxy_uri, ProxyReady * ready)
+{
+  ready->proxy_uri = g_strdup (proxy_uri);
+  ready->n_calls++;
+  g_main_loop_quit (ready->loop);
+}
+
+static gchar *
+get_played_uri (GESTrackObject * trackobject)
+{
+  gchar *uri;
+
+  g_object_get (ges_track_object_get_gnlobject (trackobject), "uri", &uri,
+      NULL);
+
+  return uri;
+}
+
+GST_START_TEST (test_filesource_proxies)
+{
+  GESProxyCache *cache;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineFileSource *tfs;
+  GESTrack *track;
+  GESTrackObject *trackobject;
+  GstDiscoverer *discoverer;
+  GstDiscovererInfo *info;
+  GList *streams;
+  ProxyReady ready = { NULL, NULL, 0 };
+  gchar *uri, *proxy_uri, *played, *filename;
+
+  ges_init ();
+
+  if (!gst_registry_check_feature_version (gst_registry_get (), "theoraenc",
+          GST_VERSION_MAJOR, GST_VERSION_MINOR, 0) ||
+      !gst_registry_check_feature_version (gst_registry_get (), "jpegenc",
+          GST_VERSION_MAJOR, GST_VERSION_MINOR, 0) ||
+      !gst_registry_check_feature_version (gst_registry_get (), "matroskamux",
+          GST_VERSION_MAJOR, GST_VERSION_MINOR, 0)) {
+    GST_WARNING ("Missing encoders, skipping");
+    return;
+  }
+
+  /* A new file has no proxy yet */
+  uri = make_test_video ();
+  ready.loop = g_main_loop_new (NULL, FALSE);
+  cache = ges_proxy_cache_new ((GESProxyReadyFunc) proxy_ready_cb, &ready);
+  fail_unless (ges_proxy_cache_lookup (cache, uri) == NULL);
+
+  ges_proxy_cache_request (cache, uri);
+  g_main_loop_run (ready.loop);
+  fail_unless (ready.proxy_uri != NULL);
+  assert_equals_int (ready.n_calls, 1);
+
+  /* It is found in the cache from now on, and only created once */
+  proxy_uri = ges_proxy_cache_lookup (cache, uri);
+  assert_equals_string (proxy_uri, ready.proxy_uri);
+  g_free (proxy_uri);
+  ges_proxy_cache_request (cache, uri);
+  while (g_main_context_iteration (NULL, FALSE));
+  assert_equals_int (ready.n_calls, 1);
+  ges_proxy_cache_free (cache);
+  g_main_loop_unref (ready.loop);
+
+  discoverer = gst_discoverer_new (10 * GST_SECOND, NULL);
+  info = gst_discoverer_discover_uri (discoverer, ready.proxy_uri, NULL);
+  fail_unless (info != NULL);
+  streams = gst_discoverer_info_get_video_streams (info);
+  fail_unless (streams != NULL);
+  assert_equals_int (gst_discoverer_video_info_get_height
+      ((GstDiscovererVideoInfo *) streams->data), 360);
+  gst_discoverer_stream_info_list_free (streams);
+  gst_discoverer_info_unref (info);
+  g_object_unref (discoverer);
+
+  /* Switching between the proxy and the original file */
+  timeline = ges_timeline_new ();
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+  tfs = ges_timeline_filesource_new (uri);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (tfs)));
+  while (ges_timeline_is_discovering (timeline))
+    g_main_context_iteration (NULL, TRUE);
+
+  trackobject = ges_timeline_object_find_track_object (GES_TIMELINE_OBJECT
+      (tfs), track, GES_TYPE_TRACK_FILESOURCE);
+  fail_unless (trackobject != NULL);
+
+  played = get_played_uri (trackobject);
+  assert_equals_string (played, uri);
+  g_free (played);
+
+  g_object_set (timeline, "use-proxies", TRUE, NULL);
+  played = get_played_uri (trackobject);
+  assert_equals_string (played, ready.proxy_uri);
+  g_free (played);
+
+  /* Rendering always uses the original file */
+  fail_unless (ges_timeline_allow_proxies (timeline, FALSE));
+  played = get_played_uri (trackobject);
+  assert_equals_string (played, uri);
+  g_free (played);
+
+  fail_unless (ges_timeline_allow_proxies (timeline, TRUE));
+  played = get_played_uri (trackobject);
+  assert_equals_string (played, ready.proxy_uri);
+  g_free (played);
+
+  g_object_set (timeline, "use-proxies", FALSE, NULL);
+  played = get_played_uri (trackobject);
+  assert_equals_string (played, uri);
+  g_free (played);
+
+  g_object_unref (trackobject);
+  g_object_unref (timeline);
+
+  filename = g_filename_from_uri (ready.proxy_uri, NULL, NULL);
+  g_unlink (filename);
+  g_free (filename);
+  g_free (ready.proxy_uri);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static gboolean
+count_discovered_hook (GSignalInvocationHint * ihint, guint n_param_values,
+    const GValue * param_values, gint * n_discovered)
+{
+  g_atomic_int_inc (n_discovered);
+
+  return TRUE;
+}
+
+static void
+check_discovered (GESTimelineFileSource * tfs)
+{
+  GList *trackobjects;
+  guint64 max_duration = ges_timeline_filesource_get_max_duration (tfs);
+
+  fail_unless (ges_timeline_filesource_get_supported_formats (tfs) ==
+      GES_TRACK_TYPE_VIDEO);
+  /* The test video lasts one second */
+  fail_unless (max_duration > GST_SECOND / 2 && max_duration < 2 * GST_SECOND);
+
+  trackobjects = ges_timeline_object_get_track_objects (GES_TIMELINE_OBJECT
+      (tfs));
+  assert_equals_int (g_list_length (trackobjects), 1);
+  g_list_free_full (trackobjects, g_object_unref);
+}
+
+GST_START_TEST (test_filesource_discovery_dedup)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineFileSource *tfs, *tfs1, *tfs2;
+  gint n_discovered = 0;
+  guint signal_id;
+  gulong hook_id;
+  gpointer klass;
+  gchar *uri;
+
+  ges_init ();
+
+  if (!gst_registry_check_feature_version (gst_registry_get (), "theoraenc",
+          GST_VERSION_MAJOR, GST_VERSION_MINOR, 0)) {
+    GST_WARNING ("Missing theoraenc, skipping");
+    return;
+  }
+
+  uri = make_test_video ();
+
+  /* Counts the discoveries of all the discoverers of the timeline */
+  klass = g_type_class_ref (GST_TYPE_DISCOVERER);
+  signal_id = g_signal_lookup ("discovered", GST_TYPE_DISCOVERER);
+  hook_id = g_signal_add_emission_hook (signal_id, 0,
+      (GSignalEmissionHook) count_discovered_hook, &n_discovered, NULL);
+
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, ges_track_video_raw_new ()));
+  layer = ges_timeline_append_layer (timeline);
+
+  /* The second source waits for the discovery of the first one */
+  tfs = ges_timeline_filesource_new (uri);
+  tfs1 = ges_timeline_filesource_new (uri);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (tfs)));
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (tfs1)));
+  while (ges_timeline_is_discovering (timeline))
+    g_main_context_iteration (NULL, TRUE);
+
+  assert_equals_int (g_atomic_int_get (&n_discovered), 1);
+  check_discovered (tfs);
+  check_discovered (tfs1);
+
+  /* Later sources use the results kept in the discovery cache */
+  tfs2 = ges_timeline_filesource_new (uri);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (tfs2)));
+  fail_if (ges_timeline_is_discovering (timeline));
+  assert_equals_int (g_atomic_int_get (&n_discovered), 1);
+  check_discovered (tfs2);
+
+  g_object_unref (timeline);
+
+  g_signal_remove_emission_hook (signal_id, hook_id);
+  g_type_class_unref (klass);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GHashTable *discoverers;
+  GHashTable *uris;
+} DiscoveryStats;
+
+static gboolean
+discovery_stats_hook (GSignalInvocationHint * ihint, guint n_param_values,
+    const GValue * param_values, DiscoveryStats * stats)
+{
+  GstDiscovererInfo *info = g_value_get_object (&param_values[1]);
+
+  g_hash_table_add (stats->discoverers,
+      g_value_get_object (&param_values[0]));
+  g_hash_table_add (stats->uris, g_strdup (gst_discoverer_info_get_uri
+          (info)));
+
+  return TRUE;
+}
+
+#define N_CONCURRENT_FILES 4
+
+GST_START_TEST (test_filesource_concurrent_discovery)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineFileSource *sources[2 * N_CONCURRENT_FILES];
+  gchar *uris[N_CONCURRENT_FILES];
+  DiscoveryStats stats;
+  guint i, signal_id;
+  gulong hook_id;
+  gpointer klass;
+
+  ges_init ();
+
+  if (!gst_registry_check_feature_version (gst_registry_get (), "theoraenc",
+          GST_VERSION_MAJOR, GST_VERSION_MINOR, 0)) {
+    GST_WARNING ("Missing theoraenc, skipping");
+    return;
+  }
+
+  for (i = 0; i < N_CONCURRENT_FILES; i++) {
+    gchar *name = g_strdup_printf ("test-discovery-%u.ogg", i);
+
+    uris[i] = make_test_video_named (name);
+    g_free (name);
+  }
+
+  stats.discoverers = g_hash_table_new (g_direct_hash, g_direct_equal);
+  stats.uris = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  klass = g_type_class_ref (GST_TYPE_DISCOVERER);
+  signal_id = g_signal_lookup ("discovered", GST_TYPE_DISCOVERER);
+  hook_id = g_signal_add_emission_hook (signal_id, 0,
+      (GSignalEmissionHook) discovery_stats_hook, &stats, NULL);
+
+  timeline = ges_timeline_new ();
+  g_object_set (timeline, "discovery-workers", N_CONCURRENT_FILES, NULL);
+  fail_unless (ges_timeline_add_track (timeline, ges_track_video_raw_new ()));
+  layer = ges_timeline_append_layer (timeline);
+
+  /* Two sources per file, all added before any discovery is done */
+  for (i = 0; i < 2 * N_CONCURRENT_FILES; i++) {
+    sources[i] = ges_timeline_filesource_new (uris[i % N_CONCURRENT_FILES]);
+    fail_unless (ges_timeline_layer_add_object (layer,
+            GES_TIMELINE_OBJECT (sources[i])));
+  }
+  fail_unless (ges_timeline_is_discovering (timeline));
+
+  while (ges_timeline_is_discovering (timeline))
+    g_main_context_iteration (NULL, TRUE);
+
+  /* Each file was discovered once, by its own worker */
+  assert_equals_int (g_hash_table_size (stats.uris), N_CONCURRENT_FILES);
+  assert_equals_int (g_hash_table_size (stats.discoverers),
+      N_CONCURRENT_FILES);
+
+  for (i = 0; i < 2 * N_CONCURRENT_FILES; i++)
+    check_discovered (sources[i]);
+
+  g_object_unref (timeline);
+
+  g_signal_remove_emission_hook (signal_id, hook_id);
+  g_type_class_unref (klass);
+  g_hash_table_unref (stats.discoverers);
+  g_hash_table_unref (stats.uris);
+
+  for (i = 0; i < N_CONCURRENT_FILES; i++) {
+    gchar *filename = g_filename_from_uri (uris[i], NULL, NULL);
+
+    g_unlink (filename);
+    g_free (filename);
+    g_free (uris[i]);
+  }
+}
+
+GST_END_TEST;
 
 static Suite *
 ges_suite (void)
@@ -210,6 +791,11 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_filesource_basic);
   tcase_add_test (tc_chain, test_filesource_images);
   tcase_add_test (tc_chain, test_filesource_properties);
+  tcase_add_test (tc_chain, test_filesource_smart_render_caps);
+  tcase_add_test (tc_chain, test_image_source_cache);
+  tcase_add_test (tc_chain, test_filesource_proxies);
+  tcase_add_test (tc_chain, test_filesource_discovery_dedup);
+  tcase_add_test (tc_chain, test_filesource_concurrent_discovery);
 
   return s;
 }
@@ -292,6 +292,91 @@ GST_START_TEST (test_layer_priorities)
 
 GST_END_TEST;
 
+GST_START_TEST (test_layer_add_objects)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track;
+  GESTimelineObject *objects[4], *extra;
+  GList *batch, *tmp;
+  guint64 starts[] = { 50, 100, 0, 75 };
+  guint64 sorted[] = { 0, 50, 75, 100 };
+  guint i;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  for (i = 0; i < 4; i++) {
+    objects[i] =
+        (GESTimelineObject *) ges_custom_timeline_source_new
+        (my_fill_track_func, NULL);
+    g_object_set (objects[i], "start", starts[i], "duration", (guint64) 10,
+        NULL);
+  }
+
+  /* One object is already there, the batch is not sorted */
+  fail_unless (ges_timeline_layer_add_object (layer, objects[0]));
+  batch = g_list_append (NULL, objects[1]);
+  batch = g_list_append (batch, objects[2]);
+  batch = g_list_append (batch, objects[3]);
+  fail_unless (ges_timeline_layer_add_objects (layer, batch));
+
+  tmp = ges_timeline_layer_get_objects (layer);
+  assert_equals_int (g_list_length (tmp), 4);
+  for (i = 0; i < 4; i++) {
+    GESTimelineObject *object = g_list_nth_data (tmp, i);
+    GESTrackObject *trackobject;
+
+    fail_if (g_object_is_floating (object));
+    assert_equals_uint64 (GES_TIMELINE_OBJECT_START (object), sorted[i]);
+
+    trackobject = ges_timeline_object_find_track_object (object, track,
+        G_TYPE_NONE);
+    fail_unless (trackobject != NULL);
+    assert_equals_uint64 (ges_track_object_get_start (trackobject),
+        sorted[i]);
+    g_object_unref (trackobject);
+  }
+  g_list_free_full (tmp, g_object_unref);
+
+  tmp = ges_track_get_objects (track);
+  assert_equals_int (g_list_length (tmp), 4);
+  g_list_free_full (tmp, g_object_unref);
+
+  /* Nothing is added if one of the objects is already in a layer */
+  extra =
+      (GESTimelineObject *) ges_custom_timeline_source_new (my_fill_track_func,
+      NULL);
+  g_object_ref_sink (extra);
+  batch = g_list_append (NULL, extra);
+  batch = g_list_append (batch, objects[1]);
+  fail_if (ges_timeline_layer_add_objects (layer, batch));
+  fail_unless (ges_timeline_object_get_layer (extra) == NULL);
+  tmp = ges_timeline_layer_get_objects (layer);
+  assert_equals_int (g_list_length (tmp), 4);
+  g_list_free_full (tmp, g_object_unref);
+
+  /* Nor if an object is in the batch twice */
+  batch = g_list_append (NULL, extra);
+  batch = g_list_append (batch, extra);
+  fail_if (ges_timeline_layer_add_objects (layer, batch));
+  fail_unless (ges_timeline_object_get_layer (extra) == NULL);
+  ASSERT_OBJECT_REFCOUNT (extra, "extra", 1);
+  tmp = ges_timeline_layer_get_objects (layer);
+  assert_equals_int (g_list_length (tmp), 4);
+  g_list_free_full (tmp, g_object_unref);
+  g_object_unref (extra);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_layer_automatic_transition)
 {
   GESTimeline *timeline;
@@ -326,6 +411,36 @@ GST_START_TEST (test_layer_automatic_transition)
   }
 
   fail_unless (res == TRUE);
+  g_list_free_full (objects, g_object_unref);
+
+  /* Moving a source away from its neighbour removes the transition */
+  g_object_set (srcbis, "start", (gint64) 20000, NULL);
+
+  res = FALSE;
+  objects = ges_timeline_layer_get_objects (layer);
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    if (GES_IS_TIMELINE_STANDARD_TRANSITION (tmp->data)) {
+      res = TRUE;
+    }
+  }
+  g_list_free_full (objects, g_object_unref);
+
+  fail_unless (res == FALSE);
+
+  /* And moving it back creates a new one */
+  g_object_set (srcbis, "start", (gint64) 5000, NULL);
+
+  objects = ges_timeline_layer_get_objects (layer);
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    if (GES_IS_TIMELINE_STANDARD_TRANSITION (tmp->data)) {
+      res = TRUE;
+    }
+  }
+  g_list_free_full (objects, g_object_unref);
+
+  fail_unless (res == TRUE);
+
+  g_object_unref (timeline);
 }
 
 GST_END_TEST;
@@ -668,6 +783,7 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_layer_properties);
   tcase_add_test (tc_chain, test_layer_priorities);
+  tcase_add_test (tc_chain, test_layer_add_objects);
   tcase_add_test (tc_chain, test_layer_automatic_transition);
   tcase_add_test (tc_chain, test_layer_metadata_string);
   tcase_add_test (tc_chain, test_layer_metadata_boolean);
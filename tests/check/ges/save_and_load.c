@@ -19,8 +19,10 @@
 
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
+#include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <glib/gstdio.h>
 #define GetCurrentDir getcwd
 
 #include <gst/audio/audio.h>
@@ -755,6 +757,450 @@ GST_START_TEST (test_keyfile_identity)
 
 GST_END_TEST;
 
+GST_START_TEST (test_binary_identity)
+{
+  GESTimeline *orig = NULL, *serialized = NULL;
+  GESFormatter *formatter;
+  gchar *location, *uri;
+
+  ges_init ();
+
+  location = g_build_filename (g_get_tmp_dir (), "test-binary.ges", NULL);
+  uri = gst_filename_to_uri (location, NULL);
+
+  TIMELINE_BEGIN (orig) {
+
+    TRACK (GES_TRACK_TYPE_AUDIO, "audio/x-raw,"
+        "format=(string)" GST_AUDIO_NE (S32) ",rate=8000");
+    TRACK (GES_TRACK_TYPE_VIDEO, "video/x-raw,format=(string)RGB24");
+
+    LAYER_BEGIN (5) {
+
+      LAYER_OBJECT (GES_TYPE_TIMELINE_TEXT_OVERLAY,
+          "start", (guint64) GST_SECOND,
+          "duration", (guint64) 2 * GST_SECOND,
+          "priority", 1,
+          "text", "Hello, world!",
+          "font-desc", "Sans 9",
+          "halignment", GES_TEXT_HALIGN_LEFT,
+          "valignment", GES_TEXT_VALIGN_TOP);
+
+      LAYER_OBJECT (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) 0,
+          "duration", (guint64) 5 * GST_SECOND,
+          "priority", 2,
+          "freq", (gdouble) 500,
+          "volume", 1.0, "vpattern", GES_VIDEO_TEST_PATTERN_WHITE);
+
+      LAYER_OBJECT (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) 6 * GST_SECOND,
+          "duration", (guint64) 5 * GST_SECOND,
+          "priority", 3,
+          "freq", (gdouble) 600,
+          "volume", 1.0, "vpattern", GES_VIDEO_TEST_PATTERN_RED);
+
+    }
+    LAYER_END;
+
+  }
+  TIMELINE_END;
+
+  formatter = GES_FORMATTER (ges_binary_formatter_new ());
+  fail_unless (ges_formatter_save_to_uri (formatter, orig, uri));
+  g_object_unref (formatter);
+
+  /* The binary project is recognized and loaded from the mapped file */
+  formatter = ges_formatter_new_for_uri (uri);
+  fail_unless (GES_IS_BINARY_FORMATTER (formatter));
+
+  serialized = ges_timeline_new ();
+  fail_unless (ges_formatter_load_from_uri (formatter, serialized, uri));
+
+  TIMELINE_COMPARE (serialized, orig);
+
+  g_object_unref (formatter);
+  g_object_unref (serialized);
+  g_object_unref (orig);
+
+  unlink (location);
+  g_free (location);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_journal_replay)
+{
+  GESTimeline *orig, *replayed;
+  GESTimelineLayer *layer, *layer2;
+  GESTimelineObject *src, *src2, *text;
+  gchar *location, *uri;
+
+  ges_init ();
+
+  location = g_build_filename (g_get_tmp_dir (), "test-journal.ges", NULL);
+  uri = gst_filename_to_uri (location, NULL);
+
+  orig = ges_timeline_new ();
+  ges_timeline_add_track (orig, ges_track_new (GES_TRACK_TYPE_AUDIO,
+          gst_caps_from_string ("audio/x-raw")));
+  layer = ges_timeline_append_layer (orig);
+
+  src = GES_TIMELINE_OBJECT (g_object_new (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) 0, "duration", (guint64) GST_SECOND,
+          "freq", (gdouble) 500, NULL));
+  ges_timeline_layer_add_object (layer, src);
+
+  /* Everything done from now on is only recorded in the journal */
+  fail_unless (ges_timeline_start_journal (orig, uri));
+
+  src2 = GES_TIMELINE_OBJECT (g_object_new (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) 2 * GST_SECOND, "duration", (guint64) GST_SECOND,
+          NULL));
+  ges_timeline_layer_add_object (layer, src2);
+
+  /* move, trim and change a property */
+  ges_timeline_object_set_start (src, 5 * GST_SECOND);
+  ges_timeline_object_set_inpoint (src, GST_SECOND / 2);
+  ges_timeline_object_set_duration (src, 3 * GST_SECOND);
+  g_object_set (src, "freq", (gdouble) 600, NULL);
+
+  layer2 = ges_timeline_append_layer (orig);
+  text = GES_TIMELINE_OBJECT (g_object_new (GES_TYPE_TIMELINE_TEXT_OVERLAY,
+          "start", (guint64) GST_SECOND, "duration", (guint64) GST_SECOND,
+          "text", "Hello, world!", NULL));
+  ges_timeline_layer_add_object (layer2, text);
+
+  ges_timeline_layer_remove_object (layer, src2);
+
+  replayed = ges_timeline_new ();
+  fail_unless (ges_timeline_replay_journal (replayed, uri));
+  TIMELINE_COMPARE (replayed, orig);
+  g_object_unref (replayed);
+
+  /* Compacting does not change what gets replayed */
+  fail_unless (ges_timeline_compact_journal (orig));
+  g_object_set (text, "text", "Hello again", NULL);
+
+  replayed = ges_timeline_new ();
+  fail_unless (ges_timeline_replay_journal (replayed, uri));
+  TIMELINE_COMPARE (replayed, orig);
+  g_object_unref (replayed);
+
+  ges_timeline_stop_journal (orig);
+  g_object_unref (orig);
+
+  unlink (location);
+  g_free (location);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static guint
+count_objects (GESTimeline * timeline)
+{
+  GList *layers, *objects;
+  guint n;
+
+  layers = ges_timeline_get_layers (timeline);
+  objects = ges_timeline_layer_get_objects (layers->data);
+  n = g_list_length (objects);
+  g_list_free_full (objects, g_object_unref);
+  g_list_free_full (layers, g_object_unref);
+
+  return n;
+}
+
+GST_START_TEST (test_journal_replay_auto_transition)
+{
+  GESTimeline *orig, *replayed;
+  GESTimelineLayer *layer;
+  GESTimelineObject *src, *src2;
+  gchar *location, *uri;
+  FILE *file;
+
+  ges_init ();
+
+  location = g_build_filename (g_get_tmp_dir (), "test-journal-auto.ges",
+      NULL);
+  uri = gst_filename_to_uri (location, NULL);
+
+  orig = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (orig);
+  ges_timeline_layer_set_auto_transition (layer, TRUE);
+
+  fail_unless (ges_timeline_start_journal (orig, uri));
+
+  /* The overlap creates a transition, which gets journaled */
+  src = GES_TIMELINE_OBJECT (g_object_new (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) 0, "duration", (guint64) 2 * GST_SECOND,
+          NULL));
+  ges_timeline_layer_add_object (layer, src);
+  src2 = GES_TIMELINE_OBJECT (g_object_new (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) GST_SECOND, "duration", (guint64) 2 * GST_SECOND,
+          NULL));
+  ges_timeline_layer_add_object (layer, src2);
+  assert_equals_int (count_objects (orig), 3);
+
+  /* Replaying must not create the transition a second time */
+  replayed = ges_timeline_new ();
+  fail_unless (ges_timeline_replay_journal (replayed, uri));
+  assert_equals_int (count_objects (replayed), 3);
+  TIMELINE_COMPARE (replayed, orig);
+  g_object_unref (replayed);
+
+  ges_timeline_stop_journal (orig);
+
+  /* A record cut in the middle of its value still parses, it is ignored
+   * because it is not terminated */
+  file = fopen (location, "ab");
+  fail_unless (file != NULL);
+  fputs ("set, journal-id=(uint)2, start=(string)5", file);
+  fclose (file);
+
+  replayed = ges_timeline_new ();
+  fail_unless (ges_timeline_replay_journal (replayed, uri));
+  TIMELINE_COMPARE (replayed, orig);
+  g_object_unref (replayed);
+
+  g_object_unref (orig);
+
+  unlink (location);
+  g_free (location);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static goffset
+journal_size (const gchar * location)
+{
+  GStatBuf st;
+
+  fail_unless (g_stat (location, &st) == 0);
+
+  return st.st_size;
+}
+
+GST_START_TEST (test_journal_batch_and_compaction)
+{
+  GESTimeline *orig, *replayed;
+  GESTimelineLayer *layer;
+  GESTimelineObject *src;
+  gchar *location, *uri;
+  goffset size;
+  guint i;
+
+  ges_init ();
+
+  location = g_build_filename (g_get_tmp_dir (), "test-journal-batch.ges",
+      NULL);
+  uri = gst_filename_to_uri (location, NULL);
+
+  orig = ges_timeline_new ();
+  ges_timeline_add_track (orig, ges_track_new (GES_TRACK_TYPE_AUDIO,
+          gst_caps_from_string ("audio/x-raw")));
+  layer = ges_timeline_append_layer (orig);
+  src = GES_TIMELINE_OBJECT (g_object_new (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) 0, "duration", (guint64) GST_SECOND, NULL));
+  ges_timeline_layer_add_object (layer, src);
+
+  fail_unless (ges_timeline_start_journal (orig, uri));
+  size = journal_size (location);
+
+  /* The records of a batch are appended once it is committed */
+  ges_timeline_begin_edit (orig);
+  ges_timeline_object_set_start (src, GST_SECOND);
+  ges_timeline_object_set_duration (src, 2 * GST_SECOND);
+  fail_unless (journal_size (location) == size);
+  fail_unless (ges_timeline_commit_edit (orig));
+  fail_unless (journal_size (location) > size);
+
+  replayed = ges_timeline_new ();
+  fail_unless (ges_timeline_replay_journal (replayed, uri));
+  TIMELINE_COMPARE (replayed, orig);
+  g_object_unref (replayed);
+
+  /* Enough records get compacted from the main loop, in the background */
+  for (i = 0; i < 4096; i++)
+    ges_timeline_object_set_start (src, (i % 2) * GST_SECOND);
+  size = journal_size (location);
+  while (journal_size (location) >= size)
+    g_main_context_iteration (NULL, TRUE);
+
+  replayed = ges_timeline_new ();
+  fail_unless (ges_timeline_replay_journal (replayed, uri));
+  TIMELINE_COMPARE (replayed, orig);
+  g_object_unref (replayed);
+
+  ges_timeline_stop_journal (orig);
+  g_object_unref (orig);
+
+  unlink (location);
+  g_free (location);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static void
+load_progress_cb (GESTimeline * timeline, guint created, guint total,
+    guint * last_created)
+{
+  fail_unless (created >= *last_created);
+  fail_unless (created <= total);
+  *last_created = created;
+}
+
+static void
+load_done_cb (GESTimeline * timeline, GAsyncResult * res, GMainLoop * loop)
+{
+  fail_unless (ges_timeline_load_from_uri_finish (timeline, res, NULL));
+  g_main_loop_quit (loop);
+}
+
+GST_START_TEST (test_load_from_uri_async)
+{
+  GESTimeline *orig = NULL, *loaded;
+  GMainLoop *loop;
+  gchar *location, *uri;
+  guint created = 0;
+
+  ges_init ();
+
+  location = g_build_filename (g_get_tmp_dir (), "test-async.ges", NULL);
+  uri = gst_filename_to_uri (location, NULL);
+
+  TIMELINE_BEGIN (orig) {
+
+    TRACK (GES_TRACK_TYPE_AUDIO, "audio/x-raw");
+
+    LAYER_BEGIN (0) {
+
+      LAYER_OBJECT (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) 0,
+          "duration", (guint64) 5 * GST_SECOND,
+          "priority", 2, "freq", (gdouble) 500);
+
+      LAYER_OBJECT (GES_TYPE_TIMELINE_TEST_SOURCE,
+          "start", (guint64) 6 * GST_SECOND,
+          "duration", (guint64) 5 * GST_SECOND,
+          "priority", 3, "freq", (gdouble) 600);
+
+    }
+    LAYER_END;
+
+  }
+  TIMELINE_END;
+
+  fail_unless (ges_timeline_save_to_uri (orig, uri));
+
+  loop = g_main_loop_new (NULL, FALSE);
+  loaded = ges_timeline_new ();
+  g_signal_connect (loaded, "load-progress", G_CALLBACK (load_progress_cb),
+      &created);
+
+  ges_timeline_load_from_uri_async (loaded, uri, NULL,
+      (GAsyncReadyCallback) load_done_cb, loop);
+  g_main_loop_run (loop);
+
+  fail_unless_equals_int (created, 2);
+  TIMELINE_COMPARE (loaded, orig);
+
+  g_main_loop_unref (loop);
+  g_object_unref (loaded);
+  g_object_unref (orig);
+
+  unlink (location);
+  g_free (location);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static void
+cancel_progress_cb (GESTimeline * timeline, guint created, guint total,
+    GCancellable * cancellable)
+{
+  g_cancellable_cancel (cancellable);
+}
+
+static void
+load_cancelled_cb (GESTimeline * timeline, GAsyncResult * res,
+    GMainLoop * loop)
+{
+  GError *error = NULL;
+
+  fail_if (ges_timeline_load_from_uri_finish (timeline, res, &error));
+  fail_unless (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED));
+  g_error_free (error);
+  g_main_loop_quit (loop);
+}
+
+GST_START_TEST (test_load_from_uri_async_cancel)
+{
+  GESTimeline *orig, *loaded;
+  GESTimelineLayer *layer;
+  GESTimelineTestSource *source;
+  GCancellable *cancellable;
+  GMainLoop *loop;
+  gchar *location, *uri;
+  guint i, created = 0;
+
+  ges_init ();
+
+  location = g_build_filename (g_get_tmp_dir (), "test-async-cancel.ges",
+      NULL);
+  uri = gst_filename_to_uri (location, NULL);
+
+  /* More objects than inserted in one batch */
+  orig = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (orig,
+          ges_track_new (GES_TRACK_TYPE_AUDIO,
+              gst_caps_from_string ("audio/x-raw"))));
+  layer = ges_timeline_append_layer (orig);
+  for (i = 0; i < 100; i++) {
+    source = ges_timeline_test_source_new ();
+    g_object_set (source, "start", (guint64) i * GST_SECOND, "duration",
+        (guint64) GST_SECOND, NULL);
+    fail_unless (ges_timeline_layer_add_object (layer,
+            GES_TIMELINE_OBJECT (source)));
+  }
+  fail_unless (ges_timeline_save_to_uri (orig, uri));
+
+  loop = g_main_loop_new (NULL, FALSE);
+  cancellable = g_cancellable_new ();
+  loaded = ges_timeline_new ();
+  g_signal_connect (loaded, "load-progress", G_CALLBACK (load_progress_cb),
+      &created);
+  g_signal_connect (loaded, "load-progress", G_CALLBACK (cancel_progress_cb),
+      cancellable);
+
+  /* Updates were disabled by the application and stay disabled */
+  ges_timeline_enable_update (loaded, FALSE);
+
+  ges_timeline_load_from_uri_async (loaded, uri, cancellable,
+      (GAsyncReadyCallback) load_cancelled_cb, loop);
+  g_main_loop_run (loop);
+
+  /* Cancelled after the first batch */
+  fail_unless (created > 0);
+  fail_unless (created < 100);
+  fail_if (ges_timeline_is_updating (loaded));
+
+  g_main_loop_unref (loop);
+  g_object_unref (cancellable);
+  g_object_unref (loaded);
+  g_object_unref (orig);
+
+  unlink (location);
+  g_free (location);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -766,6 +1212,12 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_keyfile_save);
   tcase_add_test (tc_chain, test_keyfile_load);
   tcase_add_test (tc_chain, test_keyfile_identity);
+  tcase_add_test (tc_chain, test_binary_identity);
+  tcase_add_test (tc_chain, test_journal_replay);
+  tcase_add_test (tc_chain, test_journal_replay_auto_transition);
+  tcase_add_test (tc_chain, test_journal_batch_and_compaction);
+  tcase_add_test (tc_chain, test_load_from_uri_async);
+  tcase_add_test (tc_chain, test_load_from_uri_async_cancel);
   tcase_add_test (tc_chain, test_pitivi_file_load);
 
   return s;
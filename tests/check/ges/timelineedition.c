@@ -942,6 +942,70 @@ GST_START_TEST (test_timeline_edition_mode)
 
 GST_END_TEST;
 
+GST_START_TEST (test_batch_edition)
+{
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrackObject *tckobj, *tckobj1;
+  GESTimelineObject *obj, *obj1;
+  GList *tckobjs;
+
+  ges_init ();
+
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (track != NULL);
+
+  timeline = ges_timeline_new ();
+  fail_unless (timeline != NULL);
+
+  fail_unless (ges_timeline_add_track (timeline, track));
+  fail_unless ((layer = ges_timeline_append_layer (timeline)) != NULL);
+
+  obj = create_custom_tlobj ();
+  obj1 = create_custom_tlobj ();
+  g_object_set (obj, "start", (guint64) 0, "duration", (guint64) 10, NULL);
+  g_object_set (obj1, "start", (guint64) 10, "duration", (guint64) 10, NULL);
+
+  fail_unless (ges_timeline_layer_add_object (layer, obj));
+  fail_unless (ges_timeline_layer_add_object (layer, obj1));
+
+  tckobjs = ges_timeline_object_get_track_objects (obj);
+  tckobj = GES_TRACK_OBJECT (tckobjs->data);
+  g_list_free_full (tckobjs, g_object_unref);
+  tckobjs = ges_timeline_object_get_track_objects (obj1);
+  tckobj1 = GES_TRACK_OBJECT (tckobjs->data);
+  g_list_free_full (tckobjs, g_object_unref);
+
+  ges_timeline_begin_edit (timeline);
+  fail_if (ges_timeline_is_updating (timeline));
+
+  /* Nested batches are only committed by the outermost one */
+  ges_timeline_begin_edit (timeline);
+  ges_timeline_object_set_start (obj, 30);
+  fail_unless (ges_timeline_commit_edit (timeline));
+  fail_if (ges_timeline_is_updating (timeline));
+
+  /* Editing modes still see the objects in the right order:
+   *
+   * inpoints  0--------        0--------
+   *           |  obj1  |       |  obj   |
+   * time     10--------20     30--------40
+   */
+  fail_unless (ges_timeline_object_edit (obj1, NULL, -1, GES_EDIT_MODE_RIPPLE,
+          GES_EDGE_NONE, 15) == TRUE);
+  CHECK_OBJECT_PROPS (tckobj, 35, 0, 10);
+  CHECK_OBJECT_PROPS (tckobj1, 15, 0, 10);
+
+  fail_unless (ges_timeline_commit_edit (timeline));
+  fail_unless (ges_timeline_is_updating (timeline));
+  assert_equals_uint64 (ges_timeline_get_duration (timeline), 45);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -953,6 +1017,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_basic_timeline_edition);
   tcase_add_test (tc_chain, test_snapping);
   tcase_add_test (tc_chain, test_timeline_edition_mode);
+  tcase_add_test (tc_chain, test_batch_edition);
 
   return s;
 }
@@ -20,6 +20,10 @@
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
 
+/* ges-internal.h sets its own default debug category */
+#undef GST_CAT_DEFAULT
+#include <ges/ges-internal.h>
+
 GST_START_TEST (test_title_source_basic)
 {
   GESTimelineTitleSource *source;
@@ -215,6 +219,218 @@ GST_START_TEST (test_title_source_in_layer)
 
 GST_END_TEST;
 
+/* A pipeline playing @source for 200ms in a @width wide track */
+static GESTimelinePipeline *
+title_pipeline_new (GESTimelineTitleSource * source, gint width)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelinePipeline *pipeline;
+  GESTrack *track;
+  GstElement *sink;
+  gchar *caps;
+
+  timeline = ges_timeline_new ();
+  caps = g_strdup_printf ("video/x-raw,format=I420,width=%d,height=%d",
+      width, width * 3 / 4);
+  track = ges_track_new (GES_TRACK_TYPE_VIDEO, gst_caps_from_string (caps));
+  g_free (caps);
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  g_object_set (source, "duration", GST_SECOND / 5, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (source)));
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+
+  pipeline = ges_timeline_pipeline_new ();
+  ges_timeline_pipeline_preview_set_video_sink (pipeline, sink);
+  fail_unless (ges_timeline_pipeline_add_timeline (pipeline, timeline));
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_PREVIEW_VIDEO));
+
+  return pipeline;
+}
+
+/* Plays @pipeline from the start to the end */
+static void
+play_title (GESTimelinePipeline * pipeline)
+{
+  GstElement *element = GST_ELEMENT (pipeline);
+  GstBus *bus;
+  GstMessage *message;
+
+  gst_element_set_state (element, GST_STATE_PAUSED);
+  fail_if (gst_element_get_state (element, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE);
+  fail_unless (gst_element_seek_simple (element, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, 0));
+  fail_if (gst_element_get_state (element, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (element);
+  gst_element_set_state (element, GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+}
+
+static void
+title_pipeline_free (GESTimelinePipeline * pipeline)
+{
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+static GstPadProbeReturn
+count_rendered_cb (GstPad * pad, GstPadProbeInfo * info, gint * rendered)
+{
+  g_atomic_int_inc (rendered);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Counts the frames on which the text of @source is rendered in @rendered */
+static void
+count_rendered_frames (GESTimelineTitleSource * source, gint * rendered)
+{
+  GList *trackobjects;
+  GstElement *text;
+  GstPad *pad;
+
+  trackobjects = ges_timeline_object_get_track_objects (GES_TIMELINE_OBJECT
+      (source));
+  fail_unless (trackobjects != NULL);
+  text = gst_bin_get_by_name (GST_BIN (ges_track_object_get_element
+          (GES_TRACK_OBJECT (trackobjects->data))), "titlsrc-text");
+  fail_unless (text != NULL);
+
+  pad = gst_element_get_static_pad (text, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) count_rendered_cb, rendered, NULL);
+  gst_object_unref (pad);
+
+  gst_object_unref (text);
+  g_list_free_full (trackobjects, g_object_unref);
+}
+
+GST_START_TEST (test_title_source_frame_reuse)
+{
+  GESLruCache *cache;
+  GESTimelineTitleSource *source;
+  GESTimelinePipeline *pipeline, *other;
+  gsize frame_size;
+  gint rendered = 0, other_rendered = 0;
+
+  ges_init ();
+
+  cache = ges_track_title_source_get_frame_cache ();
+  assert_equals_int (ges_lru_cache_get_size (cache), 0);
+
+  source = ges_timeline_title_source_new ();
+  g_object_set (source, "text", "reused", NULL);
+  pipeline = title_pipeline_new (source, 64);
+  count_rendered_frames (source, &rendered);
+
+  /* A single frame is rendered for the whole title, the preroll of the
+   * pipeline may render it before the seek */
+  play_title (pipeline);
+  frame_size = ges_lru_cache_get_size (cache);
+  fail_unless (frame_size > 0);
+  fail_unless (rendered > 0);
+  fail_unless (rendered <= 2);
+
+  /* Playing it again outputs the cached frame */
+  play_title (pipeline);
+  assert_equals_int (ges_lru_cache_get_size (cache), frame_size);
+  fail_unless (rendered <= 2);
+
+  /* And so does another title with the same configuration, without
+   * rendering anything */
+  source = ges_timeline_title_source_new ();
+  g_object_set (source, "text", "reused", NULL);
+  other = title_pipeline_new (source, 64);
+  count_rendered_frames (source, &other_rendered);
+  play_title (other);
+  assert_equals_int (ges_lru_cache_get_size (cache), frame_size);
+  assert_equals_int (other_rendered, 0);
+
+  title_pipeline_free (other);
+  title_pipeline_free (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_title_source_frame_invalidation)
+{
+  GESLruCache *cache;
+  GESTimelineTitleSource *source;
+  GESTimelinePipeline *pipeline;
+  GESTrackObject *trobj;
+  GstElement *background;
+  GList *trackobjects;
+  gsize frame_size, size;
+  gint rendered = 0;
+
+  ges_init ();
+
+  cache = ges_track_title_source_get_frame_cache ();
+
+  source = ges_timeline_title_source_new ();
+  g_object_set (source, "text", "first", NULL);
+  pipeline = title_pipeline_new (source, 64);
+  play_title (pipeline);
+  frame_size = ges_lru_cache_get_size (cache);
+  fail_unless (frame_size > 0);
+
+  /* Each change renders and caches a new frame */
+  g_object_set (source, "text", "second", NULL);
+  play_title (pipeline);
+  assert_equals_int (ges_lru_cache_get_size (cache), 2 * frame_size);
+
+  g_object_set (source, "font-desc", "sans 24", NULL);
+  play_title (pipeline);
+  assert_equals_int (ges_lru_cache_get_size (cache), 3 * frame_size);
+
+  title_pipeline_free (pipeline);
+
+  /* A smaller output is a smaller frame */
+  source = ges_timeline_title_source_new ();
+  g_object_set (source, "text", "second", "font-desc", "sans 24", NULL);
+  pipeline = title_pipeline_new (source, 32);
+  play_title (pipeline);
+  size = ges_lru_cache_get_size (cache);
+  fail_unless (size > 3 * frame_size);
+  fail_unless (size < 4 * frame_size);
+  count_rendered_frames (source, &rendered);
+
+  /* Animated backgrounds are rendered on each frame and never cached */
+  trackobjects = ges_timeline_object_get_track_objects (GES_TIMELINE_OBJECT
+      (source));
+  fail_unless (trackobjects != NULL);
+  trobj = GES_TRACK_OBJECT (trackobjects->data);
+  background = gst_bin_get_by_name (GST_BIN (ges_track_object_get_element
+          (trobj)), "titlesrc-bg");
+  fail_unless (background != NULL);
+  g_object_set (background, "pattern", (gint) GES_VIDEO_TEST_PATTERN_SNOW,
+      NULL);
+  gst_object_unref (background);
+  g_list_free_full (trackobjects, g_object_unref);
+
+  play_title (pipeline);
+  assert_equals_int (ges_lru_cache_get_size (cache), size);
+  fail_unless (rendered > 2);
+
+  title_pipeline_free (pipeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -226,6 +442,8 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_title_source_basic);
   tcase_add_test (tc_chain, test_title_source_properties);
   tcase_add_test (tc_chain, test_title_source_in_layer);
+  tcase_add_test (tc_chain, test_title_source_frame_reuse);
+  tcase_add_test (tc_chain, test_title_source_frame_invalidation);
 
   return s;
 }
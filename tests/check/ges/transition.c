@@ -20,6 +20,7 @@
 
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
+#include <gst/audio/audio.h>
 
 /* This test uri will eventually have to be fixed */
 #define TEST_URI "blahblahblah"
@@ -176,6 +177,431 @@ GST_START_TEST (test_transition_properties)
 GST_END_TEST;
 
 
+static void
+handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    guint8 * pixels)
+{
+  GstMapInfo map;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  /* First and last pixels of the first row */
+  pixels[0] = map.data[0];
+  pixels[1] = map.data[63];
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* Blends black frames in @format_a with white frames in @format_b, the
+ * output is in @format_a */
+static void
+blend_frame_formats (const gchar * format_a, const gchar * format_b,
+    GESVideoStandardTransitionType type, gdouble position, guint8 * pixels)
+{
+  GstElement *pipeline, *blend, *sink;
+  GstMessage *message;
+  GstBus *bus;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=1 pattern=black ! "
+      "video/x-raw,format=%s,width=64,height=48 ! gesvideoblend name=blend "
+      "! fakesink name=sink signal-handoffs=true "
+      "videotestsrc num-buffers=1 pattern=white ! "
+      "video/x-raw,format=%s,width=64,height=48 ! videoconvert ! "
+      "blend.sink_b", format_a, format_b);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  blend = gst_bin_get_by_name (GST_BIN (pipeline), "blend");
+  g_object_set (blend, "transition-type", type, "position", position, NULL);
+  gst_object_unref (blend);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), pixels);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+static void
+blend_frame (GESVideoStandardTransitionType type, gdouble position,
+    guint8 * pixels)
+{
+  blend_frame_formats ("GRAY8", "GRAY8", type, position, pixels);
+}
+
+GST_START_TEST (test_video_blend)
+{
+  guint8 black[2], white[2], pixels[2];
+
+  ges_init ();
+
+  blend_frame (GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE, 0.0, black);
+  blend_frame (GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE, 1.0, white);
+  fail_unless (black[0] < white[0]);
+
+  blend_frame (GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE, 0.5, pixels);
+  assert_equals_int (pixels[0],
+      black[0] + (((white[0] - black[0]) * 128 + 128) >> 8));
+  assert_equals_int (pixels[1], pixels[0]);
+
+  /* Half way through a left to right wipe */
+  blend_frame (GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR, 0.5, pixels);
+  assert_equals_int (pixels[0], white[0]);
+  assert_equals_int (pixels[1], black[1]);
+
+  /* An RGB input is converted to the YUV format of the output, the luma
+   * plane comes first */
+  blend_frame_formats ("I420", "RGB",
+      GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE, 0.0, black);
+  blend_frame_formats ("I420", "RGB",
+      GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE, 1.0, white);
+  fail_unless (black[0] < 32);
+  fail_unless (white[0] > 224);
+  assert_equals_int (white[1], white[0]);
+
+  blend_frame_formats ("I420", "RGB",
+      GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE, 0.5, pixels);
+  assert_equals_int (pixels[0],
+      black[0] + (((white[0] - black[0]) * 128 + 128) >> 8));
+
+  blend_frame_formats ("I420", "RGB",
+      GES_VIDEO_STANDARD_TRANSITION_TYPE_BAR_WIPE_LR, 0.5, pixels);
+  assert_equals_int (pixels[0], white[0]);
+  assert_equals_int (pixels[1], black[1]);
+}
+
+GST_END_TEST;
+
+#define BLENDED_FRAMES 10
+
+typedef struct
+{
+  guint8 luma[BLENDED_FRAMES];
+  guint n_frames;
+} BlendedFrames;
+
+static void
+blended_frame_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    BlendedFrames * frames)
+{
+  GstMapInfo map;
+
+  /* What is left of the second input once the first one is EOS */
+  if (frames->n_frames == BLENDED_FRAMES)
+    return;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  frames->luma[frames->n_frames++] = map.data[0];
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* Shows the second input of a crossfade between a 25fps input and an
+ * input at @fps_n/@fps_d, whose frames have a luma of 10 times their index */
+static void
+blend_framerates (gint fps_n, gint fps_d, guint8 * luma)
+{
+  GstElement *pipeline, *src, *sink;
+  BlendedFrames frames = { {0}, 0 };
+  GstFlowReturn ret;
+  GstMessage *message;
+  GstBus *bus;
+  gchar *desc;
+  GstClockTime frame_duration;
+  guint i, n_buffers;
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=%d pattern=black ! "
+      "video/x-raw,format=GRAY8,width=64,height=48,framerate=25/1 ! "
+      "gesvideoblend name=blend position=1.0 ! "
+      "fakesink name=sink signal-handoffs=true "
+      "appsrc name=src format=time caps=video/x-raw,format=GRAY8,width=64,"
+      "height=48,framerate=%d/%d ! blend.sink_b", BLENDED_FRAMES, fps_n, fps_d);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  /* As long as the first input */
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  n_buffers = BLENDED_FRAMES * fps_n / (25 * fps_d);
+  frame_duration = gst_util_uint64_scale_int (GST_SECOND, fps_d, fps_n);
+  for (i = 0; i < n_buffers; i++) {
+    GstBuffer *buffer = gst_buffer_new_allocate (NULL, 64 * 48, NULL);
+
+    gst_buffer_memset (buffer, 0, i * 10, 64 * 48);
+    GST_BUFFER_TIMESTAMP (buffer) = i * frame_duration;
+    GST_BUFFER_DURATION (buffer) = frame_duration;
+    g_signal_emit_by_name (src, "push-buffer", buffer, &ret);
+    gst_buffer_unref (buffer);
+  }
+  g_signal_emit_by_name (src, "end-of-stream", &ret);
+  gst_object_unref (src);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (blended_frame_cb), &frames);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  assert_equals_int (frames.n_frames, BLENDED_FRAMES);
+  for (i = 0; i < BLENDED_FRAMES; i++)
+    luma[i] = frames.luma[i];
+}
+
+GST_START_TEST (test_video_blend_framerates)
+{
+  guint8 luma[BLENDED_FRAMES];
+  guint i;
+
+  ges_init ();
+
+  /* Every other frame of a 50fps input is dropped */
+  blend_framerates (50, 1, luma);
+  for (i = 0; i < BLENDED_FRAMES; i++)
+    assert_equals_int (luma[i], 20 * i);
+
+  /* Each frame of a 12.5fps input is shown twice */
+  blend_framerates (25, 2, luma);
+  for (i = 0; i < BLENDED_FRAMES; i++)
+    assert_equals_int (luma[i], 10 * (i / 2));
+}
+
+GST_END_TEST;
+
+static void
+peak_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad, gfloat * peak)
+{
+  GstMapInfo map;
+  gfloat *samples;
+  guint i;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  samples = (gfloat *) map.data;
+  for (i = 0; i < map.size / sizeof (gfloat); i++)
+    *peak = MAX (*peak, ABS (samples[i]));
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* Crossfades a sine wave into silence and returns the peak of the output */
+static gfloat
+crossfade_peak (guint64 duration, GESAudioTransitionCurve curve)
+{
+  GstElement *pipeline, *crossfade, *sink;
+  GstMessage *message;
+  GstBus *bus;
+  gfloat peak = 0;
+
+  pipeline = gst_parse_launch ("audiotestsrc num-buffers=4 wave=sine ! "
+      "audio/x-raw,format=" GST_AUDIO_NE (F32) ",rate=44100,channels=2 ! "
+      "gesaudiocrossfade name=crossfade ! "
+      "fakesink name=sink signal-handoffs=true "
+      "audiotestsrc num-buffers=4 wave=silence ! "
+      "audio/x-raw,format=" GST_AUDIO_NE (F32) ",rate=44100,channels=2 ! "
+      "crossfade.sink_b", NULL);
+  fail_unless (pipeline != NULL);
+
+  crossfade = gst_bin_get_by_name (GST_BIN (pipeline), "crossfade");
+  g_object_set (crossfade, "duration", duration, "curve", curve, NULL);
+  gst_object_unref (crossfade);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (peak_cb), &peak);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return peak;
+}
+
+typedef struct
+{
+  gboolean s16;
+  GArray *samples;
+} CrossfadeOutput;
+
+static void
+samples_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    CrossfadeOutput * output)
+{
+  GstMapInfo map;
+  gdouble value;
+  guint i;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  if (output->s16) {
+    for (i = 0; i < map.size / sizeof (gint16); i++) {
+      value = ((gint16 *) map.data)[i] / 32767.0;
+      g_array_append_val (output->samples, value);
+    }
+  } else {
+    for (i = 0; i < map.size / sizeof (gfloat); i++) {
+      value = ((gfloat *) map.data)[i];
+      g_array_append_val (output->samples, value);
+    }
+  }
+  gst_buffer_unmap (buffer, &map);
+}
+
+#define FADE_SAMPLES 4410
+
+/* Crossfades a constant signal of amplitude 0.5 on the first or the second
+ * input with silence on the other one, during FADE_SAMPLES mono samples,
+ * and stores the gain applied to that signal at each of the @positions of
+ * the fade */
+static void
+crossfade_gains (const gchar * format, GESAudioTransitionCurve curve,
+    gboolean second, const gdouble * positions, gdouble * gains, guint n)
+{
+  GstElement *pipeline, *crossfade, *sink;
+  GstMessage *message;
+  GstBus *bus;
+  CrossfadeOutput output;
+  gchar *desc;
+  guint i;
+
+  /* A square wave this slow stays at its maximum for five seconds */
+  desc = g_strdup_printf ("audiotestsrc num-buffers=20 samplesperbuffer=441 "
+      "wave=%s volume=0.5 freq=0.1 ! "
+      "audio/x-raw,format=%s,rate=44100,channels=1 ! "
+      "gesaudiocrossfade name=crossfade ! "
+      "fakesink name=sink signal-handoffs=true "
+      "audiotestsrc num-buffers=20 samplesperbuffer=441 "
+      "wave=%s volume=0.5 freq=0.1 ! "
+      "audio/x-raw,format=%s,rate=44100,channels=1 ! crossfade.sink_b",
+      second ? "silence" : "square", format,
+      second ? "square" : "silence", format);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  crossfade = gst_bin_get_by_name (GST_BIN (pipeline), "crossfade");
+  g_object_set (crossfade, "duration", (guint64) FADE_SAMPLES * GST_SECOND /
+      44100, "curve", curve, NULL);
+  gst_object_unref (crossfade);
+
+  output.s16 = !g_strcmp0 (format, GST_AUDIO_NE (S16));
+  output.samples = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (samples_cb), &output);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_EOS);
+  gst_message_unref (message);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  assert_equals_int (output.samples->len, 20 * 441);
+  for (i = 0; i < n; i++)
+    gains[i] = g_array_index (output.samples, gdouble,
+        (guint) (positions[i] * FADE_SAMPLES)) / 0.5;
+  g_array_free (output.samples, TRUE);
+}
+
+#define fail_unless_gain(gain, expected) \
+  fail_unless (ABS ((gain) - (expected)) < 0.01, \
+      "Gain %f instead of %f", (gain), (expected))
+
+/* Start, a quarter, half way through the fade, and after it */
+static const gdouble fade_positions[] = { 0.0, 0.25, 0.5, 1.5 };
+
+static void
+check_crossfade_curve (const gchar * format, GESAudioTransitionCurve curve,
+    const gdouble * expected_a, const gdouble * expected_b)
+{
+  gdouble gains[G_N_ELEMENTS (fade_positions)];
+  guint i;
+
+  crossfade_gains (format, curve, FALSE, fade_positions, gains,
+      G_N_ELEMENTS (fade_positions));
+  for (i = 0; i < G_N_ELEMENTS (fade_positions); i++)
+    fail_unless_gain (gains[i], expected_a[i]);
+
+  crossfade_gains (format, curve, TRUE, fade_positions, gains,
+      G_N_ELEMENTS (fade_positions));
+  for (i = 0; i < G_N_ELEMENTS (fade_positions); i++)
+    fail_unless_gain (gains[i], expected_b[i]);
+}
+
+GST_START_TEST (test_audio_crossfade)
+{
+  GESTrackAudioTransition *transition;
+
+  ges_init ();
+
+  transition = ges_track_audio_transition_new ();
+  assert_equals_int (ges_track_audio_transition_get_curve (transition),
+      GES_AUDIO_TRANSITION_CURVE_LINEAR);
+  ges_track_audio_transition_set_curve (transition,
+      GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER);
+  assert_equals_int (ges_track_audio_transition_get_curve (transition),
+      GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER);
+  g_object_unref (transition);
+
+  /* An empty crossfade only lets the second input through */
+  fail_unless (crossfade_peak (0, GES_AUDIO_TRANSITION_CURVE_LINEAR) == 0.0);
+
+  /* A long one barely attenuates the first one */
+  fail_unless (crossfade_peak (100 * GST_SECOND,
+          GES_AUDIO_TRANSITION_CURVE_LINEAR) > 0.7);
+  fail_unless (crossfade_peak (100 * GST_SECOND,
+          GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER) > 0.7);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_audio_crossfade_gains)
+{
+  /* Equal power gains are the cos and sin of the position times pi / 2 */
+  const gdouble linear_a[] = { 1.0, 0.75, 0.5, 0.0 };
+  const gdouble linear_b[] = { 0.0, 0.25, 0.5, 1.0 };
+  const gdouble power_a[] = { 1.0, 0.92388, 0.70711, 0.0 };
+  const gdouble power_b[] = { 0.0, 0.38268, 0.70711, 1.0 };
+
+  ges_init ();
+
+  check_crossfade_curve (GST_AUDIO_NE (F32),
+      GES_AUDIO_TRANSITION_CURVE_LINEAR, linear_a, linear_b);
+  check_crossfade_curve (GST_AUDIO_NE (F32),
+      GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER, power_a, power_b);
+  check_crossfade_curve (GST_AUDIO_NE (S16),
+      GES_AUDIO_TRANSITION_CURVE_LINEAR, linear_a, linear_b);
+  check_crossfade_curve (GST_AUDIO_NE (S16),
+      GES_AUDIO_TRANSITION_CURVE_EQUAL_POWER, power_a, power_b);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 ges_suite (void)
@@ -187,6 +613,10 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_transition_basic);
   tcase_add_test (tc_chain, test_transition_properties);
+  tcase_add_test (tc_chain, test_video_blend);
+  tcase_add_test (tc_chain, test_video_blend_framerates);
+  tcase_add_test (tc_chain, test_audio_crossfade);
+  tcase_add_test (tc_chain, test_audio_crossfade_gains);
 
   return s;
 }
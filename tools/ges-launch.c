@@ -24,8 +24,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <glib.h>
 #include <glib/gprintf.h>
+#include <glib/gstdio.h>
 #include <ges/ges.h>
 #include <gst/pbutils/encoding-profile.h>
 
@@ -299,6 +301,61 @@ failure:
   }
 }
 
+static gboolean
+render_parallel (gchar * load_path, gchar * save_path, int argc, char **argv,
+    gchar * audio, gchar * video, gchar * outputuri,
+    GstEncodingProfile * prof, gint jobs)
+{
+  GESTimeline *timeline;
+  gchar *uri, *tmpname = NULL;
+  gboolean res;
+
+  /* Every job loads its own copy of the project */
+  if (load_path) {
+    if (!(uri = ensure_uri (load_path))) {
+      g_error ("couldn't create uri for '%s'", load_path);
+      return FALSE;
+    }
+  } else {
+    if (!(timeline = create_timeline (argc, argv, audio, video)))
+      return FALSE;
+
+    if (save_path) {
+      uri = ensure_uri (save_path);
+    } else {
+      gint fd = g_file_open_tmp ("ges-launch-XXXXXX", &tmpname, NULL);
+
+      if (fd == -1) {
+        g_object_unref (timeline);
+        g_error ("couldn't create a temporary project file");
+        return FALSE;
+      }
+      close (fd);
+      uri = gst_filename_to_uri (tmpname, NULL);
+    }
+
+    res = uri && ges_timeline_save_to_uri (timeline, uri);
+    g_object_unref (timeline);
+
+    if (!res) {
+      g_error ("couldn't save the project to '%s'", uri);
+      return FALSE;
+    }
+  }
+
+  g_printf ("Rendering with up to %d jobs\n", jobs);
+  res = ges_parallel_render (uri, outputuri, prof, jobs);
+  g_printf ("%s\n", res ? "Done" : "Rendering failed");
+
+  if (tmpname) {
+    g_unlink (tmpname);
+    g_free (tmpname);
+  }
+  g_free (uri);
+
+  return res;
+}
+
 static void
 bus_message_cb (GstBus * bus, GstMessage * message, GMainLoop * mainloop)
 {
@@ -407,6 +464,7 @@ main (int argc, gchar ** argv)
   static gboolean list_transitions = FALSE;
   static gboolean list_patterns = FALSE;
   static gdouble thumbinterval = 0;
+  static gint jobs = 1;
   static gboolean verbose = FALSE;
   gchar *save_path = NULL;
   gchar *load_path = NULL;
@@ -418,6 +476,9 @@ main (int argc, gchar ** argv)
         "Render to outputuri", NULL},
     {"smartrender", 's', 0, G_OPTION_ARG_NONE, &smartrender,
         "Render to outputuri, and avoid decoding/reencoding", NULL},
+    {"jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+        "Render in up to N pipelines at once (needs a concatenable container "
+          "such as Ogg)", "N"},
     {"outputuri", 'o', 0, G_OPTION_ARG_STRING, &outputuri,
         "URI to encode to", "URI (<protocol>://<location>)"},
     {"format", 'f', 0, G_OPTION_ARG_STRING, &container,
@@ -514,6 +575,29 @@ main (int argc, gchar ** argv)
   if (strcmp (video, "none") == 0)
     video = NULL;
 
+  /* Render several ranges of the timeline at once */
+  if (render && jobs > 1) {
+    GstEncodingProfile *prof;
+    gboolean res;
+
+    prof = make_encoding_profile (audio, video, video_restriction, audio_preset,
+        video_preset, container);
+
+    if (!prof || !ges_parallel_render_can_concatenate (prof)) {
+      g_printerr ("Container %s can not be rendered with several jobs\n",
+          container);
+      res = FALSE;
+    } else
+      res = render_parallel (load_path, save_path, argc - 1, argv + 1, audio,
+          video, outputuri, prof, jobs);
+
+    if (prof)
+      gst_encoding_profile_unref (prof);
+    g_free (outputuri);
+
+    return res ? 0 : 1;
+  }
+
   /* Create the pipeline */
   pipeline = create_pipeline (load_path, save_path, argc - 1, argv + 1,
       audio, video);